@@ -885,7 +885,6 @@ void Grid3DNoFile<T>::reset()
 template <class T>
 GridBlock<T>* Grid3DNoFile<T>::findBlock(long x, long y)
 {
-    errorVal = 0;
     GridBlock<T> *current;// = myMap; //set the pointer to look at the original map block
 
 	if(lastAccessedBlock == 0)
@@ -905,14 +904,28 @@ GridBlock<T>* Grid3DNoFile<T>::findBlock(long x, long y)
 		//}
 	}
 	
+	current = findBlockFrom(current,x,y,errorVal);
+	if(current != 0)
+	{
+		lastAccessedBlock = current;
+	}
+	return current;
+}
+
+//walks from the block 'current' to the block holding (x,y).  If there is no such block, 0 is
+//returned and 'error' is the direction the map would have to grow in.  Nothing in the map is
+//changed, so any number of threads can walk it while nobody writes to the map
+template <class T>
+GridBlock<T>* Grid3DNoFile<T>::findBlockFrom(GridBlock<T>* current, long x, long y, int& error)
+{
+    error = 0;
+
     while(1)
     {
 		//if the grid reference we're looking for is in this current grid
 		if(x >= current->globOrigin[XX] && x < current->globOrigin[XX] + blockSize
 			&& y >= current->globOrigin[YY] && y < current->globOrigin[YY] + blockSize)
 		{
-			
-			lastAccessedBlock = current;
 			return current;
 		}	
 		
@@ -922,7 +935,7 @@ GridBlock<T>* Grid3DNoFile<T>::findBlock(long x, long y)
 		if(x >= current->globOrigin[XX] + blockSize)//check west first
 		{
 			if(current->east == 0)
-			{	errorVal = EAST;
+			{	error = EAST;
 			return 0;
 			}
 			else 
@@ -932,7 +945,7 @@ GridBlock<T>* Grid3DNoFile<T>::findBlock(long x, long y)
 		{
 			if( current->north == 0)
 			{	
-				errorVal = NORTH;
+				error = NORTH;
 				return 0;
 			}
 			else
@@ -942,7 +955,7 @@ GridBlock<T>* Grid3DNoFile<T>::findBlock(long x, long y)
 		{	
 			if(current->south == 0)
 			{
-				errorVal = SOUTH;
+				error = SOUTH;
 				return 0;
 			}
 			else
@@ -952,7 +965,7 @@ GridBlock<T>* Grid3DNoFile<T>::findBlock(long x, long y)
 		{
 			if( current->north == 0)
 			{	
-				errorVal = NORTH;
+				error = NORTH;
 				return 0;
 			}
 			else
@@ -962,7 +975,7 @@ GridBlock<T>* Grid3DNoFile<T>::findBlock(long x, long y)
 		{
 			if(current->west ==0)
 			{	
-				errorVal = WEST;
+				error = WEST;
 				return 0;
 			}
 			else
@@ -1231,6 +1244,21 @@ void Grid3DNoFile<T>::translate(long xDist, long yDist)
 
 template <class T>
 bool Grid3DNoFile<T>::copyRow(T* arrayRef, long y, long fromX, long toX, long z)
+{
+	return copyRowFrom(lastAccessedBlock != 0 ? lastAccessedBlock : myMap,arrayRef,y,fromX,toX,z);
+}
+
+//copyRow() without the block lastAccessedBlock points to, so several threads can copy rows of
+//the map at the same time, as long as none of them writes to it
+template <class T>
+bool Grid3DNoFile<T>::copyRowConcurrent(T* arrayRef, long y, long fromX, long toX, long z)
+{
+	return copyRowFrom(myMap,arrayRef,y,fromX,toX,z);
+}
+
+//the row is looked for from the block 'start', see findBlockFrom()
+template <class T>
+bool Grid3DNoFile<T>::copyRowFrom(GridBlock<T>* start, T* arrayRef, long y, long fromX, long toX, long z)
 {
 	if(arrayRef == 0 || z > blockHeight - 1 || fromX > toX)
     {
@@ -1261,7 +1289,8 @@ bool Grid3DNoFile<T>::copyRow(T* arrayRef, long y, long fromX, long toX, long z)
 	}
 
 	GridBlock<T> *current = 0;
-	current = findBlock(fromX,y);
+	int error = 0;
+	current = findBlockFrom(start,fromX,y,error);
 
 	if(current == 0)
 		return false;
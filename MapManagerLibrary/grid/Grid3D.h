@@ -110,12 +110,17 @@ class Grid3DNoFile: public ICopyRow3D<T>
 		void translate(long xDist, long yDist);
 
 		bool copyRow(T* arrayRef, long y, long fromX, long toX, long z = 0);
+
+		//the same as copyRow, for threads reading the map at the same time
+		bool copyRowConcurrent(T* arrayRef, long y, long fromX, long toX, long z = 0);
 	protected:
 		void appendBlock(GridBlock<T>* original_block, GridBlock<T>* new_block, int direction);
 		int growMap(int times, int direction=0);
 		GridBlock<T> * newBlock();
 		
 		GridBlock<T>* findBlock(long x, long y);
+		GridBlock<T>* findBlockFrom(GridBlock<T>* current, long x, long y, int& error);
+		bool copyRowFrom(GridBlock<T>* start, T* arrayRef, long y, long fromX, long toX, long z);
 
 		void init(int blocksize, int radius, T Unknown, int blockheight);
 		
@@ -291,6 +291,12 @@ bool GridMap<T>::copyRow(T* arrayRef, long y, long fromX, long toX)
 	return Grid3D<T>::copyRow(arrayRef,y,fromX,toX,0);
 }
 
+template <class T>
+bool GridMap<T>::copyRowConcurrent(T* arrayRef, long y, long fromX, long toX)
+{
+	return Grid3D<T>::copyRowConcurrent(arrayRef,y,fromX,toX,0);
+}
+
 
 //------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------
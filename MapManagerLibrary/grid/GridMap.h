@@ -117,6 +117,9 @@ class GridMap : public Grid3D<T>, public ICopyRow2D<T>
 			long viewHeight, long viewWidth,bool doubleLine = true);
 
 		bool copyRow(T* arrayRef, long y, long fromX, long toX);		
+
+		//copyRow for threads that read the map at the same time, see Grid3DNoFile
+		bool copyRowConcurrent(T* arrayRef, long y, long fromX, long toX);
 	private:
 		DEF_LOG
 
@@ -88,6 +88,12 @@ public:
 
 	bool remove();//removes the node currently being accessed with the iterator
 
+	//push() that gives back the node the value went into, so removeNode() can take it out
+	//again without looking for it.  Only in the queue and stack modes
+	ListNode<T>* pushNode(const T& val);
+	//the node stays good until it is removed or the list is cleared
+	void removeNode(ListNode<T>* node);
+
 	bool replace(const T& val);
 	bool replaceSequence(const T &firstVal, const T& lastVal, List<T>& sequenceReplacement);
 
@@ -174,36 +180,36 @@ private:
 };
 
 
-template List<int>;
-template List<double>;
-template List<float>;
-template List<long>;
-template List<PathNode>;
-template List<LineXY>;
+template class List<int>;
+template class List<double>;
+template class List<float>;
+template class List<long>;
+template class List<PathNode>;
+template class List<LineXY>;
 
 #if 0  //enable-disable lists this way
 
-template List<DrawableRectangle>;
-template List<DrawableRectangleFilled>;
-template List<DrawableLine>;
-template List<RectObject>;
+template class List<DrawableRectangle>;
+template class List<DrawableRectangleFilled>;
+template class List<DrawableLine>;
+template class List<RectObject>;
 #endif
 
-template List<LineXYLayer>;
+template class List<LineXYLayer>;
 
 
 //this is a list of LayerValue, each of which contains a list of points belonging to a layer
-template List<LayerValue<List<PointXY>*> >;
-template List<LayerValue<float> >;
+template class List<LayerValue<List<PointXY>*> >;
+template class List<LayerValue<float> >;
 
 #ifndef POINTXYZ_ALREADY_DEFINED
-template List<PointXY>;
+template class List<PointXY>;
 #endif
 
-template List<PointXYZ>;
+template class List<PointXYZ>;
 
 
-template ListUnordered<SosPose>;
+template class ListUnordered<SosPose>;
 
 template<class T>
 List<T>::List()
@@ -787,6 +793,28 @@ bool List<T>::remove()
 	return true;
 }
 
+template<class T>
+ListNode<T>* List<T>::pushNode(const T& val)
+{
+	push(val);
+	return (_mode == MODE_STACK) ? _head : _tail;
+}
+
+template<class T>
+void List<T>::removeNode(ListNode<T>* node)
+{
+	if(node == _iterCurrent)
+	{
+		_iterCurrent = node->next;
+		_advanceIteration = false;
+	}
+
+	deleteNode(node);
+	_listSize--;
+	if(_head == 0)
+		_tail = _iterCurrent = 0;
+}
+
 
 template<class T>
 void List<T>::deleteNode(ListNode<T>* node)
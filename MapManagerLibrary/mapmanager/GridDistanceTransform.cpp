@@ -0,0 +1,461 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#include "GridDistanceTransform.h"
+#include "../sosutil/Threaded.h"
+#include <float.h>
+#include <string.h>
+
+//the passes, in the order they are run
+#define DISTANCE_COLUMN_PASS	0
+#define DISTANCE_ROW_PASS		1
+#define DISTANCE_RIDGE_PASS		2
+
+//the directions from a cell to its neighbours, anticlockwise from east.  The odd ones are the
+//diagonals
+static const int linkX[] = {1,1,0,-1,-1,-1,0,1};
+static const int linkY[] = {0,1,1,1,0,-1,-1,-1};
+
+//one pass of the transform, a stripe to a part
+class GridDistancePass : public IThreadedParts
+{
+public:
+	GridDistancePass(GridDistanceTransform* transform, int pass)
+	{
+		_transform = transform;
+		_pass = pass;
+	}
+
+	virtual void runPart(int part)
+	{
+		_transform->runPass(_pass,part);
+	}
+
+private:
+	GridDistanceTransform*	_transform;
+	int						_pass;
+};
+
+GridDistanceTransform::GridDistanceTransform()
+{
+	_gridLayer = 0;
+	_gridMap = 0;
+	_xMin = _yMin = _width = _height = 0;
+	_threshold1 = _threshold2 = _minDistance = 0;
+	_numOfStripes = 1;
+}
+
+GridDistanceTransform::~GridDistanceTransform()
+{
+}
+
+bool GridDistanceTransform::transform(GridMapLayer& gridLayer, long xMin, long yMin, long xMax, long yMax,
+									  float threshold1, float threshold2, int numOfThreads)
+{
+	_gridLayer = &gridLayer;
+	_gridMap = 0;
+	return transform(xMin,yMin,xMax,yMax,threshold1,threshold2,numOfThreads);
+}
+
+bool GridDistanceTransform::transform(GridMap<float>& gridMap, long xMin, long yMin, long xMax, long yMax,
+									  float threshold1, float threshold2, int numOfThreads)
+{
+	_gridLayer = 0;
+	_gridMap = &gridMap;
+	return transform(xMin,yMin,xMax,yMax,threshold1,threshold2,numOfThreads);
+}
+
+bool GridDistanceTransform::transform(long xMin, long yMin, long xMax, long yMax, float threshold1,
+									  float threshold2, int numOfThreads)
+{
+	SosUtil::ensureSmaller(threshold1, threshold2);
+
+	_xMin = xMin;
+	_yMin = yMin;
+	_width = xMax - xMin + 1;
+	_height = yMax - yMin + 1;
+	_threshold1 = threshold1;
+	_threshold2 = threshold2;
+	_minDistance = 0;
+
+	if(_width <= 0 || _height <= 0)
+	{
+		_width = _height = 0;
+		return false;
+	}
+
+	//every stripe of both passes has a column or a row
+	_numOfStripes = (numOfThreads > 1) ? numOfThreads : 1;
+	if(_numOfStripes > _width)
+		_numOfStripes = (int)_width;
+	if(_numOfStripes > _height)
+		_numOfStripes = (int)_height;
+
+	_nearestX.resize(_width*_height);
+	_nearestY.resize(_width*_height);
+	_ridge.assign(_width*_height,0);
+	_rowValues.resize(_width);
+	_columnRows.resize(_numOfStripes*_width);
+	_envelope.resize(_numOfStripes*_width);
+	_bounds.resize(_numOfStripes*(_width + 1));
+
+	runStripes(DISTANCE_COLUMN_PASS);
+	runStripes(DISTANCE_ROW_PASS);
+	return true;
+}
+
+void GridDistanceTransform::findRidges(float minDistance)
+{
+	if(_width == 0)
+		return;
+
+	_minDistance = minDistance;
+	runStripes(DISTANCE_RIDGE_PASS);
+}
+
+bool GridDistanceTransform::readRow(float* arrayRef, long y, long fromX, long toX)
+{
+	if(_gridLayer != 0)
+		return _gridLayer->copyRowConcurrent(arrayRef,y,fromX,toX);
+	return _gridMap->copyRowConcurrent(arrayRef,y,fromX,toX);
+}
+
+//stripe 0 is done by the calling thread, the others by the threads
+void GridDistanceTransform::runStripes(int pass)
+{
+	GridDistancePass job(this,pass);
+	runParts(job,_numOfStripes);
+}
+
+void GridDistanceTransform::runPass(int pass, int stripe)
+{
+	switch(pass)
+	{
+	case DISTANCE_COLUMN_PASS: columnPass(stripe); break;
+	case DISTANCE_ROW_PASS: rowPass(stripe); break;
+	case DISTANCE_RIDGE_PASS: ridgePass(stripe); break;
+	}
+}
+
+//The stripe's part of each row is read into the same row buffer, the stripes don't overlap.
+//The loops over x only look at the row before, so they have no branches the compiler can't
+//turn into selects
+void GridDistanceTransform::columnPass(int stripe)
+{
+	long x0 = _width*stripe/_numOfStripes, x1 = _width*(stripe + 1)/_numOfStripes;
+	float* values = &_rowValues[0];
+	int* nearest = &_nearestY[0];
+	float threshold1 = _threshold1, threshold2 = _threshold2;
+	long x = 0, y = 0;
+
+	//up the columns, the nearest occupied cell at or below each cell.  The tests are & and |
+	//rather than && and || so there is no branch in the loop to stop it being vectorised
+	for(y = 0; y < _height; y++)
+	{
+		int* row = nearest + y*_width;
+		int rowY = (int)y;
+		readRow(values + x0,_yMin + y,_xMin + x0,_xMin + x1 - 1);
+
+		if(y == 0)
+		{
+			for(x = x0; x < x1; x++)
+			{
+				float value = values[x];
+				row[x] = ((value < 0) | ((value >= threshold1) & (value <= threshold2))) ? rowY : -1;
+			}
+		}
+		else
+		{
+			const int* below = row - _width;
+			for(x = x0; x < x1; x++)
+			{
+				float value = values[x];
+				int next = below[x];
+				row[x] = ((value < 0) | ((value >= threshold1) & (value <= threshold2))) ? rowY : next;
+			}
+		}
+	}
+
+	//and back down, the nearest cell of the row above is taken when it is above and nearer
+	for(y = _height - 2; y >= 0; y--)
+	{
+		int* row = nearest + y*_width;
+		const int* above = row + _width;
+		int rowY = (int)y;
+		for(x = x0; x < x1; x++)
+		{
+			int up = above[x], down = row[x];
+			row[x] = ((up > rowY) & ((down < 0) | (up - rowY < rowY - down))) ? up : down;
+		}
+	}
+}
+
+//The parabola of column q is (x - q)^2 + (y - columnRows[q])^2.  The envelope holds the columns
+//whose parabola is the lowest somewhere along the row, from left to right, and parabola k of it
+//is the lowest from bounds[k] on.  The squares are whole numbers far below 2^53, so they are
+//exact in doubles
+void GridDistanceTransform::rowPass(int stripe)
+{
+	long y0 = _height*stripe/_numOfStripes, y1 = _height*(stripe + 1)/_numOfStripes;
+	int* columnRows = &_columnRows[stripe*_width];
+	int* envelope = &_envelope[stripe*_width];
+	double* bounds = &_bounds[stripe*(_width + 1)];
+	long x = 0, y = 0, q = 0;
+
+	for(y = y0; y < y1; y++)
+	{
+		int* nearestX = &_nearestX[y*_width];
+		int* nearestY = &_nearestY[y*_width];
+		memcpy(columnRows,nearestY,_width*sizeof(int));
+
+		long k = -1;
+		double s = 0;
+		for(q = 0; q < _width; q++)
+		{
+			if(columnRows[q] < 0)
+				continue;
+
+			double dy = (double)(y - columnRows[q]);
+			double height = dy*dy + (double)q*q;
+			while(k >= 0)
+			{
+				long p = envelope[k];
+				double dp = (double)(y - columnRows[p]);
+				s = (height - (dp*dp + (double)p*p))/(2.0*(q - p));
+				if(s > bounds[k])
+					break;
+				k--;
+			}
+			k++;
+			envelope[k] = (int)q;
+			bounds[k] = (k == 0) ? -DBL_MAX : s;
+		}
+
+		//no occupied cell in the window at all
+		if(k < 0)
+		{
+			for(x = 0; x < _width; x++)
+				nearestX[x] = nearestY[x] = -1;
+			continue;
+		}
+
+		long j = 0;
+		for(x = 0; x < _width; x++)
+		{
+			while(j < k && bounds[j + 1] <= x)
+				j++;
+			nearestX[x] = envelope[j];
+			nearestY[x] = columnRows[envelope[j]];
+		}
+	}
+}
+
+//Each cell only writes itself, so a neighbour in the next stripe is just read.  Of two cells
+//next to each other with nearest cells at least minDistance apart, the one further from its
+//own nearest cell is on the ridge, the left or lower one when they are as far
+void GridDistanceTransform::ridgePass(int stripe)
+{
+	static const int sideX[] = {1,0,-1,0};
+	static const int sideY[] = {0,1,0,-1};
+	long y0 = _height*stripe/_numOfStripes, y1 = _height*(stripe + 1)/_numOfStripes;
+	double minSquared = (double)_minDistance*_minDistance;
+	long x = 0, y = 0;
+
+	for(y = y0; y < y1; y++)
+	{
+		for(x = 0; x < _width; x++)
+		{
+			long cell = y*_width + x;
+			int cellX = _nearestX[cell], cellY = _nearestY[cell];
+			unsigned char ridge = 0;
+
+			if(cellX >= 0 && (cellX != x || cellY != y))
+			{
+				double own = (double)(x - cellX)*(x - cellX) + (double)(y - cellY)*(y - cellY);
+				for(int side = 0; side < 4 && ridge == 0; side++)
+				{
+					long nextX = x + sideX[side], nextY = y + sideY[side];
+					if(nextX < 0 || nextX >= _width || nextY < 0 || nextY >= _height)
+						continue;
+
+					long next = nextY*_width + nextX;
+					int otherX = _nearestX[next], otherY = _nearestY[next];
+					if(otherX < 0 || (otherX == cellX && otherY == cellY))
+						continue;
+					if((double)(otherX - cellX)*(otherX - cellX) + (double)(otherY - cellY)*(otherY - cellY) < minSquared)
+						continue;
+
+					double other = (double)(nextX - otherX)*(nextX - otherX) + (double)(nextY - otherY)*(nextY - otherY);
+					if(own > other || (own == other && side < 2))
+						ridge = 1;
+				}
+			}
+			_ridge[cell] = ridge;
+		}
+	}
+}
+
+bool GridDistanceTransform::ridgeAt(long x, long y) const
+{
+	if(x < 0 || x >= _width || y < 0 || y >= _height)
+		return false;
+	return _ridge[y*_width + x] != 0;
+}
+
+//A diagonal is left out when a cell beside both ends is on the ridge, the line goes through
+//that cell instead.  The cells beside the diagonal are the same seen from either end, so two
+//cells are always joined to each other or not at all
+int GridDistanceTransform::getLinks(long x, long y) const
+{
+	int links = 0;
+	for(int direction = 0; direction < 8; direction++)
+	{
+		if(!ridgeAt(x + linkX[direction],y + linkY[direction]))
+			continue;
+		if((direction & 1) && (ridgeAt(x + linkX[direction - 1],y + linkY[direction - 1]) ||
+			ridgeAt(x + linkX[(direction + 1) & 7],y + linkY[(direction + 1) & 7])))
+			continue;
+		links |= 1 << direction;
+	}
+	return links;
+}
+
+static int countLinks(int links)
+{
+	int count = 0;
+	for(; links != 0; links >>= 1)
+		count += links & 1;
+	return count;
+}
+
+//A chain is followed from each vertex along each of its lines, and pushed from the end with the
+//lower cell, or the lower direction when it comes back to where it started.  The rings of cells
+//with two lines have no vertex, and are left out of the vertex pairs, as generateVoronoi() does
+
+void GridDistanceTransform::getRidges(long resolution, List<LineXY>& lines, List<LineXY>& vertexPairs,
+									  List<PointXY>& vertices)
+{
+	lines.clear();
+	vertexPairs.clear();
+	vertices.clear();
+
+	std::vector<unsigned char> links(_width*_height,0);
+	long x = 0, y = 0, cell = 0;
+	for(cell = 0; cell < _width*_height; cell++)
+	{
+		if(_ridge[cell] != 0)
+			links[cell] = (unsigned char)getLinks(cell%_width,cell/_width);
+	}
+
+	LineXY line;
+	PointXY pt;
+	float res = (float)resolution;
+	for(y = 0; y < _height; y++)
+	{
+		for(x = 0; x < _width; x++)
+		{
+			cell = y*_width + x;
+			if(_ridge[cell] == 0)
+				continue;
+
+			float centreX = (float)(x + _xMin) + 0.5f, centreY = (float)(y + _yMin) + 0.5f;
+			int direction = 0;
+
+			//the lines east to north west, the others are pushed from the other end
+			for(direction = 0; direction < 4; direction++)
+			{
+				if(links[cell] & (1 << direction))
+				{
+					line.setPoints(long(centreX*res),long(centreY*res),
+								   long((centreX + linkX[direction])*res),long((centreY + linkY[direction])*res));
+					lines.push(line);
+				}
+			}
+
+			int count = countLinks(links[cell]);
+			if(count == 0 || count == 2)
+				continue;
+
+			pt.setPoints(centreX,centreY);
+			vertices.push(pt);
+
+			for(direction = 0; direction < 8; direction++)
+			{
+				if(!(links[cell] & (1 << direction)))
+					continue;
+
+				long endX = x + linkX[direction], endY = y + linkY[direction];
+				int last = direction;
+				while(countLinks(links[endY*_width + endX]) == 2)
+				{
+					int next = links[endY*_width + endX] & ~(1 << ((last + 4) & 7));
+					for(last = 0; !(next & (1 << last)); last++)
+						;
+					endX += linkX[last];
+					endY += linkY[last];
+				}
+
+				long end = endY*_width + endX;
+				if(cell < end || (cell == end && direction < ((last + 4) & 7)))
+				{
+					line.setPoints((float)(endX + _xMin) + 0.5f,(float)(endY + _yMin) + 0.5f,centreX,centreY);
+					vertexPairs.push(line);
+				}
+			}
+		}
+	}
+}
+
+bool GridDistanceTransform::getNearest(long x, long y, long& nearestX, long& nearestY) const
+{
+	x -= _xMin;
+	y -= _yMin;
+	if(x < 0 || x >= _width || y < 0 || y >= _height || _nearestX[y*_width + x] < 0)
+		return false;
+
+	nearestX = _nearestX[y*_width + x] + _xMin;
+	nearestY = _nearestY[y*_width + x] + _yMin;
+	return true;
+}
+
+bool GridDistanceTransform::getSquaredDistance(long x, long y, double& squaredDistance) const
+{
+	long nearestX = 0, nearestY = 0;
+	if(!getNearest(x,y,nearestX,nearestY))
+		return false;
+
+	squaredDistance = (double)(x - nearestX)*(x - nearestX) + (double)(y - nearestY)*(y - nearestY);
+	return true;
+}
+
+bool GridDistanceTransform::isRidge(long x, long y) const
+{
+	return ridgeAt(x - _xMin,y - _yMin);
+}
+
+long GridDistanceTransform::getNumOfRidgeCells() const
+{
+	long count = 0;
+	for(long cell = 0; cell < (long)_ridge.size() && cell < _width*_height; cell++)
+		count += _ridge[cell];
+	return count;
+}
@@ -0,0 +1,120 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#ifndef GRIDDISTANCETRANSFORM_H
+#define GRIDDISTANCETRANSFORM_H
+
+#include "../list/SosList.h"
+#include "../sosutil/SosUtil.h"
+#include "GridMapLayer.h"
+
+#include <vector>
+
+class GridDistancePass;
+
+//The exact euclidean distance from every cell of a window of the map to the nearest occupied
+//cell, and which cell that is.  A cell is occupied when it is between the two thresholds or
+//negative, as generateVoronoi() takes the centre cell.
+//
+//The transform is the one of Felzenszwalb and Huttenlocher, in two passes.  The first goes up
+//and then down the columns, and finds the nearest occupied cell in the cell's own column.  It
+//works on a whole row of the window at a time from the row before it, so the loop over the
+//cells has no dependencies and the compiler can vectorise it.  The second goes along the rows,
+//and finds the lower envelope of the parabolas (x - q)^2 + dy(q)^2, where dy(q) is the distance
+//the first pass found in column q, which gives the nearest occupied cell of every cell of the
+//row in linear time.  The columns are cut into stripes for the first pass and the rows for the
+//second, one stripe per thread.
+//
+//The ridges are the generalised voronoi diagram on the grid: a free cell is on a ridge when its
+//nearest occupied cell is at least minDistance from that of a neighbour, and it is the further
+//of the two from its own.  Each cell looks at its neighbours, so the rows are cut into stripes
+//again
+class GridDistanceTransform
+{
+public:
+	GridDistanceTransform();
+	~GridDistanceTransform();
+
+	//Works out the transform of the cells from (xMin,yMin) to (xMax,yMax) of the map, on
+	//numOfThreads threads.  Nothing may write to the map while it runs.  False if the window
+	//is empty
+	bool transform(GridMapLayer& gridLayer, long xMin, long yMin, long xMax, long yMax,
+				   float threshold1, float threshold2, int numOfThreads);
+	bool transform(GridMap<float>& gridMap, long xMin, long yMin, long xMax, long yMax,
+				   float threshold1, float threshold2, int numOfThreads);
+
+	//Marks the ridges of the last transform.  minDistance is in grid cells, and is what
+	//generateVoronoi() takes: the occupied cells nearer each other than it make one boundary
+	void findRidges(float minDistance);
+
+	//The ridges as three lists, as generateVoronoi() makes them: the lines between the centres
+	//of the ridge cells next to each other, in millimetres, the cells where the lines do more
+	//than pass through as the vertices, and the vertices at the two ends of each chain of lines
+	//as the vertex pairs, in grid cells.  Two ridge cells on a diagonal are only joined when
+	//neither of the cells beside them both is on a ridge
+	void getRidges(long resolution, List<LineXY>& lines, List<LineXY>& vertexPairs, List<PointXY>& vertices);
+
+	//The cell (nearestX,nearestY) nearest to (x,y) that is occupied, and the square of the
+	//distance to it in grid cells.  False when (x,y) is outside the window, or there is no
+	//occupied cell in it
+	bool getNearest(long x, long y, long& nearestX, long& nearestY) const;
+	bool getSquaredDistance(long x, long y, double& squaredDistance) const;
+
+	bool isRidge(long x, long y) const;
+	long getNumOfRidgeCells() const;
+
+private:
+	friend class GridDistancePass;
+
+	bool transform(long xMin, long yMin, long xMax, long yMax, float threshold1, float threshold2,
+				   int numOfThreads);
+	bool readRow(float* arrayRef, long y, long fromX, long toX);
+	void runStripes(int pass);
+	void runPass(int pass, int stripe);
+
+	void columnPass(int stripe);
+	void rowPass(int stripe);
+	void ridgePass(int stripe);
+
+	//the ridge cells joined to (x,y), a bit for each direction
+	int getLinks(long x, long y) const;
+	bool ridgeAt(long x, long y) const;
+
+	GridMapLayer*			_gridLayer;			//the map is one of these
+	GridMap<float>*			_gridMap;
+
+	long					_xMin, _yMin, _width, _height;
+	float					_threshold1, _threshold2, _minDistance;
+	int						_numOfStripes;
+
+	//the nearest occupied cell of each cell, in the window, -1 when there is none.  The first
+	//pass leaves the row of the nearest one in the column in _nearestY
+	std::vector<int>		_nearestX, _nearestY;
+	std::vector<unsigned char>	_ridge;
+
+	//the rows of each stripe: the cells read in, then the envelope of the second pass
+	std::vector<float>		_rowValues;
+	std::vector<int>		_columnRows, _envelope;
+	std::vector<double>		_bounds;
+};
+
+#endif
@@ -42,6 +42,9 @@ GridMapLayer::GridMapLayer(float defaultValue)
 	_oneTempRow = 0;
 	_oneTempRowSize = 0;
 	_layersEnabled = true;
+
+	_changed = _wholeMapChanged = true;
+	_changedWest = _changedNorth = _changedEast = _changedSouth = 0;
 }
 
 GridMapLayer::~GridMapLayer()
@@ -91,6 +94,7 @@ void GridMapLayer::initFromMap(GridMap<float>* initMap, bool destroyParamMap)
 	long minX,maxX,minY,maxY;
 	_baseMap->getAllUpdatedDimensions(minX,maxY,maxX,minY);	
 	_myMap->setDimensions(minX,maxY,maxX,minY);
+	wholeMapChanged();
 
 //	LOG<<"Copied "<<counter<<" cells into the grid layers";
 }
@@ -110,6 +114,7 @@ void GridMapLayer::clearBaseMap(float value)
 			_baseMap->updateGridRef(value,x,y);
 		}
 	}
+	wholeMapChanged();
 }
 
 
@@ -176,6 +181,7 @@ void GridMapLayer::reset(bool resetBaseMap)
 		delete _baseMap;
 		_baseMap = 0;
 	}
+	wholeMapChanged();
 
 	LOG<<"Finished resetting the maps";
 
@@ -210,6 +216,7 @@ void GridMapLayer::push(long x,long y, long layer, float value)
 		}
 	}
 	_baseMap->updateGridRef(value,x,y);
+	cellsChanged(x,y,x,y);
 }
 
 bool GridMapLayer::pop(long x, long y, long layer)
@@ -228,6 +235,7 @@ bool GridMapLayer::pop(long x, long y, long layer)
 	if(list->readHead(val))
 	{
 		_baseMap->updateGridRef(val.value,x,y);
+		cellsChanged(x,y,x,y);
 	}
 	if(list->getListSize() == 1)//0) new
 	{
@@ -273,6 +281,7 @@ void GridMapLayer::pushLine(float x1, float y1, float x2, float y2, long layer,
 			val.value = value;
 			list->push(val);
 			_baseMap->updateGridRef(value,x,y);//new
+			cellsChanged(x,y,x,y);
 		}
 	}
 	else
@@ -284,6 +293,7 @@ void GridMapLayer::pushLine(float x1, float y1, float x2, float y2, long layer,
 			y = ptLong.y;
 
 			_baseMap->updateGridRef(value,x,y);//new
+			cellsChanged(x,y,x,y);
 		}
 	}
 
@@ -312,6 +322,7 @@ void GridMapLayer::pushRect(long x1, long y1, long x2, long y2, long layer, floa
 	long x2L = (x2 < 0 && float((long)x2) != x2)? long(x2 - 1):(long)x2;
 	long y2L = (y2 < 0 && float((long)y2) != y2)? long(y2 - 1):(long)y2;
 	LOG<<"pushRect changed to ("<<x1L<<","<<y1L<<") -> ("<<x2L<<","<<y2L<<")";
+	cellsChanged(x1L,y2L,x2L,y1L);
 
 	if(_layersEnabled)
 	{
@@ -363,6 +374,7 @@ void GridMapLayer::pushRectFilled(long x1, long y1, long x2, long y2, long layer
 
 	SosUtil::ensureSmaller(x1,x2);
 	SosUtil::ensureSmaller(y1,y2);
+	cellsChanged(x1,y2,x2,y1);
 
 	if(_layersEnabled)
 	{
@@ -492,6 +504,7 @@ LineXYLong GridMapLayer::redoLayer(long layer)
 				maxY = SosUtil::maxVal(maxY,pt.y);				
 			}
 			_baseMap->updateGridRef(layerVal.value,pt.x,pt.y);
+			cellsChanged(pt.x,pt.y,pt.x,pt.y);
 		}
 	}
 	else
@@ -564,6 +577,7 @@ LineXYLong GridMapLayer::deleteLayer(long layer)
 					LOG<<"Did NOT delete the list because list size = "<<gridList->getListSize();
 				}
 				_baseMap->updateGridRef(tempLayerVal.value,pt.x,pt.y);//new
+				cellsChanged(pt.x,pt.y,pt.x,pt.y);
 
 			//	LOG<<"minX = "<<minX<<", maxX = "<<maxX<<", minY = "<<minY<<", maxY = "<<maxY;
 			}
@@ -997,7 +1011,7 @@ void GridMapLayer::crop(long west,long north,long east,long south)
 	deleteAllLayerInfo();//since this cannot be undone, no point keeping layer info
 	
 	_myMap->setDimensions(west,north,east,south);
-
+	wholeMapChanged();
 }
 
 void GridMapLayer::translate(long xDist, long yDist)
@@ -1011,7 +1025,7 @@ void GridMapLayer::translate(long xDist, long yDist)
 		_myMap->translate(xDist,yDist);
 	}
 	deleteAllLayerInfo();//changed the whole map - no point keeping undo info
-
+	wholeMapChanged();
 }
 
 void GridMapLayer::getDimensions(long& west,long&north,long&east,long&south)
@@ -1028,6 +1042,26 @@ bool GridMapLayer::copyRow(float* arrayRef, long y, long fromX, long toX)
 	return _baseMap->copyRow(arrayRef,y,fromX,toX);	
 }
 
+bool GridMapLayer::copyRowConcurrent(float* arrayRef, long y, long fromX, long toX)
+{
+	return _baseMap->copyRowConcurrent(arrayRef,y,fromX,toX);
+}
+
+bool GridMapLayer::getChangedArea(long& west,long& north,long& east,long& south, bool& wholeMap)
+{
+	west = _changedWest;
+	north = _changedNorth;
+	east = _changedEast;
+	south = _changedSouth;
+	wholeMap = _wholeMapChanged;
+	return _changed;
+}
+
+void GridMapLayer::clearChangedArea()
+{
+	_changed = _wholeMapChanged = false;
+}
+
 bool GridMapLayer::generateCSpace(long radius, float lowerBound, 
 								  float upperBound, long squaresize)
 {
@@ -1044,6 +1078,7 @@ bool GridMapLayer::generateCSpace(long radius, float lowerBound,
 	
 	_baseMap->setDimensions(west,north,east,south);
 	_baseMap->growOccArea(radius,lowerBound,upperBound,squaresize);
+	wholeMapChanged();
 /*
 	west = SosUtil::minVal(west,_baseMap->getUpdatedDimensions(WEST));
 	east = SosUtil::maxVal(east,_baseMap->getUpdatedDimensions(EAST));
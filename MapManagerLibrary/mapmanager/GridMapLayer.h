@@ -133,8 +133,41 @@ public:
 
 	bool copyRow(float* arrayRef, long y, long fromX, long toX);
 
+	//copyRow for threads that read the base map at the same time, nothing may write to it
+	bool copyRowConcurrent(float* arrayRef, long y, long fromX, long toX);
+
+	//The cells of the base map written since clearChangedArea(), so what was worked out from
+	//the map can be redone just around them.  Returns false if nothing was written.  When the
+	//whole map was replaced, cleared, cropped, translated or grown into c-space, 'wholeMap'
+	//is set and the area is meaningless
+	bool getChangedArea(long& west,long& north,long& east,long& south, bool& wholeMap);
+	void clearChangedArea();
+
 private:
 
+	void cellsChanged(long west, long north, long east, long south)
+	{
+		if(!_changed)
+		{
+			_changed = true;
+			_changedWest = west;
+			_changedEast = east;
+			_changedNorth = north;
+			_changedSouth = south;
+			return;
+		}
+		if(west < _changedWest) _changedWest = west;
+		if(east > _changedEast) _changedEast = east;
+		if(north > _changedNorth) _changedNorth = north;
+		if(south < _changedSouth) _changedSouth = south;
+	}
+
+	void wholeMapChanged()
+	{
+		_changed = true;
+		_wholeMapChanged = true;
+	}
+
 	//push a line from (x1,y1) to (x2,y2) for the given layer with the given value
 	void pushLine(float x1, float y1, float x2, float y2, long layer, float value);
 	
@@ -182,6 +215,9 @@ private:
 
 	bool _destroyMapOnInit;
 
+	bool	_changed, _wholeMapChanged;
+	long	_changedWest, _changedNorth, _changedEast, _changedSouth;
+
 	DEF_LOG
 	
 };
@@ -0,0 +1,34 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#ifndef IGRID_TO_MM_H
+#define IGRID_TO_MM_H
+
+//Converts grid coordinates to millimetre coordinates, MapManager::gridToMm()
+class IGridToMm
+{
+public:
+	virtual void gridToMm(float gridX, float gridY, long& mmX, long& mmY) = 0;
+};
+
+
+#endif
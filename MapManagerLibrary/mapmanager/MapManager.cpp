@@ -23,21 +23,45 @@ email: shaneosullivan1@gmail.com
 
 #include "../sosutil/SosUtil.h"
 #include "../voronoi/VoronoiDiagramGenerator.h"
+#include "../voronoi/VoronoiTiledGenerator.h"
 #include <fcntl.h>
+#include <string.h>
 #include "MapManager.h"
+#include "VoronoiDiagramCache.h"
+#include "VoronoiRoadmap.h"
+#include "GridDistanceTransform.h"
+#include "VoronoiSiteScan.h"
 
 MapManager::MapManager()
 {		
+	_voronoiGenerator = 0;
+	_voronoiTiles = 0;
+	_voronoiSiteScan = 0;
+	_voronoiCache = 0;
+	_voronoiRoadmap = 0;
+	_distanceTransform = 0;
 	init();
 }
 
 MapManager::MapManager(GridMap<float> *m)
 {	
+	_voronoiGenerator = 0;
+	_voronoiTiles = 0;
+	_voronoiSiteScan = 0;
+	_voronoiCache = 0;
+	_voronoiRoadmap = 0;
+	_distanceTransform = 0;
 	init();
 	addMap(m);
 }
 MapManager::MapManager(std::vector<LineXYLayer>* initialVectors, long resolution)
 {
+	_voronoiGenerator = 0;
+	_voronoiTiles = 0;
+	_voronoiSiteScan = 0;
+	_voronoiCache = 0;
+	_voronoiRoadmap = 0;
+	_distanceTransform = 0;
 	init();
 
 	setViewGridMap(false);
@@ -118,6 +142,42 @@ MapManager::~MapManager()
 		LOG<<"After Deleting _myMap = "<<_myMap;
 	}
 
+	if(_voronoiGenerator != 0)
+	{
+		delete _voronoiGenerator;
+		_voronoiGenerator = 0;
+	}
+
+	if(_voronoiTiles != 0)
+	{
+		delete _voronoiTiles;
+		_voronoiTiles = 0;
+	}
+
+	if(_voronoiSiteScan != 0)
+	{
+		delete _voronoiSiteScan;
+		_voronoiSiteScan = 0;
+	}
+
+	if(_voronoiCache != 0)
+	{
+		delete _voronoiCache;
+		_voronoiCache = 0;
+	}
+
+	if(_voronoiRoadmap != 0)
+	{
+		delete _voronoiRoadmap;
+		_voronoiRoadmap = 0;
+	}
+
+	if(_distanceTransform != 0)
+	{
+		delete _distanceTransform;
+		_distanceTransform = 0;
+	}
+
 	LOG<<"At end of MapManager destructor"<<endl;
 }
 
@@ -701,6 +761,7 @@ bool MapManager::loadVoronoi(char* fileName)
 	_listVoronoiLines.clear();
 	_listVoronoiEdges.clear();
 	_listVoronoiVertices.clear();
+	_voronoiChanged = true;//the loaded diagram isn't the one generateVoronoi() made
 
 	in>>buffer1;
 
@@ -4683,6 +4744,7 @@ void MapManager::clearVoronoi()
 	_listVoronoiLines.clear();
 	_listVoronoiEdges.clear();
 	_listVoronoiVertices.clear();
+	_voronoiChanged = true;
 }
 
 void MapManager::clearDelaunay()
@@ -5149,6 +5211,7 @@ bool MapManager::translateMap(long xDist, long yDist)
 	{
 		_listVoronoiVertices.push(pt);
 	}
+	_voronoiChanged = true;//the kept diagram, and the graph of findPath(), are where the map was
 
 	_vectorBoundary.pt1.x += xDist;
 	_vectorBoundary.pt2.x += xDist;
@@ -6066,94 +6129,107 @@ bool MapManager::generateVoronoi(float threshold1, float threshold2, float minDi
 
 	LOG<<"Creating a VoronoiDiagramGenerator object";
 
-	VoronoiDiagramGenerator vdg;
+	//the generator keeps its memory for the next call, the map is usually regenerated after every edit
+	if(_voronoiGenerator == 0)
+	{
+		_voronoiGenerator = new VoronoiDiagramGenerator;
+		_voronoiGenerator->setRetainMemory(true);
+	}
+	VoronoiDiagramGenerator& vdg = *_voronoiGenerator;
 
 	long xMin=0,xMax=0,yMin=0,yMax=0;
 	_gridLayer.getDimensions(xMin,yMax,xMax,yMin);
 
 	LOG<<"Boundaries for voronoi are ("<<xMin<<","<<yMin<<") -> ("<<xMax<<","<<yMax<<")";
 
-	float * xValues = 0, *yValues = 0;
-	long count = 0;
-	long x = 0, y = 0;
-	float val = 0;
-	List<PointXYLong> points;
-	points.setModeQueue();
-	PointXYLong ptLong;
+	if(_voronoiSiteScan == 0)
+	{
+		_voronoiSiteScan = new VoronoiSiteScan;
+	}
+	if(_voronoiCache == 0)
+	{
+		_voronoiCache = new VoronoiDiagramCache;
+	}
 
+	vdg.setGenerateDelaunay(false);
+	vdg.setGenerateVoronoi(true);
+	vdg.setSitesSorted(true);
 
-	//do one scan through the current map.  If a cell within the two thresholds does not touch a cell
-	//not between the thresholds, then ignore it, as it is surrounded by other cells similar to it.
-	//Otherwise push the (x,y) position of the cell onto the list of points we're interested in
-	for( x = xMin; x <= xMax; x++)
+	//if only part of the map was changed since the last diagram, only that part of the diagram
+	//is made again
+	long west = 0, north = 0, east = 0, south = 0;
+	bool wholeMap = false;
+	bool changed = _gridLayer.getChangedArea(west,north,east,south,wholeMap);
+
+	if(!_voronoiChanged && !wholeMap && _voronoiCache->matches(threshold1,threshold2,minDistance,_resolution,
+		xMin,yMax,xMax,yMin,_listVoronoiLines,_listVoronoiEdges,_listVoronoiVertices))
 	{
-		for(y = yMin; y<= yMax; y++)
+		if(!changed)
 		{
-			val = _gridLayer.read(x,y);
-			if(val < 0)
-			{
-				val = threshold1;//all negative values fall within the threshold
-			}
-			if(SosUtil::between(val,threshold1,threshold2))
-			{
-				if(!SosUtil::between(_gridLayer.read(x +1, y ),threshold1,threshold2) ||
-					!SosUtil::between(_gridLayer.read(x-1 , y ),threshold1,threshold2) ||
-					!SosUtil::between(_gridLayer.read(x+1 , y+1 ),threshold1,threshold2) ||
-					!SosUtil::between(_gridLayer.read(x+1 , y-1 ),threshold1,threshold2) ||
-					!SosUtil::between(_gridLayer.read(x , y +1),threshold1,threshold2) ||
-					!SosUtil::between(_gridLayer.read(x , y -1),threshold1,threshold2) ||
-					!SosUtil::between(_gridLayer.read(x -1, y +1),threshold1,threshold2) ||
-					!SosUtil::between(_gridLayer.read(x -1, y -1),threshold1,threshold2))
-				{
-					ptLong.x = x;
-					ptLong.y = y;
-					points.push(ptLong);
-				}
-				//count++;
-			}
+			LOG<<"generateVoronoi() returning, the map hasn't changed since the last diagram";
+			LOGEXIT("generateVoronoi")
+			return true;
 		}
-	}
-	//copy the voronoi cells into the two arrays to pass to the VoronoiDiagramGenerator
-	count = points.getListSize();
 
-	LOG<<"generateVoronoi() about create two float arrays of size "<<count<<endl;;
-	xValues = new float[count];
-	yValues = new float[count];
+		if(updateVoronoi(west,north,east,south,threshold1,threshold2,minDistance))
+		{
+			_gridLayer.clearChangedArea();
+			LOG<<"generateVoronoi() made the diagram again round ("<<west<<","<<north<<") -> ("<<east<<","<<south<<")";
+			LOGEXIT("generateVoronoi")
+			return true;
+		}
+	}
 
-	if(xValues == 0 || yValues == 0)
+	//find the cells within the two thresholds that touch a cell not between the thresholds. The
+	//others are ignored, as they are surrounded by other cells similar to them
+	_voronoiCache->invalidate();
+	double cells = (double)(xMax - xMin + 1)*(double)(yMax - yMin + 1);
+	int numOfThreads = (cells >= VORONOI_PARALLEL_SCAN_CELLS) ? VORONOI_SCAN_THREADS : 1;
+	if(!_voronoiSiteScan->scan(_gridLayer,xMin,yMin,xMax,yMax,threshold1,threshold2,numOfThreads))
 	{
-		LOG<<"generateVoronoi() returning false because it couldn't create two float arrays of size "<<count;
-		if(xValues != 0) delete[] xValues;
-		if(yValues != 0) delete[] yValues; 
+		LOG<<"generateVoronoi() returning false because there was no memory to scan the map for its boundary cells";
 		return false;
 	}
+
+	float* xValues = _voronoiSiteScan->getXValues();
+	float* yValues = _voronoiSiteScan->getYValues();
+	long count = _voronoiSiteScan->getNumOfSites();
 	
-	count = 0;
-	while(points.popHead(ptLong))
-	{
-		xValues[count] = (float)ptLong.x+ 0.5f;
-		yValues[count] = (float)ptLong.y+ 0.5f;
-		count++;
-	}
-	
-	LOG<<"generateVoronoi() Finished copying "<<count<<" values into float arrays";
+	LOG<<"generateVoronoi() found "<<count<<" boundary cells";
 	
 	LOG<<"About to call generateVoronoi()";
-	
-	vdg.setGenerateDelaunay(false);
-	vdg.setGenerateVoronoi(true);
-
-	//generate the voronoi diagram
-	retval = vdg.generateVoronoi(xValues,yValues,count, (float)xMin, (float)xMax, 
-										(float)yMin,(float)yMax,minDistance);
 
-	LOG<<"generateVoronoi() Finished generating the voronoi diagram";
+	_listVoronoiLines.clear();
+	_listVoronoiEdges.clear();
+	_listVoronoiVertices.clear();
 
-	//clean up the two arrays
-	delete []xValues;
-	delete []yValues;
+	//generate the voronoi diagram.  The edges are kept with how far they are from the sites,
+	//then the cache makes the three lists from them.  With no boundary cells there is nothing
+	//to give the generator, the diagram is empty
+	VoronoiSiteEdgeBuffer edges;
+	if(count == 0)
+	{
+		retval = true;
+	}
+#if VORONOI_TILED
+	else if(count >= VORONOI_TILED_SITES)
+	{
+		if(_voronoiTiles == 0)
+		{
+			_voronoiTiles = new VoronoiTiledGenerator;
+		}
+		retval = _voronoiTiles->generateVoronoi(xValues,yValues,count,(float)xMin,(float)xMax,(float)yMin,(float)yMax,
+										minDistance,VORONOI_TILES,VORONOI_TILE_MARGIN,&edges);
+		LOG<<"generateVoronoi() made the diagram in "<<VORONOI_TILES<<" tiles, "<<_voronoiTiles->getNumOfRetries()<<" of them twice or more";
+	}
+#endif
+	else
+	{
+		retval = vdg.generateVoronoi(xValues,yValues,count, (float)xMin, (float)xMax, 
+											(float)yMin,(float)yMax,minDistance,false,&edges);
+	}
 
-	LOG<<"generateVoronoi() Finished deleting the two float arrays";
+	LOG<<"generateVoronoi() Finished generating the voronoi diagram";
 
 	LOG<<"The generateVoronoi call on the VoronoiDiagramGenerator returned "<<retval<<endl;
 
@@ -6162,84 +6238,171 @@ bool MapManager::generateVoronoi(float threshold1, float threshold2, float minDi
 		return false;
 	}
 
-	LineXY line;
+	_voronoiCache->rebuild(edges,_gridLayer,*this,threshold1,threshold2,minDistance,_resolution,xMin,yMax,xMax,yMin,
+		_listVoronoiLines,_listVoronoiEdges,_listVoronoiVertices);
+	_gridLayer.clearChangedArea();
+	_voronoiChanged = false;
+	
+	LOG<<"Pushed "<<_listVoronoiLines.getListSize()<<" lines onto the voronoi lines list";
+	LOG<<"Pushed "<<_listVoronoiVertices.getListSize()<<" vertices onto the voronoi vertices list";
+	LOG<<"Pushed "<<_listVoronoiEdges.getListSize()<<" edges onto the voronoi edges list";
 
-	float x1 = 0, x2 = 0, y1 = 0, y2 = 0;
-	long x1L = 0, x2L = 0,y1L = 0,y2L = 0;
+	LOGEXIT("generateVoronoi")
+	return true;
+}
 
-	
-	//go through the lines in the graph - if either of the two ends of a line is in a cell that has
-	//a value between the two thresholds, ignore the line, since it only exists because of the 
-	//performance enhancement done earlier.  Otherwise store it in the list of voronoi lines
-	LOG<<"generateVoronoi() about to iterate through all edges in the voronoi diagram";
+//The window starts round the circles of the edges that touch the change, and grows until it holds
+//the circles of all the new edges that do.  See VoronoiDiagramCache
+bool MapManager::updateVoronoi(long west, long north, long east, long south,
+							   float threshold1, float threshold2, float minDistance)
+{
+	VoronoiDiagramGenerator& vdg = *_voronoiGenerator;
+	VoronoiSiteEdgeBuffer edges;
 
-	_listVoronoiLines.clear();
-	_listVoronoiEdges.clear();
-	_listVoronoiVertices.clear();
+	long xMin=0,xMax=0,yMin=0,yMax=0;
+	_gridLayer.getDimensions(xMin,yMax,xMax,yMin);
+	double mapCells = (double)(xMax - xMin + 1)*(double)(yMax - yMin + 1);
 
-	vdg.resetIterator();
+	long windowWest = 0, windowNorth = 0, windowEast = 0, windowSouth = 0;
+	_voronoiCache->beginUpdate(west,north,east,south,windowWest,windowNorth,windowEast,windowSouth);
 
-	while(vdg.getNext(x1,y1,x2,y2))
+	while((double)(windowEast - windowWest + 1)*(double)(windowNorth - windowSouth + 1) <= 
+		VORONOI_UPDATE_MAX_FRACTION*mapCells)
 	{
-		x1L = (x1 < 0) ? (long)(x1 - 1):(long)x1;
-		x2L = (x2 < 0) ? (long)(x2 - 1):(long)x2;
-		y1L = (y1 < 0) ? (long)(y1 - 1):(long)y1;
-		y2L = (y2 < 0) ? (long)(y2 - 1):(long)y2;
+		LOG<<"updateVoronoi() generating the diagram in ("<<windowWest<<","<<windowNorth<<") -> ("<<windowEast<<","<<windowSouth<<")";
 
-		if(!SosUtil::between(_gridLayer.read(x1L,y1L),threshold1,threshold2) && 
-			!SosUtil::between(_gridLayer.read(x2L,y2L),threshold1,threshold2))
-		{
-			gridToMm(x1,y1,x1L, y1L);
-			gridToMm(x2,y2,x2L,y2L);
-			line.setPoints(x1L,y1L,x2L,y2L);
+		if(!_voronoiSiteScan->scan(_gridLayer,windowWest,windowSouth,windowEast,windowNorth,threshold1,threshold2))
+			return false;
 
-			_listVoronoiLines.push(line);
-		}
-	}	
-	
-	vdg.resetVertexPairIterator();
+		edges.clear();
+		if(_voronoiSiteScan->getNumOfSites() > 0 && 
+			!vdg.generateVoronoi(_voronoiSiteScan->getXValues(),_voronoiSiteScan->getYValues(),
+								 _voronoiSiteScan->getNumOfSites(),(float)xMin,(float)xMax,
+								 (float)yMin,(float)yMax,minDistance,false,&edges))
+			return false;
+
+		if(_voronoiCache->finishUpdate(edges,_gridLayer,*this,windowWest,windowNorth,windowEast,windowSouth,
+			_listVoronoiLines,_listVoronoiEdges,_listVoronoiVertices))
+			return true;
+	}
 
-	//go through the vertex pairs in the graph - if either of the two ends of a line is in a cell that has
-	//a value between the two thresholds, ignore the line, since it only exists because of the 
-	//performance enhancement done earlier.  Otherwise store it in the list of voronoi vertices
-	while(vdg.getNextVertexPair(x1,y1,x2,y2))
+	LOG<<"updateVoronoi() returning false, the change is too big to only make part of the diagram again";
+	return false;
+}
+
+bool MapManager::generateVoronoiGrid(float threshold1, float threshold2, float minDistance)
+{
+	LOGENTRY("generateVoronoiGrid")
+	if(!hasMap())
+		return false;
+
+	SosUtil::ensureSmaller(threshold1, threshold2);
+
+	if(_viewGridMap == false)
 	{
-		x1L = (x1 < 0) ? (long)(x1 - 1):(long)x1;
-		x2L = (x2 < 0) ? (long)(x2 - 1):(long)x2;
-		y1L = (y1 < 0) ? (long)(y1 - 1):(long)y1;
-		y2L = (y2 < 0) ? (long)(y2 - 1):(long)y2;
+		pushAllVectorsOntoGrid();
+	}
 
-		if(!SosUtil::between(_gridLayer.read(x1L,y1L),threshold1,threshold2) && 
-			!SosUtil::between(_gridLayer.read(x2L,y2L),threshold1,threshold2))
-		{
-			line.setPoints(x1,y1,x2,y2);
-			_listVoronoiEdges.push(line);
-		}
-	}	
+	if(_distanceTransform == 0)
+	{
+		_distanceTransform = new GridDistanceTransform;
+	}
 
-	
-	vdg.resetVerticesIterator();
-	PointXY pt;
+	long xMin=0,xMax=0,yMin=0,yMax=0;
+	_gridLayer.getDimensions(xMin,yMax,xMax,yMin);
 
-	//go through the vertices in the graph - if either of the two ends of a line is in a cell that has
-	//a value between the two thresholds, ignore the line, since it only exists because of the 
-	//performance enhancement done earlier.  Otherwise store it in the list of voronoi vertices
-	while(vdg.getNextVertex(pt.x,pt.y))
+	//the lists won't hold the diagram the cache has any more
+	if(_voronoiCache != 0)
 	{
-		x1L = (pt.x < 0) ? (long)(pt.x - 1):(long)pt.x;
-		y1L = (pt.y < 0) ? (long)(pt.y - 1):(long)pt.y;
+		_voronoiCache->invalidate();
+	}
+	_voronoiChanged = true;
 
-		if(!SosUtil::between(_gridLayer.read(x1L,y1L),threshold1,threshold2))
-		{
-			_listVoronoiVertices.push(pt);
-		}
+	double cells = (double)(xMax - xMin + 1)*(double)(yMax - yMin + 1);
+	int numOfThreads = (cells >= VORONOI_PARALLEL_SCAN_CELLS) ? VORONOI_SCAN_THREADS : 1;
+	if(!_distanceTransform->transform(_gridLayer,xMin,yMin,xMax,yMax,threshold1,threshold2,numOfThreads))
+	{
+		LOG<<"generateVoronoiGrid() returning false, the map has no cells";
+		return false;
 	}
-	
+
+	_distanceTransform->findRidges(minDistance);
+	_distanceTransform->getRidges(_resolution,_listVoronoiLines,_listVoronoiEdges,_listVoronoiVertices);
+
+	LOG<<"generateVoronoiGrid() found "<<_distanceTransform->getNumOfRidgeCells()<<" ridge cells";
 	LOG<<"Pushed "<<_listVoronoiLines.getListSize()<<" lines onto the voronoi lines list";
 	LOG<<"Pushed "<<_listVoronoiVertices.getListSize()<<" vertices onto the voronoi vertices list";
 	LOG<<"Pushed "<<_listVoronoiEdges.getListSize()<<" edges onto the voronoi edges list";
 
-	LOGEXIT("generateVoronoi")
+	LOGEXIT("generateVoronoiGrid")
+	return true;
+}
+
+//The roads are the chains of edges between the vertices of the diagram, in grid cells, so the 
+//start and goal are changed to grid cells and the path back to millimetres
+bool MapManager::findPath(long startX, long startY, long goalX, long goalY, 
+						  float minClearance, float clearanceWeight)
+{
+	if(_voronoiChanged || _voronoiCache == 0 || !_voronoiCache->isValid())
+	{
+		LOG<<"findPath() returning false, there is no diagram made by generateVoronoi() to find a path on";
+		return false;
+	}
+
+	if(_voronoiRoadmap == 0)
+	{
+		_voronoiRoadmap = new VoronoiRoadmap;
+	}
+
+	if(!_voronoiRoadmap->isBuilt() || _voronoiRoadmap->getVersion() != _voronoiCache->getVersion())
+	{
+		_voronoiRoadmap->clear();
+		_voronoiCache->getRoads(*_voronoiRoadmap);
+		_voronoiRoadmap->build(_voronoiCache->getVersion());
+		LOG<<"findPath() made a graph of "<<_voronoiRoadmap->getNumOfRoads()<<" roads and "
+			<<_voronoiRoadmap->getNumOfNodes()<<" nodes";
+	}
+
+	float gridStartX = 0, gridStartY = 0, gridGoalX = 0, gridGoalY = 0;
+	mmToGrid(startX,startY,gridStartX,gridStartY);
+	mmToGrid(goalX,goalY,gridGoalX,gridGoalY);
+
+	std::vector<float> xValues, yValues;
+	if(!_voronoiRoadmap->findPath(gridStartX,gridStartY,gridGoalX,gridGoalY,minClearance,clearanceWeight,
+								  xValues,yValues))
+	{
+		LOG<<"findPath() returning false, there is no path from ("<<startX<<","<<startY<<") to ("
+			<<goalX<<","<<goalY<<")";
+		return false;
+	}
+
+	List<PointXYLong>* ptList = new List<PointXYLong>;
+	if(ptList == 0)
+	{
+		return false;
+	}
+
+	LineXYLong line(0,0,0,0);
+	PointXYLong pt1, pt2;
+	for(size_t i = 0; i < xValues.size(); i++)
+	{
+		gridToMm(xValues[i],yValues[i],pt2.x,pt2.y);
+		ptList->push(pt2);
+
+		if(i > 0)
+		{
+			line.pt1 = pt1;
+			line.pt2 = pt2;
+			_listPathLines.push(line);
+		}
+		pt1 = pt2;
+	}
+	_pathLists.push(ptList);
+
+	LOG<<"findPath() found a path of "<<(long)xValues.size()<<" points, "<<_voronoiRoadmap->getNumOfExpanded()
+		<<" nodes were searched";
+
+	_viewPath = true;
 	return true;
 }
 
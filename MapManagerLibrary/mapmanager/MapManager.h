@@ -52,6 +52,7 @@ object.
 
  
 #include "../mapmanager/IBulkJobWorker.h"
+#include "IGridToMm.h"
 #include "SosUtil.h"
 #include "../grid/IncludeAll.h"
 #include "fstream.h"
@@ -73,8 +74,33 @@ object.
 
 #define MAX_DIST_TO_JOIN_VECTOR			0.2
 
-
-class MapManager : public IBulkJobWorker
+//generateVoronoi() looks for the boundary cells with this many threads when the map has at
+//least VORONOI_PARALLEL_SCAN_CELLS cells, and with the calling thread otherwise
+#define VORONOI_SCAN_THREADS			4
+#define VORONOI_PARALLEL_SCAN_CELLS		1000000
+
+//After an edit, generateVoronoi() only makes the diagram again round the changed cells, while
+//the window of the map it has to look at is at most this part of the map.  See VoronoiDiagramCache
+#define VORONOI_UPDATE_MAX_FRACTION		0.25
+
+//When VORONOI_TILED is defined to 1, a whole diagram of at least VORONOI_TILED_SITES boundary
+//cells is generated in VORONOI_TILES tiles, each on its own thread, from the cells within
+//VORONOI_TILE_MARGIN cells of the tile to start with.  See VoronoiTiledGenerator.  It is off
+//otherwise: the tiles are only faster with a core for each of them, on one core they took 2 to
+//14 times as long as one generator ( benchmark/voronoitiles )
+#define VORONOI_TILES					8
+#define VORONOI_TILED_SITES				1000000
+#define VORONOI_TILE_MARGIN				64
+
+template<class Coord> class VoronoiDiagramGeneratorT;
+typedef VoronoiDiagramGeneratorT<float> VoronoiDiagramGenerator;
+class VoronoiTiledGenerator;
+class VoronoiSiteScan;
+class VoronoiDiagramCache;
+class VoronoiRoadmap;
+class GridDistanceTransform;
+
+class MapManager : public IBulkJobWorker, public IGridToMm
 {
 public:
 
@@ -277,6 +303,25 @@ public:
 	//in very bad results, and is not advised, as it places an edge between adjacent occupied cells.
 	bool generateVoronoi(float threshold1, float threshold2, float minDistance);
 
+	//Finds a path along the voronoi diagram made by generateVoronoi() from (startX,startY) to 
+	//(goalX,goalY), in millimetres, and adds it to the paths as loadPath() does.  The start and goal
+	//are joined to the nearest vertices of the diagram.  Only the edges at least 'minClearance' from
+	//the occupied cells are used, and each grid cell along an edge costs 1 + clearanceWeight/clearance
+	//with the clearance of that edge, so a bigger weight keeps the path further from the occupied
+	//cells.  The clearances are in grid-cell coordinates, as 'minDistance' is.  The graph of the
+	//diagram is kept until the diagram changes.  Returns false if there is no generated diagram,
+	//or no path
+	bool findPath(long startX, long startY, long goalX, long goalY, 
+				  float minClearance = 0, float clearanceWeight = 0);
+
+	//Makes the voronoi diagram into the same lists as generateVoronoi(), from the exact distance
+	//of every cell to the nearest occupied cell instead of from the boundary cells as sites.  The
+	//diagram is the ridges of the distances, with lines between the centres of the cells on them,
+	//so it follows the grid.  Its time goes with the number of cells in the map rather than the 
+	//number of boundary cells, so it can be the faster of the two on maps with a lot of boundary.
+	//No diagram is kept to be updated after an edit, or for findPath()
+	bool generateVoronoiGrid(float threshold1, float threshold2, float minDistance);
+
 	bool generateDelaunay(float threshold1, float threshold2, float minDistance);
 
 
@@ -350,7 +395,7 @@ public:
 	virtual void		resetAllObjects();
 
 	//Converts grid coordinates to millimetre coordinates
-	void				gridToMm(float gridX, float gridY, long& mmX, long& mmY);
+	virtual void		gridToMm(float gridX, float gridY, long& mmX, long& mmY);
 
 	//Converts millimeter coordinates to grid coordinates
 	void				mmToGrid(long mmX, long mmY,float& gridX, float& gridY);
@@ -468,6 +513,11 @@ protected:
 	//clears all undo information
 	void				resetUndoInfo();
 
+	//makes the voronoi diagram again round the cells from (west,south) to (east,north), which
+	//were changed since it was made.  False if the change was too big, or there was no memory
+	bool				updateVoronoi(long west, long north, long east, long south,
+									  float threshold1, float threshold2, float minDistance);
+
 	//Private data members
 	GridMap<float>*					_myMap;
 	long							_resolution;
@@ -517,6 +567,12 @@ protected:
 	List<LineXY>					_listVoronoiLines;//stores all the small lines in a voronoi diagram
 	List<PointXY>					_listVoronoiVertices;//stores all the vertices in the voronoi diagram
 	List<LineXY>					_listVoronoiEdges;//stores the links between the vertices in the voronoi diagram
+	VoronoiDiagramGenerator*		_voronoiGenerator;//kept between the calls to generateVoronoi(), so its memory is reused
+	VoronoiTiledGenerator*			_voronoiTiles;//the generator of the big diagrams, made when one is first needed
+	VoronoiSiteScan*				_voronoiSiteScan;//the boundary cells of generateVoronoi(), kept the same way
+	VoronoiDiagramCache*			_voronoiCache;//the last diagram, so an edit only changes part of it
+	VoronoiRoadmap*					_voronoiRoadmap;//the graph findPath() searches, made from _voronoiCache
+	GridDistanceTransform*			_distanceTransform;//the distances of generateVoronoiGrid(), kept for its memory
 
 	List<LineXY>					_listDelaunayLines;//stores all the small lines in a Delaunay diagram
 	
@@ -0,0 +1,972 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#include "VoronoiDiagramCache.h"
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <algorithm>
+
+void VoronoiSiteEdgeBuffer::addEdge(float x1, float y1, float x2, float y2)
+{
+	VoronoiSiteEdge e = {x1, y1, x2, y2, FLT_MAX, FLT_MAX, 0, 0, 0, 0, -1, -1};
+	_edges.push_back(e);
+}
+
+void VoronoiSiteEdgeBuffer::addEdgeSites(float x1, float y1, float x2, float y2,
+										 float site1X, float site1Y, float site2X, float site2Y)
+{
+	addEdgeVertices(x1,y1,x2,y2,site1X,site1Y,site2X,site2Y,-1,-1);
+}
+
+void VoronoiSiteEdgeBuffer::addEdgeVertices(float x1, float y1, float x2, float y2, float site1X, float site1Y,
+											float site2X, float site2Y, int vertex1, int vertex2)
+{
+	VoronoiSiteEdge e;
+	e.x1 = x1;
+	e.y1 = y1;
+	e.x2 = x2;
+	e.y2 = y2;
+	e.r1 = (float)sqrt((x1 - site1X)*(x1 - site1X) + (y1 - site1Y)*(y1 - site1Y));
+	e.r2 = (float)sqrt((x2 - site1X)*(x2 - site1X) + (y2 - site1Y)*(y2 - site1Y));
+	e.site1X = site1X;
+	e.site1Y = site1Y;
+	e.site2X = site2X;
+	e.site2Y = site2Y;
+	e.v1 = vertex1;
+	e.v2 = vertex2;
+	_edges.push_back(e);
+}
+
+//the generator numbers the vertices from 0 as it makes them
+void VoronoiSiteEdgeBuffer::addVertex(int vertex, float x, float y)
+{
+	if(vertex >= (int)_vertices.size())
+		_vertices.resize(vertex + 1);
+	_vertices[vertex].x = x;
+	_vertices[vertex].y = y;
+}
+
+
+static bool circleTouches(float x, float y, float r, float minX, float minY, float maxX, float maxY)
+{
+	float dx = (x < minX) ? minX - x : ((x > maxX) ? x - maxX : 0);
+	float dy = (y < minY) ? minY - y : ((y > maxY) ? y - maxY : 0);
+	return dx*dx + dy*dy <= r*r;
+}
+
+static long long chainKey(int v, int e)
+{
+	return ((long long)v << 32) | (unsigned int)e;
+}
+
+//the sites of an edge with the lower one, by y and then x, first
+static void orderedSites(const VoronoiSiteEdge& e, float sites[4])
+{
+	bool swap = (e.site2Y < e.site1Y) || (e.site2Y == e.site1Y && e.site2X < e.site1X);
+	sites[0] = swap ? e.site2X : e.site1X;
+	sites[1] = swap ? e.site2Y : e.site1Y;
+	sites[2] = swap ? e.site1X : e.site2X;
+	sites[3] = swap ? e.site1Y : e.site2Y;
+}
+
+static bool sameSites(const VoronoiSiteEdge& e1, const VoronoiSiteEdge& e2)
+{
+	float sites1[4], sites2[4];
+	orderedSites(e1,sites1);
+	orderedSites(e2,sites2);
+	return sites1[0] == sites2[0] && sites1[1] == sites2[1] && sites1[2] == sites2[2] && sites1[3] == sites2[3];
+}
+
+//the cache vertex of a pair of a cache vertex and a vertex of the window's diagram
+static bool lessVertex(const std::pair<int,int>& joined1, const std::pair<int,int>& joined2)
+{
+	return joined1.first < joined2.first;
+}
+
+//an edge an update can take out and put in: it has its vertices and its circles
+static bool canUpdate(const VoronoiSiteEdge& e)
+{
+	return e.v1 >= 0 && e.v2 >= 0 && e.r1 != FLT_MAX && e.r2 != FLT_MAX;
+}
+
+
+VoronoiDiagramCache::VoronoiDiagramCache()
+{
+	_numOfEdges = 0;
+	_maxReach = 0;
+	_bucketColumns = _bucketRows = 0;
+	_cells = 0;
+	_mm = 0;
+	_valid = false;
+	_updatable = false;
+	_version = 0;
+	_threshold1 = _threshold2 = _minDistance = 0;
+	_resolution = 0;
+	_west = _north = _east = _south = 0;
+	_numOfLines = _numOfVertexPairs = _numOfListVertices = 0;
+	_changeMinX = _changeMinY = _changeMaxX = _changeMaxY = 0;
+}
+
+bool VoronoiDiagramCache::matches(float threshold1, float threshold2, float minDistance, long resolution,
+								  long west, long north, long east, long south, List<LineXY>& lines,
+								  List<LineXY>& vertexPairs, List<PointXY>& vertices)
+{
+	return _valid && _updatable && threshold1 == _threshold1 && threshold2 == _threshold2 &&
+		minDistance == _minDistance && resolution == _resolution &&
+		west == _west && north == _north && east == _east && south == _south &&
+		lines.getListSize() == _numOfLines && vertexPairs.getListSize() == _numOfVertexPairs &&
+		vertices.getListSize() == _numOfListVertices;
+}
+
+bool VoronoiDiagramCache::between(float x, float y)
+{
+	long xL = (x < 0) ? (long)(x - 1):(long)x;
+	long yL = (y < 0) ? (long)(y - 1):(long)y;
+	float value = 0;
+	_cells->copyRow(&value,yL,xL,xL);
+	return SosUtil::between(value,_threshold1,_threshold2);
+}
+
+//the edges with either end in a cell between the thresholds only exist because of the boundary
+//cells being used as the sites, so they are left out, as generateVoronoi() always did
+void VoronoiDiagramCache::pushLine(int e, List<LineXY>& lines)
+{
+	const VoronoiSiteEdge& edge = _edges[e].edge;
+	_edges[e].line = 0;
+	if(between(edge.x1,edge.y1) || between(edge.x2,edge.y2))
+		return;
+
+	long x1L = 0, y1L = 0, x2L = 0, y2L = 0;
+	_mm->gridToMm(edge.x1,edge.y1,x1L,y1L);
+	_mm->gridToMm(edge.x2,edge.y2,x2L,y2L);
+	LineXY line;
+	line.setPoints(x1L,y1L,x2L,y2L);
+	_edges[e].line = lines.pushNode(line);
+}
+
+void VoronoiDiagramCache::pushVertex(int v, List<PointXY>& vertices)
+{
+	Vertex& vertex = _vertices[v];
+	vertex.node = 0;
+	if(vertex.degree == 0 || !isEnd(v) || between(vertex.x,vertex.y))
+		return;
+
+	PointXY pt;
+	pt.setPoints(vertex.x,vertex.y);
+	vertex.node = vertices.pushNode(pt);
+}
+
+void VoronoiDiagramCache::rebuild(const VoronoiSiteEdgeBuffer& edges, ICopyRow2D<float>& cells, IGridToMm& mm,
+								  float threshold1, float threshold2, float minDistance, long resolution, long west,
+								  long north, long east, long south, List<LineXY>& lines, List<LineXY>& vertexPairs,
+								  List<PointXY>& vertices)
+{
+	_cells = &cells;
+	_mm = &mm;
+	_threshold1 = threshold1;
+	_threshold2 = threshold2;
+	_minDistance = minDistance;
+	_resolution = resolution;
+	_west = west;
+	_north = north;
+	_east = east;
+	_south = south;
+
+	clearGraph();
+	lines.clear();
+	vertexPairs.clear();
+	vertices.clear();
+
+	//the vertices of the cache are those of the generator, with the same numbers
+	long i = 0;
+	_vertices.resize(edges.getNumOfVertices());
+	for(i = 0; i < edges.getNumOfVertices(); i++)
+	{
+		_vertices[i].x = edges.getVertex(i).x;
+		_vertices[i].y = edges.getVertex(i).y;
+		_vertices[i].firstEdge = -1;
+		_vertices[i].degree = 0;
+		_vertices[i].node = 0;
+	}
+
+	_updatable = true;
+	for(i = 0; i < edges.getNumOfEdges(); i++)
+	{
+		const VoronoiSiteEdge& edge = edges.getEdge(i);
+		if(!canUpdate(edge))
+			_updatable = false;
+		int e = addEdge(edge,edge.v1,edge.v2);
+		pushLine(e,lines);
+	}
+
+	//every chain is found from both its ends, it is pushed from the one with the lower key
+	std::vector<Chain> chains;
+	int v = 0;
+	for(v = 0; v < (int)_vertices.size(); v++)
+	{
+		if(_vertices[v].degree == 0)
+		{
+			_freeVertices.push_back(v);
+			continue;
+		}
+		pushVertex(v,vertices);
+		if(isEnd(v))
+			findChains(v,chains);
+	}
+	pushChains(chains,vertexPairs);
+
+	_numOfLines = lines.getListSize();
+	_numOfVertexPairs = vertexPairs.getListSize();
+	_numOfListVertices = vertices.getListSize();
+	_valid = true;
+	_version++;
+}
+
+void VoronoiDiagramCache::beginUpdate(long west, long north, long east, long south,
+									  long& windowWest, long& windowNorth, long& windowEast, long& windowSouth)
+{
+	_changeMinX = (float)(west - 1);
+	_changeMinY = (float)(south - 1);
+	_changeMaxX = (float)(east + 2);
+	_changeMaxY = (float)(north + 2);
+
+	//the window starts round the circles of the edges being taken out, the new edges usually
+	//don't reach much further
+	float minX = _changeMinX, minY = _changeMinY, maxX = _changeMaxX, maxY = _changeMaxY;
+	findAffected();
+	std::vector<int>::iterator it;
+	for(it = _affected.begin(); it != _affected.end(); ++it)
+	{
+		const VoronoiSiteEdge& edge = _edges[*it].edge;
+		minX = SosUtil::minVal(minX,SosUtil::minVal(edge.x1 - edge.r1,edge.x2 - edge.r2));
+		minY = SosUtil::minVal(minY,SosUtil::minVal(edge.y1 - edge.r1,edge.y2 - edge.r2));
+		maxX = SosUtil::maxVal(maxX,SosUtil::maxVal(edge.x1 + edge.r1,edge.x2 + edge.r2));
+		maxY = SosUtil::maxVal(maxY,SosUtil::maxVal(edge.y1 + edge.r1,edge.y2 + edge.r2));
+	}
+
+	windowWest = windowEast = west;
+	windowSouth = windowNorth = south;
+	growWindow(minX,minY,maxX,maxY,windowWest,windowNorth,windowEast,windowSouth);
+}
+
+//makes the window hold the area from (minX,minY) to (maxX,maxY) and the margin round it,
+//as far as the map goes
+void VoronoiDiagramCache::growWindow(float minX, float minY, float maxX, float maxY,
+									 long& windowWest, long& windowNorth, long& windowEast, long& windowSouth)
+{
+	minX = (float)floor(minX) - VORONOI_UPDATE_MARGIN;
+	minY = (float)floor(minY) - VORONOI_UPDATE_MARGIN;
+	maxX = (float)floor(maxX) + VORONOI_UPDATE_MARGIN;
+	maxY = (float)floor(maxY) + VORONOI_UPDATE_MARGIN;
+
+	windowWest = (minX <= (float)_west) ? _west : SosUtil::minVal(windowWest,(long)minX);
+	windowSouth = (minY <= (float)_south) ? _south : SosUtil::minVal(windowSouth,(long)minY);
+	windowEast = (maxX >= (float)_east) ? _east : SosUtil::maxVal(windowEast,(long)maxX);
+	windowNorth = (maxY >= (float)_north) ? _north : SosUtil::maxVal(windowNorth,(long)maxY);
+}
+
+bool VoronoiDiagramCache::touchesChange(const VoronoiSiteEdge& e) const
+{
+	return circleTouches(e.x1,e.y1,e.r1,_changeMinX,_changeMinY,_changeMaxX,_changeMaxY) ||
+		circleTouches(e.x2,e.y2,e.r2,_changeMinX,_changeMinY,_changeMaxX,_changeMaxY);
+}
+
+//both circles have to be inside the cells of the window.  There are no sites past the edge of
+//the map, so the window is open on the sides where it reaches it
+bool VoronoiDiagramCache::inWindow(const VoronoiSiteEdge& e, long west, long north, long east, long south) const
+{
+	bool openWest = (west <= _west), openEast = (east >= _east);
+	bool openSouth = (south <= _south), openNorth = (north >= _north);
+
+	return (openWest || (e.x1 - e.r1 >= (float)west && e.x2 - e.r2 >= (float)west)) &&
+		(openEast || (e.x1 + e.r1 <= (float)(east + 1) && e.x2 + e.r2 <= (float)(east + 1))) &&
+		(openSouth || (e.y1 - e.r1 >= (float)south && e.y2 - e.r2 >= (float)south)) &&
+		(openNorth || (e.y1 + e.r1 <= (float)(north + 1) && e.y2 + e.r2 <= (float)(north + 1)));
+}
+
+bool VoronoiDiagramCache::finishUpdate(const VoronoiSiteEdgeBuffer& edges, ICopyRow2D<float>& cells, IGridToMm& mm,
+									   long& windowWest, long& windowNorth, long& windowEast, long& windowSouth,
+									   List<LineXY>& lines, List<LineXY>& vertexPairs, List<PointXY>& vertices)
+{
+	_cells = &cells;
+	_mm = &mm;
+
+	//the new edges that touch the change, which have to be right
+	std::vector<long> selected;
+	std::vector<char> isSelected(edges.getNumOfEdges(),0);
+	float minX = 0, minY = 0, maxX = 0, maxY = 0;
+	bool tooSmall = false;
+	long i = 0;
+	for(i = 0; i < edges.getNumOfEdges(); i++)
+	{
+		const VoronoiSiteEdge& edge = edges.getEdge(i);
+		if(!touchesChange(edge))
+			continue;
+
+		selected.push_back(i);
+		isSelected[i] = 1;
+		if(inWindow(edge,windowWest,windowNorth,windowEast,windowSouth))
+			continue;
+
+		if(!tooSmall)
+		{
+			minX = maxX = edge.x1;
+			minY = maxY = edge.y1;
+			tooSmall = true;
+		}
+		minX = SosUtil::minVal(minX,SosUtil::minVal(edge.x1 - edge.r1,edge.x2 - edge.r2));
+		minY = SosUtil::minVal(minY,SosUtil::minVal(edge.y1 - edge.r1,edge.y2 - edge.r2));
+		maxX = SosUtil::maxVal(maxX,SosUtil::maxVal(edge.x1 + edge.r1,edge.x2 + edge.r2));
+		maxY = SosUtil::maxVal(maxY,SosUtil::maxVal(edge.y1 + edge.r1,edge.y2 + edge.r2));
+	}
+
+	if(tooSmall)
+	{
+		growWindow(minX,minY,maxX,maxY,windowWest,windowNorth,windowEast,windowSouth);
+		return false;
+	}
+
+	//a pair of sites has one edge, a kept edge with the sites of a new one goes too
+	long numOfAffected = (long)_affected.size();
+	int e = 0;
+	for(i = 0; i < (long)selected.size(); i++)
+	{
+		e = findEdge(edges.getEdge(selected[i]));
+		if(e >= 0 && !_edges[e].affected)
+		{
+			_edges[e].affected = true;
+			_affected.push_back(e);
+		}
+	}
+
+	//The vertices of the cache the ends of the new edges are.  An edge of the window's diagram
+	//that isn't new and ends at the same vertex as a new one is a kept edge, so the vertex is
+	//the end of the kept edge with the same sites.  The ends that aren't found are new vertices
+	_runVertex.assign(edges.getNumOfVertices(),-1);
+	std::vector<int> newAt(edges.getNumOfVertices(),0), keptAt(edges.getNumOfVertices(),0);
+	for(i = 0; i < (long)selected.size(); i++)
+	{
+		const VoronoiSiteEdge& edge = edges.getEdge(selected[i]);
+		_runVertex[edge.v1] = _runVertex[edge.v2] = -2;
+		newAt[edge.v1]++;
+		newAt[edge.v2]++;
+	}
+	bool joins = true;
+	std::vector<std::pair<long,int> > noLength;
+	for(i = 0; i < edges.getNumOfEdges(); i++)
+	{
+		const VoronoiSiteEdge& edge = edges.getEdge(i);
+		if(isSelected[i] || (_runVertex[edge.v1] == -1 && _runVertex[edge.v2] == -1) ||
+			(e = findEdge(edge)) < 0 || _edges[e].affected)
+			continue;
+
+		for(int end = 0; end < 2; end++)
+		{
+			int r = (end == 0) ? edge.v1 : edge.v2;
+			if(_runVertex[r] == -1)
+				continue;
+			const PointXY& pt = edges.getVertex(r);
+			const Vertex& vertex1 = _vertices[_edges[e].v1];
+			const Vertex& vertex2 = _vertices[_edges[e].v2];
+			float d1 = (vertex1.x - pt.x)*(vertex1.x - pt.x) + (vertex1.y - pt.y)*(vertex1.y - pt.y);
+			float d2 = (vertex2.x - pt.x)*(vertex2.x - pt.x) + (vertex2.y - pt.y)*(vertex2.y - pt.y);
+			if(d1 == d2)
+			{
+				noLength.push_back(std::make_pair(i,end));
+				continue;
+			}
+			int vertex = (d1 < d2) ? _edges[e].v1 : _edges[e].v2;
+			if(_runVertex[r] >= 0 && _runVertex[r] != vertex)
+				joins = false;
+			_runVertex[r] = vertex;
+			keptAt[r]++;
+		}
+	}
+
+	//A kept edge of no length, where more than 3 sites are on a circle, doesn't tell by its ends
+	//which vertex it is.  It is the one the other edges there found, else the one at its other
+	//end didn't, else the one losing edges
+	for(i = 0; i < (long)noLength.size() && joins; i++)
+	{
+		const VoronoiSiteEdge& edge = edges.getEdge(noLength[i].first);
+		int r = (noLength[i].second == 0) ? edge.v1 : edge.v2;
+		int other = (noLength[i].second == 0) ? edge.v2 : edge.v1;
+		e = findEdge(edge);
+		int v1 = _edges[e].v1, v2 = _edges[e].v2;
+		int vertex = -1;
+		if(_runVertex[r] >= 0)
+			vertex = _runVertex[r];
+		else if(_runVertex[other] >= 0)
+			vertex = (_runVertex[other] == v1) ? v2 : ((_runVertex[other] == v2) ? v1 : -1);
+		else if((goingAt(v1) > 0) != (goingAt(v2) > 0))
+			vertex = (goingAt(v1) > 0) ? v1 : v2;
+		joins = (vertex == v1 || vertex == v2);
+		_runVertex[r] = vertex;
+		keptAt[r]++;
+	}
+
+	//A vertex that is kept keeps its edges: the window's diagram has all its kept edges at the
+	//vertex, and a new edge for each of its edges that goes.  Where more than 3 sites are on a
+	//circle the window's diagram can join them another way than the cache did, then the cache
+	//gives up and the whole map is made again
+	std::vector<std::pair<int,int> > joined;
+	for(i = 0; i < (long)selected.size(); i++)
+	{
+		const VoronoiSiteEdge& edge = edges.getEdge(selected[i]);
+		if(_runVertex[edge.v1] >= 0)
+			joined.push_back(std::make_pair(_runVertex[edge.v1],edge.v1));
+		if(_runVertex[edge.v2] >= 0)
+			joined.push_back(std::make_pair(_runVertex[edge.v2],edge.v2));
+	}
+	std::sort(joined.begin(), joined.end());
+	joined.erase(std::unique(joined.begin(), joined.end()), joined.end());
+	for(i = 0; i < (long)joined.size() && joins; i++)
+	{
+		int going = goingAt(joined[i].first);
+		joins = (i == 0 || joined[i].first != joined[i-1].first) &&
+			keptAt[joined[i].second] == _vertices[joined[i].first].degree - going &&
+			newAt[joined[i].second] == going;
+	}
+	for(i = 0; i < (long)_affected.size() && joins; i++)
+	{
+		for(int end = 0; end < 2 && joins; end++)
+		{
+			int v = (end == 0) ? _edges[_affected[i]].v1 : _edges[_affected[i]].v2;
+			joins = goingAt(v) == _vertices[v].degree ||
+				std::binary_search(joined.begin(), joined.end(), std::make_pair(v,0), lessVertex);
+		}
+	}
+	if(!joins)
+	{
+		for(i = numOfAffected; i < (long)_affected.size(); i++)
+			_edges[_affected[i]].affected = false;
+		_affected.resize(numOfAffected);
+		windowWest = _west;
+		windowNorth = _north;
+		windowEast = _east;
+		windowSouth = _south;
+		return false;
+	}
+
+	//what they were in the lists: the lines of the edges going, and the chains and the
+	//vertices through the vertices at their ends and at the ends of the edges coming
+	std::vector<int> touched;
+	std::vector<int>::iterator it;
+	for(it = _affected.begin(); it != _affected.end(); ++it)
+	{
+		touched.push_back(_edges[*it].v1);
+		touched.push_back(_edges[*it].v2);
+	}
+	for(i = 0; i < (long)selected.size(); i++)
+	{
+		const VoronoiSiteEdge& edge = edges.getEdge(selected[i]);
+		if(_runVertex[edge.v1] >= 0)
+			touched.push_back(_runVertex[edge.v1]);
+		if(_runVertex[edge.v2] >= 0)
+			touched.push_back(_runVertex[edge.v2]);
+	}
+	std::sort(touched.begin(), touched.end());
+	touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+	std::vector<Chain> chains;
+	for(it = touched.begin(); it != touched.end(); ++it)
+	{
+		findChains(*it,chains);
+		if(_vertices[*it].node != 0)
+		{
+			vertices.removeNode(_vertices[*it].node);
+			_vertices[*it].node = 0;
+		}
+	}
+	removeChains(chains,vertexPairs);
+	for(it = _affected.begin(); it != _affected.end(); ++it)
+	{
+		if(_edges[*it].line != 0)
+			lines.removeNode(_edges[*it].line);
+		removeEdge(*it);
+	}
+	_affected.clear();
+
+	//the new edges go in, then the chains and vertices are found again
+	for(i = 0; i < (long)selected.size(); i++)
+	{
+		const VoronoiSiteEdge& edge = edges.getEdge(selected[i]);
+		for(int end = 0; end < 2; end++)
+		{
+			int r = (end == 0) ? edge.v1 : edge.v2;
+			if(_runVertex[r] == -2)
+			{
+				_runVertex[r] = addVertex(edges.getVertex(r).x,edges.getVertex(r).y);
+				touched.push_back(_runVertex[r]);
+			}
+		}
+		e = addEdge(edge,_runVertex[edge.v1],_runVertex[edge.v2]);
+		pushLine(e,lines);
+	}
+	std::sort(touched.begin(), touched.end());
+	touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+	chains.clear();
+	for(it = touched.begin(); it != touched.end(); ++it)
+	{
+		if(_vertices[*it].degree == 0)
+			continue;
+		findChains(*it,chains);
+		pushVertex(*it,vertices);
+	}
+	pushChains(chains,vertexPairs);
+
+	_numOfLines = lines.getListSize();
+	_numOfVertexPairs = vertexPairs.getListSize();
+	_numOfListVertices = vertices.getListSize();
+	_version++;
+	return true;
+}
+
+//The least distance from the edge to the site: the ends are r1 and r2 from it, and the point
+//of the edge nearest it can be between them
+float VoronoiDiagramCache::clearance(const VoronoiSiteEdge& e)
+{
+	if(e.r1 == FLT_MAX || e.r2 == FLT_MAX)
+		return FLT_MAX;
+
+	double dx = e.x2 - e.x1, dy = e.y2 - e.y1;
+	double length = sqrt(dx*dx + dy*dy);
+	double r1 = e.r1, r2 = e.r2;
+	if(length <= 0)
+		return e.r1;
+
+	//how far along the edge the site is
+	double along = (r1*r1 - r2*r2 + length*length)/(2*length);
+	if(along <= 0)
+		return e.r1;
+	if(along >= length)
+		return e.r2;
+	double height = r1*r1 - along*along;
+	return (height > 0) ? (float)sqrt(height) : 0;
+}
+
+void VoronoiDiagramCache::getRoads(VoronoiRoadmap& roadmap)
+{
+	float xValues[2], yValues[2];
+	for(int e = 0; e < (int)_edges.size(); e++)
+	{
+		if(!_edges[e].used || _edges[e].line == 0)
+			continue;
+
+		const VoronoiSiteEdge& edge = _edges[e].edge;
+		xValues[0] = edge.x1;
+		yValues[0] = edge.y1;
+		xValues[1] = edge.x2;
+		yValues[1] = edge.y2;
+		roadmap.addRoad(xValues,yValues,2,clearance(edge),_edges[e].v1,_edges[e].v2);
+	}
+}
+
+//Follows the chain from v along e, through the vertices with 2 edges, to the vertex at its
+//other end.  False if the chain is a ring of vertices with 2 edges, and has no end
+bool VoronoiDiagramCache::walkChain(int v, int e, int& end, int& lastEdge) const
+{
+	int current = otherEnd(e,v);
+	long steps = 0;
+	while(!isEnd(current) && current != v && steps < (long)_edges.size())
+	{
+		int next = _vertices[current].firstEdge;
+		if(next == e)
+			next = nextEdge(next,current);
+		e = next;
+		current = otherEnd(e,current);
+		steps++;
+	}
+	end = current;
+	lastEdge = e;
+	return isEnd(current);
+}
+
+//Adds the chains through v to 'chains'.  A chain is known by the lower of the keys of its two
+//ends, the vertex and the first edge along it, so it can be found from any of its vertices
+void VoronoiDiagramCache::findChains(int v, std::vector<Chain>& chains) const
+{
+	Chain chain;
+	int end1 = 0, end2 = 0, last1 = 0, last2 = 0;
+
+	if(isEnd(v))
+	{
+		for(int e = _vertices[v].firstEdge; e != -1; e = nextEdge(e,v))
+		{
+			if(!walkChain(v,e,end1,last1))
+				continue;
+			bool first = chainKey(v,e) <= chainKey(end1,last1);
+			chain.v1 = first ? v : end1;
+			chain.e1 = first ? e : last1;
+			chain.v2 = first ? end1 : v;
+			chain.e2 = first ? last1 : e;
+			chain.key = chainKey(chain.v1,chain.e1);
+			chains.push_back(chain);
+		}
+	}
+	else if(_vertices[v].degree == 2)
+	{
+		int e1 = _vertices[v].firstEdge;
+		int e2 = nextEdge(e1,v);
+		if(!walkChain(v,e1,end1,last1) || !walkChain(v,e2,end2,last2))
+			return;
+		bool first = chainKey(end1,last1) <= chainKey(end2,last2);
+		chain.v1 = first ? end1 : end2;
+		chain.e1 = first ? last1 : last2;
+		chain.v2 = first ? end2 : end1;
+		chain.e2 = first ? last2 : last1;
+		chain.key = chainKey(chain.v1,chain.e1);
+		chains.push_back(chain);
+	}
+}
+
+//the pair of a chain is kept at the end it was pushed from, the one of its key
+void VoronoiDiagramCache::removeChains(std::vector<Chain>& chains, List<LineXY>& vertexPairs)
+{
+	std::sort(chains.begin(), chains.end());
+	for(long i = 0; i < (long)chains.size(); i++)
+	{
+		if(i > 0 && chains[i].key == chains[i-1].key)
+			continue;
+		ListNode<LineXY>*& node = pairNode(chains[i].e1,chains[i].v1);
+		if(node != 0)
+		{
+			vertexPairs.removeNode(node);
+			node = 0;
+		}
+	}
+}
+
+//as the generator's getNextVertexPair(), from the far end of the chain to the end it is pushed from
+void VoronoiDiagramCache::pushChains(std::vector<Chain>& chains, List<LineXY>& vertexPairs)
+{
+	std::sort(chains.begin(), chains.end());
+	LineXY line;
+	for(long i = 0; i < (long)chains.size(); i++)
+	{
+		if(i > 0 && chains[i].key == chains[i-1].key)
+			continue;
+		const Vertex& v1 = _vertices[chains[i].v1];
+		const Vertex& v2 = _vertices[chains[i].v2];
+		if(between(v1.x,v1.y) || between(v2.x,v2.y))
+			continue;
+		line.setPoints(v2.x,v2.y,v1.x,v1.y);
+		pairNode(chains[i].e1,chains[i].v1) = vertexPairs.pushNode(line);
+	}
+}
+
+void VoronoiDiagramCache::clearGraph()
+{
+	_edges.clear();
+	_freeEdges.clear();
+	_vertices.clear();
+	_freeVertices.clear();
+	_hash.assign(1024,-1);
+	_numOfEdges = 0;
+	_affected.clear();
+
+	_bucketColumns = (_east - _west)/VORONOI_CACHE_BUCKET + 1;
+	_bucketRows = (_north - _south)/VORONOI_CACHE_BUCKET + 1;
+	_bucketFirst.assign(_bucketColumns*_bucketRows,-1);
+	_bucketReach.assign(_bucketColumns*_bucketRows,0);
+	_maxReach = 0;
+}
+
+//An edge without its vertices or its sites only goes in the lines, an update can't be done then
+int VoronoiDiagramCache::addEdge(const VoronoiSiteEdge& edge, int v1, int v2)
+{
+	int e = 0;
+	if(!_freeEdges.empty())
+	{
+		e = _freeEdges.back();
+		_freeEdges.pop_back();
+	}
+	else
+	{
+		e = (int)_edges.size();
+		_edges.push_back(Edge());
+	}
+
+	Edge& added = _edges[e];
+	added.edge = edge;
+	added.v1 = v1;
+	added.v2 = v2;
+	added.next1 = added.next2 = -1;
+	added.bucket = added.prevInBucket = added.nextInBucket = -1;
+	added.used = true;
+	added.affected = false;
+	added.line = added.pair1 = added.pair2 = 0;
+
+	if(!canUpdate(edge))
+		return e;
+
+	linkEdge(e,v1);
+	linkEdge(e,v2);
+	hashEdge(e);
+	bucketEdge(e);
+	return e;
+}
+
+void VoronoiDiagramCache::removeEdge(int e)
+{
+	if(canUpdate(_edges[e].edge))
+	{
+		unbucketEdge(e);
+		unhashEdge(e);
+		unlinkEdge(e,_edges[e].v1);
+		unlinkEdge(e,_edges[e].v2);
+	}
+	_edges[e].used = false;
+	_edges[e].affected = false;
+	_freeEdges.push_back(e);
+}
+
+int VoronoiDiagramCache::addVertex(float x, float y)
+{
+	int v = 0;
+	if(!_freeVertices.empty())
+	{
+		v = _freeVertices.back();
+		_freeVertices.pop_back();
+	}
+	else
+	{
+		v = (int)_vertices.size();
+		_vertices.push_back(Vertex());
+	}
+	_vertices[v].x = x;
+	_vertices[v].y = y;
+	_vertices[v].firstEdge = -1;
+	_vertices[v].degree = 0;
+	_vertices[v].node = 0;
+	return v;
+}
+
+//the edges at v the update under way takes out
+int VoronoiDiagramCache::goingAt(int v) const
+{
+	int going = 0;
+	for(int e = _vertices[v].firstEdge; e != -1; e = nextEdge(e,v))
+	{
+		if(_edges[e].affected)
+			going++;
+	}
+	return going;
+}
+
+//the two ends of an edge are always different vertices of the generator's diagram
+void VoronoiDiagramCache::linkEdge(int e, int v)
+{
+	if(_edges[e].v1 == v)
+		_edges[e].next1 = _vertices[v].firstEdge;
+	else
+		_edges[e].next2 = _vertices[v].firstEdge;
+	_vertices[v].firstEdge = e;
+	_vertices[v].degree++;
+}
+
+//a vertex left with no edges is free to be used again
+void VoronoiDiagramCache::unlinkEdge(int e, int v)
+{
+	int previous = -1;
+	int current = _vertices[v].firstEdge;
+	while(current != -1 && current != e)
+	{
+		previous = current;
+		current = nextEdge(current,v);
+	}
+	if(current == -1)
+		return;
+
+	int next = nextEdge(e,v);
+	if(previous == -1)
+		_vertices[v].firstEdge = next;
+	else if(_edges[previous].v1 == v)
+		_edges[previous].next1 = next;
+	else
+		_edges[previous].next2 = next;
+
+	_vertices[v].degree--;
+	if(_vertices[v].degree == 0)
+		_freeVertices.push_back(v);
+}
+
+unsigned int VoronoiDiagramCache::hashSlot(const VoronoiSiteEdge& e) const
+{
+	float sites[4];
+	orderedSites(e,sites);
+	unsigned int h = 0, bits = 0;
+	for(int i = 0; i < 4; i++)
+	{
+		memcpy(&bits,&sites[i],sizeof(bits));
+		h = (h ^ bits)*0x9E3779B1u;
+		h ^= h >> 15;
+	}
+	return h & (unsigned int)(_hash.size() - 1);
+}
+
+int VoronoiDiagramCache::findEdge(const VoronoiSiteEdge& e) const
+{
+	if(!canUpdate(e))
+		return -1;
+
+	unsigned int mask = (unsigned int)(_hash.size() - 1);
+	for(unsigned int slot = hashSlot(e); _hash[slot] != -1; slot = (slot + 1) & mask)
+	{
+		if(sameSites(_edges[_hash[slot]].edge,e))
+			return _hash[slot];
+	}
+	return -1;
+}
+
+void VoronoiDiagramCache::hashEdge(int e)
+{
+	if((_numOfEdges + 1)*2 > (long)_hash.size())
+		growHash();
+
+	unsigned int mask = (unsigned int)(_hash.size() - 1);
+	unsigned int slot = hashSlot(_edges[e].edge);
+	while(_hash[slot] != -1)
+		slot = (slot + 1) & mask;
+	_hash[slot] = e;
+	_numOfEdges++;
+}
+
+//the edges after it that were moved on by it are moved back, so no search stops early
+void VoronoiDiagramCache::unhashEdge(int e)
+{
+	unsigned int mask = (unsigned int)(_hash.size() - 1);
+	unsigned int slot = hashSlot(_edges[e].edge);
+	while(_hash[slot] != e)
+	{
+		if(_hash[slot] == -1)
+			return;
+		slot = (slot + 1) & mask;
+	}
+
+	unsigned int hole = slot;
+	for(slot = (hole + 1) & mask; _hash[slot] != -1; slot = (slot + 1) & mask)
+	{
+		unsigned int home = hashSlot(_edges[_hash[slot]].edge);
+		if(((slot - home) & mask) >= ((slot - hole) & mask))
+		{
+			_hash[hole] = _hash[slot];
+			hole = slot;
+		}
+	}
+	_hash[hole] = -1;
+	_numOfEdges--;
+}
+
+void VoronoiDiagramCache::growHash()
+{
+	std::vector<int> old;
+	old.swap(_hash);
+	_hash.assign(old.size()*2,-1);
+	_numOfEdges = 0;
+	for(long i = 0; i < (long)old.size(); i++)
+	{
+		if(old[i] != -1)
+			hashEdge(old[i]);
+	}
+}
+
+int VoronoiDiagramCache::bucketOf(float x, float y) const
+{
+	long column = SosUtil::minVal(SosUtil::maxVal((long)floor((x - (float)_west)/VORONOI_CACHE_BUCKET),0L),
+								  _bucketColumns - 1);
+	long row = SosUtil::minVal(SosUtil::maxVal((long)floor((y - (float)_south)/VORONOI_CACHE_BUCKET),0L),
+							   _bucketRows - 1);
+	return (int)(row*_bucketColumns + column);
+}
+
+//An edge goes in the square of the middle of the box round its two circles, and the square
+//reaches out as far as the box does past it
+void VoronoiDiagramCache::bucketEdge(int e)
+{
+	const VoronoiSiteEdge& edge = _edges[e].edge;
+	float minX = SosUtil::minVal(edge.x1 - edge.r1,edge.x2 - edge.r2);
+	float minY = SosUtil::minVal(edge.y1 - edge.r1,edge.y2 - edge.r2);
+	float maxX = SosUtil::maxVal(edge.x1 + edge.r1,edge.x2 + edge.r2);
+	float maxY = SosUtil::maxVal(edge.y1 + edge.r1,edge.y2 + edge.r2);
+	int bucket = bucketOf((minX + maxX)/2,(minY + maxY)/2);
+
+	float west = (float)(_west + (bucket % _bucketColumns)*VORONOI_CACHE_BUCKET);
+	float south = (float)(_south + (bucket / _bucketColumns)*VORONOI_CACHE_BUCKET);
+	float reach = SosUtil::maxVal(SosUtil::maxVal(west - minX,maxX - (west + VORONOI_CACHE_BUCKET)),
+								  SosUtil::maxVal(south - minY,maxY - (south + VORONOI_CACHE_BUCKET)));
+	_bucketReach[bucket] = SosUtil::maxVal(_bucketReach[bucket],reach);
+	_maxReach = SosUtil::maxVal(_maxReach,reach);
+
+	_edges[e].bucket = bucket;
+	_edges[e].prevInBucket = -1;
+	_edges[e].nextInBucket = _bucketFirst[bucket];
+	if(_bucketFirst[bucket] != -1)
+		_edges[_bucketFirst[bucket]].prevInBucket = e;
+	_bucketFirst[bucket] = e;
+}
+
+//the reach of the square is left as it is, it can only be too big
+void VoronoiDiagramCache::unbucketEdge(int e)
+{
+	Edge& edge = _edges[e];
+	if(edge.prevInBucket != -1)
+		_edges[edge.prevInBucket].nextInBucket = edge.nextInBucket;
+	else
+		_bucketFirst[edge.bucket] = edge.nextInBucket;
+	if(edge.nextInBucket != -1)
+		_edges[edge.nextInBucket].prevInBucket = edge.prevInBucket;
+	edge.bucket = edge.prevInBucket = edge.nextInBucket = -1;
+}
+
+//the edges whose circles touch the change are in the squares that reach it
+void VoronoiDiagramCache::findAffected()
+{
+	_affected.clear();
+	int first = bucketOf(_changeMinX - _maxReach,_changeMinY - _maxReach);
+	int last = bucketOf(_changeMaxX + _maxReach,_changeMaxY + _maxReach);
+	for(long row = first / _bucketColumns; row <= last / _bucketColumns; row++)
+	{
+		for(long column = first % _bucketColumns; column <= last % _bucketColumns; column++)
+		{
+			int bucket = (int)(row*_bucketColumns + column);
+			float reach = _bucketReach[bucket];
+			float west = (float)(_west + column*VORONOI_CACHE_BUCKET) - reach;
+			float south = (float)(_south + row*VORONOI_CACHE_BUCKET) - reach;
+			float east = west + VORONOI_CACHE_BUCKET + 2*reach;
+			float north = south + VORONOI_CACHE_BUCKET + 2*reach;
+			if(west > _changeMaxX || east < _changeMinX || south > _changeMaxY || north < _changeMinY)
+				continue;
+
+			for(int e = _bucketFirst[bucket]; e != -1; e = _edges[e].nextInBucket)
+			{
+				if(touchesChange(_edges[e].edge))
+				{
+					_edges[e].affected = true;
+					_affected.push_back(e);
+				}
+			}
+		}
+	}
+}
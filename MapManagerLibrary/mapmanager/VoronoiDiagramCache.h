@@ -0,0 +1,245 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#ifndef VORONOIDIAGRAMCACHE_H
+#define VORONOIDIAGRAMCACHE_H
+
+#include "../list/SosList.h"
+#include "../sosutil/SosUtil.h"
+#include "../voronoi/VoronoiDiagramGenerator.h"
+#include "../grid/Grid3D.h"
+#include "IGridToMm.h"
+#include "VoronoiRoadmap.h"
+
+#include <vector>
+
+//the cells added all round the window the diagram is generated in for an update, so it
+//reaches a bit past the circles it has to hold
+#define VORONOI_UPDATE_MARGIN			4
+
+//the width in cells of the squares the cache puts the edges into, by the middle of their circles,
+//so an update only looks at the edges near the change
+#define VORONOI_CACHE_BUCKET			16
+
+//A voronoi edge, in grid coordinates, with how far each of its ends is from the two sites
+//the edge is between.  The circle of that radius around an end has no site inside it.  v1 and
+//v2 are the numbers the generator gave the ends as vertices, -1 if it didn't give them
+struct VoronoiSiteEdge
+{
+	float	x1,y1,x2,y2;
+	float	r1,r2;
+	float	site1X,site1Y,site2X,site2Y;
+	int		v1,v2;
+};
+
+//Keeps the edges and the vertices of a diagram as the VoronoiDiagramGenerator finds them, the
+//edges with their sites and the numbers of the vertices at their ends
+class VoronoiSiteEdgeBuffer : public VoronoiEdgeSink
+{
+public:
+	//only called by a generator that can't tell the sites, the ends are then taken as
+	//being infinitely far from them
+	void addEdge(float x1, float y1, float x2, float y2);
+	void addEdgeSites(float x1, float y1, float x2, float y2,
+					  float site1X, float site1Y, float site2X, float site2Y);
+	void addEdgeVertices(float x1, float y1, float x2, float y2, float site1X, float site1Y,
+						 float site2X, float site2Y, int vertex1, int vertex2);
+	void addVertex(int vertex, float x, float y);
+
+	void clear(){_edges.clear(); _vertices.clear();}
+	long getNumOfEdges() const {return (long)_edges.size();}
+	const VoronoiSiteEdge& getEdge(long i) const {return _edges[i];}
+	long getNumOfVertices() const {return (long)_vertices.size();}
+	const PointXY& getVertex(long v) const {return _vertices[v];}
+
+private:
+	std::vector<VoronoiSiteEdge>	_edges;
+	std::vector<PointXY>			_vertices;
+};
+
+//The voronoi diagram that MapManager::generateVoronoi() made last, so the next one can be
+//worked out from it when only part of the map was changed.
+//
+//An edge of the diagram only depends on the sites inside the empty circles around its ends: it
+//doesn't change when the map is changed outside them.  So after an edit, the edges with a circle
+//touching the changed cells are taken out, the diagram is generated again from the sites in a
+//window around them, and the new edges with a circle touching the changed cells are put in.  The
+//window is right when all those circles are inside it, as no site outside the window can then be
+//nearer to the new edges.  If one isn't, the window is made bigger.  The edges are put into
+//squares of the map by their circles, so only the edges near the change are looked at.
+//
+//The vertices are those of the generator, the ends of the edges it gave the same number are one
+//vertex, and a vertex pair joins two vertices with 1 or 3 edges along a chain of vertices with 2,
+//as the generator's getNextVertexPair() and getNextVertex() do.  So the lists are the ones
+//generateVoronoi() made from the generator.  The edges are known by their two sites, a pair of
+//sites has one edge at most.  A new edge joins a vertex that is kept when an edge of the window's
+//diagram with the same sites as a kept edge ends at the same vertex.  Where more than 3 sites are
+//on one circle the window's diagram can join the edges there another way than the cache did, the
+//update then gives up and the whole diagram is made again.  After an edit only the chains and
+//vertices the changed edges touch are redone.  Every value the cache pushed onto a list keeps its
+//node, so it is taken out again without looking for it
+class VoronoiDiagramCache
+{
+public:
+	VoronoiDiagramCache();
+
+	//The diagram is thrown away and has to be made again with rebuild()
+	void invalidate(){_valid = false; _version++;}
+
+	bool isValid() const {return _valid;}
+
+	//changes every time the diagram does
+	long getVersion() const {return _version;}
+
+	//true if the cache holds the diagram that is in the three lists, generated with these
+	//settings, and can change it.  Otherwise the whole diagram has to be made again
+	bool matches(float threshold1, float threshold2, float minDistance, long resolution,
+				 long west, long north, long east, long south, List<LineXY>& lines,
+				 List<LineXY>& vertexPairs, List<PointXY>& vertices);
+
+	//Makes the cache and the three lists from all the edges of a new diagram.  The lines are
+	//pushed in millimetres, with mm.gridToMm(), the vertex pairs and vertices in grid
+	//coordinates, unless either end is in a cell of 'cells' between the two thresholds.  The
+	//diagram can only be changed by an update if the generator gave the vertices of the edges
+	void rebuild(const VoronoiSiteEdgeBuffer& edges, ICopyRow2D<float>& cells, IGridToMm& mm,
+				 float threshold1, float threshold2, float minDistance, long resolution, long west,
+				 long north, long east, long south, List<LineXY>& lines, List<LineXY>& vertexPairs,
+				 List<PointXY>& vertices);
+
+	//Starts an update for the cells from (west,south) to (east,north) having changed.  Gives
+	//the window of cells whose sites the diagram has to be generated from
+	void beginUpdate(long west, long north, long east, long south,
+					 long& windowWest, long& windowNorth, long& windowEast, long& windowSouth);
+
+	//Puts the edges generated from the sites in the window into the cache and the lists.
+	//Returns false, changing nothing, if the window was too small, and gives the bigger one.
+	//If the window's diagram doesn't join the cache's, it gives the whole map as the window
+	bool finishUpdate(const VoronoiSiteEdgeBuffer& edges, ICopyRow2D<float>& cells, IGridToMm& mm,
+					  long& windowWest, long& windowNorth, long& windowEast, long& windowSouth,
+					  List<LineXY>& lines, List<LineXY>& vertexPairs, List<PointXY>& vertices);
+
+	//Adds the edges of the lines list to the roadmap, each as a road between its vertices with
+	//the least distance from it to the sites as its clearance, in grid cells
+	void getRoads(VoronoiRoadmap& roadmap);
+
+private:
+	struct Edge
+	{
+		VoronoiSiteEdge	edge;
+		int		v1, v2;			//the vertices at the two ends
+		int		next1, next2;	//the next edge at v1 and at v2
+		int		bucket;			//the square it is in, and the edges before and after it there
+		int		prevInBucket, nextInBucket;
+		bool	used;
+		bool	affected;		//taken out by the update under way
+		ListNode<LineXY>*	line;			//its node in the lines list, 0 if it wasn't pushed
+		ListNode<LineXY>*	pair1;			//the vertex pair of the chain from v1 along this
+		ListNode<LineXY>*	pair2;			//edge, and from v2, if it was pushed from there
+	};
+
+	struct Vertex
+	{
+		float	x, y;
+		int		firstEdge;
+		int		degree;			//0 for a vertex that isn't used
+		ListNode<PointXY>*	node;	//in the vertices list
+	};
+
+	//a vertex pair, found from the ends of the chain: the vertex and the first edge along it
+	struct Chain
+	{
+		long long	key;
+		int			v1, e1, v2, e2;
+		bool operator<(const Chain& chain) const {return key < chain.key;}
+	};
+
+	void growWindow(float minX, float minY, float maxX, float maxY,
+					long& windowWest, long& windowNorth, long& windowEast, long& windowSouth);
+	bool touchesChange(const VoronoiSiteEdge& e) const;
+	bool inWindow(const VoronoiSiteEdge& e, long west, long north, long east, long south) const;
+	bool between(float x, float y);
+
+	void clearGraph();
+	int addEdge(const VoronoiSiteEdge& e, int v1, int v2);
+	void removeEdge(int e);
+	int addVertex(float x, float y);
+	void linkEdge(int e, int v);
+	void unlinkEdge(int e, int v);
+
+	int findEdge(const VoronoiSiteEdge& e) const;
+	unsigned int hashSlot(const VoronoiSiteEdge& e) const;
+	void hashEdge(int e);
+	void unhashEdge(int e);
+	void growHash();
+
+	int bucketOf(float x, float y) const;
+	void bucketEdge(int e);
+	void unbucketEdge(int e);
+	void findAffected();
+
+	int otherEnd(int e, int v) const {return (_edges[e].v1 == v) ? _edges[e].v2 : _edges[e].v1;}
+	int nextEdge(int e, int v) const {return (_edges[e].v1 == v) ? _edges[e].next1 : _edges[e].next2;}
+	ListNode<LineXY>*& pairNode(int e, int v) {return (_edges[e].v1 == v) ? _edges[e].pair1 : _edges[e].pair2;}
+	bool isEnd(int v) const {return _vertices[v].degree == 1 || _vertices[v].degree >= 3;}
+	int goingAt(int v) const;
+	bool walkChain(int v, int e, int& end, int& lastEdge) const;
+	void findChains(int v, std::vector<Chain>& chains) const;
+	void removeChains(std::vector<Chain>& chains, List<LineXY>& vertexPairs);
+	void pushChains(std::vector<Chain>& chains, List<LineXY>& vertexPairs);
+	void pushVertex(int v, List<PointXY>& vertices);
+
+	void pushLine(int e, List<LineXY>& lines);
+	static float clearance(const VoronoiSiteEdge& e);
+
+	std::vector<Edge>		_edges;
+	std::vector<int>		_freeEdges;
+	std::vector<Vertex>		_vertices;
+	std::vector<int>		_freeVertices;
+	std::vector<int>		_hash;			//the edges by their sites, -1 for an empty slot
+	long					_numOfEdges;
+
+	//the first edge of each square, and the furthest the circles of its edges reach out of it
+	std::vector<int>		_bucketFirst;
+	std::vector<float>		_bucketReach;
+	float					_maxReach;
+	long					_bucketColumns, _bucketRows;
+
+	ICopyRow2D<float>*		_cells;
+	IGridToMm*				_mm;
+	bool					_valid;
+	bool					_updatable;		//every edge had the vertices at its ends
+	long					_version;
+	float					_threshold1, _threshold2, _minDistance;
+	long					_resolution;
+	long					_west, _north, _east, _south;
+	long					_numOfLines, _numOfVertexPairs, _numOfListVertices;
+
+	//the update under way: the changed part of the map, with a cell more all round since the
+	//sites are found from their neighbours, and the edges whose circles touch it
+	float					_changeMinX, _changeMinY, _changeMaxX, _changeMaxY;
+	std::vector<int>		_affected;
+
+	//the vertex of the cache each vertex of the diagram being put in is, -1 if none yet
+	std::vector<int>		_runVertex;
+};
+
+#endif
@@ -0,0 +1,459 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#include "VoronoiRoadmap.h"
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+VoronoiRoadmap::VoronoiRoadmap()
+{
+	_built = false;
+	_version = -1;
+	_bucketMinX = _bucketMinY = 0;
+	_bucketSize = 1;
+	_bucketColumns = _bucketRows = 0;
+	_query = 0;
+	_expanded = 0;
+	_roadStart.push_back(0);
+}
+
+void VoronoiRoadmap::clear()
+{
+	_built = false;
+	_version = -1;
+	_roadStart.assign(1,0);
+	_pointX.clear();
+	_pointY.clear();
+	_roadLength.clear();
+	_roadClearance.clear();
+	_roadLengthOverClearance.clear();
+	_roadNode1.clear();
+	_roadNode2.clear();
+	_nodeX.clear();
+	_nodeY.clear();
+	_linkStart.clear();
+	_linkRoad.clear();
+	_linkNode.clear();
+	_bucketStart.clear();
+	_bucketNodes.clear();
+}
+
+void VoronoiRoadmap::addRoad(const float* xValues, const float* yValues, long numOfPoints, float clearance,
+							 int node1, int node2)
+{
+	if(numOfPoints < 2 || node1 < 0 || node2 < 0)
+		return;
+
+	float length = 0;
+	for(long i = 0; i < numOfPoints; i++)
+	{
+		_pointX.push_back(xValues[i]);
+		_pointY.push_back(yValues[i]);
+		if(i > 0)
+		{
+			float dx = xValues[i] - xValues[i-1], dy = yValues[i] - yValues[i-1];
+			length += (float)sqrt(dx*dx + dy*dy);
+		}
+	}
+	_roadStart.push_back((long)_pointX.size());
+	_roadLength.push_back(length);
+	_roadClearance.push_back(clearance);
+	_roadLengthOverClearance.push_back(length/std::max(clearance,1e-6f));
+	_roadNode1.push_back(node1);
+	_roadNode2.push_back(node2);
+}
+
+//the vertices at the ends of the roads are numbered as nodes, in the order they are first met,
+//at the end of the road they were met at
+void VoronoiRoadmap::numberNodes()
+{
+	long numOfRoads = (long)_roadClearance.size();
+	std::vector<int> nodeOf;
+	_nodeX.clear();
+	_nodeY.clear();
+	for(long i = 0; i < 2*numOfRoads; i++)
+	{
+		int& node = (i%2 == 0) ? _roadNode1[i/2] : _roadNode2[i/2];
+		if(node >= (int)nodeOf.size())
+			nodeOf.resize(node + 1,-1);
+		if(nodeOf[node] == -1)
+		{
+			long point = (i%2 == 0) ? _roadStart[i/2] : _roadStart[i/2 + 1] - 1;
+			nodeOf[node] = (int)_nodeX.size();
+			_nodeX.push_back(_pointX[point]);
+			_nodeY.push_back(_pointY[point]);
+		}
+		node = nodeOf[node];
+	}
+}
+
+//the roads at each node, a road that comes back to where it started is no way anywhere
+void VoronoiRoadmap::linkRoads()
+{
+	long numOfNodes = (long)_nodeX.size(), numOfRoads = (long)_roadClearance.size();
+	long n = 0, r = 0;
+	_linkStart.assign(numOfNodes + 1,0);
+	for(r = 0; r < numOfRoads; r++)
+	{
+		if(_roadNode1[r] == _roadNode2[r])
+			continue;
+		_linkStart[_roadNode1[r] + 1]++;
+		_linkStart[_roadNode2[r] + 1]++;
+	}
+	for(n = 1; n <= numOfNodes; n++)
+		_linkStart[n] += _linkStart[n - 1];
+
+	std::vector<long> next(_linkStart.begin(),_linkStart.end() - 1);
+	_linkRoad.resize(_linkStart[numOfNodes]);
+	_linkNode.resize(_linkStart[numOfNodes]);
+	for(r = 0; r < numOfRoads; r++)
+	{
+		int node1 = _roadNode1[r], node2 = _roadNode2[r];
+		if(node1 == node2)
+			continue;
+		_linkRoad[next[node1]] = (int)r;
+		_linkNode[next[node1]++] = node2;
+		_linkRoad[next[node2]] = (int)r;
+		_linkNode[next[node2]++] = node1;
+	}
+}
+
+//The roads through the nodes with two roads are joined into one, so only the nodes where roads
+//end or meet are left.  A ring of nodes with two roads has no such node, so once the rest are
+//joined, a node of a ring that is left and the node at the other end of its first road are
+//kept, and the ring is two roads between them
+void VoronoiRoadmap::joinRoads()
+{
+	long numOfNodes = (long)_nodeX.size(), numOfRoads = (long)_roadClearance.size();
+	std::vector<long> roadStart(1,0);
+	std::vector<float> pointX, pointY, roadLength, roadClearance, roadLengthOverClearance;
+	std::vector<int> roadNode1, roadNode2;
+	std::vector<bool> joined(numOfRoads,false), kept(numOfNodes,false);
+
+	int n = 0;
+	for(n = 0; n < numOfNodes; n++)
+		kept[n] = _linkStart[n + 1] - _linkStart[n] != 2;
+
+	for(int ring = 0; ring < 2; ring++)
+	{
+		for(n = 0; n < numOfNodes; n++)
+		{
+			if(ring == 1 && !kept[n] && !joined[_linkRoad[_linkStart[n]]])
+			{
+				int road = _linkRoad[_linkStart[n]];
+				kept[n] = kept[(_roadNode1[road] == n) ? _roadNode2[road] : _roadNode1[road]] = true;
+			}
+			if(!kept[n])
+				continue;
+
+			for(long l = _linkStart[n]; l < _linkStart[n + 1]; l++)
+			{
+				int road = _linkRoad[l], node = n;
+				if(joined[road])
+					continue;
+
+				pointX.push_back(_nodeX[n]);
+				pointY.push_back(_nodeY[n]);
+				float length = 0, clearance = FLT_MAX, lengthOverClearance = 0;
+				while(true)
+				{
+					joined[road] = true;
+					appendRoad(road,node,pointX,pointY);
+					length += _roadLength[road];
+					clearance = std::min(clearance,_roadClearance[road]);
+					lengthOverClearance += _roadLengthOverClearance[road];
+					node = (_roadNode1[road] == node) ? _roadNode2[road] : _roadNode1[road];
+					if(kept[node])
+						break;
+					road = (_linkRoad[_linkStart[node]] == road) ? _linkRoad[_linkStart[node] + 1] : _linkRoad[_linkStart[node]];
+				}
+				roadStart.push_back((long)pointX.size());
+				roadLength.push_back(length);
+				roadClearance.push_back(clearance);
+				roadLengthOverClearance.push_back(lengthOverClearance);
+				roadNode1.push_back(n);
+				roadNode2.push_back(node);
+			}
+		}
+	}
+
+	//the nodes left are numbered again
+	std::vector<int> newNode(numOfNodes,-1);
+	std::vector<float> nodeX, nodeY;
+	for(n = 0; n < numOfNodes; n++)
+	{
+		if(!kept[n] || _linkStart[n + 1] == _linkStart[n])
+			continue;
+		newNode[n] = (int)nodeX.size();
+		nodeX.push_back(_nodeX[n]);
+		nodeY.push_back(_nodeY[n]);
+	}
+	for(long r = 0; r < (long)roadNode1.size(); r++)
+	{
+		roadNode1[r] = newNode[roadNode1[r]];
+		roadNode2[r] = newNode[roadNode2[r]];
+	}
+
+	_roadStart.swap(roadStart);
+	_pointX.swap(pointX);
+	_pointY.swap(pointY);
+	_roadLength.swap(roadLength);
+	_roadClearance.swap(roadClearance);
+	_roadLengthOverClearance.swap(roadLengthOverClearance);
+	_roadNode1.swap(roadNode1);
+	_roadNode2.swap(roadNode2);
+	_nodeX.swap(nodeX);
+	_nodeY.swap(nodeY);
+}
+
+void VoronoiRoadmap::build(long version)
+{
+	numberNodes();
+	linkRoads();
+	joinRoads();
+	linkRoads();
+
+	long numOfNodes = (long)_nodeX.size();
+	long n = 0;
+
+	//about one node to a bucket
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	for(n = 0; n < numOfNodes; n++)
+	{
+		minX = std::min(minX,_nodeX[n]);
+		minY = std::min(minY,_nodeY[n]);
+		maxX = std::max(maxX,_nodeX[n]);
+		maxY = std::max(maxY,_nodeY[n]);
+	}
+	if(numOfNodes == 0)
+		minX = minY = maxX = maxY = 0;
+	_bucketMinX = minX;
+	_bucketMinY = minY;
+	_bucketSize = (float)sqrt((double)(maxX - minX)*(maxY - minY)/(numOfNodes + 1));
+	if(_bucketSize <= 0)
+		_bucketSize = std::max(maxX - minX,maxY - minY)/(numOfNodes + 1);
+	if(_bucketSize <= 0)
+		_bucketSize = 1;
+	_bucketColumns = (long)((maxX - minX)/_bucketSize) + 1;
+	_bucketRows = (long)((maxY - minY)/_bucketSize) + 1;
+
+	std::vector<long> bucketOf(numOfNodes);
+	_bucketStart.assign(_bucketColumns*_bucketRows + 1,0);
+	for(n = 0; n < numOfNodes; n++)
+	{
+		long column = std::min(_bucketColumns - 1,(long)((_nodeX[n] - minX)/_bucketSize));
+		long row = std::min(_bucketRows - 1,(long)((_nodeY[n] - minY)/_bucketSize));
+		bucketOf[n] = row*_bucketColumns + column;
+		_bucketStart[bucketOf[n] + 1]++;
+	}
+	long b = 0;
+	for(b = 1; b < (long)_bucketStart.size(); b++)
+		_bucketStart[b] += _bucketStart[b - 1];
+	std::vector<long> next(_bucketStart.begin(),_bucketStart.end() - 1);
+	_bucketNodes.resize(numOfNodes);
+	for(n = 0; n < numOfNodes; n++)
+		_bucketNodes[next[bucketOf[n]]++] = (int)n;
+
+	_cost.resize(numOfNodes);
+	_cameBy.resize(numOfNodes);
+	_mark.assign(numOfNodes,0);
+	_doneMark.assign(numOfNodes,0);
+	_query = 0;
+
+	_version = version;
+	_built = true;
+}
+
+bool VoronoiRoadmap::hasWay(int node, float minClearance) const
+{
+	for(long l = _linkStart[node]; l < _linkStart[node + 1]; l++)
+	{
+		if(_roadClearance[_linkRoad[l]] >= minClearance)
+			return true;
+	}
+	return false;
+}
+
+//the buckets are searched ring by ring round the point's bucket, until the ring is further
+//than the nearest node found
+int VoronoiRoadmap::nearestNode(float x, float y, float minClearance) const
+{
+	long column = (long)floor((x - _bucketMinX)/_bucketSize);
+	long row = (long)floor((y - _bucketMinY)/_bucketSize);
+	column = std::max(0L,std::min(_bucketColumns - 1,column));
+	row = std::max(0L,std::min(_bucketRows - 1,row));
+
+	int nearest = -1;
+	double best = DBL_MAX;
+	long rings = std::max(_bucketColumns,_bucketRows);
+	for(long ring = 0; ring <= rings; ring++)
+	{
+		//everything outside the rings done so far is at least this far, also when the point is
+		//outside the buckets
+		double reach = (ring - 1)*(double)_bucketSize;
+		if(nearest != -1 && reach > 0 && reach*reach > best)
+			break;
+
+		for(long r = row - ring; r <= row + ring; r++)
+		{
+			if(r < 0 || r >= _bucketRows)
+				continue;
+			bool edgeRow = (r == row - ring || r == row + ring);
+			for(long c = column - ring; c <= column + ring; c += (edgeRow || ring == 0) ? 1 : 2*ring)
+			{
+				if(c < 0 || c >= _bucketColumns)
+					continue;
+				long b = r*_bucketColumns + c;
+				for(long i = _bucketStart[b]; i < _bucketStart[b + 1]; i++)
+				{
+					int node = _bucketNodes[i];
+					double dx = _nodeX[node] - x, dy = _nodeY[node] - y;
+					double d = dx*dx + dy*dy;
+					if(d < best && hasWay(node,minClearance))
+					{
+						best = d;
+						nearest = node;
+					}
+				}
+			}
+		}
+	}
+	return nearest;
+}
+
+//the points of the road after the node it is entered from
+void VoronoiRoadmap::appendRoad(int road, int fromNode, std::vector<float>& xValues, std::vector<float>& yValues) const
+{
+	long first = _roadStart[road], last = _roadStart[road + 1] - 1;
+	long i = 0;
+	if(_roadNode1[road] == fromNode)
+	{
+		for(i = first + 1; i <= last; i++)
+		{
+			xValues.push_back(_pointX[i]);
+			yValues.push_back(_pointY[i]);
+		}
+	}
+	else
+	{
+		for(i = last - 1; i >= first; i--)
+		{
+			xValues.push_back(_pointX[i]);
+			yValues.push_back(_pointY[i]);
+		}
+	}
+}
+
+bool VoronoiRoadmap::findPath(float startX, float startY, float goalX, float goalY, float minClearance,
+							  float clearanceWeight, std::vector<float>& xValues, std::vector<float>& yValues)
+{
+	xValues.clear();
+	yValues.clear();
+	_expanded = 0;
+	if(!_built || _nodeX.empty())
+		return false;
+
+	int start = nearestNode(startX,startY,minClearance);
+	int goal = nearestNode(goalX,goalY,minClearance);
+	if(start < 0 || goal < 0)
+		return false;
+
+	if(++_query == 0)
+	{
+		std::fill(_mark.begin(),_mark.end(),0);
+		std::fill(_doneMark.begin(),_doneMark.end(),0);
+		_query = 1;
+	}
+
+	//the straight line to the goal is never dearer than the roads, each unit of which costs 1
+	//or more, so A* finds the cheapest path
+	typedef std::pair<double,int> Entry;
+	std::priority_queue<Entry,std::vector<Entry>,std::greater<Entry> > queue;
+	double gx = _nodeX[goal], gy = _nodeY[goal];
+
+	_cost[start] = 0;
+	_cameBy[start] = -1;
+	_mark[start] = _query;
+	queue.push(Entry(sqrt((_nodeX[start] - gx)*(_nodeX[start] - gx) + (_nodeY[start] - gy)*(_nodeY[start] - gy)),start));
+
+	while(!queue.empty())
+	{
+		int node = queue.top().second;
+		queue.pop();
+		if(_doneMark[node] == _query)
+			continue;
+		_doneMark[node] = _query;
+		_expanded++;
+		if(node == goal)
+			break;
+
+		for(long l = _linkStart[node]; l < _linkStart[node + 1]; l++)
+		{
+			int road = _linkRoad[l];
+			if(_roadClearance[road] < minClearance)
+				continue;
+
+			//the least clearance of a joined road would cost all of it as its narrowest part
+			double cost = _cost[node] + _roadLength[road];
+			if(clearanceWeight > 0)
+				cost += clearanceWeight*_roadLengthOverClearance[road];
+
+			int other = _linkNode[l];
+			if(_doneMark[other] == _query || (_mark[other] == _query && _cost[other] <= cost))
+				continue;
+			_cost[other] = cost;
+			_cameBy[other] = road;
+			_mark[other] = _query;
+			double dx = _nodeX[other] - gx, dy = _nodeY[other] - gy;
+			queue.push(Entry(cost + sqrt(dx*dx + dy*dy),other));
+		}
+	}
+
+	if(_doneMark[goal] != _query)
+		return false;
+
+	//the roads from the goal back to the start, then forwards along them
+	std::vector<int> roads;
+	int node = goal;
+	while(node != start)
+	{
+		int road = _cameBy[node];
+		roads.push_back(road);
+		node = (_roadNode1[road] == node) ? _roadNode2[road] : _roadNode1[road];
+	}
+
+	xValues.push_back(startX);
+	yValues.push_back(startY);
+	xValues.push_back(_nodeX[start]);
+	yValues.push_back(_nodeY[start]);
+	for(long i = (long)roads.size() - 1; i >= 0; i--)
+	{
+		appendRoad(roads[i],node,xValues,yValues);
+		node = (_roadNode1[roads[i]] == node) ? _roadNode2[roads[i]] : _roadNode1[roads[i]];
+	}
+	xValues.push_back(goalX);
+	yValues.push_back(goalY);
+	return true;
+}
@@ -0,0 +1,110 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#ifndef VORONOIROADMAP_H
+#define VORONOIROADMAP_H
+
+#include <vector>
+
+//A graph of roads for finding paths on, made from the voronoi diagram.  A road is a line of
+//points, with the least distance from it to the sites of the diagram as its clearance.  The
+//ends of the roads are the nodes, given as the numbers of the vertices of the diagram, so the
+//roads with the same number at an end meet there.
+//
+//The roads are added, then build() puts them into arrays: the nodes are numbered, the roads
+//through nodes with only two roads are joined into one, and the roads at each node are in one
+//array with an offset per node.  The nodes are also put into square buckets, so the node
+//nearest a point is found from the buckets round it.  A path is found with A*, the arrays for
+//it are kept between queries and are marked with the number of the query instead of being
+//cleared
+class VoronoiRoadmap
+{
+public:
+	VoronoiRoadmap();
+
+	//throws the roads away
+	void clear();
+
+	//adds a road through 'numOfPoints' points, which are copied, from the vertex 'node1' at its
+	//first point to the vertex 'node2' at its last.  The vertex numbers are not negative
+	void addRoad(const float* xValues, const float* yValues, long numOfPoints, float clearance,
+				 int node1, int node2);
+
+	//makes the graph from the roads added since clear().  'version' tells what the roads were
+	//made from, see getVersion()
+	void build(long version);
+
+	bool isBuilt() const {return _built;}
+	long getVersion() const {return _version;}
+	long getNumOfNodes() const {return (long)_nodeX.size();}
+	long getNumOfRoads() const {return (long)_roadClearance.size();}
+
+	//The cheapest path from the start to the goal: from the start to the node nearest it, along
+	//the roads to the node nearest the goal, and on to the goal.  A road is a way only if its
+	//clearance is at least minClearance.  A unit of its length costs 1 + clearanceWeight/clearance
+	//with the clearance of the road it was added as, not the least one of the joined road.  The
+	//points of the path go in xValues and yValues.  False if no node can be reached or there is
+	//no way between them
+	bool findPath(float startX, float startY, float goalX, float goalY, float minClearance,
+				  float clearanceWeight, std::vector<float>& xValues, std::vector<float>& yValues);
+
+	//the nodes A* took off its queue in the last findPath()
+	long getNumOfExpanded() const {return _expanded;}
+
+private:
+	void numberNodes();
+	void linkRoads();
+	void joinRoads();
+	int nearestNode(float x, float y, float minClearance) const;
+	bool hasWay(int node, float minClearance) const;
+	void appendRoad(int road, int fromNode, std::vector<float>& xValues, std::vector<float>& yValues) const;
+
+	bool					_built;
+	long					_version;
+
+	//the roads: the points of road r start at _roadStart[r]
+	std::vector<long>		_roadStart;
+	std::vector<float>		_pointX, _pointY;
+	std::vector<float>		_roadLength, _roadClearance;
+	std::vector<float>		_roadLengthOverClearance;	//of each road joined into it, summed
+	std::vector<int>		_roadNode1, _roadNode2;	//the vertex numbers until build() numbers the nodes
+
+	//the nodes, with the roads at node n from _linkStart[n]
+	std::vector<float>		_nodeX, _nodeY;
+	std::vector<long>		_linkStart;
+	std::vector<int>		_linkRoad, _linkNode;
+
+	//the buckets, the nodes in bucket b from _bucketStart[b]
+	float					_bucketMinX, _bucketMinY, _bucketSize;
+	long					_bucketColumns, _bucketRows;
+	std::vector<long>		_bucketStart;
+	std::vector<int>		_bucketNodes;
+
+	//A*: a node's cost and the road it was reached by are only good if its mark is the query
+	std::vector<double>		_cost;
+	std::vector<int>		_cameBy;
+	std::vector<unsigned int>	_mark, _doneMark;
+	unsigned int			_query;
+	long					_expanded;
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#include "VoronoiSiteScan.h"
+#include "../sosutil/Threaded.h"
+#include <string.h>
+
+//the stripes of the scan are marked, or their sites written, a stripe to a part
+class VoronoiScanPass : public IThreadedParts
+{
+public:
+	VoronoiScanPass(VoronoiSiteScan* scan, bool write)
+	{
+		_scan = scan;
+		_write = write;
+	}
+
+	virtual void runPart(int part)
+	{
+		if(_write)
+			_scan->writeStripe(part);
+		else
+			_scan->markStripe(part);
+	}
+
+private:
+	VoronoiSiteScan*	_scan;
+	bool				_write;
+};
+
+bool VoronoiSiteScan::scan(GridMapLayer& gridLayer, long xMin, long yMin, long xMax, long yMax,
+						   float threshold1, float threshold2, int numOfThreads)
+{
+	SosUtil::ensureSmaller(threshold1, threshold2);
+
+	_gridLayer = &gridLayer;
+	_xMin = xMin;
+	_yMin = yMin;
+	_width = xMax - xMin + 1;
+	_height = yMax - yMin + 1;
+	_threshold1 = threshold1;
+	_threshold2 = threshold2;
+	_numOfSites = 0;
+
+	if(_width <= 0 || _height <= 0)
+		return true;
+
+	_numOfStripes = (numOfThreads > 1) ? numOfThreads : 1;
+	if(_numOfStripes > _height)
+		_numOfStripes = (int)_height;
+	_stripeSites.resize(_numOfStripes);
+
+	_wordsPerRow = (_width + 31)/32;
+	if(_bits == 0 || _wordsPerRow*_height > _bitsCapacity)
+	{
+		if(_bits != 0) delete[] _bits;
+		_bitsCapacity = _wordsPerRow*_height;
+		_bits = new unsigned int[_bitsCapacity];
+	}
+
+	//the window rows have a cell more on each side for the neighbours
+	long rowsNeeded = 3*(_width + 2)*_numOfStripes;
+	if(_rows == 0 || rowsNeeded > _rowsCapacity)
+	{
+		if(_rows != 0) delete[] _rows;
+		_rowsCapacity = rowsNeeded;
+		_rows = new float[_rowsCapacity];
+	}
+
+	if(_bits == 0 || _rows == 0)
+	{
+		_bitsCapacity = _rowsCapacity = 0;
+		return false;
+	}
+
+	VoronoiScanPass mark(this, false);
+	runParts(mark, _numOfStripes);
+
+	//the counts become the first site of each stripe
+	long total = 0;
+	int stripe;
+	for(stripe = 0; stripe < _numOfStripes; stripe++)
+	{
+		long count = _stripeSites[stripe];
+		_stripeSites[stripe] = total;
+		total += count;
+	}
+
+	if(_xValues == 0 || _yValues == 0 || total > _sitesCapacity)
+	{
+		if(_xValues != 0) delete[] _xValues;
+		if(_yValues != 0) delete[] _yValues;
+		_sitesCapacity = (total > 0) ? total : 1;
+		_xValues = new float[_sitesCapacity];
+		_yValues = new float[_sitesCapacity];
+
+		if(_xValues == 0 || _yValues == 0)
+		{
+			if(_xValues != 0) delete[] _xValues;
+			if(_yValues != 0) delete[] _yValues;
+			_xValues = _yValues = 0;
+			_sitesCapacity = 0;
+			return false;
+		}
+	}
+
+	VoronoiScanPass write(this, true);
+	runParts(write, _numOfStripes);
+	_numOfSites = total;
+
+	return true;
+}
+
+//Only the centre cell is taken as between the thresholds when it is negative, not its neighbours,
+//as generateVoronoi() always did
+void VoronoiSiteScan::markStripe(int stripe)
+{
+	long start = stripeStart(stripe), end = stripeStart(stripe + 1);
+	long rowLength = _width + 2;
+	float* below = _rows + 3*rowLength*stripe;
+	float* centre = below + rowLength;
+	float* above = centre + rowLength;
+	float* temp = 0;
+	long count = 0;
+	long x = 0, y = 0;
+	float val = 0;
+
+	_gridLayer->copyRowConcurrent(below,_yMin + start - 1,_xMin - 1,_xMin + _width);
+	_gridLayer->copyRowConcurrent(centre,_yMin + start,_xMin - 1,_xMin + _width);
+
+	for(y = start; y < end; y++)
+	{
+		_gridLayer->copyRowConcurrent(above,_yMin + y + 1,_xMin - 1,_xMin + _width);
+
+		unsigned int* bits = _bits + y*_wordsPerRow;
+		memset(bits, 0, _wordsPerRow*sizeof(unsigned int));
+
+		//the cell x of the map is at x + 1 in the window
+		for(x = 1; x <= _width; x++)
+		{
+			val = centre[x];
+			if(val < 0)
+			{
+				val = _threshold1;//all negative values fall within the threshold
+			}
+			if(!between(val))
+				continue;
+
+			if(!between(centre[x+1]) || !between(centre[x-1]) ||
+				!between(above[x+1]) || !between(below[x+1]) ||
+				!between(above[x]) || !between(below[x]) ||
+				!between(above[x-1]) || !between(below[x-1]))
+			{
+				bits[(x-1) >> 5] |= 1u << ((x-1) & 31);
+				count++;
+			}
+		}
+
+		temp = below;
+		below = centre;
+		centre = above;
+		above = temp;
+	}
+
+	_stripeSites[stripe] = count;
+}
+
+void VoronoiSiteScan::writeStripe(int stripe)
+{
+	long start = stripeStart(stripe), end = stripeStart(stripe + 1);
+	long position = _stripeSites[stripe];
+
+	for(long y = start; y < end; y++)
+	{
+		unsigned int* bits = _bits + y*_wordsPerRow;
+		float yValue = (float)(y + _yMin) + 0.5f;
+
+		for(long word = 0; word < _wordsPerRow; word++)
+		{
+			unsigned int cells = bits[word];
+			for(long x = word*32; cells != 0; x++, cells >>= 1)
+			{
+				if(cells & 1)
+				{
+					_xValues[position] = (float)(x + _xMin) + 0.5f;
+					_yValues[position] = yValue;
+					position++;
+				}
+			}
+		}
+	}
+}
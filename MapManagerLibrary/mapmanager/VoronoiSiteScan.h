@@ -0,0 +1,104 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#ifndef VORONOISITESCAN_H
+#define VORONOISITESCAN_H
+
+#include "../sosutil/SosUtil.h"
+#include "GridMapLayer.h"
+
+#include <vector>
+
+//The boundary cells that generateVoronoi() gives the VoronoiDiagramGenerator as sites: the cells
+//between the two thresholds with a neighbour that isn't.  The map is cut into horizontal stripes,
+//one per thread.  A stripe is read with copyRowConcurrent() into a window of three rows that rolls
+//up the stripe, so every row is copied once per stripe instead of nine reads per cell.  The first
+//pass marks the boundary cells with one bit each and counts them per stripe, the second writes the
+//cell centres of each stripe straight into its part of the site arrays.  The stripes follow each
+//other up the map, so the sites come out sorted by y then x, the order the generator sorts them
+//in, where the loop over the cells before went up each column in turn.  The arrays are kept for
+//the next call
+class VoronoiSiteScan
+{
+public:
+	VoronoiSiteScan()
+	{
+		_xValues = _yValues = 0;
+		_sitesCapacity = 0;
+		_numOfSites = 0;
+		_bits = 0;
+		_bitsCapacity = 0;
+		_rows = 0;
+		_rowsCapacity = 0;
+		_gridLayer = 0;
+		_xMin = _yMin = _width = _height = 0;
+		_wordsPerRow = 0;
+		_threshold1 = _threshold2 = 0;
+		_numOfStripes = 0;
+	}
+
+	~VoronoiSiteScan()
+	{
+		if(_xValues != 0) delete[] _xValues;
+		if(_yValues != 0) delete[] _yValues;
+		if(_bits != 0) delete[] _bits;
+		if(_rows != 0) delete[] _rows;
+	}
+
+	//scans the cells from (xMin,yMin) to (xMax,yMax) on numOfThreads threads, false if there
+	//was no memory
+	bool scan(GridMapLayer& gridLayer, long xMin, long yMin, long xMax, long yMax,
+			  float threshold1, float threshold2, int numOfThreads);
+
+	float* getXValues(){return _xValues;}
+	float* getYValues(){return _yValues;}
+	long getNumOfSites(){return _numOfSites;}
+
+	void markStripe(int stripe);
+	void writeStripe(int stripe);
+
+private:
+	bool between(float val)
+	{
+		return (val >= _threshold1 && val <= _threshold2);
+	}
+
+	long stripeStart(int stripe)
+	{
+		return _height*stripe/_numOfStripes;
+	}
+
+	float*			_xValues, *_yValues;
+	long			_sitesCapacity, _numOfSites;
+	unsigned int*	_bits;					//a bit per cell, set for the boundary cells
+	long			_bitsCapacity;
+	float*			_rows;					//the three row window of each stripe
+	long			_rowsCapacity;
+
+	GridMapLayer*	_gridLayer;
+	long			_xMin, _yMin, _width, _height, _wordsPerRow;
+	float			_threshold1, _threshold2;
+	int				_numOfStripes;
+	std::vector<long>	_stripeSites;		//the count of each stripe, then where its sites go
+};
+
+#endif
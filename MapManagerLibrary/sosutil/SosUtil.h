@@ -92,7 +92,7 @@ public:
 	static double cos(double angle); 	
 	static double sin(double angle);
 	
-	static void SosUtil::sinAndCos(double angle, double& sine, double& cosine);
+	static void sinAndCos(double angle, double& sine, double& cosine);
 
 	static double roundDown(double num);
 	static double roundUp(double num);
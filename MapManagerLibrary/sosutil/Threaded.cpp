@@ -11,11 +11,53 @@ DWORD WINAPI runThread(void *arg)
 
 	Threaded* thread = (Threaded*)arg;
 
+	//nothing of the thread is written after run(), it may have been started again
+	//or deleted once run() called threadFinished()
 	thread->run();
 
-	//cout<<"After calling thread->run"<<endl;
-
-	thread->_myThread = 0;
-
 	return 1;
+}
+
+class ThreadedPart : public Threaded
+{
+public:
+	ThreadedPart()
+	{
+		job = 0;
+		part = 0;
+	}
+
+	virtual void run()
+	{
+		job->runPart(part);
+		threadFinished();
+	}
+
+	IThreadedParts*	job;
+	int				part;
+};
+
+void runParts(IThreadedParts& job, int numOfParts)
+{
+	if(numOfParts <= 1)
+	{
+		job.runPart(0);
+		return;
+	}
+
+	ThreadedPart* threads = new ThreadedPart[numOfParts];
+	int part;
+	for(part = 1; part < numOfParts; part++)
+	{
+		threads[part].job = &job;
+		threads[part].part = part;
+		if(!threads[part].start())
+			threads[part].run();
+	}
+
+	job.runPart(0);
+
+	for(part = 1; part < numOfParts; part++)
+		threads[part].wait();
+	delete[] threads;
 }
\ No newline at end of file
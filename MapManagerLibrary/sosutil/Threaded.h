@@ -3,59 +3,82 @@
 
 #include <windows.h>
 
+DWORD WINAPI runThread(void *arg);
+
 class Threaded
 {
 public:
 	friend DWORD WINAPI runThread(void *arg);
 	Threaded()
 	{
-		_myThread = 0;
+		_threadHandle = 0;
 		_isRunning = false;
 		_threadFinished = true;
 	}
 
+	//stops the thread if it is running, and closes its handle
 	virtual ~Threaded()
 	{
-		if(_myThread != 0)
+		if(_threadHandle != 0)
 		{
 			stop();			
 		}
 	}
 
+	//false if the last thread hasn't called threadFinished() yet, wait() for it
 	bool start()
 	{
 		DWORD ret = 0;
 
-		if(_myThread != 0)
+		if(_threadHandle != 0)
+		{
+			//still running
+			if(!_threadFinished)
+			{
+				return false;
+			}
+			//the last thread ended without a wait(), it is only returning from run()
+			wait();
+		}
+		//set before the thread runs, it can finish before CreateThread returns
+		_isRunning = true;
+		_threadFinished = false;
+		_threadHandle = CreateThread(0, 0, &runThread, (void*)(this), 0, &ret);
+		if(_threadHandle == 0)
 		{
+			_isRunning = false;
+			_threadFinished = true;
 			return false;
 		}
-		_myThread = CreateThread(0, 0, &runThread, (void*)(this), 0, &ret);
-		_isRunning = !(_myThread == 0);
-		_threadFinished = !_isRunning;
 
-		return _isRunning;
+		return true;
 	}
 
 	bool stop()
 	{
-		if(_myThread != 0)
+		if(_threadHandle == 0)
 		{
-			//the running thread should check this in its while/for loop
-			//and stop when it goes false
-			_isRunning = false;
-
-			while(!_threadFinished) 
-			{
-				Sleep(1);//sleep for a millisecond
-			}
-		//	TerminateThread(_myThread, 1);
-			_myThread = 0;
+			return false;
 		}
-		else
+		//the running thread should check this in its while/for loop
+		//and stop when it goes false
+		_isRunning = false;
+		return wait();
+	}
+
+	//waits until the thread has ended, so everything run() did can be used.
+	//The thread can be started again afterwards
+	bool wait()
+	{
+		if(_threadHandle == 0)
 		{
 			return false;
 		}
+		WaitForSingleObject(_threadHandle, INFINITE);
+		CloseHandle(_threadHandle);
+		_threadHandle = 0;
+		_isRunning = false;
+		_threadFinished = true;
 		return true;
 	}
 
@@ -81,10 +104,23 @@ protected:
 
 private:
 	bool _threadFinished;
-	HANDLE _myThread;
+	HANDLE _threadHandle;	//only used by the starting thread, the thread itself never writes it
 
 };
 
+//A job split into parts that can be done at the same time
+class IThreadedParts
+{
+public:
+	virtual ~IThreadedParts(){}
+
+	//does part 'part' of the job
+	virtual void runPart(int part) = 0;
+};
 
+//Does the parts 0 to numOfParts-1 of the job and returns when they are all done.  Part 0 is done
+//by the calling thread and the others by threads of their own, if a thread can't be made its
+//part is done by the calling thread
+void runParts(IThreadedParts& job, int numOfParts);
 
 #endif
\ No newline at end of file
@@ -22,7 +22,96 @@ email: shaneosullivan1@gmail.com
 
 #include "VoronoiDiagramGenerator.h"
 
-VoronoiDiagramGenerator::VoronoiDiagramGenerator()
+template<class Real>
+VoronoiEdgeBufferT<Real>::VoronoiEdgeBufferT()
+{
+	x1Values = y1Values = x2Values = y2Values = 0;
+	count = 0;
+	capacity = 0;
+	good = true;
+}
+
+template<class Real>
+VoronoiEdgeBufferT<Real>::~VoronoiEdgeBufferT()
+{
+	release();
+}
+
+template<class Real>
+bool VoronoiEdgeBufferT<Real>::reserve(long size)
+{
+	if(size <= capacity)
+		return true;
+	return grow(size);
+}
+
+template<class Real>
+bool VoronoiEdgeBufferT<Real>::grow(long size)
+{
+	if(size < 4000)
+		size = 4000;
+
+	//all four arrays grow or none of them do, the old ones are kept until the new
+	//ones are all there
+	Real* newX1 = (Real*)malloc(size*sizeof(Real));
+	Real* newY1 = (Real*)malloc(size*sizeof(Real));
+	Real* newX2 = (Real*)malloc(size*sizeof(Real));
+	Real* newY2 = (Real*)malloc(size*sizeof(Real));
+
+	if(newX1 == 0 || newY1 == 0 || newX2 == 0 || newY2 == 0)
+	{
+		if(newX1 != 0) free(newX1);
+		if(newY1 != 0) free(newY1);
+		if(newX2 != 0) free(newX2);
+		if(newY2 != 0) free(newY2);
+		return false;
+	}
+
+	if(count > 0)
+	{
+		memcpy(newX1,x1Values,count*sizeof(Real));
+		memcpy(newY1,y1Values,count*sizeof(Real));
+		memcpy(newX2,x2Values,count*sizeof(Real));
+		memcpy(newY2,y2Values,count*sizeof(Real));
+	}
+
+	long oldCount = count;
+	release();
+	x1Values = newX1;
+	y1Values = newY1;
+	x2Values = newX2;
+	y2Values = newY2;
+	count = oldCount;
+	capacity = size;
+	return true;
+}
+
+template<class Real>
+void VoronoiEdgeBufferT<Real>::release()
+{
+	if(x1Values != 0) free(x1Values);
+	if(y1Values != 0) free(y1Values);
+	if(x2Values != 0) free(x2Values);
+	if(y2Values != 0) free(y2Values);
+	x1Values = y1Values = x2Values = y2Values = 0;
+	count = 0;
+	capacity = 0;
+	good = true;
+}
+
+//sort sites on y, then x, coord
+template<class Point> static int scomp(const void *p1,const void *p2)
+{
+	const Point *s1 = (const Point*)p1, *s2=(const Point*)p2;
+	if(s1 -> y < s2 -> y) return(-1);
+	if(s1 -> y > s2 -> y) return(1);
+	if(s1 -> x < s2 -> x) return(-1);
+	if(s1 -> x > s2 -> x) return(1);
+	return(0);
+}
+
+template<class Coord>
+VoronoiDiagramGeneratorT<Coord>::VoronoiDiagramGeneratorT()
 {
 	GET_FILE_LOG
 	//LOGGING_OFF
@@ -31,30 +120,68 @@ VoronoiDiagramGenerator::VoronoiDiagramGenerator()
 
 	allMemoryList = new FreeNodeArrayList;
 	allMemoryList->memory = 0;
+	allMemoryList->size = 0;
 	allMemoryList->next = 0;
 	currentMemoryBlock = allMemoryList;
-	allEdges = 0;
-	iteratorEdges = 0;
+	edgeSink = &edges;
+	iteratorEdge = 0;
 	sites = 0;
 	ELhash = 0;
 	PQhash = 0;
+	PQsplit = 0;
+	PQsubhash = 0;
+	PQsubhashsize = 0;
+	PQsubhashCapacity = 0;
+	PQminSub = 0;
+	PQheap = 0;
+	PQheapCapacity = 0;
+	PQtype = PRIORITY_QUEUE_HASH;
+	PQorder = 0;
+	PQfailed = false;
+	memset(&pqStats, 0, sizeof(pqStats));
+	memset(&elStats, 0, sizeof(elStats));
+	ELcheckLookups = 0;
+	ELcheckWalk = 0;
+	ELcheckSearch = 0;
+	sitesCapacity = 0;
+	ELhashCapacity = 0;
+	PQhashCapacity = 0;
+	sortKeys = 0;
+	sortIndices = 0;
+	sortCapacity = 0;
+	retainMemory = false;
+	sitesSorted = false;
 
 	minDistanceBetweenSites = 0;
+	originX = 0;
+	originY = 0;
+	exactSites = false;
 	
-	vertexLinks = 0;
-	vertices = 0;
-	finalVertexLinks =0;
-	finalVertices = 0;
+	vertexPoints = 0;
+	vertexOffsets = 0;
+	vertexNeighbours = 0;
+	numOfGraphVertices = 0;
+	capacityOfVertexGraph = 0;
+	genVertexGraph = false;
+	currentVertexLink = 0;
+	currentVertexNeighbour = 0;
+	currentVertex = 0;
 
 	setGenerateVoronoi(true);
 	setGenerateDelaunay(false);
 
-	delaunayEdges = 0;
-	iteratorDelaunayEdges = 0;
+	delaunaySitePoints = 0;
+	delaunayEdgeSites = 0;
+	delaunayTriangles = 0;
+	numOfDelaunayEdges = 0;
+	numOfDelaunayTriangles = 0;
+	capacityOfDelaunay = 0;
+	iteratorDelaunayEdge = 0;
 	
 }
 
-VoronoiDiagramGenerator::~VoronoiDiagramGenerator()
+template<class Coord>
+VoronoiDiagramGeneratorT<Coord>::~VoronoiDiagramGeneratorT()
 {
 	LOG<<"In ~VoronoiDiagramGenerator()"<<endl;
 	reset();
@@ -80,44 +207,100 @@ VoronoiDiagramGenerator::~VoronoiDiagramGenerator()
 		*/
 }
 
-void VoronoiDiagramGenerator::reset()
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::reset()
 {
 	LOG<<"In VoronoiDiagramGenerator::reset()"<<endl;
-	cleanup();
+	releaseMemory();
 	cleanupEdges();
+	releaseVertexArrays();
+	releaseDelaunayArrays();
 
 	if(allMemoryList != 0)
 		delete allMemoryList;
 
-	if(finalVertices != 0)
-		free(finalVertices);
+	edges.release();
 
-	if(vertexLinks != 0)
-		free(vertexLinks);
+	allMemoryList = 0;
+	currentMemoryBlock = 0;
 
-	if(vertices != 0)
-		free(vertices);
+	LOG<<"At end of VoronoiDiagramGenerator::reset()"<<endl;
 
-	if(finalVertexLinks != 0)
-		free(finalVertexLinks);	
+}
 
-	allMemoryList = 0;
-	finalVertices = 0;
-	vertexLinks = 0;
-	vertices = 0;
-	finalVertexLinks = 0;
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::setRetainMemory(bool retain)
+{
+	if(retainMemory && !retain)
+	{
+		releaseMemory();
+		releaseVertexArrays();
+		releaseDelaunayArrays();
+	}
+	retainMemory = retain;
+}
 
-	LOG<<"At end of VoronoiDiagramGenerator::reset()"<<endl;
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::setPriorityQueue(int type)
+{
+	PQtype = type;
+}
 
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::setSitesSorted(bool isSorted)
+{
+	sitesSorted = isSorted;
 }
 
-void VoronoiDiagramGenerator::setGenerateDelaunay(bool genDel)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::releaseVertexArrays()
+{
+	if(vertexPoints != 0)
+		free(vertexPoints);
+
+	if(vertexOffsets != 0)
+		free(vertexOffsets);
+
+	if(vertexNeighbours != 0)
+		free(vertexNeighbours);
+
+	vertexPoints = 0;
+	vertexOffsets = 0;
+	vertexNeighbours = 0;
+
+	numOfGraphVertices = 0;
+	capacityOfVertexGraph = 0;
+}
+
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::releaseDelaunayArrays()
+{
+	if(delaunaySitePoints != 0)
+		free(delaunaySitePoints);
+
+	if(delaunayEdgeSites != 0)
+		free(delaunayEdgeSites);
+
+	if(delaunayTriangles != 0)
+		free(delaunayTriangles);
+
+	delaunaySitePoints = 0;
+	delaunayEdgeSites = 0;
+	delaunayTriangles = 0;
+	numOfDelaunayEdges = 0;
+	numOfDelaunayTriangles = 0;
+	capacityOfDelaunay = 0;
+}
+
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::setGenerateDelaunay(bool genDel)
 {
 	genDelaunay = genDel;
 }
 
 
-void VoronoiDiagramGenerator::setGenerateVoronoi(bool genVor)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::setGenerateVoronoi(bool genVor)
 {
 	genVoronoi= genVor;
 }
@@ -125,13 +308,26 @@ void VoronoiDiagramGenerator::setGenerateVoronoi(bool genVor)
 
 
 
-bool VoronoiDiagramGenerator::generateVoronoi(float *xValues, float *yValues,  int numPoints, float minX, 
-											  float maxX, float minY, float maxY, float minDist, bool genVertexInfo)
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::generateVoronoi(Coord *xValues, Coord *yValues,  int numPoints, Real minX, 
+											  Real maxX, Real minY, Real maxY, Real minDist, bool genVertexInfo,
+											  VoronoiEdgeSinkT<Real>* sink)
 {
 	cleanup();
 	cleanupEdges();
 	int i;
 
+	//a diagram of n sites has less than 3n edges, so the default buffer is only sized once
+	if(sink == 0)
+	{
+		edgeSink = &edges;
+		edges.reserve(3*(long)numPoints);
+	}
+	else
+	{
+		edgeSink = sink;
+	}
+
 	minDistanceBetweenSites = minDist;
 
 	nsites=numPoints;
@@ -139,72 +335,90 @@ bool VoronoiDiagramGenerator::generateVoronoi(float *xValues, float *yValues,  i
 	triangulate = 0;	
 	debug = 1;
 	sorted = 0; 
-	if(sites != 0)
-		free(sites);
 
 	freeinit(&sfl, sizeof (Site));
-		
-	sites = (struct Site *) myalloc(nsites*sizeof( *sites));
-
-	if(finalVertices != 0)
-		free(finalVertices);
-
-	if(vertexLinks != 0)
-		free(vertexLinks);
-
-	if(vertices != 0)
-		free(vertices);
-
-	if(finalVertexLinks != 0)
-		free(finalVertexLinks);
+	
+	//the sites array is kept by cleanup() when retainMemory is set
+	if(sites == 0 || nsites > sitesCapacity)
+	{
+		if(sites != 0)
+			free(sites);
+		sites = (struct Site *) myalloc(nsites*sizeof( *sites));
+		sitesCapacity = (sites != 0) ? nsites : 0;
+	}
 
-	vertexLinks = 0;
-	vertices = 0;
-	finalVertexLinks =0;
-	finalVertices = 0;
+	if(!retainMemory)
+	{
+		releaseVertexArrays();
+		releaseDelaunayArrays();
+	}
 
-	sizeOfVertices = 0;
-	sizeOfVertexLinks = 0;
-	sizeOfFinalVertices = 0;
-	sizeOfFinalVertexLinks = 0;
+	//a diagram of n sites has less than 2n vertices, plus the ones made on the border
+	numOfGraphVertices = 0;
+	genVertexGraph = genVertexInfo && reserveVertexGraph(2*(long)nsites + 64);
 
-	if(sites == 0)
+	if(sites == 0 || (genDelaunay && !reserveDelaunay(xValues, yValues)))
 	{
 		LOG<<"generateVoronoi returning false 1";
 		return false;
 	}
 
 
-	xmin = xValues[0];
-	ymin = yValues[0];
-	xmax = xValues[0];
-	ymax = yValues[0];
+	Coord lowX = xValues[0], lowY = yValues[0], highX = xValues[0], highY = yValues[0];
 
 	for(i = 0; i< nsites; i++)
 	{
-		sites[i].coord.x = xValues[i];
-		sites[i].coord.y = yValues[i];
-		sites[i].sitenbr = i;
-		sites[i].refcnt = 0;
-
-		if(xValues[i] < xmin)
-			xmin = xValues[i];
-		else if(xValues[i] > xmax)
-			xmax = xValues[i];
+		if(xValues[i] < lowX)
+			lowX = xValues[i];
+		else if(xValues[i] > highX)
+			highX = xValues[i];
 
-		if(yValues[i] < ymin)
-			ymin = yValues[i];
-		else if(yValues[i] > ymax)
-			ymax = yValues[i];
+		if(yValues[i] < lowY)
+			lowY = yValues[i];
+		else if(yValues[i] > highY)
+			highY = yValues[i];
 
 		//printf("\n%f %f\n",xValues[i],yValues[i]);
 	}
+
+	//whole numbers are moved to the origin, which is exact, so the range of the exact
+	//site events is the size of the map and not how far it is from 0
+	originX = 0;
+	originY = 0;
+	exactSites = false;
+	if(VoronoiCoordTraits<Coord>::exact)
+	{
+		originX = lowX;
+		originY = lowY;
+		exactSites = highX - lowX < VDG_EXACT_RANGE && highY - lowY < VDG_EXACT_RANGE;
+		minX -= (Real)originX;
+		maxX -= (Real)originX;
+		minY -= (Real)originY;
+		maxY -= (Real)originY;
+	}
+
+	xmin = (Real)(lowX - originX);
+	ymin = (Real)(lowY - originY);
+	xmax = (Real)(highX - originX);
+	ymax = (Real)(highY - originY);
 	
-	qsort(sites, nsites, sizeof (*sites), scomp); //undo
+	//the sites go into the array sorted by y, then by x.  qsort is only used when
+	//there is no memory for the radix sort
+	if(!sortSites(xValues, yValues))
+	{
+		for(i = 0; i< nsites; i++)
+		{
+			sites[i].coord.x = (Real)(xValues[i] - originX);
+			sites[i].coord.y = (Real)(yValues[i] - originY);
+			sites[i].sitenbr = i;
+			sites[i].refcnt = 0;
+		}
+		qsort(sites, nsites, sizeof (*sites), scomp<PointVDG>);
+	}
 	
 	siteidx = 0;
 	geominit();
-	float temp = 0;
+	Real temp = 0;
 	if(minX > maxX)
 	{
 		temp = minX;
@@ -225,20 +439,39 @@ bool VoronoiDiagramGenerator::generateVoronoi(float *xValues, float *yValues,  i
 	siteidx = 0;
 
 	LOG<<"About to call voronoi("<<triangulate<<")";
-	voronoi(genVertexInfo); //uncomment
+	if(!voronoi(genVertexInfo))
+	{
+		LOG<<"generateVoronoi returning false, voronoi() failed";
+		return false;
+	}
 
+	if(!edgeSink->isGood())
+	{
+		LOG<<"generateVoronoi returning false, the sink lost edges";
+		return false;
+	}
 	return true;
 }
 
-bool VoronoiDiagramGenerator::ELinitialize()
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::ELinitialize()
 {
 	int i;
 	freeinit(&hfl, sizeof **ELhash);
 	ELhashsize = 2 * sqrt_nsites;
-	ELhash = (struct Halfedge **) myalloc ( sizeof *ELhash * ELhashsize);
+	if(ELhash == 0 || ELhashsize > ELhashCapacity)
+	{
+		if(ELhash != 0)
+			free(ELhash);
+		ELhash = (struct Halfedge **) myalloc ( sizeof *ELhash * ELhashsize);
+		ELhashCapacity = ELhashsize;
+	}
 
 	if(ELhash == 0)
+	{
+		ELhashCapacity = 0;
 		return false;
+	}
 
 	for(i=0; i<ELhashsize; i +=1) ELhash[i] = (struct Halfedge *)NULL;
 	ELleftend = HEcreate( (struct Edge *)NULL, 0);
@@ -250,11 +483,58 @@ bool VoronoiDiagramGenerator::ELinitialize()
 	ELhash[0] = ELleftend;
 	ELhash[ELhashsize-1] = ELrightend;
 
+	memset(&elStats, 0, sizeof(elStats));
+	elStats.hashSize = ELhashsize;
+	ELcheckLookups = VDG_EL_CHECK_LOOKUPS;
+	ELcheckWalk = 0;
+	ELcheckSearch = 0;
+
+	return true;
+}
+
+//Makes ELhash VDG_EL_GROWTH times bigger.  Every bucket becomes VDG_EL_GROWTH buckets which
+//all start from its halfedge, that has a reference from each of them, and get their own
+//halfedges as the lookups go.  It is done in place from the end, a bucket never moves down.
+//The ends of the beach line stay in the first and last buckets
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::ELrehash()
+{
+	//more buckets than there can be halfedges on the beach line don't help
+	long size = (long)ELhashsize * VDG_EL_GROWTH;
+	if(size > 2*(long)nsites + 2)
+		return false;
+
+	if(size > ELhashCapacity)
+	{
+		struct Halfedge **newHash = (struct Halfedge **)realloc(ELhash, size * sizeof *ELhash);
+		if(newHash == 0)
+		{
+			LOG<<"Error - realloc failed, ELhash stays at "<<ELhashsize<<" buckets";
+			return false;
+		}
+		ELhash = newHash;
+		ELhashCapacity = size;
+	}
+
+	for(int b = ELhashsize-1; b >= 0; b--)
+	{
+		struct Halfedge *he = ELgethash(b);
+		for(int i = 0; i < VDG_EL_GROWTH; i++)
+			ELhash[b*VDG_EL_GROWTH + i] = he;
+		if(he != (struct Halfedge *) NULL)
+			he -> ELrefcnt += VDG_EL_GROWTH - 1;
+	}
+	ELhashsize = (int)size;
+
+	elStats.rehashes++;
+	elStats.hashSize = ELhashsize;
+	LOG<<"ELhash grew to "<<ELhashsize<<" buckets";
 	return true;
 }
 
 
-struct Halfedge* VoronoiDiagramGenerator::HEcreate(struct Edge *e,int pm)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Halfedge * VoronoiDiagramGeneratorT<Coord>::HEcreate(struct Edge *e,int pm)
 {
 	struct Halfedge *answer;
 	answer = (struct Halfedge *) getfree(&hfl);
@@ -267,7 +547,8 @@ struct Halfedge* VoronoiDiagramGenerator::HEcreate(struct Edge *e,int pm)
 }
 
 
-void VoronoiDiagramGenerator::ELinsert(struct	Halfedge *lb, struct Halfedge *newHe)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::ELinsert(struct	Halfedge *lb, struct Halfedge *newHe)
 {
 	newHe -> ELleft = lb;
 	newHe -> ELright = lb -> ELright;
@@ -276,7 +557,8 @@ void VoronoiDiagramGenerator::ELinsert(struct	Halfedge *lb, struct Halfedge *new
 }
 
 /* Get entry from hash table, pruning any deleted nodes */
-struct Halfedge * VoronoiDiagramGenerator::ELgethash(int b)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Halfedge * VoronoiDiagramGeneratorT<Coord>::ELgethash(int b)
 {
 	struct Halfedge *he;
 	
@@ -293,7 +575,8 @@ struct Halfedge * VoronoiDiagramGenerator::ELgethash(int b)
 	return ((struct Halfedge *) NULL);
 }	
 
-struct Halfedge * VoronoiDiagramGenerator::ELleftbnd(struct PointVDG *p)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Halfedge * VoronoiDiagramGeneratorT<Coord>::ELleftbnd(struct PointVDG *p)
 {
 	int i, bucket;
 	struct Halfedge *he;
@@ -314,15 +597,17 @@ struct Halfedge * VoronoiDiagramGenerator::ELleftbnd(struct PointVDG *p)
 			if ((he=ELgethash(bucket+i)) != (struct Halfedge *) NULL) 
 				break;
 		};
-		totalsearch += i;
+		elStats.hashSearch += i;
 	};
-	ntry += 1;
+	elStats.lookups += 1;
+	long walk = 0;
 	/* Now search linear list of halfedges for the correct one */
 	if (he==ELleftend  || (he != ELrightend && right_of(he,p)))
 	{
 		do 
 		{
 			he = he -> ELright;
+			walk++;
 		} while (he!=ELrightend && right_of(he,p));	//keep going right on the list until either the end is reached, or you find the 1st edge which the point
 		he = he -> ELleft;				//isn't to the right of
 	}
@@ -330,7 +615,11 @@ struct Halfedge * VoronoiDiagramGenerator::ELleftbnd(struct PointVDG *p)
 		do 
 		{
 			he = he -> ELleft;
+			walk++;
 		} while (he!=ELleftend && !right_of(he,p));
+	elStats.walk += walk;
+	if(walk > elStats.maxWalk)
+		elStats.maxWalk = walk;
 		
 	/* Update hash table and reference counts */
 	if(bucket > 0 && bucket <ELhashsize-1)
@@ -342,13 +631,29 @@ struct Halfedge * VoronoiDiagramGenerator::ELleftbnd(struct PointVDG *p)
 		ELhash[bucket] = he;
 		ELhash[bucket] -> ELrefcnt += 1;
 	};
+
+	//the buckets are too wide for the beach line when the walks get long, the table is
+	//made bigger after the halfedge went in, so the hint is kept.  Not when most of the time
+	//goes to empty buckets already, the sites are too close together in x for more buckets
+	//to tell them apart (a column of grid cells)
+	if(elStats.lookups >= ELcheckLookups)
+	{
+		long recentWalk = elStats.walk - ELcheckWalk;
+		long recentSearch = elStats.hashSearch - ELcheckSearch;
+		if(recentWalk > (long)VDG_EL_REHASH_WALK * VDG_EL_CHECK_LOOKUPS && recentWalk > 2*recentSearch)
+			ELrehash();
+		ELcheckLookups = elStats.lookups + VDG_EL_CHECK_LOOKUPS;
+		ELcheckWalk = elStats.walk;
+		ELcheckSearch = elStats.hashSearch;
+	}
 	return (he);
 }
 
 
 /* This delete routine can't reclaim node, since pointers from hash
 table may be present.   */
-void VoronoiDiagramGenerator::ELdelete(struct Halfedge *he)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::ELdelete(struct Halfedge *he)
 {
 	(he -> ELleft) -> ELright = he -> ELright;
 	(he -> ELright) -> ELleft = he -> ELleft;
@@ -356,18 +661,21 @@ void VoronoiDiagramGenerator::ELdelete(struct Halfedge *he)
 }
 
 
-struct Halfedge * VoronoiDiagramGenerator::ELright(struct Halfedge *he)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Halfedge * VoronoiDiagramGeneratorT<Coord>::ELright(struct Halfedge *he)
 {
 	return (he -> ELright);
 }
 
-struct Halfedge * VoronoiDiagramGenerator::ELleft(struct Halfedge *he)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Halfedge * VoronoiDiagramGeneratorT<Coord>::ELleft(struct Halfedge *he)
 {
 	return (he -> ELleft);
 }
 
 
-struct Site * VoronoiDiagramGenerator::leftreg(struct Halfedge *he)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Site * VoronoiDiagramGeneratorT<Coord>::leftreg(struct Halfedge *he)
 {
 	if(he -> ELedge == (struct Edge *)NULL) 
 		return(bottomsite);
@@ -375,7 +683,8 @@ struct Site * VoronoiDiagramGenerator::leftreg(struct Halfedge *he)
 		he -> ELedge -> reg[le] : he -> ELedge -> reg[re]);
 }
 
-struct Site * VoronoiDiagramGenerator::rightreg(struct Halfedge *he)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Site * VoronoiDiagramGeneratorT<Coord>::rightreg(struct Halfedge *he)
 {
 	if(he -> ELedge == (struct Edge *)NULL) //if this halfedge has no edge, return the bottom site (whatever that is)
 		return(bottomsite);
@@ -384,7 +693,8 @@ struct Site * VoronoiDiagramGenerator::rightreg(struct Halfedge *he)
 	return( he -> ELpm == le ? he -> ELedge -> reg[re] : he -> ELedge -> reg[le]);
 }
 
-void VoronoiDiagramGenerator::geominit()
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::geominit()
 {	
 	float sn;
 
@@ -398,9 +708,10 @@ void VoronoiDiagramGenerator::geominit()
 }
 
 
-struct Edge * VoronoiDiagramGenerator::bisect(struct Site *s1,struct Site *s2)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Edge * VoronoiDiagramGeneratorT<Coord>::bisect(struct Site *s1,struct Site *s2)
 {
-	float dx,dy,adx,ady;
+	Real dx,dy,adx,ady;
 	struct Edge *newedge;
 	
 	newedge = (struct Edge *) getfree(&efl);
@@ -416,7 +727,7 @@ struct Edge * VoronoiDiagramGenerator::bisect(struct Site *s1,struct Site *s2)
 	dy = s2->coord.y - s1->coord.y;
 	adx = dx>0 ? dx : -dx;					//make sure that the difference in positive
 	ady = dy>0 ? dy : -dy;
-	newedge -> c = (float)(s1->coord.x * dx + s1->coord.y * dy + (dx*dx + dy*dy)*0.5);//get the slope of the line
+	newedge -> c = (Real)(s1->coord.x * dx + s1->coord.y * dy + (dx*dx + dy*dy)*0.5);//get the slope of the line
 
 	if (adx>ady)
 	{	
@@ -436,11 +747,12 @@ struct Edge * VoronoiDiagramGenerator::bisect(struct Site *s1,struct Site *s2)
 }
 
 //create a new site where the HalfEdges el1 and el2 intersect - note that the PointVDG in the argument list is not used, don't know why it's there
-struct Site * VoronoiDiagramGenerator::intersect(struct Halfedge *el1, struct Halfedge *el2, struct PointVDG *p)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Site * VoronoiDiagramGeneratorT<Coord>::intersect(struct Halfedge *el1, struct Halfedge *el2, struct PointVDG *)
 {
 	struct	Edge *e1,*e2, *e;
 	struct  Halfedge *el;
-	float d, xint, yint;
+	Real d, xint, yint;
 	int right_of_site;
 	struct Site *v;
 	
@@ -486,12 +798,16 @@ struct Site * VoronoiDiagramGenerator::intersect(struct Halfedge *el1, struct Ha
 }
 
 /* returns 1 if p is to right of halfedge e */
-int VoronoiDiagramGenerator::right_of(struct Halfedge *el,struct PointVDG *p)
+template<class Coord>
+int VoronoiDiagramGeneratorT<Coord>::right_of(struct Halfedge *el,struct PointVDG *p)
 {
 	struct Edge *e;
 	struct Site *topsite;
 	int right_of_site, above, fast;
-	float dxp, dyp, dxs, t1, t2, t3, yl;
+	Real dxp, dyp, dxs, t1, t2, t3, yl;
+
+	if(exactSites)
+		return right_of_exact(el, p);
 	
 	e = el -> ELedge;
 	topsite = e -> reg[1];
@@ -530,7 +846,42 @@ int VoronoiDiagramGenerator::right_of(struct Halfedge *el,struct PointVDG *p)
 }
 
 
-void VoronoiDiagramGenerator::endpoint(struct Edge *e,int lr,struct Site * s)
+//right_of() for sites that are whole numbers.  p is above the bisector of the sites of
+//the halfedge, moved up by the distance to them, when (py-yl)^2 > (px-x1)^2 + (yl-y1)^2,
+//with (x1,y1) the top site and yl the bisector at px.  With d = 2(y1-y0), yl is n/d, and
+//taking the squares apart leaves (py-y1)(d(py+y1) - 2n) - d(px-x1)^2, which has the sign
+//of d when p is above.  The coordinates are below VDG_EXACT_RANGE, so it fits a long long
+template<class Coord>
+int VoronoiDiagramGeneratorT<Coord>::right_of_exact(struct Halfedge *el,struct PointVDG *p)
+{
+	struct Edge *e = el -> ELedge;
+	long long px = (long long)p->x, py = (long long)p->y;
+	long long x0 = (long long)e->reg[0]->coord.x, y0 = (long long)e->reg[0]->coord.y;
+	long long x1 = (long long)e->reg[1]->coord.x, y1 = (long long)e->reg[1]->coord.y;
+	int right_of_site, above;
+
+	right_of_site = px > x1;
+	if(right_of_site && el -> ELpm == le) return(1);
+	if(!right_of_site && el -> ELpm == re) return (0);
+
+	long long d = 2*(y1 - y0);
+	if(d == 0)
+	{
+		//the sites are side by side, the bisector goes straight up between them
+		above = 2*px > x0 + x1;
+	}
+	else
+	{
+		long long n = x1*x1 + y1*y1 - x0*x0 - y0*y0 - 2*(x1 - x0)*px;
+		long long t2 = px - x1;
+		long long l = (py - y1)*(d*(py + y1) - 2*n) - d*t2*t2;
+		above = d > 0 ? l > 0 : l < 0;
+	}
+	return (el->ELpm==le ? above : !above);
+}
+
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::endpoint(struct Edge *e,int lr,struct Site * s)
 {
 	e -> ep[lr] = s;
 	ref(s);
@@ -545,76 +896,174 @@ void VoronoiDiagramGenerator::endpoint(struct Edge *e,int lr,struct Site * s)
 }
 
 
-float VoronoiDiagramGenerator::dist(struct Site *s,struct Site *t)
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Real VoronoiDiagramGeneratorT<Coord>::dist(struct Site *s,struct Site *t)
 {
-	float dx,dy;
+	Real dx,dy;
 	dx = s->coord.x - t->coord.x;
 	dy = s->coord.y - t->coord.y;
-	return (float)(sqrt(dx*dx + dy*dy));
+	return (Real)(sqrt(dx*dx + dy*dy));
 }
 
 
-void VoronoiDiagramGenerator::makevertex(struct Site *v)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::makevertex(struct Site *v)
 {
 	v -> sitenbr = nvertices;
-	insertVertexAddress(nvertices,v);
+	if(genVertexGraph)
+		insertGraphVertex(v);
 	nvertices += 1;
+	//the sink gets the vertex as the vertex graph has it, the default buffer has no use for it
+	if(genVoronoi && edgeSink != &edges)
+	{
+		if(VoronoiCoordTraits<Coord>::exact)
+			edgeSink->addVertex(v->sitenbr,(Real)v->coord.x + (Real)originX,(Real)v->coord.y + (Real)originY);
+		else
+			edgeSink->addVertex(v->sitenbr,v->coord.x,v->coord.y);
+	}
 	out_vertex(v);
 }
 
 
-void VoronoiDiagramGenerator::deref(struct Site *v)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::deref(struct Site *v)
 {
 	v -> refcnt -= 1;
 	if (v -> refcnt == 0 ) 
 		makefree((Freenode*)v, &sfl);
 }
 
-void VoronoiDiagramGenerator::ref(struct Site *v)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::ref(struct Site *v)
 {
 	v -> refcnt += 1;
 	v -> overallRefcnt += 1;
 }
 
 //push the HalfEdge into the ordered linked list of vertices
-void VoronoiDiagramGenerator::PQinsert(struct Halfedge *he,struct Site * v, float offset)
+//the order of the circle events: by ystar, then by x, and the newest first
+template<class Entry> static inline bool PQless(const Entry& a, const Entry& b)
+{
+	if(a.ystar != b.ystar)
+		return a.ystar < b.ystar;
+	if(a.x != b.x)
+		return a.x < b.x;
+	return a.order > b.order;
+}
+
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::PQinsert(struct Halfedge *he,struct Site * v, Real offset)
 {
 	struct Halfedge *last, *next;
 	
 	he -> vertex = v;
 	ref(v);
-	he -> ystar = (float)(v -> coord.y + offset);
-	last = &PQhash[PQbucket(he)];
-	while ((next = last -> PQnext) != (struct Halfedge *) NULL &&
-		(he -> ystar  > next -> ystar  ||
-		(he -> ystar == next -> ystar && v -> coord.x > next->vertex->coord.x)))
-	{	
-		last = next;
-	};
-	he -> PQnext = last -> PQnext; 
-	last -> PQnext = he;
-	PQcount += 1;
+	he -> ystar = (Real)(v -> coord.y + offset);
+	pqStats.inserts++;
+
+	if(PQtype == PRIORITY_QUEUE_HEAP)
+	{
+		if(PQcount == PQheapCapacity)
+		{
+			long capacity = (PQheapCapacity > 0) ? PQheapCapacity*2 : 1024;
+			PQHeapEntry* newHeap = (PQHeapEntry*)realloc(PQheap, capacity*sizeof(PQHeapEntry));
+			if(newHeap == 0)
+			{
+				LOG<<"Error - realloc failed, the priority queue heap can't grow to "<<capacity;
+				he -> vertex = (struct Site *) NULL;
+				deref(v);
+				PQfailed = true;
+				return;
+			}
+			PQheap = newHeap;
+			PQheapCapacity = capacity;
+		}
+		PQheap[PQcount].ystar = he -> ystar;
+		PQheap[PQcount].x = v -> coord.x;
+		PQheap[PQcount].order = PQorder++;
+		PQheap[PQcount].he = he;
+		PQcount += 1;
+		PQheapUp(PQcount - 1);
+	}
+	else
+	{
+		int bucket = 0;
+		long probes = 0;
+		last = PQhead(he, bucket);
+		while ((next = last -> PQnext) != (struct Halfedge *) NULL &&
+			(he -> ystar  > next -> ystar  ||
+			(he -> ystar == next -> ystar && v -> coord.x > next->vertex->coord.x)))
+		{	
+			last = next;
+			probes++;
+		};
+		he -> PQnext = last -> PQnext; 
+		last -> PQnext = he;
+		PQcount += 1;
+		PQcountProbes(probes);
+
+		if(PQtype == PRIORITY_QUEUE_ADAPTIVE && probes > VDG_PQ_SPLIT_LENGTH && PQsplit[bucket] < 0)
+			PQsplitBucket(bucket);
+	}
+
+	if(PQcount > pqStats.maxSize)
+		pqStats.maxSize = PQcount;
 }
 
 //remove the HalfEdge from the list of vertices 
-void VoronoiDiagramGenerator::PQdelete(struct Halfedge *he)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::PQdelete(struct Halfedge *he)
 {
 	struct Halfedge *last;
 	
 	if(he -> vertex != (struct Site *) NULL)
 	{	
-		last = &PQhash[PQbucket(he)];
-		while (last -> PQnext != he) 
-			last = last -> PQnext;
+		pqStats.deletes++;
+		if(PQtype == PRIORITY_QUEUE_HEAP)
+		{
+			//the last entry goes into the hole, and moves up or down from there
+			long i = he -> PQindex;
+			PQcount -= 1;
+			if(i != PQcount)
+			{
+				PQheap[i] = PQheap[PQcount];
+				PQheap[i].he -> PQindex = i;
+				if(i > 0 && PQless(PQheap[i], PQheap[(i-1)/4]))
+					PQheapUp(i);
+				else
+					PQheapDown(i);
+			}
+		}
+		else
+		{
+			int bucket = 0;
+			long probes = 0;
+			last = PQhead(he, bucket);
+			while (last -> PQnext != he) 
+			{
+				last = last -> PQnext;
+				probes++;
+			}
 
-		last -> PQnext = he -> PQnext;
-		PQcount -= 1;
+			last -> PQnext = he -> PQnext;
+			PQcount -= 1;
+			PQcountProbes(probes);
+		}
 		deref(he -> vertex);
 		he -> vertex = (struct Site *) NULL;
 	};
 }
 
-int VoronoiDiagramGenerator::PQbucket(struct Halfedge *he)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::PQcountProbes(long probes)
+{
+	pqStats.probes += probes;
+	if(probes > pqStats.maxProbes)
+		pqStats.maxProbes = probes;
+}
+
+template<class Coord>
+int VoronoiDiagramGeneratorT<Coord>::PQbucket(struct Halfedge *he)
 {
 	int bucket;
 	
@@ -625,75 +1074,328 @@ int VoronoiDiagramGenerator::PQbucket(struct Halfedge *he)
 	return(bucket);
 }
 
+//the part of a split bucket that ystar goes in, 'position' is where ystar is in the buckets
+static inline int PQpart(double position, int bucket)
+{
+	int part = (int)((position - bucket) * VDG_PQ_SUB_BUCKETS);
+	if (part<0) part = 0;
+	if (part>=VDG_PQ_SUB_BUCKETS) part = VDG_PQ_SUB_BUCKETS-1;
+	return part;
+}
+
+//The head of the list the halfedge goes in.  That is the bucket, or the part of
+//it when the bucket is split
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Halfedge * VoronoiDiagramGeneratorT<Coord>::PQhead(struct Halfedge *he, int& bucket)
+{
+	if(PQtype != PRIORITY_QUEUE_ADAPTIVE)
+	{
+		bucket = PQbucket(he);
+		return &PQhash[bucket];
+	}
+
+	Real position = (he->ystar - ymin)/deltay * PQhashsize;
+	bucket = (int)position;
+	if (bucket<0) bucket = 0;
+	if (bucket>=PQhashsize) bucket = PQhashsize-1 ;
 
+	int part = 0;
+	if(PQsplit[bucket] >= 0)
+		part = PQpart(position, bucket);
 
-int VoronoiDiagramGenerator::PQempty()
+	if (bucket < PQmin || (bucket == PQmin && part < PQminSub))
+	{
+		PQmin = bucket;
+		PQminSub = part;
+	}
+
+	if(PQsplit[bucket] < 0)
+		return &PQhash[bucket];
+	return &PQsubhash[PQsplit[bucket] + part];
+}
+
+//The head of the lowest list that isn't empty, there must be one
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Halfedge * VoronoiDiagramGeneratorT<Coord>::PQminHead()
+{
+	while(true)
+	{
+		if(PQtype != PRIORITY_QUEUE_ADAPTIVE || PQsplit[PQmin] < 0)
+		{
+			if(PQhash[PQmin].PQnext != (struct Halfedge *)NULL)
+				return &PQhash[PQmin];
+		}
+		else
+		{
+			struct Halfedge *parts = &PQsubhash[PQsplit[PQmin]];
+			while(PQminSub < VDG_PQ_SUB_BUCKETS && parts[PQminSub].PQnext == (struct Halfedge *)NULL)
+			{
+				PQminSub++;
+				pqStats.emptyBuckets++;
+			}
+			if(PQminSub < VDG_PQ_SUB_BUCKETS)
+				return &parts[PQminSub];
+		}
+		PQmin += 1;
+		PQminSub = 0;
+		pqStats.emptyBuckets++;
+	}
+}
+
+//Splits the bucket into VDG_PQ_SUB_BUCKETS parts of the same height.  The entries are
+//sorted, so they stay sorted when they are handed out in order.  A bucket is only
+//split once, entries with the same ystar can't be split anyway
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::PQsplitBucket(int bucket)
+{
+	struct Halfedge *tails[VDG_PQ_SUB_BUCKETS];
+	struct Halfedge *he, *next;
+	int i;
+
+	if(PQsubhashsize + VDG_PQ_SUB_BUCKETS > PQsubhashCapacity)
+	{
+		int capacity = (PQsubhashCapacity > 0) ? PQsubhashCapacity*2 : 16*VDG_PQ_SUB_BUCKETS;
+		struct Halfedge* newSubhash = (struct Halfedge *)realloc(PQsubhash, capacity*sizeof(*PQsubhash));
+		if(newSubhash == 0)
+		{
+			LOG<<"Error - realloc failed, the bucket "<<bucket<<" of the priority queue isn't split";
+			return;
+		}
+		PQsubhash = newSubhash;
+		PQsubhashCapacity = capacity;
+	}
+
+	struct Halfedge *parts = &PQsubhash[PQsubhashsize];
+	for(i = 0; i < VDG_PQ_SUB_BUCKETS; i++)
+	{
+		parts[i].PQnext = (struct Halfedge *)NULL;
+		tails[i] = &parts[i];
+	}
+
+	for(he = PQhash[bucket].PQnext; he != (struct Halfedge *)NULL; he = next)
+	{
+		next = he -> PQnext;
+		i = PQpart((he->ystar - ymin)/deltay * PQhashsize, bucket);
+		he -> PQnext = (struct Halfedge *)NULL;
+		tails[i] -> PQnext = he;
+		tails[i] = he;
+	}
+	PQhash[bucket].PQnext = (struct Halfedge *)NULL;
+
+	PQsplit[bucket] = PQsubhashsize;
+	PQsubhashsize += VDG_PQ_SUB_BUCKETS;
+	if(bucket == PQmin)
+		PQminSub = 0;
+	pqStats.splits++;
+}
+
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::PQheapUp(long i)
+{
+	PQHeapEntry entry = PQheap[i];
+	long probes = 0;
+	while(i > 0)
+	{
+		long parent = (i-1)/4;
+		if(!PQless(entry, PQheap[parent]))
+			break;
+		PQheap[i] = PQheap[parent];
+		PQheap[i].he -> PQindex = i;
+		i = parent;
+		probes++;
+	}
+	PQheap[i] = entry;
+	entry.he -> PQindex = i;
+	PQcountProbes(probes);
+}
+
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::PQheapDown(long i)
+{
+	PQHeapEntry entry = PQheap[i];
+	long probes = 0;
+	while(true)
+	{
+		long child = 4*i + 1, best = child, last = child + 4;
+		if(child >= PQcount)
+			break;
+		if(last > PQcount)
+			last = PQcount;
+		for(child++; child < last; child++)
+		{
+			if(PQless(PQheap[child], PQheap[best]))
+				best = child;
+		}
+		if(!PQless(PQheap[best], entry))
+			break;
+		PQheap[i] = PQheap[best];
+		PQheap[i].he -> PQindex = i;
+		i = best;
+		probes++;
+	}
+	PQheap[i] = entry;
+	entry.he -> PQindex = i;
+	PQcountProbes(probes);
+}
+
+template<class Coord>
+int VoronoiDiagramGeneratorT<Coord>::PQempty()
 {
 	return(PQcount==0);
 }
 
 
-struct PointVDG VoronoiDiagramGenerator::PQ_min()
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::PointVDG VoronoiDiagramGeneratorT<Coord>::PQ_min()
 {
 	struct PointVDG answer;
 	
-	while(PQhash[PQmin].PQnext == (struct Halfedge *)NULL) {PQmin += 1;};
-	answer.x = PQhash[PQmin].PQnext -> vertex -> coord.x;
-	answer.y = PQhash[PQmin].PQnext -> ystar;
+	if(PQtype == PRIORITY_QUEUE_HEAP)
+	{
+		answer.x = PQheap[0].x;
+		answer.y = PQheap[0].ystar;
+		return (answer);
+	}
+
+	struct Halfedge *head = PQminHead();
+	answer.x = head -> PQnext -> vertex -> coord.x;
+	answer.y = head -> PQnext -> ystar;
 	return (answer);
 }
 
-struct Halfedge * VoronoiDiagramGenerator::PQextractmin()
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Halfedge * VoronoiDiagramGeneratorT<Coord>::PQextractmin()
 {
 	struct Halfedge *curr;
 	
-	curr = PQhash[PQmin].PQnext;
-	PQhash[PQmin].PQnext = curr -> PQnext;
+	pqStats.extractions++;
+	if(PQtype == PRIORITY_QUEUE_HEAP)
+	{
+		curr = PQheap[0].he;
+		PQcount -= 1;
+		if(PQcount > 0)
+		{
+			PQheap[0] = PQheap[PQcount];
+			PQheapDown(0);
+		}
+		return(curr);
+	}
+
+	struct Halfedge *head = PQminHead();
+	curr = head -> PQnext;
+	head -> PQnext = curr -> PQnext;
 	PQcount -= 1;
 	return(curr);
 }
 
 
-bool VoronoiDiagramGenerator::PQinitialize()
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::PQinitialize()
 {
 	int i; 
 	
 	PQcount = 0;
 	PQmin = 0;
+	PQminSub = 0;
+	PQorder = 0;
+	PQfailed = false;
+	memset(&pqStats, 0, sizeof(pqStats));
+
+	if(PQtype == PRIORITY_QUEUE_HEAP)
+	{
+		//a queue of n sites rarely has more than a few sqrt(n) events, it doubles if it does
+		long capacity = 4 * sqrt_nsites;
+		if(PQheap == 0 || capacity > PQheapCapacity)
+		{
+			if(PQheap != 0)
+				free(PQheap);
+			PQheap = (PQHeapEntry *) myalloc(capacity * sizeof(PQHeapEntry));
+			PQheapCapacity = (PQheap != 0) ? capacity : 0;
+		}
+		return PQheap != 0;
+	}
+
 	PQhashsize = 4 * sqrt_nsites;
-	PQhash = (struct Halfedge *) myalloc(PQhashsize * sizeof *PQhash);
+	if(PQhash == 0 || PQhashsize > PQhashCapacity)
+	{
+		if(PQhash != 0)
+			free(PQhash);
+		if(PQsplit != 0)
+			free(PQsplit);
+		PQsplit = 0;
+		PQhash = (struct Halfedge *) myalloc(PQhashsize * sizeof *PQhash);
+		PQhashCapacity = PQhashsize;
+	}
 
 	if(PQhash == 0)
+	{
+		PQhashCapacity = 0;
 		return false;
+	}
 
 	for(i=0; i<PQhashsize; i+=1) PQhash[i].PQnext = (struct Halfedge *)NULL;
 
+	if(PQtype == PRIORITY_QUEUE_ADAPTIVE)
+	{
+		//PQsplit is always as big as PQhash
+		if(PQsplit == 0)
+			PQsplit = (int *) myalloc(PQhashCapacity * sizeof *PQsplit);
+		if(PQsplit == 0)
+			return false;
+
+		//the same buckets as the hash to start with
+		for(i=0; i<PQhashsize; i+=1) PQsplit[i] = -1;
+		PQsubhashsize = 0;
+	}
+
 	return true;
 }
 
 
-void VoronoiDiagramGenerator::freeinit(struct Freelist *fl,int size)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::freeinit(struct Freelist *fl,int size)
 {
 	fl -> head = (struct Freenode *) NULL;
 	fl -> nodesize = size;
 }
 
-char * VoronoiDiagramGenerator::getfree(struct Freelist *fl)
+template<class Coord>
+char * VoronoiDiagramGeneratorT<Coord>::getfree(struct Freelist *fl)
 {
 	int i; 
 	struct Freenode *t;
 
 	if(fl->head == (struct Freenode *) NULL)
 	{	
-		t =  (struct Freenode *) myalloc(sqrt_nsites * fl->nodesize);
+		unsigned size = sqrt_nsites * fl->nodesize;
+		FreeNodeArrayList* block = currentMemoryBlock->next;
+
+		//a block kept from the last diagram is used again if it is big enough
+		if(block != 0 && block->size < size)
+		{
+			free(block->memory);
+			block->memory = (struct Freenode *) myalloc(size);
+			block->size = (block->memory != 0) ? size : 0;
+			if(block->memory == 0)
+				return 0;
+		}
 
-		if(t == 0)
-			return 0;
+		if(block == 0)
+		{
+			t =  (struct Freenode *) myalloc(size);
+
+			if(t == 0)
+				return 0;
 		
-		currentMemoryBlock->next = new FreeNodeArrayList;
-		currentMemoryBlock = currentMemoryBlock->next;
-		currentMemoryBlock->memory = t;
-		currentMemoryBlock->next = 0;
+			block = new FreeNodeArrayList;
+			block->memory = t;
+			block->size = size;
+			block->next = 0;
+			currentMemoryBlock->next = block;
+		}
+
+		currentMemoryBlock = block;
+		t = block->memory;
 
 		for(i=0; i<sqrt_nsites; i+=1) 	
 			makefree((struct Freenode *)((char *)t+i*fl->nodesize), fl);		
@@ -705,13 +1407,29 @@ char * VoronoiDiagramGenerator::getfree(struct Freelist *fl)
 
 
 
-void VoronoiDiagramGenerator::makefree(struct Freenode *curr,struct Freelist *fl)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::makefree(struct Freenode *curr,struct Freelist *fl)
 {
 	curr -> nextfree = fl -> head;
 	fl -> head = curr;
 }
 
-void VoronoiDiagramGenerator::cleanup()
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::cleanup()
+{
+	if(!retainMemory)
+	{
+		releaseMemory();
+		return;
+	}
+
+	//keep everything, the blocks are handed out again from the start of the list
+	LOG<<"In cleanup, retaining the memory"<<endl;
+	currentMemoryBlock = allMemoryList;
+}
+
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::releaseMemory()
 {
 	LOG<<"In cleanup"<<endl;
 	if(sites != 0)
@@ -719,33 +1437,26 @@ void VoronoiDiagramGenerator::cleanup()
 		free(sites);
 		sites = 0;
 	}
+	sitesCapacity = 0;
 
-	FreeNodeArrayList* current=0, *prev = 0;
+	FreeNodeArrayList* current=0, *next = 0;
 
-	current = prev = allMemoryList;
+	current = allMemoryList;
 
-	if(current != 0)
+	while(current != 0)
 	{
-		while(current->next != 0)
-		{
-			prev = current;
-			current = current->next;
-			free(prev->memory);
-			delete prev;
-			prev = 0;
-		}
-	}
-	allMemoryList = 0;
-
-	if(current != 0 && current->memory != 0)
-	{
-		free(current->memory);
+		next = current->next;
+		if(current->memory != 0)
+			free(current->memory);
 		delete current;
+		current = next;
 	}
+	allMemoryList = 0;
 
 	allMemoryList = new FreeNodeArrayList;
 	allMemoryList->next = 0;
 	allMemoryList->memory = 0;
+	allMemoryList->size = 0;
 	currentMemoryBlock = allMemoryList;
 
 	if(ELhash != 0)
@@ -753,80 +1464,116 @@ void VoronoiDiagramGenerator::cleanup()
 		free(ELhash);
 		ELhash = 0;
 	}
+	ELhashCapacity = 0;
 
 	if(PQhash != 0)
 	{
 		free(PQhash);
 		PQhash = 0;
 	}
+	if(PQsplit != 0)
+	{
+		free(PQsplit);
+		PQsplit = 0;
+	}
+	PQhashCapacity = 0;
 
-	LOG<<"At the end of cleanup";
-}
-
-void VoronoiDiagramGenerator::cleanupEdges()
-{
-	LOG<<"At start of cleanupEdges"<<endl;
-	GraphEdge* geCurrent = 0, *gePrev = 0;
-	geCurrent = gePrev = allEdges;
-
-	while(geCurrent != 0 && geCurrent->next != 0)
+	if(PQsubhash != 0)
 	{
-		gePrev = geCurrent;
-		geCurrent = geCurrent->next;
-		delete gePrev;
+		free(PQsubhash);
+		PQsubhash = 0;
 	}
+	PQsubhashCapacity = 0;
 
-	allEdges = 0;
+	if(PQheap != 0)
+	{
+		free(PQheap);
+		PQheap = 0;
+	}
+	PQheapCapacity = 0;
 
-	geCurrent = gePrev = delaunayEdges;
+	if(sortKeys != 0)
+	{
+		free(sortKeys);
+		sortKeys = 0;
+	}
 
-	while(geCurrent != 0 && geCurrent->next != 0)
+	if(sortIndices != 0)
 	{
-		gePrev = geCurrent;
-		geCurrent = geCurrent->next;
-		delete gePrev;
+		free(sortIndices);
+		sortIndices = 0;
 	}
+	sortCapacity = 0;
 
-	delaunayEdges = 0;
+	LOG<<"At the end of cleanup";
+}
+
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::cleanupEdges()
+{
+	LOG<<"At start of cleanupEdges"<<endl;
+
+	edges.clear();
+	iteratorEdge = 0;
+
+	numOfDelaunayEdges = 0;
+	numOfDelaunayTriangles = 0;
+	iteratorDelaunayEdge = 0;
 	LOG<<"At end of cleanupEdges"<<endl;
 }
 
-void VoronoiDiagramGenerator::pushGraphEdge(float x1, float y1, float x2, float y2)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::pushGraphEdge(Real x1, Real y1, Real x2, Real y2,
+												 struct Site* site1, struct Site* site2,
+												 struct Site* vertex1, struct Site* vertex2)
 {
 	if(genVoronoi)
 	{
+		if(VoronoiCoordTraits<Coord>::exact)
+		{
+			x1 += (Real)originX;
+			y1 += (Real)originY;
+			x2 += (Real)originX;
+			y2 += (Real)originY;
+		}
 		//LOG<<"Graph edge pushed";
-		GraphEdge* newEdge = new GraphEdge;
-		newEdge->next = allEdges;
-		allEdges = newEdge;
-		newEdge->x1 = x1;
-		newEdge->y1 = y1;
-		newEdge->x2 = x2;
-		newEdge->y2 = y2;
+		//the default buffer is called directly, so the compiler can inline it
+		if(edgeSink == &edges)
+			edges.addEdge(x1,y1,x2,y2);
+		else if(site1 == 0 || site2 == 0)
+			edgeSink->addEdge(x1,y1,x2,y2);
+		else if(VoronoiCoordTraits<Coord>::exact)
+			edgeSink->addEdgeVertices(x1,y1,x2,y2,
+				site1->coord.x + (Real)originX,site1->coord.y + (Real)originY,
+				site2->coord.x + (Real)originX,site2->coord.y + (Real)originY,
+				vertex1->sitenbr,vertex2->sitenbr);
+		else
+			edgeSink->addEdgeVertices(x1,y1,x2,y2,site1->coord.x,site1->coord.y,site2->coord.x,site2->coord.y,
+				vertex1->sitenbr,vertex2->sitenbr);
 	}
 }
 
-void VoronoiDiagramGenerator::pushDelaunayGraphEdge(float x1, float y1, float x2, float y2)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::pushDelaunayGraphEdge(struct Site* s1, struct Site* s2)
 {
-	if(sqrt(((x2 - x1) * (x2 - x1)) + ((y2 - y1) * (y2 - y1))) < minDistanceBetweenSites)
+	Real dx = s2->coord.x - s1->coord.x;
+	Real dy = s2->coord.y - s1->coord.y;
+	if(sqrt((dx * dx) + (dy * dy)) < minDistanceBetweenSites)
 	{
-		LOG<<"Skipping line of length "<<(x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1)<<" because minDistanceBetweenSites = "<<minDistanceBetweenSites;
+		LOG<<"Skipping line of length "<<dx * dx + dy * dy<<" because minDistanceBetweenSites = "<<minDistanceBetweenSites;
 		return;
 	}
-	LOG<<"NOT Skipping line of length "<<(x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1)<<" because minDistanceBetweenSites = "<<minDistanceBetweenSites;
-		
-	GraphEdge* newEdge = new GraphEdge;
-	newEdge->next = delaunayEdges;
-	delaunayEdges = newEdge;
-	newEdge->x1 = x1;
-	newEdge->y1 = y1;
-	newEdge->x2 = x2;
-	newEdge->y2 = y2;
+	LOG<<"NOT Skipping line of length "<<dx * dx + dy * dy<<" because minDistanceBetweenSites = "<<minDistanceBetweenSites;
 
-	//LOG<<"Pushed Delaunay edge ("<<x1<<","<<y1<<") -> ("<<x2<<","<<y2<<"), now delaunayEdges = "<<delaunayEdges;
+	if(numOfDelaunayEdges >= 3*capacityOfDelaunay)
+		return;
+	delaunayEdgeSites[2*numOfDelaunayEdges] = s1->sitenbr;
+	delaunayEdgeSites[2*numOfDelaunayEdges+1] = s2->sitenbr;
+	numOfDelaunayEdges++;
 }
 
-char * VoronoiDiagramGenerator::myalloc(unsigned n)
+template<class Coord>
+char * VoronoiDiagramGeneratorT<Coord>::myalloc(unsigned n)
 {
 	char *t=0;	
 	t=(char*)malloc(n);
@@ -837,23 +1584,27 @@ char * VoronoiDiagramGenerator::myalloc(unsigned n)
 
 /* for those who don't have Cherry's plot */
 /* #include <plot.h> */
-void VoronoiDiagramGenerator::openpl(){}
-void VoronoiDiagramGenerator::line(float x1, float y1, float x2, float y2)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::openpl(){}
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::line(Real x1, Real y1, Real x2, Real y2)
 {	
-	pushGraphEdge(x1,y1,x2,y2);
+	pushGraphEdge(x1,y1,x2,y2,0,0,0,0);
 
 }
-void VoronoiDiagramGenerator::circle(float x, float y, float radius){}
-void VoronoiDiagramGenerator::range(float minX, float minY, float maxX, float maxY){}
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::circle(Real, Real, Real){}
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::range(Real, Real, Real, Real){}
 
 
 
-void VoronoiDiagramGenerator::out_bisector(struct Edge *e)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::out_bisector(struct Edge *e)
 {
 	if(genDelaunay)
 	{
-		pushDelaunayGraphEdge(e->reg[0]->coord.x, e->reg[0]->coord.y, 
-		     e->reg[1]->coord.x, e->reg[1]->coord.y);
+		pushDelaunayGraphEdge(e->reg[0], e->reg[1]);
 		LOG<<"Pused Delaunay Edge ("<<e->reg[0]->coord.x<<","<<e->reg[0]->coord.y<<") -> ("<<e->reg[1]->coord.x<<","<<e->reg[1]->coord.y<<")";
 
 
@@ -870,7 +1621,8 @@ void VoronoiDiagramGenerator::out_bisector(struct Edge *e)
 }
 
 
-void VoronoiDiagramGenerator::out_ep(struct Edge *e)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::out_ep(struct Edge *)
 {
 	//if(!triangulate & plot) 
 	//clip_line(e);
@@ -886,7 +1638,8 @@ void VoronoiDiagramGenerator::out_ep(struct Edge *e)
 	
 }
 
-void VoronoiDiagramGenerator::out_vertex(struct Site *v)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::out_vertex(struct Site *)
 {
 	if(!triangulate & !plot &!debug)
 	{
@@ -899,7 +1652,8 @@ void VoronoiDiagramGenerator::out_vertex(struct Site *v)
 }
 
 
-void VoronoiDiagramGenerator::out_site(struct Site *s)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::out_site(struct Site *)
 {/*
 	if(!triangulate & plot & !debug)
 		circle (s->coord.x, s->coord.y, cradius);
@@ -914,8 +1668,18 @@ void VoronoiDiagramGenerator::out_site(struct Site *s)
 }
 
 
-void VoronoiDiagramGenerator::out_triple(struct Site *s1, struct Site *s2,struct Site * s3)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::out_triple(struct Site *s1, struct Site *s2,struct Site * s3)
 {
+	//the circle event of a voronoi vertex, its three sites are a delaunay triangle
+	if(genDelaunay && numOfDelaunayTriangles < 2*capacityOfDelaunay)
+	{
+		int* t = delaunayTriangles + 3*numOfDelaunayTriangles;
+		t[0] = s1->sitenbr;
+		t[1] = s2->sitenbr;
+		t[2] = s3->sitenbr;
+		numOfDelaunayTriangles++;
+	}
 	//if(triangulate & !plot &!debug)
 	//{
 		//printf("%d %d %d\n", s1->sitenbr, s2->sitenbr, s3->sitenbr);
@@ -928,28 +1692,30 @@ void VoronoiDiagramGenerator::out_triple(struct Site *s1, struct Site *s2,struct
 
 
 
-void VoronoiDiagramGenerator::plotinit()
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::plotinit()
 {
-	float dx,dy,d;
+	Real dx,dy,d;
 	
 	dy = ymax - ymin;
 	dx = xmax - xmin;
-	d = (float)(( dx > dy ? dx : dy) * 1.1);
-	pxmin = (float)(xmin - (d-dx)/2.0);
-	pxmax = (float)(xmax + (d-dx)/2.0);
-	pymin = (float)(ymin - (d-dy)/2.0);
-	pymax = (float)(ymax + (d-dy)/2.0);
-	cradius = (float)((pxmax - pxmin)/350.0);
+	d = (Real)(( dx > dy ? dx : dy) * 1.1);
+	pxmin = (Real)(xmin - (d-dx)/2.0);
+	pxmax = (Real)(xmax + (d-dx)/2.0);
+	pymin = (Real)(ymin - (d-dy)/2.0);
+	pymax = (Real)(ymax + (d-dy)/2.0);
+	cradius = (Real)((pxmax - pxmin)/350.0);
 	openpl();
 	range(pxmin, pymin, pxmax, pymax);
 
 //	printf("pxmin = %f, pxmax = %f, pymin = %f, pymax = %f\n",pxmin,pxmax,pymin,pymax);
 }
 
-void VoronoiDiagramGenerator::clip_line(struct Edge *e)
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::clip_line(struct Edge *e)
 {
 	struct Site *s1, *s2;
-	float x1=0,x2=0,y1=0,y2=0, temp = 0;
+	Real x1=0,x2=0,y1=0,y2=0;
 	Site *v1= 0, *v2 = 0;
 	bool needNewVertex1 = false,needNewVertex2 = false;
 
@@ -1091,7 +1857,7 @@ void VoronoiDiagramGenerator::clip_line(struct Edge *e)
 	if(!((x1 == x2 && x2== pxmin) || (x1 == x2 && x2 == pxmax) || 
 		(y1 == y2 && y2 == pymin) || (y1 == y2 && y2 == pymax)))
 	{
-		pushGraphEdge(x1,y1,x2,y2);
+		//the clipped ends are made vertices first, so the sink gets the numbers of both ends
 		if(needNewVertex1)
 		{
 			//printf("\nCreate new vertex 1 
@@ -1111,7 +1877,9 @@ void VoronoiDiagramGenerator::clip_line(struct Edge *e)
 			v2 -> coord.y = y2;
 			makevertex(v2);
 		}
-		insertVertexLink(v1->sitenbr,v2->sitenbr);
+		pushGraphEdge(x1,y1,x2,y2,e->reg[0],e->reg[1],v1,v2);
+		if(genVertexGraph)
+			insertGraphEdge(v1->sitenbr,v2->sitenbr);
 	}
 
 	
@@ -1122,7 +1890,8 @@ deltax, deltay (can all be estimates).
 Performance suffers if they are wrong; better to make nsites,
 deltax, and deltay too big than too small.  (?) */
 
-bool VoronoiDiagramGenerator::voronoi(bool genVertexInfo)
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::voronoi(bool)
 {
 	struct Site *newsite, *bot, *top, *temp, *p;
 	struct Site *v;
@@ -1131,7 +1900,11 @@ bool VoronoiDiagramGenerator::voronoi(bool genVertexInfo)
 	struct Halfedge *lbnd, *rbnd, *llbnd, *rrbnd, *bisector;
 	struct Edge *e;
 	
-	PQinitialize();
+	if(!PQinitialize())
+	{
+		LOG<<"voronoi returning false, no memory for the priority queue";
+		return false;
+	}
 	bottomsite = nextone();
 	bool retval = ELinitialize();
 
@@ -1144,10 +1917,16 @@ bool VoronoiDiagramGenerator::voronoi(bool genVertexInfo)
 	newsite = nextone();
 
 	LOG<<"About to go into the infinite while loop";
-	long counter = 0;
 	while(1)
 	{
-		//LOG<<++counter;
+		//a lost circle event would make the rest of the diagram wrong
+		if(PQfailed)
+		{
+			LOG<<"voronoi returning false, a circle event was lost";
+			cleanup();
+			return false;
+		}
+
 		if(!PQempty()) 
 			newintstar = PQ_min();
 		
@@ -1234,6 +2013,10 @@ bool VoronoiDiagramGenerator::voronoi(bool genVertexInfo)
 		else break;
 	};
 
+	pqStats.buckets = (PQtype == PRIORITY_QUEUE_HEAP) ? 0 : PQhashsize;
+	if(PQtype == PRIORITY_QUEUE_ADAPTIVE)
+		pqStats.buckets += PQsubhashsize;
+
 	
 
 
@@ -1244,44 +2027,12 @@ bool VoronoiDiagramGenerator::voronoi(bool genVertexInfo)
 		clip_line(e);
 	};
 
-	LOG<<"Voronoi: after finishing the voronoi diagram - about to get the vertices";
-	LOG<<"sizeOfVertexLinks = "<<sizeOfVertexLinks;
-	//count the total number of 
-	long i = 0;
-
-	if(genVertexInfo)
+	if(genVertexGraph)
 	{
-		counter = 0;
-		sizeOfFinalVertices = 0;
-		for(i = 0; i < sizeOfVertexLinks; i++)
-		{
-			if(vertexLinks[i].count == 1 || vertexLinks[i].count == 3)
-			{
-				sizeOfFinalVertices++;
-			}
-		}
-
-		LOG<<"After counting the size of the final vertices = "<<sizeOfFinalVertices<<endl;
-
-		finalVertices = (PointVDG*)myalloc(sizeOfFinalVertices*sizeof(PointVDG));
-		counter = 0;
-		for(i = 0; i < sizeOfVertexLinks; i++)
-		{
-			if(vertexLinks[i].count == 1 || vertexLinks[i].count == 3 && vertices[i] != 0)
-			{
-				finalVertices[counter] = vertices[i]->coord;
-				counter++;
-			}
-		}
-
-		LOG<<"Just before generateVertexLinks()"<<endl;
-
-		generateVertexLinks();
-		LOG<<"Just after generateVertexLinks()"<<endl;
-
+		finishVertexGraph();
+		LOG<<"Voronoi: the vertex graph has "<<numOfGraphVertices<<" vertices";
 	}
 	
-	LOG<<"After generateVertexLinks()"<<endl;
 	cleanup();
 
 	LOG<<"After cleanup()";
@@ -1291,392 +2042,378 @@ bool VoronoiDiagramGenerator::voronoi(bool genVertexInfo)
 }
 
 
-void VoronoiDiagramGenerator::insertVertexAddress(long vertexNum, struct Site* address)
+//The float bits of a coordinate, changed so that they sort as an unsigned integer
+//in the same order as the floats
+static inline unsigned int sortableFloatBits(float value)
 {
-	if(vertices == 0)
-	{
-		vertices = (struct Site **) myalloc(4000*sizeof( *vertices));
-		sizeOfVertices = 4000;
-		for(int i = sizeOfVertices - 4000; i < sizeOfVertices; i++)
-		{
-			vertices[i] = 0;
-		}
-	}
-	//if the site address being entered is past the end of the array, then grow the array
-	while(vertexNum > sizeOfVertices - 1)
-	{
-		vertices = (Site**)realloc(vertices,(sizeOfVertices+4000)*sizeof(Site*));
-		sizeOfVertices += 4000;
-
-		for(int i = sizeOfVertices - 4000; i < sizeOfVertices; i++)
-		{
-			vertices[i] = 0;
-		}
-
-		LOG<<"Grew vertices to size "<<sizeOfVertices<<" and vertices = "<<vertices<<endl;
-	}
-	vertices[vertexNum] = address;
+	unsigned int bits;
+	value += 0.0f;	//-0 becomes 0, they are equal as floats
+	memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
 }
 
+static inline unsigned long long sortableDoubleBits(double value)
+{
+	unsigned long long bits;
+	value += 0.0;
+	memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+}
 
-
-void VoronoiDiagramGenerator::insertVertexLink(long vertexNum, long vertexLinkedTo)
+//sorting the keys sorts the sites by y, then by x, the same as scomp.  A float site
+//fits in one key
+unsigned long long VoronoiCoordTraits<float>::sortKey(float x, float y, int)
 {
-	if(vertexLinks == 0)
-	{
-		LOG<<"Initialising vertexlinks for the first time";
-		vertexLinks = (struct Point3*) myalloc(4000*sizeof(*vertexLinks));
-		sizeOfVertexLinks = 4000;
-		for(int i = 0; i < sizeOfVertexLinks; i++)
-		{
-			vertexLinks[i].x = vertexLinks[i].y = vertexLinks[i].z = -1; //initialise all elements in the array to -1
-			vertexLinks[i].count = 0;
-		}
-	}
-	//if the site address being entered is past the end of the array, then grow the array
-	while(vertexNum > sizeOfVertexLinks - 1 || vertexLinkedTo > sizeOfVertexLinks - 1)
-	{
-		//LOG<<"Resizing the array to "<<sizeOfVertexLinks + 4000<<endl;
-		//LOG<<endl;
-		vertexLinks = (Point3*)realloc(vertexLinks,(sizeOfVertexLinks+4000)*sizeof(Point3));
-		//if(vertexLinks == 0)LOG<<"Error - realloc failed, vertexLinks == 0"<<endl;
-		sizeOfVertexLinks += 4000;
+	return ((unsigned long long)sortableFloatBits(y) << 32) | sortableFloatBits(x);
+}
 
-		for(int i = sizeOfVertexLinks - 4000; i < sizeOfVertexLinks; i++)
-		{
-			vertexLinks[i].x = vertexLinks[i].y = vertexLinks[i].z = -1; //initialise all elements in the array to -1
-			vertexLinks[i].count = 0;
-		}
-	}
+unsigned long long VoronoiCoordTraits<double>::sortKey(double x, double y, int word)
+{
+	return sortableDoubleBits(word == 0 ? x : y);
+}
 
-	if(vertexLinks[vertexNum].x == -1)
-	{
-		vertexLinks[vertexNum].x = (float)vertexLinkedTo;
-		vertexLinks[vertexNum].count = 1;
-	}
-	else if(vertexLinks[vertexNum].y == -1)
-	{
-		vertexLinks[vertexNum].y = (float)vertexLinkedTo;
-		vertexLinks[vertexNum].count = 2;
-	}
-	else if(vertexLinks[vertexNum].z == -1)
-	{
-		vertexLinks[vertexNum].z = (float)vertexLinkedTo;
-		vertexLinks[vertexNum].count = 3;
-	}
+unsigned long long VoronoiCoordTraits<long long>::sortKey(long long x, long long y, int word)
+{
+	return (unsigned long long)(word == 0 ? x : y) ^ 0x8000000000000000ULL;
+}
 
-	if(vertexLinks[vertexLinkedTo].x == -1)
-	{
-		vertexLinks[vertexLinkedTo].x = (float)vertexNum;
-		vertexLinks[vertexLinkedTo].count = 1;
-	}
-	else if(vertexLinks[vertexLinkedTo].y == -1)
-	{
-		vertexLinks[vertexLinkedTo].y = (float)vertexNum;
-		vertexLinks[vertexLinkedTo].count = 2;
-	}
-	else if(vertexLinks[vertexLinkedTo].z == -1)
-	{
-		vertexLinks[vertexLinkedTo].z = (float)vertexNum;
-		vertexLinks[vertexLinkedTo].count = 3;
-	}	
+//One 8 bit pass of the radix sort.  The keys are cut into parts, each part is
+//counted and then moved by its own thread
+struct SiteSortPass : public IThreadedParts
+{
+	virtual void runPart(int part);
+
+	const unsigned long long*	keysIn;
+	const int*			indicesIn;
+	unsigned long long*	keysOut;
+	int*				indicesOut;
+	long				numOfKeys;
+	int					numOfParts;
+	int					shift;
+	bool				move;		//the keys are counted, then moved
+	long				counts[VDG_SORT_THREADS][256];	//the digit counts of each part, then where its keys go
+};
+
+static void countSiteKeys(SiteSortPass* pass, int part)
+{
+	long* counts = pass->counts[part];
+	long end = pass->numOfKeys*(part+1)/pass->numOfParts;
 
-//	LOG<<"insertVertexLink exit"<<endl;
+	memset(counts, 0, 256*sizeof(long));
+	for(long i = pass->numOfKeys*part/pass->numOfParts; i < end; i++)
+		counts[(pass->keysIn[i] >> pass->shift) & 0xff]++;
 }
 
-
-void VoronoiDiagramGenerator::generateVertexLinks()
+static void moveSiteKeys(SiteSortPass* pass, int part)
 {
-	long i = 0, j = 0;	
-	if(finalVertexLinks != 0)
-	{
-		LOG<<"Just before freeing finalVertexLinks";
-		free(finalVertexLinks);
-		finalVertexLinks = 0;
-	}
+	long* positions = pass->counts[part];
+	long end = pass->numOfKeys*(part+1)/pass->numOfParts;
 
-	if(vertices == 0)
+	for(long i = pass->numOfKeys*part/pass->numOfParts; i < end; i++)
 	{
-		LOG<<"vertices is zero, not doing anything in generateVertexLinks()";
-		return;
+		long position = positions[(pass->keysIn[i] >> pass->shift) & 0xff]++;
+		pass->keysOut[position] = pass->keysIn[i];
+		pass->indicesOut[position] = pass->indicesIn[i];
 	}
+}
 
-	sizeOfFinalVertexLinks = (sizeOfVertices>sizeOfVertexLinks) ? sizeOfVertices : sizeOfVertexLinks;
-
-	LOG<<"sizeOfFinalVertexLinks = "<<sizeOfFinalVertexLinks<<",sizeOfVertexLinks = "<<sizeOfVertexLinks<<endl; 
-
-	finalVertexLinks = (struct VertexLink*)myalloc(sizeOfFinalVertexLinks* sizeof(VertexLink));
-
-	if(finalVertexLinks == 0)
-		return;
-
-	LOG<<"Created vertexLinks array of size "<<sizeOfFinalVertexLinks<<endl;
-	LOG<<"finalVertexLinks = "<<finalVertexLinks;
+void SiteSortPass::runPart(int part)
+{
+	if(move)
+		moveSiteKeys(this, part);
+	else
+		countSiteKeys(this, part);
+}
 
-	for(i = 0; i< sizeOfFinalVertexLinks; i++)
-	{
-		finalVertexLinks[i].count = 0;		
-	}
-	
-	long *count1vertices = (long*)myalloc(sizeOfFinalVertexLinks * sizeof(long));
-	long *count3vertices = (long*)myalloc(sizeOfFinalVertexLinks * sizeof(long));
+//Fills the sites array from the coordinates, sorted by y then by x.  The sort is an
+//LSD radix sort on the 64 bit keys of VoronoiCoordTraits, from the least significant
+//word to the most, a pass is skipped when all the keys have the same digit.  Returns
+//false if there was no memory for the keys
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::sortSites(Coord *xValues, Coord *yValues)
+{
+	typedef VoronoiCoordTraits<Coord> Traits;
+	long i;
 
-	//if we couldn't get the memory we need, return
-	if(count1vertices == 0 || count3vertices == 0)
+	if(sitesSorted)
 	{
-		if(count3vertices != 0)
+		for(i = 1; i < nsites; i++)
 		{
-			delete[] count3vertices;
+			if(yValues[i] < yValues[i-1] || (yValues[i] == yValues[i-1] && xValues[i] < xValues[i-1]))
+				break;
 		}
-		if(count1vertices != 0)
+
+		if(i >= nsites)
 		{
-			delete[] count1vertices;
+			for(i = 0; i < nsites; i++)
+			{
+				sites[i].coord.x = (Real)(xValues[i] - originX);
+				sites[i].coord.y = (Real)(yValues[i] - originY);
+				sites[i].sitenbr = i;
+				sites[i].refcnt = 0;
+			}
+			return true;
 		}
-		return;
+		LOG<<"The sites should be sorted, but site "<<i<<" is out of order, sorting them";
 	}
 
-	//initialise the two arrays
-	for(i = 0; i< sizeOfFinalVertexLinks; i++)
+	//kept like the sites array when retainMemory is set
+	if(sortKeys == 0 || sortIndices == 0 || nsites > sortCapacity)
 	{
-		count1vertices[i] = 0;
-		count3vertices[i] = 0;
+		if(sortKeys != 0)
+			free(sortKeys);
+		if(sortIndices != 0)
+			free(sortIndices);
+		sortKeys = (unsigned long long*)myalloc(2*nsites*sizeof(unsigned long long));
+		sortIndices = (int*)myalloc(2*nsites*sizeof(int));
+		sortCapacity = nsites;
+
+		if(sortKeys == 0 || sortIndices == 0)
+		{
+			LOG<<"sortSites couldn't allocate the keys for "<<nsites<<" sites";
+			if(sortKeys != 0)
+				free(sortKeys);
+			if(sortIndices != 0)
+				free(sortIndices);
+			sortKeys = 0;
+			sortIndices = 0;
+			sortCapacity = 0;
+			return false;
+		}
 	}
 
-	LOG<<"sizeOfVertices = "<<sizeOfVertices;
-	LOG<<"sizeOfVertexLinks = "<<sizeOfVertexLinks;
-	LOG<<"count1vertices and count3vertices are of size "<<sizeOfFinalVertexLinks;
-	LOG<<"finalVertexLinks is of size "<<sizeOfFinalVertexLinks;
-	
-	long count1counter = 0, count3counter = 0;
-	long count3links[3] = {-1};
-	
-	LOG<<"Before copying "<<sizeOfVertices<<" coordinates into finalVertexLinks"<<endl;
-	for(i = 0; i< sizeOfVertices; i++)
-	{		
-	//	LOG<<"copying "<<i<<" coords,vertices[i]="<<vertices[i]<<endl;
-		if(vertices[i] == 0)
-			break;
-		
-		finalVertexLinks[i].coord = vertices[i]->coord;
-	}
-	
-	LOG<<"After copying "<<i+1<<" coordinates into finalVertexLinks"<<endl;
+	unsigned long long* keys = sortKeys, *otherKeys = sortKeys + nsites, *tempKeys = 0;
+	int* indices = sortIndices, *otherIndices = sortIndices + nsites, *tempIndices = 0;
 
-	for(i = 0; i< sizeOfVertexLinks; i++)
-	{
-		switch(vertexLinks[i].count)
-		{
-		case 1:count1vertices[count1counter] = i;
-			count1counter++;
-			break;
-		case 3:count3vertices[count3counter] = i;
-			count3counter++;
-			break;		
-		}		
-	}
+	for(i = 0; i < nsites; i++)
+		indices[i] = i;
 
-	LOG<<"About to process the "<<count1counter<<" count 1 (leaf) vertices"<<endl;
+	SiteSortPass pass;
+	pass.numOfKeys = nsites;
+	pass.numOfParts = (nsites >= VDG_PARALLEL_SORT_SITES) ? VDG_SORT_THREADS : 1;
 
-	//first, we go from all leaf nodes, those with just one edge, to either the next leaf or the
-	//next node with 3 edges
-	long currentVertex = 0, prevVertex = 0;
-	
-	for(i = 0; i< count1counter; i++)
+	for(int word = 0; word < Traits::sortKeyWords; word++)
 	{
-		if(vertexLinks[count1vertices[i]].count != 1)//if we've already been here, ignore this vertex
-			continue;
-	//	LOG<<i;
-		
-		currentVertex = (long)vertexLinks[count1vertices[i]].x;//use the x variable, since it should be the only one set
-		prevVertex = count1vertices[i];
-		vertexLinks[count1vertices[i]].count --;	//don't revisit this site
+		//the sites are in the order of the words before, the sort is stable
+		for(i = 0; i < nsites; i++)
+			keys[i] = Traits::sortKey(xValues[indices[i]], yValues[indices[i]], word);
 
-		while(currentVertex != -1 && currentVertex <sizeOfVertexLinks && 
-			vertexLinks[currentVertex].count != 1 && vertexLinks[currentVertex].count != 3 )
+		for(int shift = 0; shift < 64; shift += 8)
 		{
-			if(vertexLinks[currentVertex].count == 2)
+			pass.keysIn = keys;
+			pass.indicesIn = indices;
+			pass.keysOut = otherKeys;
+			pass.indicesOut = otherIndices;
+			pass.shift = shift;
+			pass.move = false;
+			runParts(pass, pass.numOfParts);
+
+			//the counts become the positions, the parts of a digit go one after the other so
+			//the sort is stable
+			long position = 0;
+			bool sameDigit = false;
+			for(int digit = 0; digit < 256; digit++)
 			{
-				if(vertexLinks[currentVertex].x == prevVertex )
+				long digitCount = 0;
+				for(int part = 0; part < pass.numOfParts; part++)
 				{
-					vertexLinks[currentVertex].x = vertexLinks[currentVertex].y;
-					vertexLinks[currentVertex].y = -1;
-					vertexLinks[currentVertex].count--;
+					long count = pass.counts[part][digit];
+					pass.counts[part][digit] = position;
+					position += count;
+					digitCount += count;
 				}
-				else if(vertexLinks[currentVertex].y == prevVertex)
-				{
-					vertexLinks[currentVertex].y = -1;
-					vertexLinks[currentVertex].count--;
-				}
-				prevVertex = currentVertex;
-				currentVertex = (long)vertexLinks[currentVertex].x;
-
-			}
-			else
-			{
-				break;//this is an error, and shouldn't happen
+				if(digitCount == nsites)
+					sameDigit = true;
 			}
-		}	
-
-		if(currentVertex == -1 || currentVertex >= sizeOfVertexLinks)
-			continue; //this is an error
+			if(sameDigit)
+				continue;
 
-		finalVertexLinks[count1vertices[i]].v[finalVertexLinks[count1vertices[i]].count] = vertices[currentVertex]->coord;
-				
-		finalVertexLinks[count1vertices[i]].count++;
-		
+			pass.move = true;
+			runParts(pass, pass.numOfParts);
 
-		if(vertexLinks[currentVertex].count == 1)
-		{
-			vertexLinks[currentVertex].count = 0;
-			vertexLinks[currentVertex].x = -1;
+			tempKeys = keys;
+			keys = otherKeys;
+			otherKeys = tempKeys;
+			tempIndices = indices;
+			indices = otherIndices;
+			otherIndices = tempIndices;
 		}
-		else if(vertexLinks[currentVertex].count == 3)
-		{
-			if(vertexLinks[currentVertex].x == prevVertex )
-			{
-				vertexLinks[currentVertex].x = -1;
-			}
-			else if(vertexLinks[currentVertex].y == prevVertex)
-			{
-				vertexLinks[currentVertex].y = -1;
-			}
-			else if(vertexLinks[currentVertex].z == prevVertex)
-			{
-				vertexLinks[currentVertex].z = -1;
-			}			
-		}		
 	}
 
-	LOG<<"Finished processing the "<<count1counter<<" count 1 (leaf) vertices";
-	LOG<<"About to process the "<<count3counter<<" count 3 (non-leaf) vertices"<<endl;
-
-
-	//at this stage, all the edges that end in leaf nodes are processed, now just do the edges between vertices with 3 connections
-	for(i = 0; i< count3counter; i++)
+	for(i = 0; i < nsites; i++)
 	{
-	//	LOG<<i<<", count3vertices["<<i<<"] = "<<count3vertices[i];
-
-		//get the (possible) three vertices that the vertex at pos count3vertices[i] of vertexLinks is linked to
-		count3links[0] = (long)vertexLinks[count3vertices[i]].x;
-		count3links[1] = (long)vertexLinks[count3vertices[i]].y;
-		count3links[2] = (long)vertexLinks[count3vertices[i]].z;
-	//	LOG<<"after count3links, finalVertexLinks[count3vertices[i]].count = "<<finalVertexLinks[count3vertices[i]].count<<endl;
-
-		LOGCODE		if(finalVertexLinks[count3vertices[i]].count > 2 || finalVertexLinks[count3vertices[i]].count < 0)
-		LOGCODE		{
-		LOGCODE			LOG<<"Error: finalVertexLinks[count3vertices[i]].count = "<<finalVertexLinks[count3vertices[i]].count;
-		LOGCODE			return;
-		LOGCODE		}
+		int index = indices[i];
+		sites[i].coord.x = (Real)(xValues[index] - originX);
+		sites[i].coord.y = (Real)(yValues[index] - originY);
+		sites[i].sitenbr = index;
+		sites[i].refcnt = 0;
+	}
 
-		//mark one of the links in this finalVertexLink
-		//finalVertexLinks[count3vertices[i]].v[finalVertexLinks[count3vertices[i]].count] = 
-		//														vertices[currentVertex]->coord;
-	//	LOG<<"after finalVertexLinks[count3vertices[i]]"<<endl;
+	return true;
+}
 
-		for(j = 0; j< 3; j++)//process each of the vertices that the current one is linked to
+//makes room for the delaunay triangulation of nsites sites, and copies the sites in
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::reserveDelaunay(Coord *xValues, Coord *yValues)
+{
+	if(nsites > capacityOfDelaunay)
+	{
+		long size = nsites;
+		PointVDG* newPoints = (PointVDG*)realloc(delaunaySitePoints,size*sizeof(PointVDG));
+		if(newPoints != 0)
+			delaunaySitePoints = newPoints;
+		int* newEdges = (int*)realloc(delaunayEdgeSites,6*size*sizeof(int));
+		if(newEdges != 0)
+			delaunayEdgeSites = newEdges;
+		int* newTriangles = (int*)realloc(delaunayTriangles,6*size*sizeof(int));
+		if(newTriangles != 0)
+			delaunayTriangles = newTriangles;
+
+		if(newPoints == 0 || newEdges == 0 || newTriangles == 0)
 		{
-			if(count3links[j] == -1) //all links to leaf nodes are marked with -1
-				continue;
-
-			currentVertex = count3links[j];
-			prevVertex  = count3vertices[i];
-			while(currentVertex >=0 && currentVertex < sizeOfVertexLinks && vertexLinks[currentVertex].count != 3)
-			{
-				if(vertexLinks[currentVertex].count == 2)
-				{
-					if(vertexLinks[currentVertex].x == prevVertex )
-					{
-						vertexLinks[currentVertex].x = -1;
-						prevVertex = currentVertex;
-						currentVertex = (long)vertexLinks[currentVertex].y;
-					}
-					else if(vertexLinks[currentVertex].y == prevVertex)
-					{
-						vertexLinks[currentVertex].y = -1;
-						prevVertex = currentVertex;
-						currentVertex = (long)vertexLinks[currentVertex].x;
-					}				
-					else
-					{
-						break;//this is an error, prevents infinite recursion in case I make a mistake
-					}
-
-				}
-			}
-			if(currentVertex < 0|| currentVertex >= sizeOfVertexLinks)
-			{
-				LOG<<"Error, currentVertex = "<<currentVertex<<" and sizeOfVertexLinks = "<<sizeOfVertexLinks;
-				LOG<<"On element "<<i+1<<" of "<<count3counter;
-				continue; //this is an error, and shouldn't happen
-			}
-		
-			finalVertexLinks[count3vertices[i]].v[finalVertexLinks[count3vertices[i]].count] = 
-																vertices[currentVertex]->coord;
-			finalVertexLinks[count3vertices[i]].count++;
+			LOG<<"Error - realloc failed, no room for the delaunay triangulation of "<<size<<" sites"<<endl;
+			return false;
+		}
+		capacityOfDelaunay = size;
+	}
 
-			if(vertexLinks[currentVertex].count == 3)
-			{
-				if(vertexLinks[currentVertex].x == prevVertex )
-				{
-					vertexLinks[currentVertex].x = -1;
-				}
-				else if(vertexLinks[currentVertex].y == prevVertex)
-				{
-					vertexLinks[currentVertex].y = -1;
-				}
-				else if(vertexLinks[currentVertex].z == prevVertex)
-				{
-					vertexLinks[currentVertex].z = -1;
-				}			
-			}	
-			else
-			{
-				continue;
-			}
-		}		
+	for(int i = 0; i < nsites; i++)
+	{
+		delaunaySitePoints[i].x = (Real)xValues[i];
+		delaunaySitePoints[i].y = (Real)yValues[i];
 	}
+	return true;
+}
 
-	LOG<<"Finished processing the count 3 vertices"<<endl;
+//makes room for 'size' vertices in the vertex graph, keeping the vertices already in it
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::reserveVertexGraph(long size)
+{
+	if(size <= capacityOfVertexGraph)
+		return true;
+
+	PointVDG* newPoints = (PointVDG*)realloc(vertexPoints,size*sizeof(PointVDG));
+	if(newPoints != 0)
+		vertexPoints = newPoints;
+	int* newOffsets = (int*)realloc(vertexOffsets,(size+1)*sizeof(int));
+	if(newOffsets != 0)
+		vertexOffsets = newOffsets;
+	int* newNeighbours = (int*)realloc(vertexNeighbours,3*size*sizeof(int));
+	if(newNeighbours != 0)
+		vertexNeighbours = newNeighbours;
+
+	if(newPoints == 0 || newOffsets == 0 || newNeighbours == 0)
+	{
+		LOG<<"Error - realloc failed, the vertex graph can't grow to "<<size<<" vertices"<<endl;
+		return false;
+	}
+	capacityOfVertexGraph = size;
+	return true;
 }
 
+//called from makevertex, the vertex number is the sitenbr just given to v
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::insertGraphVertex(struct Site* v)
+{
+	//the memory doubles when it runs out, an array kept from the last diagram is just reused
+	if(v->sitenbr >= capacityOfVertexGraph && !reserveVertexGraph(2*capacityOfVertexGraph))
+	{
+		genVertexGraph = false;
+		numOfGraphVertices = 0;
+		return;
+	}
 
+	vertexPoints[v->sitenbr] = v->coord;
+	if(VoronoiCoordTraits<Coord>::exact)
+	{
+		vertexPoints[v->sitenbr].x += (Real)originX;
+		vertexPoints[v->sitenbr].y += (Real)originY;
+	}
+	vertexOffsets[v->sitenbr+1] = 0;
+	numOfGraphVertices = v->sitenbr + 1;
+}
 
-bool VoronoiDiagramGenerator::getNextVertexPair(float& x1, float& y1, float& x2, float& y2)
+//called from clip_line for every edge that is kept, a vertex never gets more than 3 neighbours
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::insertGraphEdge(int v1, int v2)
 {
-	if(finalVertexLinks == 0)
-		return false;
-
-	while(currentVertexLink < sizeOfFinalVertexLinks && finalVertexLinks[currentVertexLink].count < 1)
-		currentVertexLink++;
+	if(vertexOffsets[v1+1] < 3)
+	{
+		vertexNeighbours[3*v1 + vertexOffsets[v1+1]] = v2;
+		vertexOffsets[v1+1]++;
+	}
+	if(vertexOffsets[v2+1] < 3)
+	{
+		vertexNeighbours[3*v2 + vertexOffsets[v2+1]] = v1;
+		vertexOffsets[v2+1]++;
+	}
+}
 
-	if(currentVertexLink >= sizeOfFinalVertexLinks || finalVertexLinks[currentVertexLink].count <1)
-		return false;
+//turns the neighbour counts into offsets, moving the neighbours down over the unused slots.
+//A row never moves up, so it can be done in place
+template<class Coord>
+void VoronoiDiagramGeneratorT<Coord>::finishVertexGraph()
+{
+	vertexOffsets[0] = 0;
+	for(long v = 0; v < numOfGraphVertices; v++)
+	{
+		int count = vertexOffsets[v+1];
+		int start = vertexOffsets[v];
+		for(int i = 0; i < count; i++)
+			vertexNeighbours[start + i] = vertexNeighbours[3*v + i];
+		vertexOffsets[v+1] = start + count;
+	}
+}
 
-	int num = finalVertexLinks[currentVertexLink].count -1;
-	finalVertexLinks[currentVertexLink].count--;
+//Walks the vertices in order.  For each neighbour of a vertex with 1 or 3 neighbours, the
+//chain of vertices with 2 neighbours is followed to the vertex at its other end.  Every
+//chain is found from both of its ends, the pair is returned from the end with the lower number
+template<class Coord>
+bool VoronoiDiagramGeneratorT<Coord>::getNextVertexPair(Real& x1, Real& y1, Real& x2, Real& y2)
+{
+	while(currentVertexLink < numOfGraphVertices)
+	{
+		int start = (int)currentVertexLink;
+		int count = vertexOffsets[start+1] - vertexOffsets[start];
+		if((count != 1 && count != 3) || currentVertexNeighbour >= count)
+		{
+			currentVertexLink++;
+			currentVertexNeighbour = 0;
+			continue;
+		}
 
-	x1 = finalVertexLinks[currentVertexLink].v[num].x;
-	y1 = finalVertexLinks[currentVertexLink].v[num].y;
-	x2 = finalVertexLinks[currentVertexLink].coord.x;
-	y2 = finalVertexLinks[currentVertexLink].coord.y;
+		int first = vertexNeighbours[vertexOffsets[start] + currentVertexNeighbour];
+		currentVertexNeighbour++;
 
-	return true;
+		int prev = start, current = first;
+		for(long steps = 0; steps < numOfGraphVertices && 
+			vertexOffsets[current+1] - vertexOffsets[current] == 2; steps++)
+		{
+			const int* neighbours = vertexNeighbours + vertexOffsets[current];
+			int next = (neighbours[0] != prev) ? neighbours[0] : neighbours[1];
+			prev = current;
+			current = next;
+		}
 
+		//a chain that comes back to where it started is found from both directions too
+		if(vertexOffsets[current+1] - vertexOffsets[current] != 2 &&
+			(start < current || (start == current && first < prev)))
+		{
+			x1 = vertexPoints[current].x;
+			y1 = vertexPoints[current].y;
+			x2 = vertexPoints[start].x;
+			y2 = vertexPoints[start].y;
+			return true;
+		}
+	}
 
+	return false;
 }
 
-int scomp(const void *p1,const void *p2)
-{
-	struct PointVDG *s1 = (PointVDG*)p1, *s2=(PointVDG*)p2;
-	if(s1 -> y < s2 -> y) return(-1);
-	if(s1 -> y > s2 -> y) return(1);
-	if(s1 -> x < s2 -> x) return(-1);
-	if(s1 -> x > s2 -> x) return(1);
-	return(0);
-}
 
 /* return a single in-storage site */
-struct Site * VoronoiDiagramGenerator::nextone()
+template<class Coord>
+typename VoronoiDiagramGeneratorT<Coord>::Site * VoronoiDiagramGeneratorT<Coord>::nextone()
 {
 	struct Site *s;
 	if(siteidx < nsites)
@@ -1689,3 +2426,10 @@ struct Site * VoronoiDiagramGenerator::nextone()
 		return( (struct Site *)NULL);
 }
 
+//the coordinate types of VoronoiCoordTraits
+template class VoronoiEdgeBufferT<float>;
+template class VoronoiEdgeBufferT<double>;
+
+template class VoronoiDiagramGeneratorT<float>;
+template class VoronoiDiagramGeneratorT<double>;
+template class VoronoiDiagramGeneratorT<long long>;
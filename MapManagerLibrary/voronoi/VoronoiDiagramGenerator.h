@@ -27,6 +27,7 @@ email: shaneosullivan1@gmail.com
 #include <stdlib.h>
 #include <string.h>
 #include "../logger/Logger.h"
+#include "../sosutil/Threaded.h"
 
 
 #ifndef NULL
@@ -37,6 +38,23 @@ email: shaneosullivan1@gmail.com
 #define le 0
 #define re 1
 
+//the sites are radix sorted by this many threads when there are at least
+//VDG_PARALLEL_SORT_SITES of them, and by the calling thread otherwise
+#define VDG_SORT_THREADS 4
+#define VDG_PARALLEL_SORT_SITES 100000
+
+//ELhash is made VDG_EL_GROWTH times bigger when the lookups have walked past more than
+//VDG_EL_REHASH_WALK halfedges on average, checked every VDG_EL_CHECK_LOOKUPS lookups.
+//It grows up to the number of halfedges there can be on the beach line
+#define VDG_EL_REHASH_WALK 8
+#define VDG_EL_CHECK_LOOKUPS 4096
+#define VDG_EL_GROWTH 4
+
+//with the adaptive bucket priority queue, an insert that walks past more entries
+//than this splits the bucket into VDG_PQ_SUB_BUCKETS buckets
+#define VDG_PQ_SPLIT_LENGTH 32
+#define VDG_PQ_SUB_BUCKETS 64
+
 
 
 struct	Freenode	
@@ -47,6 +65,7 @@ struct	Freenode
 struct FreeNodeArrayList
 {
 	struct	Freenode* memory;
+	unsigned	size;		//bytes in memory, so a retained block can be reused
 	struct	FreeNodeArrayList* next;
 
 };
@@ -57,76 +76,178 @@ struct	Freelist
 	int		nodesize;
 };
 
-struct PointVDG	
+//The generator is made for float, double and long long coordinates.  Real is what the
+//sites, the vertices and the edges are worked out in.  The sites are sorted on
+//sortKeyWords 64 bit keys, the last word is the most significant.  With exact set, the
+//coordinates are whole numbers: the sites are moved so the smallest x and y are 0, and
+//when they are then all below VDG_EXACT_RANGE the site events are decided with integer
+//arithmetic, so sites on a grid are not put under the wrong arc by rounding
+template<class Coord> struct VoronoiCoordTraits;
+
+template<> struct VoronoiCoordTraits<float>
 {
-	float x,y;
+	typedef float Real;
+	enum {sortKeyWords = 1, exact = 0};
+	static unsigned long long sortKey(float x, float y, int word);
 };
 
-struct Point3
+template<> struct VoronoiCoordTraits<double>
 {
-	float x,y,z;
-	int count;
+	typedef double Real;
+	enum {sortKeyWords = 2, exact = 0};
+	static unsigned long long sortKey(double x, double y, int word);
 };
 
-struct VertexLink
+//scaled integers, e.g. the cell centres of a grid in half cells, or millimetres
+template<> struct VoronoiCoordTraits<long long>
 {
-	PointVDG coord;
-	PointVDG v[3];
-	int count;
+	typedef double Real;
+	enum {sortKeyWords = 2, exact = 1};
+	static unsigned long long sortKey(long long x, long long y, int word);
 };
 
-// structure used both for sites and for vertices 
-struct Site	
+//the products of the exact site events stay in a long long below this
+#define VDG_EXACT_RANGE (1<<19)
+
+//What ELleftbnd did during the last diagram, finding the halfedges of the beach line
+//that the new sites are under
+struct VoronoiELStats
 {
-	struct	PointVDG	coord;
-	int		sitenbr;
-	int		refcnt;
-	int		overallRefcnt;
+	long	lookups;
+	long	hashSearch;		//empty ELhash buckets looked at, before a halfedge to start from was found
+	long	walk;			//halfedges walked past from there
+	long	maxWalk;		//by a single lookup
+	long	rehashes;		//times ELhash was made bigger
+	long	hashSize;		//ELhash buckets at the end of the diagram
 };
 
+//Receives the clipped voronoi edges while the sweep is running.  Pass one to
+//generateVoronoi to take the edges straight from the generator, rather than
+//reading them back with getNext() afterwards
+template<class Real> class VoronoiEdgeSinkT
+{
+public:
+	virtual ~VoronoiEdgeSinkT(){}
+	virtual void addEdge(Real x1, Real y1, Real x2, Real y2) = 0;
 
+	//With the two sites the edge is between, so a sink can tell how far the ends of
+	//the edge are from the sites and which sites it belongs to.  It goes to addEdge
+	//unless it is overridden
+	virtual void addEdgeSites(Real x1, Real y1, Real x2, Real y2, Real, Real, Real, Real)
+	{
+		addEdge(x1,y1,x2,y2);
+	}
 
-struct Edge	
-{
-	float   a,b,c;
-	struct	Site 	*ep[2];
-	struct	Site	*reg[2];
-	int		edgenbr;
+	//The generator calls this one, with the numbers of the two ends as vertices of the
+	//diagram, the ones of the vertex graph.  Ends with the same number are the same
+	//vertex, and an end that was clipped is a vertex of its own.  The numbers are only
+	//those of the one diagram.  It goes to addEdgeSites unless it is overridden
+	virtual void addEdgeVertices(Real x1, Real y1, Real x2, Real y2, Real site1X, Real site1Y,
+								 Real site2X, Real site2Y, int, int)
+	{
+		addEdgeSites(x1,y1,x2,y2,site1X,site1Y,site2X,site2Y);
+	}
+
+	//Every vertex of the diagram as the generator makes it, before the edges that end at
+	//it, with the number addEdgeVertices gives it
+	virtual void addVertex(int, Real, Real){}
 
+	//False if the sink lost an edge, e.g. it ran out of memory.  generateVoronoi then
+	//returns false
+	virtual bool isGood() const {return true;}
 };
 
-struct GraphEdge
+typedef VoronoiEdgeSinkT<float> VoronoiEdgeSink;
+
+//The default sink.  The edges are kept in four arrays, one per coordinate,
+//which only grow.  clear() keeps the memory for the next diagram.  If the arrays
+//can't grow the edge is lost and isGood() is false until the next clear()
+template<class Real> class VoronoiEdgeBufferT : public VoronoiEdgeSinkT<Real>
 {
-	float x1,y1,x2,y2;
-//	long v1,v2; //vertices that this was created from
-	struct GraphEdge* next;
-};
+public:
+	VoronoiEdgeBufferT();
+	~VoronoiEdgeBufferT();
+
+	void addEdge(Real x1, Real y1, Real x2, Real y2)
+	{
+		if(count == capacity && !grow(capacity*2))
+		{
+			good = false;
+			return;
+		}
+		x1Values[count] = x1;
+		y1Values[count] = y1;
+		x2Values[count] = x2;
+		y2Values[count] = y2;
+		count++;
+	}
+
+	//makes sure 'size' edges fit without growing the arrays again
+	bool reserve(long size);
+	void clear(){count = 0; good = true;}
+	bool isGood() const {return good;}
+	//frees the arrays
+	void release();
 
+	long getEdgeCount() const {return count;}
+	const Real* getX1Values() const {return x1Values;}
+	const Real* getY1Values() const {return y1Values;}
+	const Real* getX2Values() const {return x2Values;}
+	const Real* getY2Values() const {return y2Values;}
 
+private:
+	bool grow(long size);
+
+	Real*	x1Values;
+	Real*	y1Values;
+	Real*	x2Values;
+	Real*	y2Values;
+	long	count;
+	long	capacity;
+	bool	good;
+};
+
+typedef VoronoiEdgeBufferT<float> VoronoiEdgeBuffer;
 
 
-struct Halfedge 
+//What the priority queue did during the last diagram.  The probes are the entries
+//walked past in a bucket, or the levels an entry moved in the heap
+struct VoronoiPQStats
 {
-	struct	Halfedge	*ELleft, *ELright;
-	struct	Edge	*ELedge;
-	int		ELrefcnt;
-	char	ELpm;
-	struct	Site	*vertex;
-	float	ystar;
-	struct	Halfedge *PQnext;
+	long	inserts;
+	long	deletes;		//entries taken out before they got to the top
+	long	extractions;
+	long	probes;			//by all the inserts and deletes
+	long	maxProbes;		//by a single insert or delete
+	long	emptyBuckets;	//skipped while looking for the lowest entry
+	long	splits;			//overfull buckets split, adaptive buckets only
+	long	buckets;		//at the end of the diagram, the split ones and their parts, 0 for the heap
+	long	maxSize;		//the most entries in the queue at once
 };
 
 
 
 
-class VoronoiDiagramGenerator
+//The generator for one type of coordinates, see VoronoiCoordTraits.  The float one is
+//VoronoiDiagramGenerator
+template<class Coord> class VoronoiDiagramGeneratorT
 {
 public:
-	VoronoiDiagramGenerator();
-	~VoronoiDiagramGenerator();
+	typedef typename VoronoiCoordTraits<Coord>::Real Real;
+
+	struct PointVDG	
+	{
+		Real x,y;
+	};
+
+	VoronoiDiagramGeneratorT();
+	~VoronoiDiagramGeneratorT();
 
-	bool generateVoronoi(float *xValues, float *yValues, int numPoints, 
-		float minX, float maxX, float minY, float maxY, float minDist,bool genVectorInfo=true);
+	//The voronoi edges go to 'sink' as they are found.  If it is 0 they are kept
+	//in the generator, and can be read with resetIterator()/getNext() or getEdges()
+	bool generateVoronoi(Coord *xValues, Coord *yValues, int numPoints, 
+		Real minX, Real maxX, Real minY, Real maxY, Real minDist,bool genVectorInfo=true,
+		VoronoiEdgeSinkT<Real>* sink = 0);
 
 	//By default, the delaunay triangulation is NOT generated
 	void setGenerateDelaunay(bool genDel);
@@ -134,82 +255,231 @@ public:
 	//By default, the voronoi diagram IS generated
 	void setGenerateVoronoi(bool genVor);
 
+	//By default all the working memory is freed after each diagram.  With retain set,
+	//the memory blocks, the hash tables and the vertex arrays are kept for the next
+	//call to generateVoronoi, and only grow when a bigger diagram needs it.  Use this
+	//when the diagram is generated again and again.  reset() frees everything
+	void setRetainMemory(bool retain);
+
+	//Tells that the sites passed to generateVoronoi are already sorted by y, then by x,
+	//so the sorting is skipped.  They are still checked, and sorted if they are not
+	void setSitesSorted(bool isSorted);
+
+	//The priority queue of the circle events.  The hash has 4*sqrt(n) buckets of the same
+	//height, which fill up unevenly when the sites are clustered.  The heap is a 4-ary heap,
+	//log(n) whatever the sites are.  The adaptive buckets start like the hash, and a bucket
+	//is split into smaller ones of the same height when an insert has to walk too far in it
+	enum
+	{
+		PRIORITY_QUEUE_HASH,
+		PRIORITY_QUEUE_HEAP,
+		PRIORITY_QUEUE_ADAPTIVE
+	};
+
+	//PRIORITY_QUEUE_HASH by default
+	void setPriorityQueue(int type);
+
+	const VoronoiPQStats& getPQStats() const
+	{
+		return pqStats;
+	}
+
+	const VoronoiELStats& getELStats() const
+	{
+		return elStats;
+	}
+
 	void resetIterator()
 	{
-		iteratorEdges = allEdges;
+		iteratorEdge = 0;
 	}
 
-	bool getNext(float& x1, float& y1, float& x2, float& y2)
+	bool getNext(Real& x1, Real& y1, Real& x2, Real& y2)
 	{
-		if(iteratorEdges == 0)
+		if(iteratorEdge >= edges.getEdgeCount())
 			return false;
 		
-		x1 = iteratorEdges->x1;
-		x2 = iteratorEdges->x2;
-		y1 = iteratorEdges->y1;
-		y2 = iteratorEdges->y2;
+		x1 = edges.getX1Values()[iteratorEdge];
+		x2 = edges.getX2Values()[iteratorEdge];
+		y1 = edges.getY1Values()[iteratorEdge];
+		y2 = edges.getY2Values()[iteratorEdge];
 
 //		LOG<<"getNext returned the edge ("<<x1<<","<<y1<<") -> ("<<x2<<","<<y2<<")";
 
-		iteratorEdges = iteratorEdges->next;
+		iteratorEdge++;
 
 		return true;
 	}
+
+	//the edges of the last diagram, when it was generated without a sink
+	const VoronoiEdgeBufferT<Real>& getEdges() const
+	{
+		return edges;
+	}
 	
+	//The delaunay triangulation of the last diagram, made when setGenerateDelaunay(true)
+	//is set.  The sites are numbered in the order they were passed to generateVoronoi:
+	//edge e joins the sites getDelaunayEdgeSites()[2*e] and [2*e+1], and triangle t has
+	//the corners getDelaunayTriangles()[3*t], [3*t+1] and [3*t+2].  Edges shorter than
+	//minDist are left out, the triangles are all there.  Sites dropped as duplicates are
+	//in no edge or triangle
+	long getNumOfDelaunayEdges() const
+	{
+		return numOfDelaunayEdges;
+	}
+
+	const int* getDelaunayEdgeSites() const
+	{
+		return delaunayEdgeSites;
+	}
+
+	long getNumOfDelaunayTriangles() const
+	{
+		return numOfDelaunayTriangles;
+	}
+
+	const int* getDelaunayTriangles() const
+	{
+		return delaunayTriangles;
+	}
+
+	//the sites by their number, so the edges and triangles can be used after the
+	//arrays given to generateVoronoi are gone
+	const PointVDG* getDelaunaySitePoints() const
+	{
+		return delaunaySitePoints;
+	}
+
+	//the delaunay edges as lines, the last one found first
 	void resetDelaunayEdgesIterator()
 	{
-		iteratorDelaunayEdges = delaunayEdges;
-		LOG<<"resetDelaunayEdgesIterator set iteratorDelaunayEdges = "<<iteratorDelaunayEdges;
+		iteratorDelaunayEdge = numOfDelaunayEdges;
+		LOG<<"resetDelaunayEdgesIterator set iteratorDelaunayEdge = "<<iteratorDelaunayEdge;
 	}
 
-	bool getNextDelaunay(float& x1, float& y1, float& x2, float& y2)
+	bool getNextDelaunay(Real& x1, Real& y1, Real& x2, Real& y2)
 	{
-		if(iteratorDelaunayEdges == 0)
+		if(iteratorDelaunayEdge <= 0)
 		{
-			LOG<<"iteratorDelaunayEdges = 0, returning false";
+			LOG<<"iteratorDelaunayEdge = 0, returning false";
 			return false;
 		}
-		x1 = iteratorDelaunayEdges->x1;
-		x2 = iteratorDelaunayEdges->x2;
-		y1 = iteratorDelaunayEdges->y1;
-		y2 = iteratorDelaunayEdges->y2;
-
-		iteratorDelaunayEdges = iteratorDelaunayEdges->next;
+		iteratorDelaunayEdge--;
+		const PointVDG& p1 = delaunaySitePoints[delaunayEdgeSites[2*iteratorDelaunayEdge]];
+		const PointVDG& p2 = delaunaySitePoints[delaunayEdgeSites[2*iteratorDelaunayEdge+1]];
+		x1 = p1.x;
+		y1 = p1.y;
+		x2 = p2.x;
+		y2 = p2.y;
 
 		LOG<<"getNextDelaunay returned the edge ("<<x1<<","<<y1<<") -> ("<<x2<<","<<y2<<")";
 
 		return true;
 	}
 
+	//The vertices of the last diagram and the voronoi edges between them, as a compressed
+	//sparse row graph: the neighbours of vertex v are getVertexNeighbours()[getVertexOffsets()[v]]
+	//up to, not including, getVertexNeighbours()[getVertexOffsets()[v+1]].  A vertex has at
+	//most 3 neighbours.  The graph is only made when genVectorInfo is passed to generateVoronoi
+	long getNumOfVertices() const
+	{
+		return numOfGraphVertices;
+	}
+
+	const PointVDG* getVertexPoints() const
+	{
+		return vertexPoints;
+	}
+
+	const int* getVertexOffsets() const
+	{
+		return vertexOffsets;
+	}
+
+	const int* getVertexNeighbours() const
+	{
+		return vertexNeighbours;
+	}
+
+	//The vertex pairs join the vertices with 1 or 3 neighbours, following the chains of
+	//vertices with 2 neighbours in between, so every pair is a branch of the roadmap
 	void resetVertexPairIterator()
 	{
 		currentVertexLink = 0;
+		currentVertexNeighbour = 0;
 	}
 
-	bool getNextVertexPair(float& x1, float& y1, float& x2, float& y2);
+	bool getNextVertexPair(Real& x1, Real& y1, Real& x2, Real& y2);
 
+	//the vertices with 1 or 3 neighbours, the ends of the vertex pairs
 	void resetVerticesIterator()
 	{
 		currentVertex = 0;
 	}
 
-	bool getNextVertex(float& x, float& y)
+	bool getNextVertex(Real& x, Real& y)
 	{
-		if(finalVertices == 0)
-			return false;
-
-		if(currentVertex >= sizeOfFinalVertices) return false;
-		x = finalVertices[currentVertex].x;
-		y = finalVertices[currentVertex].y;
-		currentVertex++;
-		return true;
+		while(currentVertex < numOfGraphVertices)
+		{
+			long v = currentVertex++;
+			int count = vertexOffsets[v+1] - vertexOffsets[v];
+			if(count == 1 || count == 3)
+			{
+				x = vertexPoints[v].x;
+				y = vertexPoints[v].y;
+				return true;
+			}
+		}
+		return false;
 	}
 
 	void reset();
 
 
 private:
+	// structure used both for sites and for vertices 
+	struct Site	
+	{
+		struct	PointVDG	coord;
+		int		sitenbr;
+		int		refcnt;
+		int		overallRefcnt;
+	};
+
+	struct Edge	
+	{
+		Real	a,b,c;
+		struct	Site 	*ep[2];
+		struct	Site	*reg[2];
+		int		edgenbr;
+	};
+
+	struct Halfedge 
+	{
+		struct	Halfedge	*ELleft, *ELright;
+		struct	Edge	*ELedge;
+		int		ELrefcnt;
+		char	ELpm;
+		struct	Site	*vertex;
+		Real	ystar;
+		int		PQindex;	//where it is in the heap, when the priority queue is a heap
+		struct	Halfedge *PQnext;
+	};
+
+	//entry of the heap priority queue, the keys are copied in so the heap can be
+	//ordered without going to the halfedges
+	struct PQHeapEntry
+	{
+		Real	ystar;
+		Real	x;
+		unsigned int order;	//entries with the same keys come out newest first, as from the hash
+		struct	Halfedge *he;
+	};
+
 	void cleanup();
+	void releaseMemory();
+	void releaseVertexArrays();
+	void releaseDelaunayArrays();
 	void cleanupEdges();
 	char *getfree(struct Freelist *fl);	
 	struct	Halfedge *PQfind();
@@ -237,23 +507,31 @@ private:
 	void makevertex(struct Site *v);
 	void out_triple(struct Site *s1, struct Site *s2,struct Site * s3);
 	
-	void		PQinsert(struct Halfedge *he,struct Site * v, float offset);
+	void		PQinsert(struct Halfedge *he,struct Site * v, Real offset);
 	void		PQdelete(struct Halfedge *he);
 	bool		ELinitialize();
+	bool		ELrehash();
 	void		ELinsert(struct	Halfedge *lb, struct Halfedge *newHe);
-	struct Halfedge * VoronoiDiagramGenerator::ELgethash(int b);
+	struct Halfedge *ELgethash(int b);
 	struct Halfedge *ELleft(struct Halfedge *he);
 	struct Site *leftreg(struct Halfedge *he);
 	void		out_site(struct Site *s);
 	bool		PQinitialize();
 	int			PQbucket(struct Halfedge *he);
+	struct Halfedge *PQhead(struct Halfedge *he, int& bucket);
+	struct Halfedge *PQminHead();
+	void		PQsplitBucket(int bucket);
+	void		PQheapUp(long i);
+	void		PQheapDown(long i);
+	void		PQcountProbes(long probes);
 	void		clip_line(struct Edge *e);
 	char		*myalloc(unsigned n);
 	int			right_of(struct Halfedge *el,struct PointVDG *p);
+	int			right_of_exact(struct Halfedge *el,struct PointVDG *p);
 
 	struct Site *rightreg(struct Halfedge *he);
 	struct Edge *bisect(struct	Site *s1,struct	Site *s2);
-	float dist(struct Site *s,struct Site *t);
+	Real dist(struct Site *s,struct Site *t);
 	struct Site *intersect(struct Halfedge *el1, struct Halfedge *el2, struct PointVDG *p=0);
 
 	void		out_bisector(struct Edge *e);
@@ -261,18 +539,23 @@ private:
 	void		out_vertex(struct Site *v);
 	struct Site *nextone();
 
-	void		pushGraphEdge(float x1, float y1, float x2, float y2);
-	void		pushDelaunayGraphEdge(float x1, float y1, float x2, float y2);
+	void		pushGraphEdge(Real x1, Real y1, Real x2, Real y2, struct Site* site1, struct Site* site2,
+							  struct Site* vertex1, struct Site* vertex2);
+	void		pushDelaunayGraphEdge(struct Site* s1, struct Site* s2);
 
 
 	void		openpl();
-	void		line(float x1, float y1, float x2, float y2);
-	void		circle(float x, float y, float radius);
-	void		range(float minX, float minY, float maxX, float maxY);
+	void		line(Real x1, Real y1, Real x2, Real y2);
+	void		circle(Real x, Real y, Real radius);
+	void		range(Real minX, Real minY, Real maxX, Real maxY);
 
-	void  		insertVertexAddress(long vertexNum, struct Site* address);
-	void		insertVertexLink(long vertexNum, long vertexLinkedTo);
-	void		generateVertexLinks();
+	bool		sortSites(Coord *xValues, Coord *yValues);
+
+	bool		reserveDelaunay(Coord *xValues, Coord *yValues);
+	bool		reserveVertexGraph(long size);
+	void		insertGraphVertex(struct Site* v);
+	void		insertGraphEdge(int v1, int v2);
+	void		finishVertexGraph();
 
 	bool		genDelaunay;
 	bool		genVoronoi;
@@ -282,7 +565,7 @@ private:
 	int 		ELhashsize;
 
 	int			triangulate, sorted, plot, debug;
-	float		xmin, xmax, ymin, ymax, deltax, deltay;
+	Real		xmin, xmax, ymin, ymax, deltax, deltay;
 
 	struct		Site	*sites;
 	int			nsites;
@@ -298,43 +581,82 @@ private:
 	struct		Halfedge *PQhash;
 	int			PQcount;
 	int			PQmin;
-
-	int			ntry, totalsearch;
-	float		pxmin, pxmax, pymin, pymax, cradius;
+	int			PQtype;
+	int*		PQsplit;		//where the parts of each bucket start in PQsubhash, -1 if it isn't split
+	struct		Halfedge *PQsubhash;
+	int			PQsubhashsize;
+	int			PQsubhashCapacity;
+	int			PQminSub;
+	PQHeapEntry* PQheap;
+	long		PQheapCapacity;
+	unsigned int PQorder;
+	bool		PQfailed;		//an event couldn't be put in the queue, the diagram is wrong
+	VoronoiPQStats pqStats;
+
+	bool		retainMemory;
+	bool		sitesSorted;
+	int			sitesCapacity;
+	int			ELhashCapacity;
+	int			PQhashCapacity;
+
+	//work arrays of sortSites(), the sort keys and the site numbers, twice the
+	//capacity so a radix pass can go from one half to the other
+	unsigned long long*	sortKeys;
+	int*		sortIndices;
+	long		sortCapacity;
+
+	VoronoiELStats elStats;
+	long		ELcheckLookups;	//elStats.lookups at the next check of the walks
+	long		ELcheckWalk;	//elStats.walk at the last check
+	long		ELcheckSearch;	//elStats.hashSearch at the last check
+	Real		pxmin, pxmax, pymin, pymax, cradius;
 	int			total_alloc;
 
-	float		borderMinX, borderMaxX, borderMinY, borderMaxY;
+	Real		borderMinX, borderMaxX, borderMinY, borderMaxY;
 
 	FreeNodeArrayList* allMemoryList;
 	FreeNodeArrayList* currentMemoryBlock;
 
-	GraphEdge*	allEdges;
-	GraphEdge*	iteratorEdges;
+	VoronoiEdgeBufferT<Real>	edges;
+	VoronoiEdgeSinkT<Real>*	edgeSink;
+	long		iteratorEdge;
+
+	//the delaunay triangulation, sized for nsites when the sweep starts: n sites have
+	//less than 3n delaunay edges and 2n triangles.  Kept like the vertex graph
+	PointVDG*	delaunaySitePoints;
+	int*		delaunayEdgeSites;
+	int*		delaunayTriangles;
+	long		numOfDelaunayEdges;
+	long		numOfDelaunayTriangles;
+	long		capacityOfDelaunay;		//in sites
+	long		iteratorDelaunayEdge;
+
+	//the vertex graph.  While the sweep runs every vertex has 3 slots in vertexNeighbours,
+	//starting at 3*v, and vertexOffsets[v+1] counts the used ones.  finishVertexGraph()
+	//packs the slots and turns the counts into the offsets
+	PointVDG*	vertexPoints;
+	int*		vertexOffsets;
+	int*		vertexNeighbours;
+	long		numOfGraphVertices;
+	long		capacityOfVertexGraph;	//can be bigger than numOfGraphVertices when retainMemory is set
+	bool		genVertexGraph;
 
-	GraphEdge*	delaunayEdges;
-	GraphEdge*	iteratorDelaunayEdges;
-
-	Point3*		vertexLinks; //lists all the vectors that each vector is directly connected to	
-	long		sizeOfVertexLinks;
-	
-	Site**		vertices;
-	long		sizeOfVertices ;
-
-	VertexLink* finalVertexLinks;
-	long 		sizeOfFinalVertexLinks;
 	long		currentVertexLink;
-
-	PointVDG	*finalVertices;	
-	long		sizeOfFinalVertices ;	
+	long		currentVertexNeighbour;
 	long 		currentVertex;
 
-	float		minDistanceBetweenSites;
+	Real		minDistanceBetweenSites;
+
+	//with VoronoiCoordTraits<Coord>::exact, the site of the smallest x and y is at
+	//(originX, originY), it is taken off the sites and added back to what comes out
+	Coord		originX, originY;
+	bool		exactSites;		//the sites are whole numbers below VDG_EXACT_RANGE
 
 	DEF_LOG
 	
 };
 
-int scomp(const void *p1,const void *p2);
+typedef VoronoiDiagramGeneratorT<float> VoronoiDiagramGenerator;
 
 
 #endif
@@ -0,0 +1,465 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#include "VoronoiTiledGenerator.h"
+
+#include <map>
+#include <algorithm>
+
+//An edge kept by a tile, with the two sites it is between and the numbers the tile's
+//generator gave the vertices at its ends
+struct VoronoiTileEdge
+{
+	float	x1, y1, x2, y2;
+	float	site1X, site1Y, site2X, site2Y;
+	int		v1, v2;
+};
+
+//A vertex of a tile's diagram, with the sites of the edges that end at it.  A vertex inside
+//the box is between 3 sites, which no other vertex is, so the tiles know it by them.  A vertex
+//made by clipping an edge to the box has the 2 sites of the edge
+struct VoronoiTileVertex
+{
+	float	x, y;
+	int		numOfSites;
+	float	siteX[3], siteY[3];
+
+	void addSite(float x, float y)
+	{
+		for(int i = 0; i < numOfSites; i++)
+		{
+			if(siteX[i] == x && siteY[i] == y)
+				return;
+		}
+		if(numOfSites < 3)
+		{
+			siteX[numOfSites] = x;
+			siteY[numOfSites] = y;
+			numOfSites++;
+		}
+	}
+};
+
+//the 3 sites of a vertex, lowest (by y, then x) first, so it is the same from every tile
+struct VoronoiVertexSites
+{
+	float	x[3], y[3];
+
+	VoronoiVertexSites(const VoronoiTileVertex& v)
+	{
+		for(int i = 0; i < 3; i++)
+		{
+			x[i] = v.siteX[i];
+			y[i] = v.siteY[i];
+		}
+		for(int j = 1; j < 3; j++)
+		{
+			for(int k = j; k > 0 && (y[k] < y[k-1] || (y[k] == y[k-1] && x[k] < x[k-1])); k--)
+			{
+				std::swap(x[k],x[k-1]);
+				std::swap(y[k],y[k-1]);
+			}
+		}
+	}
+
+	bool operator<(const VoronoiVertexSites& v) const
+	{
+		for(int i = 0; i < 3; i++)
+		{
+			if(y[i] != v.y[i]) return y[i] < v.y[i];
+			if(x[i] != v.x[i]) return x[i] < v.x[i];
+		}
+		return false;
+	}
+};
+
+//One tile, with the generator it is made with.  The generator gives it the edges as the
+//sink, and it checks and keeps them
+class VoronoiTile : public VoronoiEdgeSink
+{
+public:
+	VoronoiTile(VoronoiTiledGenerator* tiles, VoronoiDiagramGenerator* vdg, int index,
+				float minX, float minY, float maxX, float maxY)
+	{
+		_tiles = tiles;
+		_vdg = vdg;
+		_index = index;
+		_coreMinX = minX;
+		_coreMinY = minY;
+		_coreMaxX = maxX;
+		_coreMaxY = maxY;
+		_minDist = 0;
+		_right = false;
+		_ok = false;
+	}
+
+	//makes the edges of the tile from the sites within 'margin' of it.  Sets _ok and _right
+	void generate(float margin, float minDist);
+
+	//the generator gives every edge with its sites, an edge without them can't be owned
+	void addEdge(float, float, float, float){}
+
+	void addEdgeVertices(float x1, float y1, float x2, float y2, float site1X, float site1Y,
+						 float site2X, float site2Y, int vertex1, int vertex2);
+	void addVertex(int vertex, float x, float y);
+
+	bool isOk() const {return _ok;}
+	bool isRight() const {return _right;}
+	const std::vector<VoronoiTileEdge>& getEdges() const {return _edges;}
+	const VoronoiTileVertex& getVertex(int v) const {return _vertices[v];}
+
+private:
+	//true if the circle of radius r round (x,y) is inside the tile and its margin.  The sides
+	//of the margin at the edges of the box are open, there are no sites past them
+	bool circleInside(float x, float y, float r) const
+	{
+		if(_windowMinX > _tiles->_minX && x - r < _windowMinX) return false;
+		if(_windowMaxX < _tiles->_maxX && x + r > _windowMaxX) return false;
+		if(_windowMinY > _tiles->_minY && y - r < _windowMinY) return false;
+		if(_windowMaxY < _tiles->_maxY && y + r > _windowMaxY) return false;
+		return true;
+	}
+
+	VoronoiTiledGenerator*	_tiles;
+	VoronoiDiagramGenerator*	_vdg;
+	int						_index;
+	float					_coreMinX, _coreMinY, _coreMaxX, _coreMaxY;
+	float					_windowMinX, _windowMinY, _windowMaxX, _windowMaxY;
+	float					_minDist;
+	bool					_right;
+	bool					_ok;
+
+	std::vector<float>				_xValues, _yValues;
+	std::vector<VoronoiTileEdge>	_edges;
+	std::vector<VoronoiTileVertex>	_vertices;
+};
+
+void VoronoiTile::generate(float margin, float minDist)
+{
+	_minDist = minDist;
+	_windowMinX = _coreMinX - margin;
+	_windowMinY = _coreMinY - margin;
+	_windowMaxX = _coreMaxX + margin;
+	_windowMaxY = _coreMaxY + margin;
+	_edges.clear();
+	_vertices.clear();
+	_right = true;
+	_ok = true;
+
+	_tiles->getSites(_windowMinX,_windowMinY,_windowMaxX,_windowMaxY,_xValues,_yValues);
+
+	bool wholeBox = (_windowMinX <= _tiles->_minX && _windowMaxX >= _tiles->_maxX &&
+					 _windowMinY <= _tiles->_minY && _windowMaxY >= _tiles->_maxY);
+
+	if(_xValues.size() < 2)
+	{
+		//a site alone in the window has no edges to check, but it has some with the sites
+		//further away
+		long inTile = 0;
+		for(long i = 0; i < (long)_xValues.size(); i++)
+		{
+			if(_tiles->tileOf(_xValues[i],_yValues[i]) == _index)
+				inTile++;
+		}
+		_right = (inTile == 0 || wholeBox);
+		return;
+	}
+
+	//the edges between sites nearer than minDist are dropped here rather than by the
+	//generator, as they are needed to check the tile
+	_ok = _vdg->generateVoronoi(&_xValues[0],&_yValues[0],(int)_xValues.size(),_tiles->_minX,_tiles->_maxX,
+								_tiles->_minY,_tiles->_maxY,0,false,this);
+}
+
+void VoronoiTile::addVertex(int vertex, float x, float y)
+{
+	if(vertex >= (int)_vertices.size())
+		_vertices.resize(vertex + 1);
+	_vertices[vertex].x = x;
+	_vertices[vertex].y = y;
+	_vertices[vertex].numOfSites = 0;
+}
+
+void VoronoiTile::addEdgeVertices(float x1, float y1, float x2, float y2, float site1X, float site1Y,
+								  float site2X, float site2Y, int vertex1, int vertex2)
+{
+	//every edge of the tile's diagram, kept or not, tells the vertices their sites
+	_vertices[vertex1].addSite(site1X,site1Y);
+	_vertices[vertex1].addSite(site2X,site2Y);
+	_vertices[vertex2].addSite(site1X,site1Y);
+	_vertices[vertex2].addSite(site2X,site2Y);
+
+	int tile1 = _tiles->tileOf(site1X,site1Y);
+	int tile2 = _tiles->tileOf(site2X,site2Y);
+	if(tile1 != _index && tile2 != _index)
+		return;
+
+	float r1 = (float)sqrt((x1 - site1X)*(x1 - site1X) + (y1 - site1Y)*(y1 - site1Y));
+	float r2 = (float)sqrt((x2 - site1X)*(x2 - site1X) + (y2 - site1Y)*(y2 - site1Y));
+	if(!circleInside(x1,y1,r1) || !circleInside(x2,y2,r2))
+		_right = false;
+
+	if(sqrt(((site2X - site1X) * (site2X - site1X)) + ((site2Y - site1Y) * (site2Y - site1Y))) < _minDist)
+		return;
+
+	bool firstLower = (site1Y < site2Y || (site1Y == site2Y && site1X < site2X));
+	if((firstLower ? tile1 : tile2) != _index)
+		return;
+
+	VoronoiTileEdge e = {x1, y1, x2, y2, site1X, site1Y, site2X, site2Y, vertex1, vertex2};
+	_edges.push_back(e);
+}
+
+//the tiles to be made, a tile to a part, each with the margin it is to be generated with
+class VoronoiTileJob : public IThreadedParts
+{
+public:
+	VoronoiTileJob(std::vector<VoronoiTile*>* tiles, std::vector<float>* margins, float minDist)
+	{
+		_tiles = tiles;
+		_margins = margins;
+		_minDist = minDist;
+	}
+
+	virtual void runPart(int part)
+	{
+		(*_tiles)[part]->generate((*_margins)[part],_minDist);
+	}
+
+private:
+	std::vector<VoronoiTile*>*	_tiles;
+	std::vector<float>*			_margins;
+	float						_minDist;
+};
+
+
+VoronoiTiledGenerator::VoronoiTiledGenerator()
+{
+	_columns = _rows = 0;
+	_minX = _maxX = _minY = _maxY = 0;
+	_tileWidth = _tileHeight = 0;
+	_retries = 0;
+	GET_FILE_LOG
+}
+
+VoronoiTiledGenerator::~VoronoiTiledGenerator()
+{
+	for(long i = 0; i < (long)_tiles.size(); i++)
+		delete _tiles[i];
+	for(long j = 0; j < (long)_generators.size(); j++)
+		delete _generators[j];
+}
+
+int VoronoiTiledGenerator::columnOf(float x) const
+{
+	int column = (int)((x - _minX)/_tileWidth);
+	if(column < 0) return 0;
+	if(column >= _columns) return _columns - 1;
+	return column;
+}
+
+int VoronoiTiledGenerator::rowOf(float y) const
+{
+	int row = (int)((y - _minY)/_tileHeight);
+	if(row < 0) return 0;
+	if(row >= _rows) return _rows - 1;
+	return row;
+}
+
+//the columns and rows that multiply to numOfTiles and give the squarest tiles
+void VoronoiTiledGenerator::layOutTiles(int numOfTiles)
+{
+	float width = _maxX - _minX;
+	float height = _maxY - _minY;
+	if(width <= 0) width = 1;
+	if(height <= 0) height = 1;
+
+	double best = 0;
+	_columns = numOfTiles;
+	for(int columns = 1; columns <= numOfTiles; columns++)
+	{
+		if(numOfTiles % columns != 0)
+			continue;
+		double ratio = (width/columns)/(height/(numOfTiles/columns));
+		if(ratio < 1) ratio = 1/ratio;
+		if(columns == 1 || ratio < best)
+		{
+			best = ratio;
+			_columns = columns;
+		}
+	}
+	_rows = numOfTiles/_columns;
+	_tileWidth = width/_columns;
+	_tileHeight = height/_rows;
+
+	for(long i = 0; i < (long)_tiles.size(); i++)
+		delete _tiles[i];
+	_tiles.clear();
+
+	//the generators are kept from the last diagram with their memory, a tile is made with the
+	//one of its number
+	while((int)_generators.size() < numOfTiles)
+	{
+		VoronoiDiagramGenerator* vdg = new VoronoiDiagramGenerator;
+		vdg->setRetainMemory(true);
+		_generators.push_back(vdg);
+	}
+	for(int row = 0; row < _rows; row++)
+	{
+		for(int column = 0; column < _columns; column++)
+		{
+			_tiles.push_back(new VoronoiTile(this,_generators[row*_columns + column],row*_columns + column,
+				_minX + column*_tileWidth,_minY + row*_tileHeight,
+				(column == _columns - 1) ? _maxX : _minX + (column + 1)*_tileWidth,
+				(row == _rows - 1) ? _maxY : _minY + (row + 1)*_tileHeight));
+		}
+	}
+}
+
+//a counting sort of the sites by tile, so a tile only looks at the sites of the tiles
+//its margin reaches
+void VoronoiTiledGenerator::bucketSites(float* xValues, float* yValues, long numPoints)
+{
+	int numOfTiles = _columns*_rows;
+	_bucketStart.assign(numOfTiles + 1,0);
+	long i;
+	for(i = 0; i < numPoints; i++)
+		_bucketStart[tileOf(xValues[i],yValues[i]) + 1]++;
+	for(i = 1; i <= numOfTiles; i++)
+		_bucketStart[i] += _bucketStart[i - 1];
+
+	std::vector<long> next(_bucketStart.begin(),_bucketStart.end() - 1);
+	_bucketX.resize(numPoints);
+	_bucketY.resize(numPoints);
+	for(i = 0; i < numPoints; i++)
+	{
+		long slot = next[tileOf(xValues[i],yValues[i])]++;
+		_bucketX[slot] = xValues[i];
+		_bucketY[slot] = yValues[i];
+	}
+}
+
+void VoronoiTiledGenerator::getSites(float minX, float minY, float maxX, float maxY,
+									 std::vector<float>& xValues, std::vector<float>& yValues) const
+{
+	xValues.clear();
+	yValues.clear();
+	int lastColumn = columnOf(maxX), lastRow = rowOf(maxY);
+	for(int row = rowOf(minY); row <= lastRow; row++)
+	{
+		for(int column = columnOf(minX); column <= lastColumn; column++)
+		{
+			int tile = row*_columns + column;
+			for(long i = _bucketStart[tile]; i < _bucketStart[tile + 1]; i++)
+			{
+				if(_bucketX[i] >= minX && _bucketX[i] <= maxX && _bucketY[i] >= minY && _bucketY[i] <= maxY)
+				{
+					xValues.push_back(_bucketX[i]);
+					yValues.push_back(_bucketY[i]);
+				}
+			}
+		}
+	}
+}
+
+//The number of a vertex of the whole diagram.  A vertex between 3 sites is found in 'numbers'
+//by them, the tiles it is in give it the same number.  A clipped end only ends the one edge
+static int numberVertex(const VoronoiTileVertex& v, std::map<VoronoiVertexSites,int>& numbers,
+						int& numOfVertices, VoronoiEdgeSink* sink)
+{
+	if(v.numOfSites == 3)
+	{
+		std::map<VoronoiVertexSites,int>::iterator it = numbers.find(VoronoiVertexSites(v));
+		if(it != numbers.end())
+			return it->second;
+		numbers[VoronoiVertexSites(v)] = numOfVertices;
+	}
+	sink->addVertex(numOfVertices,v.x,v.y);
+	return numOfVertices++;
+}
+
+bool VoronoiTiledGenerator::generateVoronoi(float* xValues, float* yValues, long numPoints,
+											float minX, float maxX, float minY, float maxY, float minDist,
+											int numOfTiles, float margin, VoronoiEdgeSink* sink)
+{
+	if(numOfTiles < 1)
+		numOfTiles = 1;
+
+	_minX = minX;
+	_maxX = maxX;
+	_minY = minY;
+	_maxY = maxY;
+	_retries = 0;
+
+	layOutTiles(numOfTiles);
+	bucketSites(xValues,yValues,numPoints);
+
+	if(margin <= 0)
+		margin = ((_tileWidth < _tileHeight) ? _tileWidth : _tileHeight)/4;
+
+	//a margin this big takes in the whole box, the tiles are then always right
+	float widest = 2*(((maxX - minX) > (maxY - minY)) ? (maxX - minX) : (maxY - minY));
+
+	std::vector<VoronoiTile*> pending(_tiles);
+	std::vector<float> margins(_tiles.size(),margin);
+	while(pending.size() > 0)
+	{
+		VoronoiTileJob job(&pending,&margins,minDist);
+		runParts(job,(int)pending.size());
+
+		std::vector<VoronoiTile*> wrong;
+		std::vector<float> biggerMargins;
+		for(long i = 0; i < (long)pending.size(); i++)
+		{
+			if(!pending[i]->isOk())
+				return false;
+			if(pending[i]->isRight())
+				continue;
+
+			//the circles that didn't fit are no guide to the margin needed: an edge that
+			//runs out of the margin in the tile can be much shorter with the sites past it
+			float bigger = (2*margins[i] > widest) ? widest : 2*margins[i];
+
+			LOG<<"VoronoiTiledGenerator: generating a tile again with a margin of "<<bigger;
+			wrong.push_back(pending[i]);
+			biggerMargins.push_back(bigger);
+			_retries++;
+		}
+		pending.swap(wrong);
+		margins.swap(biggerMargins);
+	}
+
+	std::map<VoronoiVertexSites,int> numbers;
+	int numOfVertices = 0;
+	for(long t = 0; t < (long)_tiles.size(); t++)
+	{
+		const std::vector<VoronoiTileEdge>& edges = _tiles[t]->getEdges();
+		for(long i = 0; i < (long)edges.size(); i++)
+		{
+			const VoronoiTileEdge& e = edges[i];
+			int v1 = numberVertex(_tiles[t]->getVertex(e.v1),numbers,numOfVertices,sink);
+			int v2 = numberVertex(_tiles[t]->getVertex(e.v2),numbers,numOfVertices,sink);
+			sink->addEdgeVertices(e.x1,e.y1,e.x2,e.y2,e.site1X,e.site1Y,e.site2X,e.site2Y,v1,v2);
+		}
+	}
+	return true;
+}
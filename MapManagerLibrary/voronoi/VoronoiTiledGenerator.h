@@ -0,0 +1,93 @@
+/*
+MapManager library for the conversion, manipulation and analysis
+of maps used in Mobile Robotics research.
+Copyright (C) 2005 Shane O'Sullivan
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+email: shaneosullivan1@gmail.com
+*/
+
+#ifndef VORONOI_TILED_GENERATOR
+#define VORONOI_TILED_GENERATOR
+
+#include "VoronoiDiagramGenerator.h"
+#include "../sosutil/Threaded.h"
+
+#include <vector>
+
+class VoronoiTile;
+
+//Generates the voronoi diagram of a lot of sites in tiles, each tile on its own thread with
+//its own VoronoiDiagramGenerator.  The generators keep their memory for the next diagram.
+//
+//The box is cut into a grid of tiles.  A tile is generated from the sites in it and the sites
+//within a margin all round it, and keeps the edges it owns: an edge is owned by the tile that
+//holds the lower of its two sites (lower y, then lower x), so the edges whose owning site is in
+//the margin are left to the tile next to it.  The edges of a tile are right when the empty
+//circles round their ends are all inside the tile and its margin, as no site outside can then
+//be nearer to them.  That is checked for every edge with a site in the tile, and a tile where it
+//fails is generated again with twice the margin, until the margin reaches the edges of the box.
+//So the edges are the same as those of one generator on all the sites, apart from the order
+class VoronoiTiledGenerator
+{
+public:
+	VoronoiTiledGenerator();
+	~VoronoiTiledGenerator();
+
+	//As VoronoiDiagramGenerator::generateVoronoi() with a sink, in numOfTiles tiles.  'margin'
+	//is how far round a tile the sites are taken from the first time.  The edges are given to
+	//the sink with their sites and vertices once all the tiles are done, from the calling
+	//thread.  The vertices are numbered afresh, each before the first edge that ends at it
+	bool generateVoronoi(float* xValues, float* yValues, long numPoints,
+						 float minX, float maxX, float minY, float maxY, float minDist,
+						 int numOfTiles, float margin, VoronoiEdgeSink* sink);
+
+	//the tiles the last diagram was cut into, and how many times a tile had to be
+	//generated again with a bigger margin
+	int getNumOfColumns() const {return _columns;}
+	int getNumOfRows() const {return _rows;}
+	int getNumOfRetries() const {return _retries;}
+
+private:
+	friend class VoronoiTile;
+
+	//the tile that owns an edge whose lower site is (x,y)
+	int tileOf(float x, float y) const {return rowOf(y)*_columns + columnOf(x);}
+
+	//the sites from (minX,minY) to (maxX,maxY)
+	void getSites(float minX, float minY, float maxX, float maxY,
+				  std::vector<float>& xValues, std::vector<float>& yValues) const;
+
+	void layOutTiles(int numOfTiles);
+	void bucketSites(float* xValues, float* yValues, long numPoints);
+	int columnOf(float x) const;
+	int rowOf(float y) const;
+
+	std::vector<VoronoiTile*>	_tiles;
+	std::vector<VoronoiDiagramGenerator*>	_generators;	//one per tile, kept for the next diagram
+	int							_columns, _rows;
+	float						_minX, _maxX, _minY, _maxY;
+	float						_tileWidth, _tileHeight;
+	int							_retries;
+
+	//the sites sorted by the tile they are in, those of tile t start at _bucketStart[t]
+	std::vector<long>			_bucketStart;
+	std::vector<float>			_bucketX, _bucketY;
+
+	DEF_LOG
+};
+
+#endif
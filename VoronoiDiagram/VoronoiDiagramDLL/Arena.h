@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+
+// The storage of the builder: a std::vector that only grows.
+// Reset drop the elements but keep the memory, so building the diagram
+// again with about the same number of sites won't allocate anything.
+// AllocationCount is the number of times the memory had to grow.
+//
+// The elements are referred by index, a reference or pointer to them is
+// only valid until the next Push/Resize.
+template <class T>
+class txArena
+{
+public:
+	txArena():allocationCount(0){};
+
+	void Reserve(size_t n){
+		if ( n>items.capacity() ) {
+			items.reserve(n);
+			allocationCount++;
+		}
+	}
+
+	void Reset(){ items.clear(); };
+
+	bool Empty() const { return items.empty(); };
+	size_t Size() const { return items.size(); };
+	size_t Capacity() const { return items.capacity(); };
+	size_t AllocationCount() const { return allocationCount; };
+
+	T &operator[](size_t i) { return items[i]; };
+	const T &operator[](size_t i) const { return items[i]; };
+	T &Back() { return items.back(); };
+
+	// return the index of the new element
+	int Push(const T &item){
+		if ( items.size()==items.capacity() ) allocationCount++;
+		items.push_back(item);
+		return (int)items.size()-1;
+	}
+
+	void PopBack(){ items.pop_back(); };
+
+	void Append(const T *first, size_t n){
+		if ( items.size()+n>items.capacity() ) allocationCount++;
+		items.insert(items.end(), first, first+n);
+	}
+
+	void Resize(size_t n, const T &item){
+		if ( n>items.capacity() ) allocationCount++;
+		items.resize(n, item);
+	}
+
+	void Swap(txArena &other){
+		items.swap(other.items);
+		std::swap(allocationCount, other.allocationCount);
+	}
+
+private:
+	std::vector<T>   items;
+	size_t           allocationCount;
+};
@@ -0,0 +1,267 @@
+#pragma once
+#include "Arena.h"
+#include <assert.h>
+
+// The beach line as a self balanced ( AVL ) tree.
+// The arcs are kept in the tree in the x increase order, same as the
+// order they appear on the beach line, so the in order walk of the tree
+// is the beach line from left to right.
+//
+// The nodes live in one array ( txArena ) and link to each other by index,
+// a node index is the handle of the arc. The handle won't change until the
+// arc is erased. An id->handle table make the arc lookup O(1).
+//
+// T must have the integer member "id" ( small and dense, >= 0 ).
+// The break points are not kept in the tree since they move with the sweep
+// line, Locate asks the caller for the left break point of the nodes it
+// visits, which is O(log n) evaluations per search.
+template <class T>
+class txBeachLine
+{
+public:
+	txBeachLine():root(-1),count(0){};
+
+	void Reserve(size_t n){
+		nodes.Reserve(n);
+		idToNode.Reserve(n);
+	}
+
+	size_t AllocationCount() const {
+		return nodes.AllocationCount() + freeNodes.AllocationCount() + idToNode.AllocationCount();
+	}
+
+	// drop all the arcs, keep the memory
+	void Clear(){
+		nodes.Reset();
+		freeNodes.Reset();
+		idToNode.Reset();
+		root = -1;
+		count = 0;
+	}
+
+	bool Empty() const { return count==0; };
+	size_t Size() const { return count; };
+
+	T &Arc(int h) { return nodes[h].arc; };
+	const T &Arc(int h) const { return nodes[h].arc; };
+
+	// return the handle of the arc, -1 if the arc is not on the beach line
+	int Find(int arcId) const {
+		if ( arcId<0 || arcId>=(int)idToNode.Size() ) return -1;
+		return idToNode[arcId];
+	}
+
+	int First() const { return root==-1 ? -1 : Leftmost(root); }
+	int Last() const { return root==-1 ? -1 : Rightmost(root); }
+
+	int Next(int h) const {
+		if ( nodes[h].right != -1 ) return Leftmost(nodes[h].right);
+		int p = nodes[h].parent;
+		while ( p!=-1 && h==nodes[p].right ) { h = p; p = nodes[p].parent; }
+		return p;
+	}
+
+	int Prev(int h) const {
+		if ( nodes[h].left != -1 ) return Rightmost(nodes[h].left);
+		int p = nodes[h].parent;
+		while ( p!=-1 && h==nodes[p].left ) { h = p; p = nodes[p].parent; }
+		return p;
+	}
+
+	// The arc which is above the x, which is the last arc whose left
+	// break point <= x. leftValue(h) return the left break point of the
+	// node h. The leftmost arc is always -Infinite so there is always one
+	// arc if the beach line is not empty.
+	template <class KeyFn>
+	int Locate(double x, const KeyFn &leftValue) const {
+		int h = root;
+		int rtn = -1;
+		while ( h!=-1 ) {
+			if ( leftValue(h) <= x ) {
+				rtn = h;
+				h = nodes[h].right;
+			} else {
+				h = nodes[h].left;
+			}
+		}
+		return rtn==-1 ? First() : rtn;
+	}
+
+	int PushBack(const T &arc){
+		int n = NewNode(arc);
+		if ( root==-1 ) {
+			root = n;
+		} else {
+			int last = Rightmost(root);
+			Link(last, n, false);
+			Rebalance(last);
+		}
+		return n;
+	}
+
+	int InsertAfter(int h, const T &arc){
+		int n = NewNode(arc);
+		if ( nodes[h].right==-1 ) {
+			Link(h, n, false);
+		} else {
+			h = Leftmost(nodes[h].right);
+			Link(h, n, true);
+		}
+		Rebalance(h);
+		return n;
+	}
+
+	int InsertBefore(int h, const T &arc){
+		int n = NewNode(arc);
+		if ( nodes[h].left==-1 ) {
+			Link(h, n, true);
+		} else {
+			h = Rightmost(nodes[h].left);
+			Link(h, n, false);
+		}
+		Rebalance(h);
+		return n;
+	}
+
+	// Unlink the node. When it has two children the successor node is moved
+	// to its place ( not the content ), so the other handles stay valid.
+	void Erase(int h){
+		Node &node = nodes[h];
+		int rebalanceFrom;
+		if ( node.left!=-1 && node.right!=-1 ) {
+			int s = Leftmost(node.right);
+			if ( s!=node.right ) {
+				int sp = nodes[s].parent;
+				nodes[sp].left = nodes[s].right;
+				if ( nodes[s].right!=-1 ) nodes[nodes[s].right].parent = sp;
+				nodes[s].right = node.right;
+				nodes[node.right].parent = s;
+				rebalanceFrom = sp;
+			} else {
+				rebalanceFrom = s;
+			}
+			nodes[s].left = node.left;
+			nodes[node.left].parent = s;
+			nodes[s].height = node.height;
+			Replace(h, s);
+		} else {
+			int child = node.left!=-1 ? node.left : node.right;
+			rebalanceFrom = node.parent;
+			Replace(h, child);
+		}
+		if ( rebalanceFrom!=-1 ) Rebalance(rebalanceFrom);
+
+		idToNode[node.arc.id] = -1;
+		node.left = node.right = node.parent = -1;
+		freeNodes.Push(h);
+		count--;
+	}
+
+private:
+	struct Node{
+		T     arc;
+		int   left, right, parent;
+		int   height;
+		Node(const T &arc_):arc(arc_),left(-1),right(-1),parent(-1),height(1){};
+	};
+
+	int NewNode(const T &arc){
+		int n;
+		if ( !freeNodes.Empty() ) {
+			n = freeNodes.Back();
+			freeNodes.PopBack();
+			nodes[n] = Node(arc);
+		} else {
+			n = nodes.Push(Node(arc));
+		}
+		assert(arc.id>=0);
+		if ( arc.id>=(int)idToNode.Size() ) idToNode.Resize(arc.id+1, -1);
+		idToNode[arc.id] = n;
+		count++;
+		return n;
+	}
+
+	int Leftmost(int h) const {
+		while ( nodes[h].left!=-1 ) h = nodes[h].left;
+		return h;
+	}
+
+	int Rightmost(int h) const {
+		while ( nodes[h].right!=-1 ) h = nodes[h].right;
+		return h;
+	}
+
+	int Height(int h) const { return h==-1 ? 0 : nodes[h].height; }
+
+	void UpdateHeight(int h){
+		int hl = Height(nodes[h].left);
+		int hr = Height(nodes[h].right);
+		nodes[h].height = (hl>hr ? hl : hr) + 1;
+	}
+
+	void Link(int parent, int child, bool asLeft){
+		if ( asLeft ) nodes[parent].left = child;
+		else nodes[parent].right = child;
+		nodes[child].parent = parent;
+	}
+
+	// put the "by" node ( may be -1 ) at the place of node h in its parent
+	void Replace(int h, int by){
+		int p = nodes[h].parent;
+		if ( by!=-1 ) nodes[by].parent = p;
+		if ( p==-1 ) root = by;
+		else if ( nodes[p].left==h ) nodes[p].left = by;
+		else nodes[p].right = by;
+	}
+
+	// Right rotation ( left rotation is the mirror ):
+	//     h   -->   l
+	//   l   c     a   h
+	//  a b           b c
+	int RotateRight(int h){
+		int l = nodes[h].left;
+		Replace(h, l);
+		nodes[h].left = nodes[l].right;
+		if ( nodes[l].right!=-1 ) nodes[nodes[l].right].parent = h;
+		Link(l, h, false);
+		UpdateHeight(h);
+		UpdateHeight(l);
+		return l;
+	}
+
+	int RotateLeft(int h){
+		int r = nodes[h].right;
+		Replace(h, r);
+		nodes[h].right = nodes[r].left;
+		if ( nodes[r].left!=-1 ) nodes[nodes[r].left].parent = h;
+		Link(r, h, true);
+		UpdateHeight(h);
+		UpdateHeight(r);
+		return r;
+	}
+
+	// walk up to the root and fix the balance factor on the way
+	void Rebalance(int h){
+		while ( h!=-1 ) {
+			UpdateHeight(h);
+			int balance = Height(nodes[h].left) - Height(nodes[h].right);
+			if ( balance>1 ) {
+				int l = nodes[h].left;
+				if ( Height(nodes[l].left) < Height(nodes[l].right) ) RotateLeft(l);
+				h = RotateRight(h);
+			} else if ( balance<-1 ) {
+				int r = nodes[h].right;
+				if ( Height(nodes[r].right) < Height(nodes[r].left) ) RotateRight(r);
+				h = RotateLeft(h);
+			}
+			h = nodes[h].parent;
+		}
+	}
+
+private:
+	txArena<Node>        nodes;
+	txArena<int>         freeNodes;
+	txArena<int>         idToNode;    // arc id -> node handle, -1 if erased
+	int                  root;
+	size_t               count;
+};
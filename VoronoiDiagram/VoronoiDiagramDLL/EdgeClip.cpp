@@ -0,0 +1,39 @@
+#include "StdAfx.h"
+#include "EdgeClip.h"
+
+// One side of the box: p*t <= q. p<0 the line comes in, p>0 it goes out,
+// p==0 it is parallel and all out when q<0.
+static inline void ClipSide(double p, double q, double &t0, double &t1, bool &reject){
+	double r = q/p;
+	t0 = ( p<0.0 && r>t0 ) ? r : t0;
+	t1 = ( p>0.0 && r<t1 ) ? r : t1;
+	reject = reject | ( p==0.0 && q<0.0 );
+}
+
+void txEdgeClip::ClipLines(size_t n, const double *px, const double *py, const double *dx, const double *dy, double *t0, double *t1, const txBox &box){
+	for (size_t i=0; i<n; i++) {
+		double tin = t0[i];
+		double tout = t1[i];
+		bool reject = false;
+		ClipSide(-dx[i], px[i]-box.minX, tin, tout, reject);
+		ClipSide( dx[i], box.maxX-px[i], tin, tout, reject);
+		ClipSide(-dy[i], py[i]-box.minY, tin, tout, reject);
+		ClipSide( dy[i], box.maxY-py[i], tin, tout, reject);
+		t0[i] = reject ? 1.0 : tin;
+		t1[i] = reject ? 0.0 : tout;
+	}
+}
+
+double txEdgeClip::BoundaryPosition(const txBox &box, double x, double y){
+	double width = box.maxX-box.minX;
+	double height = box.maxY-box.minY;
+	double bottom = y-box.minY;
+	double right = box.maxX-x;
+	double top = box.maxY-y;
+	double left = x-box.minX;
+	// the nearest side, the point should be on it
+	if ( bottom<=right && bottom<=top && bottom<=left ) return (x-box.minX)/width;
+	if ( right<=top && right<=left ) return 1.0 + (y-box.minY)/height;
+	if ( top<=left ) return 2.0 + (box.maxX-x)/width;
+	return 3.0 + (box.maxY-y)/height;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stddef.h>
+#include "import.h"
+
+typedef struct txBox{
+	double minX, minY, maxX, maxY;
+} txBox;
+
+// Liang-Barsky clipping of a batch of lines to the box.
+// Line i is ( px[i], py[i] ) + t*( dx[i], dy[i] ) for t in [ t0[i], t1[i] ],
+// t0 / t1 may be -/+HUGE_VAL for rays and lines. The interval is narrowed
+// to the part in the box, t0[i] > t1[i] if nothing is left.
+//
+// The edges go through the same arithmetic with no branch on the data
+// ( the ifs are selects ), the arrays are separated so the compiler can
+// vectorize the loop.
+class R_DECLDIR txEdgeClip
+{
+public:
+	static void ClipLines(size_t n, const double *px, const double *py, const double *dx, const double *dy, double *t0, double *t1, const txBox &box);
+
+	// Position of a point on the box boundary, counter clockwise from the
+	// corner ( minX, minY ): [0,1) bottom, [1,2) right, [2,3) top, [3,4) left.
+	static double BoundaryPosition(const txBox &box, double x, double y);
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include "Arena.h"
+#include <assert.h>
+
+// Addressable binary heap.
+// The stl priority_queue can not remove an element that is not on the top,
+// but the circle events have to be deleted when they turn out to be false
+// alarms. So besides the heap array this keep a position index keyed by the
+// element id, which make Push, Pop and Erase all O(log n).
+//
+// T must have an integer member "id" which is >= 0. The ids are used to
+// index an array directly, so they should be small and dense
+// (txVoronoiBuilder hands them out from a counter).
+// Cmp(l, r) return true when l should be popped before r.
+template <class T, class Cmp>
+class txIndexedHeap
+{
+public:
+	txIndexedHeap(){};
+
+	void Reserve(size_t n){
+		heap.Reserve(n);
+		position.Reserve(n);
+	}
+
+	bool Empty() const { return heap.Empty(); };
+	size_t Size() const { return heap.Size(); };
+
+	size_t AllocationCount() const {
+		return heap.AllocationCount() + position.AllocationCount();
+	}
+
+	// drop all the elements, keep the memory
+	void Clear(){
+		heap.Reset();
+		position.Reset();
+	}
+
+	bool Contains(int id) const {
+		return id>=0 && id<(int)position.Size() && position[id]!=-1;
+	}
+
+	const T &Top() const {
+		assert(!heap.Empty());
+		return heap[0];
+	}
+
+	void Push(const T &node){
+		assert(node.id>=0);
+		if ( node.id >= (int)position.Size() ) {
+			position.Resize(node.id+1, -1);
+		}
+		assert(position[node.id]==-1);
+		heap.Push(node);
+		position[node.id] = (int)heap.Size()-1;
+		SiftUp(heap.Size()-1);
+	}
+
+	void Pop(){
+		assert(!heap.Empty());
+		RemoveAt(0);
+	}
+
+	// Remove the element with this id wherever it is in the heap
+	// return false if there is no such element
+	bool Erase(int id){
+		if ( !Contains(id) ) return false;
+		RemoveAt(position[id]);
+		return true;
+	}
+
+private:
+	void RemoveAt(size_t i){
+		size_t last = heap.Size()-1;
+		position[heap[i].id] = -1;
+		if ( i != last ) {
+			heap[i] = heap[last];
+			position[heap[i].id] = (int)i;
+		}
+		heap.PopBack();
+		if ( i < heap.Size() ) {
+			// the moved element may need to go either way
+			if ( i>0 && cmp(heap[i], heap[(i-1)/2]) ) {
+				SiftUp(i);
+			} else {
+				SiftDown(i);
+			}
+		}
+	}
+
+	void SiftUp(size_t i){
+		T node = heap[i];
+		while ( i>0 ) {
+			size_t parent = (i-1)/2;
+			if ( !cmp(node, heap[parent]) ) break;
+			heap[i] = heap[parent];
+			position[heap[i].id] = (int)i;
+			i = parent;
+		}
+		heap[i] = node;
+		position[node.id] = (int)i;
+	}
+
+	void SiftDown(size_t i){
+		size_t n = heap.Size();
+		T node = heap[i];
+		while ( true ) {
+			size_t child = 2*i+1;
+			if ( child>=n ) break;
+			if ( child+1<n && cmp(heap[child+1], heap[child]) ) child++;
+			if ( !cmp(heap[child], node) ) break;
+			heap[i] = heap[child];
+			position[heap[i].id] = (int)i;
+			i = child;
+		}
+		heap[i] = node;
+		position[node.id] = (int)i;
+	}
+
+private:
+	txArena<T>         heap;
+	txArena<int>       position;   // event id -> slot in heap, -1 if not in the heap
+	Cmp                cmp;
+};
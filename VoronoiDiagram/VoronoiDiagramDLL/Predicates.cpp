@@ -0,0 +1,182 @@
+#include "StdAfx.h"
+#include "Predicates.h"
+
+// The error bounds for the double precision ( epsilon = 2^-53 )
+#define EPSILON (1.0/9007199254740992.0)
+const double txPredicates::ccwErrBound = (3.0 + 16.0*EPSILON)*EPSILON;
+const double txPredicates::iccErrBound = (10.0 + 96.0*EPSILON)*EPSILON;
+
+// An expansion is a sum of doubles that don't overlap, the smallest comes
+// first. The sign of the sum is the sign of the last ( biggest ) one.
+
+// a+b = x+y exactly, x is the rounded sum
+static inline void TwoSum(double a, double b, double &x, double &y){
+	x = a + b;
+	double bvirt = x - a;
+	double avirt = x - bvirt;
+	double bround = b - bvirt;
+	double around = a - avirt;
+	y = around + bround;
+}
+
+// split a into two 26 bits halves
+static inline void Split(double a, double &hi, double &lo){
+	const double splitter = 134217729.0;   // 2^27+1
+	double c = splitter*a;
+	double abig = c - a;
+	hi = c - abig;
+	lo = a - hi;
+}
+
+// a*b = x+y exactly, x is the rounded product
+static inline void TwoProduct(double a, double b, double &x, double &y){
+	x = a*b;
+	double ahi, alo, bhi, blo;
+	Split(a, ahi, alo);
+	Split(b, bhi, blo);
+	double err1 = x - ahi*bhi;
+	double err2 = err1 - alo*bhi;
+	double err3 = err2 - ahi*blo;
+	y = alo*blo - err3;
+}
+
+// h = e+f, the zero components are removed, return the length of h
+static int ExpansionSum(int elen, const double *e, int flen, const double *f, double *h){
+	double q, qnew, hh;
+	double enow = e[0];
+	double fnow = f[0];
+	int eindex = 0, findex = 0, hindex = 0;
+	if ( (fnow > enow) == (fnow > -enow) ) {
+		q = enow;
+		if ( ++eindex < elen ) enow = e[eindex];
+	} else {
+		q = fnow;
+		if ( ++findex < flen ) fnow = f[findex];
+	}
+	if ( eindex < elen && findex < flen ) {
+		if ( (fnow > enow) == (fnow > -enow) ) {
+			qnew = enow + q;
+			hh = q - (qnew - enow);
+			if ( ++eindex < elen ) enow = e[eindex];
+		} else {
+			qnew = fnow + q;
+			hh = q - (qnew - fnow);
+			if ( ++findex < flen ) fnow = f[findex];
+		}
+		q = qnew;
+		if ( hh != 0.0 ) h[hindex++] = hh;
+		while ( eindex < elen && findex < flen ) {
+			if ( (fnow > enow) == (fnow > -enow) ) {
+				TwoSum(q, enow, qnew, hh);
+				if ( ++eindex < elen ) enow = e[eindex];
+			} else {
+				TwoSum(q, fnow, qnew, hh);
+				if ( ++findex < flen ) fnow = f[findex];
+			}
+			q = qnew;
+			if ( hh != 0.0 ) h[hindex++] = hh;
+		}
+	}
+	while ( eindex < elen ) {
+		TwoSum(q, enow, qnew, hh);
+		if ( ++eindex < elen ) enow = e[eindex];
+		q = qnew;
+		if ( hh != 0.0 ) h[hindex++] = hh;
+	}
+	while ( findex < flen ) {
+		TwoSum(q, fnow, qnew, hh);
+		if ( ++findex < flen ) fnow = f[findex];
+		q = qnew;
+		if ( hh != 0.0 ) h[hindex++] = hh;
+	}
+	if ( q != 0.0 || hindex == 0 ) h[hindex++] = q;
+	return hindex;
+}
+
+// h = e*b, the zero components are removed, return the length of h
+static int ScaleExpansion(int elen, const double *e, double b, double *h){
+	double q, sum, hh, product1, product0;
+	int hindex = 0;
+	TwoProduct(e[0], b, q, hh);
+	if ( hh != 0.0 ) h[hindex++] = hh;
+	for (int eindex=1; eindex<elen; eindex++) {
+		TwoProduct(e[eindex], b, product1, product0);
+		TwoSum(q, product0, sum, hh);
+		if ( hh != 0.0 ) h[hindex++] = hh;
+		TwoSum(product1, sum, q, hh);
+		if ( hh != 0.0 ) h[hindex++] = hh;
+	}
+	if ( q != 0.0 || hindex == 0 ) h[hindex++] = q;
+	return hindex;
+}
+
+// a0*b1 - b0*a1 as an expansion of at most 4, return the length
+static inline int TwoTwoDet(double a0, double a1, double b0, double b1, double *h){
+	double p[2], q[2];
+	TwoProduct(a0, b1, p[1], p[0]);
+	TwoProduct(b0, a1, q[1], q[0]);
+	q[0] = -q[0];
+	q[1] = -q[1];
+	return ExpansionSum(2, p, 2, q, h);
+}
+
+double txPredicates::Orient2dExact(const txVertex &a, const txVertex &b, const txVertex &c){
+	// ( ax*by - bx*ay ) + ( bx*cy - cx*by ) + ( cx*ay - ax*cy )
+	double ab[4], bc[4], ca[4];
+	int ablen = TwoTwoDet(a.x, a.y, b.x, b.y, ab);
+	int bclen = TwoTwoDet(b.x, b.y, c.x, c.y, bc);
+	int calen = TwoTwoDet(c.x, c.y, a.x, a.y, ca);
+	double temp8[8], det[12];
+	int templen = ExpansionSum(ablen, ab, bclen, bc, temp8);
+	int detlen = ExpansionSum(templen, temp8, calen, ca, det);
+	return det[detlen-1];
+}
+
+// The lifted 4x4 determinant, every minor is an expansion of the 2x2
+// determinants of the points, then scaled by the lifted coordinates.
+static int LiftedTerm(int len, const double *minor, const txVertex &p, bool negative, double *h){
+	double det24x[24], det48x[48], det24y[24], det48y[48];
+	double px = negative ? -p.x : p.x;
+	double py = negative ? -p.y : p.y;
+	int xlen = ScaleExpansion(len, minor, p.x, det24x);
+	int xxlen = ScaleExpansion(xlen, det24x, px, det48x);
+	int ylen = ScaleExpansion(len, minor, p.y, det24y);
+	int yylen = ScaleExpansion(ylen, det24y, py, det48y);
+	return ExpansionSum(xxlen, det48x, yylen, det48y, h);
+}
+
+double txPredicates::InCircleExact(const txVertex &a, const txVertex &b, const txVertex &c, const txVertex &d){
+	double ab[4], bc[4], cd[4], da[4], ac[4], bd[4];
+	int ablen = TwoTwoDet(a.x, a.y, b.x, b.y, ab);
+	int bclen = TwoTwoDet(b.x, b.y, c.x, c.y, bc);
+	int cdlen = TwoTwoDet(c.x, c.y, d.x, d.y, cd);
+	int dalen = TwoTwoDet(d.x, d.y, a.x, a.y, da);
+	int aclen = TwoTwoDet(a.x, a.y, c.x, c.y, ac);
+	int bdlen = TwoTwoDet(b.x, b.y, d.x, d.y, bd);
+
+	double temp8[8], abc[12], bcd[12], cda[12], dab[12];
+	int templen = ExpansionSum(cdlen, cd, dalen, da, temp8);
+	int cdalen = ExpansionSum(templen, temp8, aclen, ac, cda);
+	templen = ExpansionSum(dalen, da, ablen, ab, temp8);
+	int dablen = ExpansionSum(templen, temp8, bdlen, bd, dab);
+	for (int i=0; i<4; i++) {
+		bd[i] = -bd[i];
+		ac[i] = -ac[i];
+	}
+	templen = ExpansionSum(ablen, ab, bclen, bc, temp8);
+	int abclen = ExpansionSum(templen, temp8, aclen, ac, abc);
+	templen = ExpansionSum(bclen, bc, cdlen, cd, temp8);
+	int bcdlen = ExpansionSum(templen, temp8, bdlen, bd, bcd);
+
+	double adet[96], bdet[96], cdet[96], ddet[96];
+	int alen = LiftedTerm(bcdlen, bcd, a, false, adet);
+	int blen = LiftedTerm(cdalen, cda, b, true, bdet);
+	int clen = LiftedTerm(dablen, dab, c, false, cdet);
+	int dlen = LiftedTerm(abclen, abc, d, true, ddet);
+
+	double abdet[192], cddet[192], deter[384];
+	int abdetlen = ExpansionSum(alen, adet, blen, bdet, abdet);
+	int cddetlen = ExpansionSum(clen, cdet, dlen, ddet, cddet);
+	int deterlen = ExpansionSum(abdetlen, abdet, cddetlen, cddet, deter);
+	return deter[deterlen-1];
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "import.h"
+#include "halfedgeprimitive.h"
+
+// Robust geometric predicates, after J. R. Shewchuk, "Adaptive Precision
+// Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+// http://www.cs.cmu.edu/~quake/robust.html
+//
+// The determinant is first evaluated in double together with a bound of its
+// rounding error. Only when the result is smaller than the bound ( nearly
+// degenerate input ) it is evaluated again with the exact expansion
+// arithmetic, so the sign is always right.
+// The exact part needs the double rounding ( SSE2, or the x87 set to 53 bits ).
+class R_DECLDIR txPredicates
+{
+public:
+	// > 0 if a, b, c are counter clockwise, < 0 if clockwise, 0 if collinear
+	static inline double Orient2d(const txVertex &a, const txVertex &b, const txVertex &c){
+		double detleft = (a.x-c.x)*(b.y-c.y);
+		double detright = (a.y-c.y)*(b.x-c.x);
+		double det = detleft - detright;
+		double detsum;
+		if ( detleft > 0.0 ) {
+			if ( detright <= 0.0 ) return det;
+			detsum = detleft + detright;
+		} else if ( detleft < 0.0 ) {
+			if ( detright >= 0.0 ) return det;
+			detsum = -detleft - detright;
+		} else {
+			return det;
+		}
+		double errbound = ccwErrBound*detsum;
+		if ( det >= errbound || -det >= errbound ) return det;
+		return Orient2dExact(a, b, c);
+	}
+
+	// > 0 if d is inside the circle through the counter clockwise a, b, c,
+	// < 0 if outside, 0 if on the circle. The sign is reversed if a, b, c
+	// are clockwise.
+	static inline double InCircle(const txVertex &a, const txVertex &b, const txVertex &c, const txVertex &d){
+		double adx = a.x-d.x, ady = a.y-d.y;
+		double bdx = b.x-d.x, bdy = b.y-d.y;
+		double cdx = c.x-d.x, cdy = c.y-d.y;
+
+		double bdxcdy = bdx*cdy, cdxbdy = cdx*bdy;
+		double alift = adx*adx + ady*ady;
+		double cdxady = cdx*ady, adxcdy = adx*cdy;
+		double blift = bdx*bdx + bdy*bdy;
+		double adxbdy = adx*bdy, bdxady = bdx*ady;
+		double clift = cdx*cdx + cdy*cdy;
+
+		double det = alift*(bdxcdy-cdxbdy) + blift*(cdxady-adxcdy) + clift*(adxbdy-bdxady);
+		double permanent = (Abs(bdxcdy)+Abs(cdxbdy))*alift
+			+ (Abs(cdxady)+Abs(adxcdy))*blift
+			+ (Abs(adxbdy)+Abs(bdxady))*clift;
+		double errbound = iccErrBound*permanent;
+		if ( det > errbound || -det > errbound ) return det;
+		return InCircleExact(a, b, c, d);
+	}
+
+	static double Orient2dExact(const txVertex &a, const txVertex &b, const txVertex &c);
+	static double InCircleExact(const txVertex &a, const txVertex &b, const txVertex &c, const txVertex &d);
+
+private:
+	static inline double Abs(double v){ return v>=0.0 ? v : -v; };
+
+	static const double ccwErrBound;
+	static const double iccErrBound;
+};
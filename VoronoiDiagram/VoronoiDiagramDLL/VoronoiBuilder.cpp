@@ -3,10 +3,11 @@
 #include <algorithm>
 #include <assert.h>
 #include <math.h>
+#include <string.h>
 #include "mesh.h"
 #include "Vec2.h"
 #include "Matrix2.h"
-#include "Matrix3.h"
+#include "Predicates.h"
 
 #define PRESISION_OF_BISECTOR 1e-7
 #define PRESISION_OF_LINEPARALELL_DETERMIN 1e-7
@@ -17,9 +18,12 @@
 txVoronoiBuilder::txVoronoiBuilder(int numOfSites)
 {
 	mesh = new txMesh(numOfSites);
+	sitesList.Reserve(numOfSites);
 	arcCount = 0;
 	eventCount = 0;
-	edgeCount = 0;
+	sweepY = 0.0;
+	breakPointCount = 0;
+	allocationCount = 0;
 }
 
 
@@ -29,42 +33,150 @@ txVoronoiBuilder::~txVoronoiBuilder(void)
 	mesh = NULL;
 }
 
+// The site events are known before the sweep, they are sorted once and
+// read in order by a cursor. Only the circle events go in the heap, the
+// next event is the higher one of the two.
+//
+// All the storage of a build is kept by the builder and only reset before
+// the next build, so building again does not allocate once the storage is
+// big enough. GetAllocationCount() tells how many times it had to grow.
 void txVoronoiBuilder::Build(){
+	size_t allocationBefore = AllocationCount();
+	breakPointCount = 0;
+	mesh->Clear((int)sitesList.Size());
 	InitialEventQueue();
-	while (!eventQueue.empty()){
-		txPriorityNode currentEvent = *(eventQueue.begin());
-		eventQueue.pop_front();
-		if (SITE_EVENT==currentEvent.eventType)
-		{
-			HandleSiteEvent(currentEvent);
+	size_t siteCursor = 0;
+	while ( siteCursor<siteOrder.Size() || !eventQueue.Empty() ){
+		bool isSiteEvent = siteCursor<siteOrder.Size();
+		if ( isSiteEvent && !eventQueue.Empty() ) {
+			// the site goes first when they are at the same y
+			isSiteEvent = sitesList[siteOrder[siteCursor]].y >= eventQueue.Top().circleBottomY;
+		}
+		if ( isSiteEvent ) {
+			txPriorityNode siteEvent(&sitesList[siteOrder[siteCursor++]], SITE_EVENT);
+			siteEvent.id = -1;
+			siteEvent.circleBottomY = siteEvent.pV->y;
+			sweepY = siteEvent.circleBottomY;
+			HandleSiteEvent(siteEvent);
 		} else {
+			txPriorityNode currentEvent = eventQueue.Top();
+			eventQueue.Pop();
+			sweepY = currentEvent.circleBottomY;
 			HandleCircleEvent(currentEvent);
 		}
-
 	}
+	allocationCount = AllocationCount() - allocationBefore;
+}
+
+void txVoronoiBuilder::Reset(){
+	sitesList.Reset();
+	siteOrder.Reset();
+	beachLine.Clear();
+	eventQueue.Clear();
+	mesh->Clear(0);
+	arcCount = 0;
+	eventCount = 0;
+	breakPointCount = 0;
+	allocationCount = 0;
+}
+
+void txVoronoiBuilder::Rebuild(const txVertex *vertices, size_t numOfSites){
+	Reset();
+	size_t allocationBefore = AllocationCount();
+	AddSites(vertices, numOfSites);
+	Build();
+	allocationCount = AllocationCount() - allocationBefore;
+}
+
+size_t txVoronoiBuilder::AllocationCount() const {
+	return mesh->AllocationCount() + eventQueue.AllocationCount() + beachLine.AllocationCount()
+		+ sitesList.AllocationCount() + siteOrder.AllocationCount() + siteKeys.AllocationCount()
+		+ swapSiteKeys.AllocationCount() + clipPx.AllocationCount() + clipPy.AllocationCount()
+		+ clipDx.AllocationCount() + clipDy.AllocationCount() + clipT0.AllocationCount()
+		+ clipT1.AllocationCount() + deadHalfEdges.AllocationCount() + boundaryPoints.AllocationCount();
 }
 
 
 void txVoronoiBuilder::InitialEventQueue(){
-	for (size_t i=0; i<sitesList.size(); i++){
-		txPriorityNode newEvent(&sitesList[i],SITE_EVENT);
-		newEvent.id = eventCount++;
-		newEvent.circleBottomY = newEvent.pV->y;
-		InsertEvent(newEvent);
+	size_t n = sitesList.Size();
+	arcCount = 0;
+	eventCount = 0;
+	beachLine.Clear();
+	eventQueue.Clear();
+	// a site event adds 3 arcs and removes 1
+	beachLine.Reserve(3*n);
+	// the circle events in the queue are at most about the number of arcs
+	eventQueue.Reserve(n);
+	SortSites();
+}
+
+// Map the double to an unsigned integer of the same order, the positive
+// ones get the sign bit set and the negative ones get all the bits flipped.
+// -0 is made 0 first, they are the same y and must be one run.
+static unsigned long long SortKey(double d){
+	d += 0.0;
+	unsigned long long bits;
+	memcpy(&bits, &d, sizeof(bits));
+	return (bits>>63) ? ~bits : (bits | 0x8000000000000000ULL);
+}
+
+// Sort the site index to the sweep order: y decrease, and x increase for
+// the same y. LSD radix sort on the y bits ( 11 bits a pass, the passes in
+// which all the keys have the same digit are skipped ), then the runs of
+// equal y are sorted by x.
+void txVoronoiBuilder::SortSites(){
+	const int RADIX_BITS = 11;
+	const int RADIX_SIZE = 1<<RADIX_BITS;
+	size_t n = sitesList.Size();
+
+	txArena<txSiteKey> &keys = siteKeys;
+	txSiteKey emptyKey = { 0, -1 };
+	keys.Resize(n, emptyKey);
+	swapSiteKeys.Resize(n, emptyKey);
+	for (size_t i=0; i<n; i++) {
+		// y decrease
+		keys[i].key = ~SortKey(sitesList[i].y);
+		keys[i].id = (int)i;
+	}
+
+	size_t bucket[RADIX_SIZE];
+	for (int shift=0; shift<64; shift+=RADIX_BITS) {
+		std::fill(bucket, bucket+RADIX_SIZE, 0);
+		for (size_t i=0; i<n; i++) {
+			bucket[(keys[i].key>>shift)&(RADIX_SIZE-1)]++;
+		}
+		if ( n==0 || bucket[(keys[0].key>>shift)&(RADIX_SIZE-1)]==n ) continue;
+		size_t sum = 0;
+		for (int b=0; b<RADIX_SIZE; b++) {
+			size_t c = bucket[b];
+			bucket[b] = sum;
+			sum += c;
+		}
+		for (size_t i=0; i<n; i++) {
+			swapSiteKeys[bucket[(keys[i].key>>shift)&(RADIX_SIZE-1)]++] = keys[i];
+		}
+		keys.Swap(swapSiteKeys);
+	}
+
+	siteOrder.Resize(n, -1);
+	for (size_t i=0; i<n; i++) {
+		siteOrder[i] = keys[i].id;
+	}
+	for (size_t i=0; i<n; ) {
+		size_t j = i+1;
+		while ( j<n && keys[j].key==keys[i].key ) j++;
+		if ( j-i>1 ) std::sort(&siteOrder[0]+i, &siteOrder[0]+j, txSiteXCmp(sitesList));
+		i = j;
 	}
 }
 
 void txVoronoiBuilder::HandleSiteEvent(const txPriorityNode &siteEvent){
-	double siteX = siteEvent.pV->x;
-	
-	UpdateBreakPointsList(siteEvent.pV->y);
-
-	// InsertArc will rtn a newArc's iterator
-	if ( beachLine.size() == 0 ) { 
+	// The break points are evaluated when InsertNewArc search the beach
+	// line, only for the arcs on the search path.
+	if ( beachLine.Empty() ) { 
 		txArc newArc(siteEvent.pV);
-		newArc.leftValue = PRECISION_INFINIT;
 		newArc.id = arcCount++;
-		beachLine.push_back(newArc); 
+		beachLine.PushBack(newArc); 
 		return;
 	}
 
@@ -77,53 +189,75 @@ void txVoronoiBuilder::HandleSiteEvent(const txPriorityNode &siteEvent){
 
 void txVoronoiBuilder::HandleCircleEvent(const txPriorityNode &circleEvent){
 	// clear this circle event or Finalized this event
-	int aLId = circleEvent.aLId;
-	int aMId = circleEvent.aMId;
-	int aRId = circleEvent.aRId;
-
-	DeleteArc(aMId);
-	RemoveCircleEventFromArc(aLId);
-	RemoveCircleEventFromArc(aRId);
-	// add the new edge from this vertex
-
+	// Only the middle arc id is trusted, the left and right arcs may have been
+	// split by a site event since this event was inserted ( the sites are
+	// the same but the arc ids are not ), so get them from the beach line.
+	BLIt mIt = GetArcFromId(circleEvent.aMId);
+	if ( mIt == -1 ) {
+		assert(true);
+		return;
+	}
+	BLIt lIt = beachLine.Prev(mIt);
+	BLIt rIt = beachLine.Next(mIt);
+	// the middle arc always has both neighbours, or it won't converge
+	assert(lIt != -1 && rIt != -1);
+
+	// The left and right arc circle events contain the middle arc
+	// they are false alarm now.
+	CancelCircleEvent(lIt);
+	CancelCircleEvent(rIt);
+
+	// The two break points of the middle arc meet at the circle center,
+	// which is a Voronoi vertex. Both edges end here and the two halfedges
+	// of the middle arc face are joined.
+	int vertexId = mesh->AddVertex(circleEvent.center);
+	txArc &l = beachLine.Arc(lIt);
+	txArc &m = beachLine.Arc(mIt);
+	txArc &r = beachLine.Arc(rIt);
+	mesh->HalfEdge(m.leftHalfEdgeId).vertexId = vertexId;
+	mesh->HalfEdge(r.leftHalfEdgeId).vertexId = vertexId;
+	mesh->Link(m.leftHalfEdgeId, m.rightHalfEdgeId);
+	int lPreId = l.rightHalfEdgeId;   // start from the vertex
+	int rNextId = r.leftHalfEdgeId;   // end at the vertex
+
+	m.PQId = -1;
+	r.pLV = m.pLV;
+	beachLine.Erase(mIt);
+
+	// add the new edge from this vertex, traced by the new break point
+	// of the left and right arc
+	AddEdge(lIt, rIt);
+	mesh->HalfEdge(l.rightHalfEdgeId).vertexId = vertexId;
+	mesh->Link(l.rightHalfEdgeId, lPreId);
+	mesh->Link(rNextId, r.leftHalfEdgeId);
+
+	// The left and right arc become neighbours, check the new triples
+	BLIt llIt = beachLine.Prev(lIt);
+	BLIt rrIt = beachLine.Next(rIt);
+	if ( llIt != -1 ) AddCircleEvent(llIt, lIt, rIt);
+	if ( rrIt != -1 ) AddCircleEvent(lIt, rIt, rrIt);
 }
 
 // When the arc related circel event be delete
 // Anything else we must do ?
 // This question leave to the handl circle event.
+// The event queue keep the position of each event id, 
+// so no need to walk the queue to find it.
 void txVoronoiBuilder::DeleteCircleEvent(int circleId){
-	PQIt eraseIt = eventQueue.begin();
-	while (eraseIt!=eventQueue.end()) {
-		if (eraseIt->id == circleId) break;
-		eraseIt++;
-	}
-	if ( eraseIt == eventQueue.end() ) { 
+	if ( !eventQueue.Erase(circleId) ) { 
 		// If this assert being trigged the insert circle event is wrong
 		// And may this utility function be wrong called!
 		assert(true);
 		return ;
 	}
-	eventQueue.erase(eraseIt);
 }
 
 void txVoronoiBuilder::InsertEvent(const txPriorityNode &pevent){
-	if (!eventQueue.size()) {
-		eventQueue.push_back(pevent);
-		return;
-	}
-	PQIt insert = eventQueue.begin();
-	while (insert!=eventQueue.end()) {
-		if (pevent.circleBottomY>insert->circleBottomY) break;
-		insert++;
-	}
-	std::list<txPriorityNode> insertlist;
-	insertlist.push_back(pevent);
-	eventQueue.insert(insert,insertlist.begin(),insertlist.end());
+	eventQueue.Push(pevent);
 }
 
 void txVoronoiBuilder::Bisector(const txVertex &v0, const txVertex &v1, txEdge &edge){
-	double detv01 = (v0.x-v1.x)*(v0.x-v1.x)+(v0.y-v1.y)*(v0.y-v1.y);
-	assert(abs(detv01)>PRESISION_OF_BISECTOR);  // check if identical at precision 
+	assert((v0.x-v1.x)*(v0.x-v1.x)+(v0.y-v1.y)*(v0.y-v1.y)>PRESISION_OF_BISECTOR);  // check if identical at precision 
 	double nx = v0.x-v1.x;
 	double ny = v0.y-v1.y;
 	edge.a = nx;
@@ -132,6 +266,11 @@ void txVoronoiBuilder::Bisector(const txVertex &v0, const txVertex &v1, txEdge &
 }
 
 void txVoronoiBuilder::Circle(const txVertex &n0, const txVertex &n1, const txVertex &n2, double &y){
+	txVertex center;
+	Circle(n0, n1, n2, center, y);
+}
+
+void txVoronoiBuilder::Circle(const txVertex &n0, const txVertex &n1, const txVertex &n2, txVertex &center, double &y){
 	txEdge e0;
 	txEdge e1;
 	Bisector(n0,n1,e0);
@@ -145,109 +284,58 @@ void txVoronoiBuilder::Circle(const txVertex &n0, const txVertex &n1, const txVe
 	double centerY = resultv.Y();
 	double radius = sqrt( (n0.x-centerX)*(n0.x-centerX)+(n0.y-centerY)*(n0.y-centerY) );
 
+	center.x = centerX;
+	center.y = centerY;
 	y = centerY - radius;
 }
 
 
-// Insert the arc as the x coordinate increase!
-// The arc in list is ordered in increase order.
-// So the arc.leftValue "<" ...
-// Insert a new arc will lead one old arc split to two arc
-// FIXME!!!
-void txVoronoiBuilder::InserteArc(const txArc &arc){
-	BLIt rtn;
-	for ( rtn=beachLine.begin(); rtn!=beachLine.end(); rtn++ ) {
-		if ( arc.leftValue < rtn->leftValue ) { 
-			break;
-		}
-	} 
-	BLList tempList;
-	tempList.push_back(arc);
+bool txVoronoiBuilder::GetTripleAsLeft(BLIt middle, BLIt &l, BLIt &ll){
+	if ( middle==-1 ) return false;
+	l = beachLine.Prev(middle);
+	if ( l==-1 ) return false;
+	ll = beachLine.Prev(l);
+	return ll!=-1;
+}
 
-	beachLine.insert(rtn, tempList.begin(), tempList.end());
-	// check if rtn validate after the list have been updated
-	// OK rtn is invalidate!
+bool txVoronoiBuilder::GetTripleAsRight(BLIt middle, BLIt &r, BLIt &rr){
+	if ( middle==-1 ) return false;
+	r = beachLine.Next(middle);
+	if ( r==-1 ) return false;
+	rr = beachLine.Next(r);
+	return rr!=-1;
 }
 
-BLIt txVoronoiBuilder::GetArcIterator(const txArc &arc){
-	for ( BLIt it = beachLine.begin(); it!=beachLine.end(); it++ ) {
-		if ( arc.id == it->id ) return it;
+// The break point of the left arc ( site l ) and the right arc ( site r )
+// when the sweep line is at ly.
+// The parabolas intersect twice, the higher site has the wider parabola so
+// it is the outside one: if l is higher the break point is the left
+// intersection, otherwise the right one.
+// A site on the sweep line is a degenerate parabola ( vertical ray ), the
+// break point is just its x.
+double txVoronoiBuilder::BreakPoint(const txVertex &l, const txVertex &r, double ly){
+	bool lDegenerate = l.y-ly <= PRESISION_OF_PARABOLA_INTERSECTION;
+	bool rDegenerate = r.y-ly <= PRESISION_OF_PARABOLA_INTERSECTION;
+	if ( lDegenerate && rDegenerate ) return 0.5*(l.x+r.x);
+	if ( lDegenerate ) return l.x;
+	if ( rDegenerate ) return r.x;
+	if ( fabs(l.y-r.y) <= PRESISION_OF_PARABOLA_INTERSECTION ) {
+		return 0.5*(l.x+r.x);
 	}
-	return beachLine.end();
-}
 
-bool txVoronoiBuilder::GetTripleAsLeft(BLIt middle, BLIt &l, BLIt &ll){
-	l=middle;
-	if ( middle==beachLine.begin() ) return false;
-	middle--;
-	if ( middle==beachLine.begin() ) return false;
-	middle--;
-	if ( middle==beachLine.begin() ) return false;
-	l--;
-	ll = l;
-	ll--;
-	return true;
-}
-
-bool txVoronoiBuilder::GetTripleAsMiddle(BLIt middle, BLIt &l, BLIt &r){
-	l=r=middle;
-	if ( middle==beachLine.begin() )  return false;
-	middle++;
-	if ( middle==beachLine.end() ) return false;
-	l--;
-	r++;
-	return true;
+	txVertex v0;
+	txVertex v1;
+	txParabolaIntersectionType type;
+	CalculateTwoParabolaIntersectionPoints(l, r, ly, ly, v0, v1, type);
+	return l.y > r.y ? v0.x : v1.x;
 }
 
-bool txVoronoiBuilder::GetTripleAsRight(BLIt middle, BLIt &r, BLIt &rr){
-	r = middle;
-	if ( middle==beachLine.end() ) return false;
-	middle++;
-	if ( middle==beachLine.end() ) return false;
-	middle++;
-	if ( middle==beachLine.end() )   return false;
-	r++;
-	rr=r;
-	rr++;
-	return true;
-}
-
-// call the following functin when comes to new site event.
-// new site event wont change the arc topology
-// Only the Circle event will.
-// guess what the arc will not be 2! so check 2 is unecessary!
-
-// buggies!!!
-// The following update code is detected to have 2 faults
-// The first the when the blit is the back of list,
-// the next == end() which will cause a dereference failure.
-// The second the update break point is not right. 
-// Does it have a methods that use the edge (trace point or called breakpoint interchangely)
-// to Update these leftvalues?
-void txVoronoiBuilder::UpdateBreakPointsList(double bottomY){
-	BLIt blit = beachLine.begin();
-	if ( blit == beachLine.end() ) return;
-	blit++; // first arc need not to be updated see the txArc structure definatio
-	while (blit!=beachLine.end()) {
-		BLIt pre, next; pre=next=blit;
-		pre--,next++;
-		txVertex v0;
-		txVertex v1;
-		txParabolaIntersectionType type;
-		CalculateTwoParabolaIntersectionPoints(*pre->pV,*blit->pV,bottomY, bottomY, v0, v1, type);
-		assert(type==PARABOLA_INTECT_TWO);
-		// check if the pre and nex arc are belong to the same site (parabola)
-		if ( pre->pV==next->pV ) {
-			blit->leftValue = v0.x;
-			next->leftValue = v1.x;
-			blit++;blit++; // skip the next arc cause we have already calculated the next one in this step
-			               // be more carefull to the ++!!!
-		} else {
-			// let the left arc intersect with the middle pick the maximum value
-			blit->leftValue = v1.x;
-			blit++;
-		}
-	}
+// The left break point of the arc at the current sweep line
+double txVoronoiBuilder::LeftBreakPoint(BLIt arcIt){
+	const txArc &arc = beachLine.Arc(arcIt);
+	if ( arc.pLV == NULL ) return PRECISION_INFINIT;
+	breakPointCount++;
+	return BreakPoint(*arc.pLV, *arc.pV, sweepY);
 }
 
 // keep the v0.x < v1.x
@@ -287,31 +375,25 @@ void txVoronoiBuilder::CalculateTwoParabolaIntersectionPoints(const txVertex &p0
 	
 }
 
-void txVoronoiBuilder::InsertEdge(const txEdge &edge){
-	edgeList.push_back(edge);
+// Create the edge traced by the break point between the two neighbour arcs
+void txVoronoiBuilder::AddEdge(BLIt lIt, BLIt rIt){
+	txArc &l = beachLine.Arc(lIt);
+	txArc &r = beachLine.Arc(rIt);
+	int halfEdgeId = mesh->AddEdge(SiteId(l.pV), SiteId(r.pV));
+	l.rightHalfEdgeId = halfEdgeId;
+	r.leftHalfEdgeId = mesh->HalfEdge(halfEdgeId).twinId;
 }
 
 // Since the left mose arc value is always the -INFINITE 
-// so it is safe for rtnIt--;
+// there is always an arc above x.
 int txVoronoiBuilder::GetUpperArcId(double x){
-	int rtn = -1;
-	BLIt rtnIt;
-	for (BLIt it=beachLine.begin(); it!=beachLine.end(); it++) {
-		if ( x < it->leftValue ) {
-			rtnIt = it;
-			rtnIt--;
-			rtn = rtnIt->id;
-			break;
-		}
-	}
-	if ( -1 == rtn ) {
-		rtn = beachLine.back().id;
-	}
-	return rtn;
+	txBreakPointKey key = { this };
+	BLIt rtnIt = beachLine.Locate(x, key);
+	assert(rtnIt!=-1);
+	return beachLine.Arc(rtnIt).id;
 }
 
-// doesn't like the InserteArc function 
-// It will 
+// Insert the arc of the new site, it will
 // 1)insert the degenerate parabola ( vertical line )
 // 2)delete the upper arc and 
 // 3)create two new arc based on the delete arc
@@ -320,52 +402,101 @@ int txVoronoiBuilder::InsertNewArc(const txPriorityNode &siteEvent) {
 	int upperArcId = GetUpperArcId(siteX);
 	BLIt upperArcIt = GetArcFromId(upperArcId);
 	// check if the upperArc doesn't exists
-	assert(upperArcIt!=beachLine.end());
+	assert(upperArcIt!=-1);
+	const txArc &upperArc = beachLine.Arc(upperArcIt);
 	txArc newArc(siteEvent.pV);
-	newArc.leftValue = siteX;
 	newArc.id = arcCount++;
 
-	txArc leftArc(upperArcIt->pV);
-	leftArc.leftValue = upperArcIt->leftValue;
+	// The upper arc is still a vertical ray, which only happens when the
+	// first sites share the same y. Nothing to split, the new arc goes
+	// beside it. The sites of exactly the same y come from left to right
+	// ( see SortSites ), but the ones only within the precision may come
+	// in any x order, so it can be either side.
+	if ( upperArc.pV->y-siteEvent.pV->y <= PRESISION_OF_PARABOLA_INTERSECTION ) {
+		if ( siteX > upperArc.pV->x ) {
+			InsertRayArc(upperArcIt, beachLine.Next(upperArcIt), newArc);
+		} else {
+			InsertRayArc(beachLine.Prev(upperArcIt), upperArcIt, newArc);
+		}
+		return newArc.id;
+	}
+	newArc.pLV = upperArc.pV;
+
+	txArc leftArc(upperArc.pV);
+	leftArc.pLV = upperArc.pLV;
 	leftArc.id = arcCount++;
 
-	txArc rightArc(upperArcIt->pV);
-	rightArc.leftValue = siteX;
+	// the arc right to the upper arc keep its pLV, it's the same site
+	txArc rightArc(upperArc.pV);
+	rightArc.pLV = siteEvent.pV;
 	rightArc.id = arcCount++;
 
-	// Insert new edge
-	txEdge edge;
-	edge.pLSite = upperArcIt->pV;
-	edge.pRSite = siteEvent.pV;
-	edge.id = edgeCount++;
-
-	// Assign the edge id to the arc 
-	newArc.edgeId = edge.id;
+	// Insert new edge, both break points of the new arc trace it
+	// ( in the opposite directions )
+	int halfEdgeId = mesh->AddEdge(SiteId(upperArc.pV), SiteId(siteEvent.pV));
+	int twinId = mesh->HalfEdge(halfEdgeId).twinId;
+	leftArc.leftHalfEdgeId = upperArc.leftHalfEdgeId;
+	leftArc.rightHalfEdgeId = halfEdgeId;
+	newArc.leftHalfEdgeId = twinId;
+	newArc.rightHalfEdgeId = twinId;
+	rightArc.leftHalfEdgeId = halfEdgeId;
+	rightArc.rightHalfEdgeId = upperArc.rightHalfEdgeId;
 
-	BLList tempList;
-	tempList.push_back(leftArc);
-	tempList.push_back(newArc);
-	tempList.push_back(rightArc);
-	// Insert the newly created 3 arcs
-	beachLine.insert(upperArcIt, tempList.begin(), tempList.end());
 	// Delete the old arc ( the upper arc )
 	// Befor erase the upper arc we should check to see if it contains the circle event
-	// And this may contain one circle events, It may contain more than one circle event
+	// The upper arc is the middle arc of at most one circle event
 	// If it contain the circle event then this event is false alarm circle event
-	DeleteCircleEvent(upperArcIt->PQId);
+	DeleteCircleEvent(upperArc.PQId);
 
-	beachLine.erase(upperArcIt);
+	// Insert the newly created 3 arcs
+	beachLine.InsertBefore(upperArcIt, leftArc);
+	beachLine.InsertBefore(upperArcIt, newArc);
+	beachLine.InsertBefore(upperArcIt, rightArc);
+	beachLine.Erase(upperArcIt);
 	
 	return newArc.id;
 
 }
 
-BLIt txVoronoiBuilder::GetArcFromId(int id) {
-	for (BLIt it=beachLine.begin(); it!=beachLine.end(); it++ ) {
-		if ( it->id == id ) return it;
+// Put the new arc between the two rays lIt and rIt ( one of them may be
+// -1 ). They are neighbours no more, their edge becomes the edge of the
+// new arc and rIt, and a new edge is added between lIt and the new arc.
+void txVoronoiBuilder::InsertRayArc(BLIt lIt, BLIt rIt, txArc &newArc){
+	int newFaceId = SiteId(newArc.pV);
+	if ( rIt != -1 ) {
+		CancelCircleEvent(rIt);
+		txArc &r = beachLine.Arc(rIt);
+		newArc.pLV = r.pLV;
+		r.pLV = newArc.pV;
+		if ( lIt != -1 ) {
+			// the left halfedge of the edge now belongs to the new face
+			int halfEdgeId = r.leftHalfEdgeId;
+			int twinId = mesh->HalfEdge(halfEdgeId).twinId;
+			int lFaceId = mesh->HalfEdge(twinId).faceId;
+			mesh->HalfEdge(twinId).faceId = newFaceId;
+			if ( mesh->Face(lFaceId).halfEdgeId == twinId ) mesh->Face(lFaceId).halfEdgeId = -1;
+			if ( mesh->Face(newFaceId).halfEdgeId == -1 ) mesh->Face(newFaceId).halfEdgeId = twinId;
+			newArc.rightHalfEdgeId = twinId;
+		}
+	} else {
+		newArc.pLV = beachLine.Arc(lIt).pV;
+	}
+
+	BLIt newArcIt;
+	if ( lIt != -1 ) {
+		CancelCircleEvent(lIt);
+		newArcIt = beachLine.InsertAfter(lIt, newArc);
+		AddEdge(lIt, newArcIt);
+	} else {
+		newArcIt = beachLine.InsertBefore(rIt, newArc);
+	}
+	if ( rIt != -1 && beachLine.Arc(newArcIt).rightHalfEdgeId == -1 ) {
+		AddEdge(newArcIt, rIt);
 	}
+}
 
-	return beachLine.end();
+BLIt txVoronoiBuilder::GetArcFromId(int id) {
+	return beachLine.Find(id);
 }
 
 // input the newly insert arc id
@@ -375,57 +506,47 @@ BLIt txVoronoiBuilder::GetArcFromId(int id) {
 void txVoronoiBuilder::CheckCircleEvent(int newArcId) {
 	BLIt newArcIt = GetArcFromId(newArcId);
 	BLIt l,ll,r,rr;
-	l=newArcIt;
-	ll=newArcIt;
-	r=newArcIt;
-	rr=newArcIt;
-	if ( l != beachLine.begin() ) {
-		l--;
-		ll = l;
-		if ( l != beachLine.begin() ) {
-			ll--;
-			// check the left tripple
-			AddCircleEvent(ll, l, newArcIt);
-		}
+	if ( GetTripleAsLeft(newArcIt, l, ll) ) {
+		// check the left tripple
+		AddCircleEvent(ll, l, newArcIt);
 	}
 
-	if ( r++ != beachLine.end() ) {
-		rr = r;
-		if ( rr++ != beachLine.end() ) {
-			if ( rr != beachLine.end() ) {
-				// check the right tripple 
-				AddCircleEvent(newArcIt, r, rr);
-			}
-		}
+	if ( GetTripleAsRight(newArcIt, r, rr) ) {
+		// check the right tripple 
+		AddCircleEvent(newArcIt, r, rr);
 	}
-	
+
 }
 
 
 void txVoronoiBuilder::AddCircleEvent(BLIt lIt, BLIt mIt, BLIt rIt) {
 	// First check if the three arc ( the VD site ) truely compose a
 	// circle event, I just omit it 
-	bool isCircle = true;
 	double bottomY;
 	//bool isConverge = true;
-	if ( PointOrientationChecking(*lIt->pV, *mIt->pV, *rIt->pV) == P_ORIENTATION_RIGHT ) {
-		Circle(*lIt->pV, *mIt->pV, *rIt->pV, bottomY);
+	txArc &l = beachLine.Arc(lIt);
+	txArc &m = beachLine.Arc(mIt);
+	txArc &r = beachLine.Arc(rIt);
+	if ( PointOrientationChecking(*l.pV, *m.pV, *r.pV) == P_ORIENTATION_RIGHT ) {
+		txVertex center;
+		Circle(*l.pV, *m.pV, *r.pV, center, bottomY);
 
 		txPriorityNode circleEvent(NULL,CIRCLE_EVENT);
 		circleEvent.id = eventCount++;
 		circleEvent.circleBottomY = bottomY;
+		circleEvent.center = center;
 
-		// assign the circle event id to the triple
-		lIt->PQId = circleEvent.id;
-		mIt->PQId = circleEvent.id;
-		rIt->PQId = circleEvent.id;
+		// assign the circle event id to the middle arc, the arc
+		// which will disappear
+		CancelCircleEvent(mIt);
+		m.PQId = circleEvent.id;
 
 		// assign the triple to the circle event
 		// this is used to delete the middle arc
 		// and identify the idential triples
-		circleEvent.aLId = lIt->id;
-		circleEvent.aMId = mIt->id;
-		circleEvent.aRId = rIt->id;
+		circleEvent.aLId = l.id;
+		circleEvent.aMId = m.id;
+		circleEvent.aRId = r.id;
 
 		InsertEvent(circleEvent);
 
@@ -438,10 +559,10 @@ void txVoronoiBuilder::AddCircleEvent(BLIt lIt, BLIt mIt, BLIt rIt) {
 // http://www-ma2.upc.es/~geoc/indexEN.html#Dibuixador
 //  +Orientation tests
 // Point line Orientation http://www.cs.cmu.edu/~quake/robust.html
-// Not Always right!
+// The filtered predicate is exact, the nearly collinear sites won't get
+// the wrong side.
 PointOrientationType txVoronoiBuilder::PointOrientationChecking(const txVertex &v0, const txVertex &v1, const txVertex &v2) {
-	txMatrix3 m(v0.x, v1.x, v2.x, v0.y, v1.y, v2.y, 1, 1, 1);
-	double det = m.Determinant();
+	double det = txPredicates::Orient2d(v0, v1, v2);
 
 	if ( det > 0 ) {
 		return P_ORIENTATION_LEFT;
@@ -453,24 +574,253 @@ PointOrientationType txVoronoiBuilder::PointOrientationChecking(const txVertex &
 }
 
 
-void txVoronoiBuilder::RemoveCircleEventFromArc(int arcId) {
-	BLIt arcIt = GetArcFromId(arcId);
-	arcIt->PQId = -1;
+// Delete the circle event in which the arc is the middle one
+void txVoronoiBuilder::CancelCircleEvent(BLIt arcIt) {
+	txArc &arc = beachLine.Arc(arcIt);
+	if ( arc.PQId == -1 ) return;
+	DeleteCircleEvent(arc.PQId);
+	arc.PQId = -1;
+}
+
+
+
+void txVoronoiBuilder::Clip(const txBox &box){
+	size_t allocationBefore = AllocationCount();
+	for (int c=0; c<4; c++) cornerIds[c] = -1;
+	ClipEdges(box);
+	CloseCells(box);
+	// the box edges are all alive
+	deadHalfEdges.Resize(mesh->NumOfHalfEdges(), 0);
+	mesh->Compact(deadHalfEdges.Empty() ? NULL : &deadHalfEdges[0]);
+	allocationCount += AllocationCount() - allocationBefore;
+}
+
+// Cut the face loop after / before the halfedge
+static void CutAfter(txMesh &mesh, int h){
+	txHalfEdge &halfEdge = mesh.HalfEdge(h);
+	if ( halfEdge.nextId != -1 ) mesh.HalfEdge(halfEdge.nextId).preId = -1;
+	halfEdge.nextId = -1;
+}
+
+static void CutBefore(txMesh &mesh, int h){
+	txHalfEdge &halfEdge = mesh.HalfEdge(h);
+	if ( halfEdge.preId != -1 ) mesh.HalfEdge(halfEdge.preId).nextId = -1;
+	halfEdge.preId = -1;
 }
 
+static txVertex PointInBox(const txBox &box, double x, double y){
+	txVertex v;
+	v.x = x<box.minX ? box.minX : (x>box.maxX ? box.maxX : x);
+	v.y = y<box.minY ? box.minY : (y>box.maxY ? box.maxY : y);
+	return v;
+}
 
-void txVoronoiBuilder::DeleteArc( int arcId ) {
-	BLIt eraseIt = beachLine.end();
-	for ( BLIt it = beachLine.begin(); it != beachLine.end(); it++ ) {
-		if ( arcId == it->id ) {
-			eraseIt = it;
+// Every edge ( the even halfedge of the pair ) is put as a line, segment
+// or ray on its bisector and clipped in one batch. The clipped ends get
+// the new vertices on the box, the face loops are cut there.
+void txVoronoiBuilder::ClipEdges(const txBox &box){
+	int numOfEdges = mesh->NumOfHalfEdges()/2;
+	clipPx.Resize(numOfEdges, 0.0);
+	clipPy.Resize(numOfEdges, 0.0);
+	clipDx.Resize(numOfEdges, 0.0);
+	clipDy.Resize(numOfEdges, 0.0);
+	clipT0.Resize(numOfEdges, 0.0);
+	clipT1.Resize(numOfEdges, 0.0);
+	deadHalfEdges.Reset();
+	deadHalfEdges.Resize(2*numOfEdges, 0);
+	if ( numOfEdges==0 ) return;
+
+	for (int e=0; e<numOfEdges; e++) {
+		const txHalfEdge &halfEdge = mesh->HalfEdge(2*e);
+		const txHalfEdge &twin = mesh->HalfEdge(2*e+1);
+		int originId = twin.vertexId;
+		int destId = halfEdge.vertexId;
+		// The box edges of a previous Clip() have the face -1 on one side,
+		// they are segments and the sites are only needed for the rays and
+		// the lines.
+		if ( originId!=-1 && destId!=-1 ) {
+			const txVertex &origin = mesh->Vertex(originId);
+			const txVertex &dest = mesh->Vertex(destId);
+			clipPx[e] = origin.x;
+			clipPy[e] = origin.y;
+			clipDx[e] = dest.x-origin.x;
+			clipDy[e] = dest.y-origin.y;
+			clipT0[e] = 0.0;
+			clipT1[e] = 1.0;
+			continue;
+		}
+		// along the bisector, with the face of the halfedge on the left
+		const txVertex &lSite = sitesList[halfEdge.faceId];
+		const txVertex &rSite = sitesList[twin.faceId];
+		clipDx[e] = lSite.y-rSite.y;
+		clipDy[e] = rSite.x-lSite.x;
+		if ( originId!=-1 ) {
+			clipPx[e] = mesh->Vertex(originId).x;
+			clipPy[e] = mesh->Vertex(originId).y;
+			clipT0[e] = 0.0;
+			clipT1[e] = HUGE_VAL;
+		} else if ( destId!=-1 ) {
+			clipPx[e] = mesh->Vertex(destId).x;
+			clipPy[e] = mesh->Vertex(destId).y;
+			clipT0[e] = -HUGE_VAL;
+			clipT1[e] = 0.0;
+		} else {
+			clipPx[e] = 0.5*(lSite.x+rSite.x);
+			clipPy[e] = 0.5*(lSite.y+rSite.y);
+			clipT0[e] = -HUGE_VAL;
+			clipT1[e] = HUGE_VAL;
 		}
 	}
-	if ( eraseIt != beachLine.end() ) {
-		beachLine.erase(eraseIt);
-	} else {
-		assert(true);
-		return;
+
+	txEdgeClip::ClipLines(numOfEdges, &clipPx[0], &clipPy[0], &clipDx[0], &clipDy[0], &clipT0[0], &clipT1[0], box);
+
+	for (int e=0; e<numOfEdges; e++) {
+		int h = 2*e;
+		int twinId = 2*e+1;
+		double t0 = clipT0[e];
+		double t1 = clipT1[e];
+		if ( !(t0<t1) ) {
+			deadHalfEdges[h] = 1;
+			deadHalfEdges[twinId] = 1;
+			CutAfter(*mesh, h);
+			CutBefore(*mesh, h);
+			CutAfter(*mesh, twinId);
+			CutBefore(*mesh, twinId);
+			continue;
+		}
+		int originId = mesh->HalfEdge(twinId).vertexId;
+		int destId = mesh->HalfEdge(h).vertexId;
+		// the origin is at t=0, the dest is at t=1 for the segment and t=0
+		// for the ray coming from the infinite
+		double destT = originId!=-1 ? 1.0 : 0.0;
+		if ( destId==-1 || t1<destT ) {
+			int v = mesh->AddVertex(PointInBox(box, clipPx[e]+t1*clipDx[e], clipPy[e]+t1*clipDy[e]));
+			mesh->HalfEdge(h).vertexId = v;
+			CutAfter(*mesh, h);
+			CutBefore(*mesh, twinId);
+		}
+		if ( originId==-1 || t0>0.0 ) {
+			int v = mesh->AddVertex(PointInBox(box, clipPx[e]+t0*clipDx[e], clipPy[e]+t0*clipDy[e]));
+			mesh->HalfEdge(twinId).vertexId = v;
+			CutAfter(*mesh, twinId);
+			CutBefore(*mesh, h);
+		}
 	}
 }
 
+static bool BoundaryPointCmp(const txBoundaryPoint &l, const txBoundaryPoint &r){
+	return l.faceId < r.faceId;
+}
+
+// The cell leaves the box where its loop is cut and comes back at the next
+// cut along the box boundary counter clockwise ( the cell and the box are
+// both convex ), which is closed by the box edges and corners.
+void txVoronoiBuilder::CloseCells(const txBox &box){
+	int numOfHalfEdges = mesh->NumOfHalfEdges();
+	for (int f=0; f<mesh->NumOfFaces(); f++) {
+		mesh->Face(f).halfEdgeId = -1;
+	}
+
+	txArena<txBoundaryPoint> &points = boundaryPoints;
+	points.Reset();
+	for (int h=0; h<numOfHalfEdges; h++) {
+		if ( deadHalfEdges[h] ) continue;
+		const txHalfEdge &halfEdge = mesh->HalfEdge(h);
+		// the outside of the box edges of a previous Clip()
+		if ( halfEdge.faceId<0 ) continue;
+		if ( mesh->Face(halfEdge.faceId).halfEdgeId == -1 ) mesh->Face(halfEdge.faceId).halfEdgeId = h;
+		if ( halfEdge.nextId == -1 ) {
+			const txVertex &v = mesh->Vertex(halfEdge.vertexId);
+			txBoundaryPoint point = { halfEdge.faceId, h, txEdgeClip::BoundaryPosition(box, v.x, v.y), true };
+			points.Push(point);
+		}
+		if ( halfEdge.preId == -1 ) {
+			const txVertex &v = mesh->Vertex(mesh->HalfEdge(halfEdge.twinId).vertexId);
+			txBoundaryPoint point = { halfEdge.faceId, h, txEdgeClip::BoundaryPosition(box, v.x, v.y), false };
+			points.Push(point);
+		}
+	}
+	if ( !points.Empty() ) std::sort(&points[0], &points[0]+points.Size(), BoundaryPointCmp);
+
+	for (size_t i=0; i<points.Size(); ) {
+		size_t j = i;
+		while ( j<points.Size() && points[j].faceId==points[i].faceId ) j++;
+		for (size_t k=i; k<j; k++) {
+			if ( !points[k].isExit ) continue;
+			// the first entry counter clockwise
+			double sExit = points[k].s;
+			double bestDistance = 5.0;
+			int entryId = -1;
+			for (size_t m=i; m<j; m++) {
+				if ( points[m].isExit ) continue;
+				double distance = points[m].s-sExit;
+				if ( distance<0.0 ) distance += 4.0;
+				// the same point with the rounding error
+				if ( distance>4.0-1e-9 ) distance = 0.0;
+				if ( distance<bestDistance ) {
+					bestDistance = distance;
+					entryId = points[m].halfEdgeId;
+				}
+			}
+			assert(entryId!=-1);
+			if ( entryId==-1 ) continue;
+
+			int faceId = points[k].faceId;
+			int preId = points[k].halfEdgeId;
+			int fromId = mesh->HalfEdge(preId).vertexId;
+			int toId = mesh->HalfEdge(mesh->HalfEdge(entryId).twinId).vertexId;
+			double sEnd = sExit+bestDistance;
+			for (int corner=(int)floor(sExit)+1; corner<sEnd; corner++) {
+				int cornerId = BoxCorner(box, corner%4);
+				preId = AddBoxEdge(faceId, preId, fromId, cornerId);
+				fromId = cornerId;
+			}
+			if ( fromId!=toId ) preId = AddBoxEdge(faceId, preId, fromId, toId);
+			mesh->Link(preId, entryId);
+		}
+		i = j;
+	}
+
+	// No edge in the box, the box may be all in one cell, which is the
+	// cell of the site nearest to the box center.
+	if ( sitesList.Empty() ) return;
+	double cx = 0.5*(box.minX+box.maxX);
+	double cy = 0.5*(box.minY+box.maxY);
+	int nearest = 0;
+	double nearestDistance = HUGE_VAL;
+	for (int i=0; i<(int)sitesList.Size(); i++) {
+		double distance = (sitesList[i].x-cx)*(sitesList[i].x-cx)+(sitesList[i].y-cy)*(sitesList[i].y-cy);
+		if ( distance<nearestDistance ) {
+			nearestDistance = distance;
+			nearest = i;
+		}
+	}
+	if ( mesh->Face(nearest).halfEdgeId != -1 ) return;
+	int firstId = -1;
+	int preId = -1;
+	for (int corner=0; corner<4; corner++) {
+		preId = AddBoxEdge(nearest, preId, BoxCorner(box, corner), BoxCorner(box, (corner+1)%4));
+		if ( firstId==-1 ) firstId = preId;
+	}
+	mesh->Link(preId, firstId);
+	mesh->Face(nearest).halfEdgeId = firstId;
+}
+
+int txVoronoiBuilder::BoxCorner(const txBox &box, int corner){
+	if ( cornerIds[corner] == -1 ) {
+		txVertex v;
+		v.x = ( corner==1 || corner==2 ) ? box.maxX : box.minX;
+		v.y = ( corner==2 || corner==3 ) ? box.maxY : box.minY;
+		cornerIds[corner] = mesh->AddVertex(v);
+	}
+	return cornerIds[corner];
+}
+
+// The edge along the box boundary, the other side is the outside ( -1 )
+int txVoronoiBuilder::AddBoxEdge(int faceId, int preId, int fromId, int toId){
+	int h = mesh->AddEdge(faceId, -1);
+	mesh->HalfEdge(h).vertexId = toId;
+	mesh->HalfEdge(mesh->HalfEdge(h).twinId).vertexId = fromId;
+	if ( preId != -1 ) mesh->Link(preId, h);
+	return h;
+}
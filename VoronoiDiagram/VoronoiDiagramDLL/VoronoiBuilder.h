@@ -1,11 +1,11 @@
 #pragma once
 #include <vector>
-#include <queue>
 #include <stdlib.h>
-#include <list>
-#include <map>
 #include "import.h"
 #include "halfedgeprimitive.h"
+#include "IndexedHeap.h"
+#include "BeachLine.h"
+#include "EdgeClip.h"
 
 #define PRECISION_INFINIT -1e20
 
@@ -21,11 +21,6 @@ typedef enum txVoronoiEventType{
 	CIRCLE_EVENT,
 } txVoronoiEventType;
 
-typedef struct txBreakPoint{
-	int        id;
-	txVertex   v;
-} txBreakPoint;
-
 typedef enum PointOrientationType{
 	P_ORIENTATION_LEFT,
 	P_ORIENTATION_RIGHT,
@@ -44,30 +39,32 @@ typedef enum txParabolaIntersectionType{
 
 typedef struct txArc{
 	int             id;
-	// The interval right value is the pre node left value
-	// If the pre node is NULL then it's set to PRECISION_INFINIT this value 
-	// will be changed to the bounding box
-	// The last one will be set to +PRECISION_INFINIT which will be changed to 
-	// the bounding box value too.
+	// The break points are not stored, they move with the sweep line.
+	// The left break point is evaluated on demand from the site of the
+	// left neighbour ( pLV ) and this site at the current sweep y, so the
+	// arc only has to know who is on its left. pLV is NULL for the leftmost
+	// arc, whose interval starts at -Infinite.
 	// meaning leftmost:[-Infinite,l0]  |   1[l0,l1]   |    2[l1,l2] ...  [ln,+Infinite]
-	// when call the breakpoints update function the leftmost will never be updated!
-	// cause it is always -Infinite
-	double          leftValue;   
 	txVertex        *pV;
+	txVertex        *pLV;  // the site of the left neighbour arc
 	//txPriorityNode  *circleEvent;
+	// The circle event in which this arc is the middle one ( the one will
+	// disappear ), -1 if there is none. An arc can only disappear once, so
+	// one id is enough.
 	int             PQId;
-	//int             leftBPId;
-	//int             rightBPId;
-	int             edgeId;
-	txArc(txVertex *pV_):pV(pV_),PQId(-1),edgeId(-1){};
+	// The halfedges ( in the face of this site ) traced by the left and
+	// right break points of the arc, -1 if there is no neighbour yet.
+	int             leftHalfEdgeId;
+	int             rightHalfEdgeId;
+	txArc(txVertex *pV_):pV(pV_),pLV(NULL),PQId(-1),leftHalfEdgeId(-1),rightHalfEdgeId(-1){};
 } txArc;
 
 typedef struct txEdge{
 	int        id;
 	txVertex   *pLSite;
 	txVertex   *pRSite;
-	int        startBPId;    // start txBreakPoint id
-	int        endBPId;    // end txBreakPoint id
+	int        startBPId;    // start break point id
+	int        endBPId;    // end break point id
 	double a,b,c;
 	txEdge() :pLSite(NULL),pRSite(NULL), startBPId(-1), endBPId(-1), a(0.0), b(0.0), c(0.0){};
 } txEdge;
@@ -88,17 +85,19 @@ typedef struct txPriorityNode{
 	{}
 
 	void PrintNode(){
-		printf("%d--%d\n",pV->x,pV->y);
+		printf("%f--%f\n",pV->x,pV->y);
 	}
 } txPriorityNode;
 
+// The sweep line goes from top to bottom, so the event with the
+// bigger circleBottomY ( the site y for site event ) comes first.
+// Equal keys keep the insert order by the event id.
 struct txPriorityNodeCmp{
-	bool operator()( txPriorityNode *l,  txPriorityNode *r) const {
-		if (l->pV->y > r->pV->y){
-			return true;
-		} else {
-			return false;
+	bool operator()( const txPriorityNode &l, const txPriorityNode &r) const {
+		if ( l.circleBottomY != r.circleBottomY ) {
+			return l.circleBottomY > r.circleBottomY;
 		}
+		return l.id < r.id;
 	}
 };
 
@@ -106,11 +105,30 @@ struct txPriorityNodeCmp{
 //	return txPriorityNodeCmp()(l,r);
 //}
 
-typedef std::list<txArc> BLList;
-typedef BLList::iterator BLIt;
-typedef std::list<txPriorityNode> PQList;
-typedef PQList::iterator PQIt;
-typedef std::list<txBreakPoint> BPList;
+// BLIt is the handle of the arc in the beach line, -1 means no arc
+typedef txBeachLine<txArc> BLTree;
+typedef int BLIt;
+typedef txIndexedHeap<txPriorityNode, txPriorityNodeCmp> PQHeap;
+
+// The site index with its radix sort key
+typedef struct txSiteKey{
+	unsigned long long   key;
+	int                  id;
+} txSiteKey;
+
+// A cell leaving or coming back into the box of Clip(), see CloseCells
+typedef struct txBoundaryPoint{
+	int       faceId;
+	int       halfEdgeId;
+	double    s;          // txEdgeClip::BoundaryPosition
+	bool      isExit;
+} txBoundaryPoint;
+
+struct txSiteXCmp{
+	const txArena<txVertex> &sites;
+	txSiteXCmp(const txArena<txVertex> &sites_):sites(sites_){};
+	bool operator()( int l, int r ) const { return sites[l].x < sites[r].x; }
+};
 
 
 class R_DECLDIR txVoronoiBuilder
@@ -120,50 +138,100 @@ public:
 	txVoronoiBuilder(int numOfSites);
 	~txVoronoiBuilder(void);
 
-	void AddSites(const txVertex &vertex){ sitesList.push_back(vertex); };
+	void AddSites(const txVertex &vertex){ sitesList.Push(vertex); };
+	void AddSites(const txVertex *vertices, size_t numOfSites){ sitesList.Append(vertices, numOfSites); };
 
 	void Build();
 
+	// Drop the sites and the diagram, all the storage is kept for the next
+	// build.
+	void Reset();
+	// Build the diagram of the new sites with the storage of the previous
+	// builds, for the sites that change a little from frame to frame.
+	void Rebuild(const txVertex *vertices, size_t numOfSites);
+
+	// Finalize the diagram of the last Build() in the box: the open and the
+	// crossing edges are clipped, the edges out of the box are removed and
+	// the cells are closed along the box boundary. Then every cell in the
+	// box is a closed counter clockwise loop of finite edges, the cells out
+	// of the box are empty ( halfEdgeId -1 ) and the box edges have the face
+	// -1 on the other side.
+	void Clip(const txBox &box);
+
+	// The diagram of the last Build(), the face id is the index of the site
+	// in the order they were added.
+	const txMesh &GetMesh() const { return *mesh; };
+
+	// Number of parabola intersections evaluated by the last Build()
+	size_t GetBreakPointEvaluationCount() const { return breakPointCount; };
+	// Number of times the storage had to grow in the last Build(), with the
+	// sites of Rebuild() and the Clip() after it, 0 when the storage left by
+	// the previous builds is big enough
+	size_t GetAllocationCount() const { return allocationCount; };
+
 public:
 	static void Bisector(const txVertex &v0, const txVertex &v1, txEdge &edge);
 	static void Circle(const txVertex &n0, const txVertex &n1, const txVertex &n2, double &y);
+	static void Circle(const txVertex &n0, const txVertex &n1, const txVertex &n2, txVertex &center, double &y);
 	static void CalculateTwoParabolaIntersectionPoints(const txVertex &p0, const txVertex &p1, double ly0, double ly1, txVertex &v0, txVertex &v1, txParabolaIntersectionType &type);
 	static PointOrientationType PointOrientationChecking(const txVertex &v0, const txVertex &v1, const txVertex &v2);
+	static double BreakPoint(const txVertex &l, const txVertex &r, double ly);
 
 
 private:
 	void InitialEventQueue();
+	void SortSites();
+	size_t AllocationCount() const;
 	void HandleSiteEvent(const txPriorityNode &siteEvent);
 	void HandleCircleEvent(const txPriorityNode &cirlceEvent);
 	void DeleteCircleEvent(int circleId);
 	void InsertEvent(const txPriorityNode &pevent);
 	bool GetTripleAsLeft(BLIt middle, BLIt &l, BLIt &ll);
-	bool GetTripleAsMiddle(BLIt middle, BLIt &l, BLIt &r);
 	bool GetTripleAsRight(BLIt middle, BLIt &r, BLIt &rr);
-	void InserteArc(const txArc &arc);
-	BLIt GetArcIterator(const txArc &arc);
-	void UpdateBreakPointsList(double bottomY);
-	void InsertEdge(const txEdge &edge);
+	double LeftBreakPoint(BLIt arcIt);
+	int SiteId(const txVertex *pV) const { return (int)(pV-&sitesList[0]); };
+	void AddEdge(BLIt lIt, BLIt rIt);
 	int GetUpperArcId(double x);
 	int InsertNewArc(const txPriorityNode &siteEvent);
+	void InsertRayArc(BLIt lIt, BLIt rIt, txArc &newArc);
 	BLIt GetArcFromId(int id);
 	void CheckCircleEvent(int newArcId);
 	void AddCircleEvent(BLIt lIt, BLIt mIt, BLIt rIt);
-	void RemoveCircleEventFromArc(int arcId);
-	void DeleteArc( int arcId );
+	void CancelCircleEvent(BLIt arcIt);
+	void ClipEdges(const txBox &box);
+	void CloseCells(const txBox &box);
+	int BoxCorner(const txBox &box, int corner);
+	int AddBoxEdge(int faceId, int preId, int fromId, int toId);
 	// bool IsExistCircleEvent
 
 
 private:
 	txMesh                               *mesh;
-	std::vector<txVertex>                sitesList;
-	std::list<txPriorityNode>            eventQueue;
-	std::list<txEdge>                    edgeList;
-	std::list<txArc>                     beachLine;
+	txArena<txVertex>                    sitesList;
+	txArena<int>                         siteOrder;     // site index in the sweep order
+	txArena<txSiteKey>                   siteKeys;
+	txArena<txSiteKey>                   swapSiteKeys;
+
+	// Clip() work space, the edge lines in separated arrays and the
+	// dead flags of the halfedges
+	txArena<double>                      clipPx, clipPy, clipDx, clipDy, clipT0, clipT1;
+	txArena<char>                        deadHalfEdges;
+	txArena<txBoundaryPoint>             boundaryPoints;
+	int                                  cornerIds[4];
+	PQHeap                               eventQueue;
+	BLTree                               beachLine;
 	int                                  arcCount;
 	int                                  eventCount;
-	int                                  edgeCount;
-	BPList                               bpList;
+	double                               sweepY;
+	size_t                               breakPointCount;
+	size_t                               allocationCount;
+
+	// Key of the beach line search, evaluate the break point of the
+	// visited node only
+	struct txBreakPointKey{
+		txVoronoiBuilder *builder;
+		double operator()(BLIt h) const { return builder->LeftBreakPoint(h); }
+	};
 };
 
 #pragma warning(pop)
@@ -1,13 +1,13 @@
 #ifndef __HALFEDGEPRIMITIVE_HEADERFILE__
 #define __HALFEDGEPRIMITIVE_HEADERFILE__
 
-struct txFace;
-struct txHalfEdge;
-struct txVertex;
+// The mesh elements live in contiguous arrays ( see txMesh ) and refer to
+// each other by 32 bit index into these arrays, -1 means none.
+// No pointer inside, so the mesh can be copied or written out as it is.
 
 typedef struct txFace{
 	int id;                    // corresponding the Voronoi Diagram Sites
-	txHalfEdge       *pArbitrayHalfEdge;
+	int halfEdgeId;            // an arbitrary halfedge of the face
 } txFace;
 
 typedef struct txVertex{
@@ -15,11 +15,11 @@ typedef struct txVertex{
 } txVertex;
 
 typedef struct txHalfEdge{
-	txVertex         *pVertex;          // The vertex it point to
-	txFace           *pFace;            // Fact it belong to  
-	txHalfEdge       *pNextHalf;        // The next halfedge CCW
-	txHalfEdge       *pTwinHalf;        // The 'twin' halfedge
-	txHalfEdge       *PPre;	            // The pre Half [Optional]
+	int              vertexId;          // The vertex it point to, -1 if it goes to the infinite
+	int              faceId;            // Face it belong to  
+	int              nextId;            // The next halfedge of the face
+	int              twinId;            // The 'twin' halfedge
+	int              preId;             // The pre halfedge of the face
 } txHalfEdge;
 
 
@@ -1,20 +1,94 @@
 #include "StdAfx.h"
 #include "mesh.h"
+#include <vector>
 
 txMesh::txMesh (int numOfSites){
-	faceList.reserve(numOfSites);
+	Clear(numOfSites);
+}
+
+// A Voronoi diagram of n sites has at most 2n-5 vertices and 3n-6 edges
+void txMesh::Clear(int numOfSites){
+	vertexList.Reset();
+	halfEdgeList.Reset();
+	faceList.Reset();
+	vertexList.Reserve(2*numOfSites);
+	halfEdgeList.Reserve(6*numOfSites);
+	faceList.Reserve(numOfSites);
 	for (int i=0; i<numOfSites; i++ ){
 		txFace currentFace;
 		currentFace.id = i;
-		currentFace.pArbitrayHalfEdge = NULL;
-		faceList.push_back(currentFace);
+		currentFace.halfEdgeId = -1;
+		faceList.Push(currentFace);
 	}
 }
 
-void txMesh::AddHalfEdge(const txHalfEdge &halfEdge){
-	halfEdgeList.push_back(halfEdge);
+int txMesh::AddVertex(const txVertex &vertex){
+	return vertexList.Push(vertex);
+}
+
+int txMesh::AddEdge(int leftFaceId, int rightFaceId){
+	int h = (int)halfEdgeList.Size();
+	txHalfEdge halfEdge;
+	halfEdge.vertexId = -1;
+	halfEdge.nextId = -1;
+	halfEdge.preId = -1;
+
+	halfEdge.faceId = leftFaceId;
+	halfEdge.twinId = h+1;
+	halfEdgeList.Push(halfEdge);
+
+	halfEdge.faceId = rightFaceId;
+	halfEdge.twinId = h;
+	halfEdgeList.Push(halfEdge);
+
+	if ( leftFaceId != -1 && faceList[leftFaceId].halfEdgeId == -1 ) faceList[leftFaceId].halfEdgeId = h;
+	if ( rightFaceId != -1 && faceList[rightFaceId].halfEdgeId == -1 ) faceList[rightFaceId].halfEdgeId = h+1;
+	return h;
+}
+
+void txMesh::Link(int preId, int nextId){
+	halfEdgeList[preId].nextId = nextId;
+	halfEdgeList[nextId].preId = preId;
 }
 
-void txMesh::AddVertex(const txVertex &vertex){
-	vertexList.push_back(vertex);
+void txMesh::Compact(const char *deadHalfEdge){
+	int numOfHalfEdges = (int)halfEdgeList.Size();
+	int numOfVertices = (int)vertexList.Size();
+	halfEdgeMap.Reset();
+	halfEdgeMap.Resize(numOfHalfEdges, -1);
+	vertexMap.Reset();
+	vertexMap.Resize(numOfVertices, -1);
+	int liveHalfEdges = 0;
+	for (int h=0; h<numOfHalfEdges; h++) {
+		if ( deadHalfEdge[h] ) continue;
+		halfEdgeMap[h] = liveHalfEdges++;
+		if ( halfEdgeList[h].vertexId != -1 ) vertexMap[halfEdgeList[h].vertexId] = 0;
+	}
+
+	int liveVertices = 0;
+	for (int v=0; v<numOfVertices; v++) {
+		if ( vertexMap[v] == -1 ) continue;
+		vertexMap[v] = liveVertices;
+		vertexList[liveVertices++] = vertexList[v];
+	}
+
+	// the live ones only move to the front, so it is safe in place
+	for (int h=0; h<numOfHalfEdges; h++) {
+		if ( deadHalfEdge[h] ) continue;
+		txHalfEdge halfEdge = halfEdgeList[h];
+		if ( halfEdge.vertexId != -1 ) halfEdge.vertexId = vertexMap[halfEdge.vertexId];
+		if ( halfEdge.nextId != -1 ) halfEdge.nextId = halfEdgeMap[halfEdge.nextId];
+		if ( halfEdge.preId != -1 ) halfEdge.preId = halfEdgeMap[halfEdge.preId];
+		halfEdge.twinId = halfEdgeMap[halfEdge.twinId];
+		halfEdgeList[halfEdgeMap[h]] = halfEdge;
+	}
+
+	txVertex emptyVertex = { 0.0, 0.0 };
+	txHalfEdge emptyHalfEdge = { -1, -1, -1, -1, -1 };
+	vertexList.Resize(liveVertices, emptyVertex);
+	halfEdgeList.Resize(liveHalfEdges, emptyHalfEdge);
+
+	for (int f=0; f<(int)faceList.Size(); f++) {
+		if ( faceList[f].halfEdgeId != -1 ) faceList[f].halfEdgeId = halfEdgeMap[faceList[f].halfEdgeId];
+	}
 }
\ No newline at end of file
@@ -1,21 +1,53 @@
 #pragma once
 #ifndef __MESH_HEADERFILE__
 #define __MESH_HEADERFILE__
-#include <list>
-#include <vector>
+#include "Arena.h"
 #include "halfedgeprimitive.h"
 
+// Half edge mesh of the Voronoi diagram.
+// Face i is the cell of site i. The two halfedges of an edge are created
+// together and sit next to each other, so the twin of halfedge h is h^1.
+// The face -1 is the outside of the bounding box ( see
+// txVoronoiBuilder::Clip ).
 class txMesh{
 
 public:
 	txMesh (int numOfSites);
 
-	void AddHalfEdge(const txHalfEdge &halfEdge);
-	void AddVertex(const txVertex &vertex);
+	// drop all the vertices and edges, keep the capacity
+	void Clear(int numOfSites);
+
+	int AddVertex(const txVertex &vertex);
+	// Add the edge between two faces, return the halfedge of the
+	// leftFace, the one of the rightFace is its twin.
+	int AddEdge(int leftFaceId, int rightFaceId);
+	// make nextId follow preId in the face
+	void Link(int preId, int nextId);
+	// Remove the halfedges marked dead ( an edge is removed as a pair ) and
+	// the vertices no halfedge points to any more. The ids are renumbered.
+	void Compact(const char *deadHalfEdge);
+
+	int NumOfVertices() const { return (int)vertexList.Size(); };
+	int NumOfHalfEdges() const { return (int)halfEdgeList.Size(); };
+	int NumOfFaces() const { return (int)faceList.Size(); };
+	size_t AllocationCount() const {
+		return vertexList.AllocationCount() + halfEdgeList.AllocationCount() + faceList.AllocationCount()
+			+ halfEdgeMap.AllocationCount() + vertexMap.AllocationCount();
+	}
+
+	const txVertex &Vertex(int id) const { return vertexList[id]; };
+	const txHalfEdge &HalfEdge(int id) const { return halfEdgeList[id]; };
+	txHalfEdge &HalfEdge(int id) { return halfEdgeList[id]; };
+	const txFace &Face(int id) const { return faceList[id]; };
+	txFace &Face(int id) { return faceList[id]; };
+
 private:
-	std::list<txVertex>        vertexList;
-	std::list<txHalfEdge>      halfEdgeList;
-	std::vector<txFace>        faceList;
+	txArena<txVertex>          vertexList;
+	txArena<txHalfEdge>        halfEdgeList;
+	txArena<txFace>            faceList;
+	// Compact() work space, the new ids of the old ones
+	txArena<int>               halfEdgeMap;
+	txArena<int>               vertexMap;
 
 
 };
@@ -0,0 +1,24 @@
+#include "stdafx.h"
+#include "../thirdparty/gtest-1.6.0/include/gtest.h"
+#include "../VoronoiDiagramDLL/Arena.h"
+
+TEST(txArena, ResetKeepMemory) {
+	txArena<int> arena;
+	arena.Reserve(16);
+	EXPECT_EQ(1, (int)arena.AllocationCount());
+	for (int i=0; i<16; i++) {
+		EXPECT_EQ(i, arena.Push(i*2));
+	}
+	EXPECT_EQ(1, (int)arena.AllocationCount());
+	EXPECT_EQ(30, arena.Back());
+
+	arena.Reset();
+	EXPECT_TRUE(arena.Empty());
+	EXPECT_EQ(16, (int)arena.Capacity());
+	arena.Resize(16, -1);
+	arena.Reserve(8);
+	EXPECT_EQ(1, (int)arena.AllocationCount());
+
+	arena.Push(0);
+	EXPECT_EQ(2, (int)arena.AllocationCount());
+}
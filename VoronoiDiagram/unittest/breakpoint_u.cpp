@@ -0,0 +1,43 @@
+#include "stdafx.h"
+#include "../thirdparty/gtest-1.6.0/include/gtest.h"
+#include "../VoronoiDiagramDLL/VoronoiBuilder.h"
+
+TEST(VoronoiBuilder, BreakPoint) {
+	txVertex high = {0,2};
+	txVertex low = {1,1};
+	// the parabolas meet at x=0 and x=4, the higher one is outside
+	EXPECT_NEAR(0.0, txVoronoiBuilder::BreakPoint(high, low, 0.0), 1e-9);
+	EXPECT_NEAR(4.0, txVoronoiBuilder::BreakPoint(low, high, 0.0), 1e-9);
+
+	// same y, the break point is on the bisector
+	txVertex v0 = {0,1};
+	txVertex v1 = {2,1};
+	EXPECT_NEAR(1.0, txVoronoiBuilder::BreakPoint(v0, v1, -3.0), 1e-9);
+
+	// site on the sweep line is a vertical ray
+	txVertex onSweep = {3,0};
+	EXPECT_NEAR(3.0, txVoronoiBuilder::BreakPoint(high, onSweep, 0.0), 1e-9);
+	EXPECT_NEAR(3.0, txVoronoiBuilder::BreakPoint(onSweep, high, 0.0), 1e-9);
+}
+
+static size_t BreakPointEvaluations(int n){
+	txVoronoiBuilder builder(n);
+	srand(1);
+	for (int i=0; i<n; i++) {
+		txVertex v = { 1000.0*rand()/RAND_MAX, 1000.0*rand()/RAND_MAX };
+		builder.AddSites(v);
+	}
+	builder.Build();
+	return builder.GetBreakPointEvaluationCount();
+}
+
+// The break points are only evaluated on the search path, so 8 times the
+// sites should cost about 8*log(8n)/log(n) times the evaluations ( ~10 ),
+// updating the whole beach line on every site event would be ~64 times.
+TEST(VoronoiBuilder, BreakPointEvaluationCount) {
+	size_t c1 = BreakPointEvaluations(1000);
+	size_t c8 = BreakPointEvaluations(8000);
+	printf("break point evaluations: 1000 sites %u, 8000 sites %u\n", (unsigned)c1, (unsigned)c8);
+	EXPECT_GT(c1, (size_t)0);
+	EXPECT_LT(c8, 16*c1);
+}
@@ -0,0 +1,83 @@
+#include "stdafx.h"
+#include "../thirdparty/gtest-1.6.0/include/gtest.h"
+#include "../VoronoiDiagramDLL/VoronoiBuilder.h"
+#include "../VoronoiDiagramDLL/mesh.h"
+#include <stdlib.h>
+#include <vector>
+
+// Build the same sites again, the storage of the first build is enough
+TEST(txVoronoiBuilder, RebuildWithoutAllocation) {
+	const int n = 2000;
+	txVoronoiBuilder builder(n);
+	srand(11);
+	for (int i=0; i<n; i++) {
+		txVertex v = { 1000.0*rand()/RAND_MAX, 1000.0*rand()/RAND_MAX };
+		builder.AddSites(v);
+	}
+	builder.Build();
+	EXPECT_GT(builder.GetAllocationCount(), (size_t)0);
+	int numOfVertices = builder.GetMesh().NumOfVertices();
+	int numOfHalfEdges = builder.GetMesh().NumOfHalfEdges();
+
+	builder.Build();
+	EXPECT_EQ(0, (int)builder.GetAllocationCount());
+	EXPECT_EQ(numOfVertices, builder.GetMesh().NumOfVertices());
+	EXPECT_EQ(numOfHalfEdges, builder.GetMesh().NumOfHalfEdges());
+}
+
+// Rebuild and clip every frame, the sites, the clip work space and the
+// mesh compaction all reuse the storage of the first frame
+TEST(txVoronoiBuilder, RebuildAndClipWithoutAllocation) {
+	const int n = 1000;
+	std::vector<txVertex> sites(n);
+	srand(13);
+	for (int i=0; i<n; i++) {
+		sites[i].x = 1000.0*rand()/RAND_MAX;
+		sites[i].y = 1000.0*rand()/RAND_MAX;
+	}
+	txBox box = { 100.0, 100.0, 900.0, 900.0 };
+	txVoronoiBuilder builder(1);
+	builder.Rebuild(&sites[0], sites.size());
+	builder.Clip(box);
+	EXPECT_GT(builder.GetAllocationCount(), (size_t)0);
+
+	for (int frame=0; frame<3; frame++) {
+		builder.Rebuild(&sites[0], sites.size());
+		builder.Clip(box);
+		EXPECT_EQ(0, (int)builder.GetAllocationCount());
+	}
+}
+
+// The sites move a little every frame, the builder is reused for all the
+// frames and gives the same diagram as a new one.
+TEST(txVoronoiBuilder, RebuildMovedSites) {
+	const int n = 1000;
+	std::vector<txVertex> sites(n);
+	srand(5);
+	for (int i=0; i<n; i++) {
+		sites[i].x = 1000.0*rand()/RAND_MAX;
+		sites[i].y = 1000.0*rand()/RAND_MAX;
+	}
+	txVoronoiBuilder builder(n);
+	builder.AddSites(&sites[0], sites.size());
+	builder.Build();
+
+	for (int frame=0; frame<5; frame++) {
+		for (int i=0; i<n; i++) {
+			sites[i].x += 0.5*rand()/RAND_MAX;
+			sites[i].y += 0.5*rand()/RAND_MAX;
+		}
+		builder.Rebuild(&sites[0], sites.size());
+		EXPECT_EQ(0, (int)builder.GetAllocationCount());
+
+		txVoronoiBuilder fresh(n);
+		fresh.AddSites(&sites[0], sites.size());
+		fresh.Build();
+		EXPECT_EQ(fresh.GetMesh().NumOfVertices(), builder.GetMesh().NumOfVertices());
+		EXPECT_EQ(fresh.GetMesh().NumOfHalfEdges(), builder.GetMesh().NumOfHalfEdges());
+	}
+
+	builder.Reset();
+	builder.Build();
+	EXPECT_EQ(0, builder.GetMesh().NumOfFaces());
+}
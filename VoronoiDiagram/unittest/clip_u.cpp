@@ -0,0 +1,133 @@
+#include "stdafx.h"
+#include "../thirdparty/gtest-1.6.0/include/gtest.h"
+#include "../VoronoiDiagramDLL/VoronoiBuilder.h"
+#include "../VoronoiDiagramDLL/mesh.h"
+#include <vector>
+
+// Walk every cell, check it is a closed counter clockwise loop in the box
+// and return the sum of the cell areas, which should be the box area.
+static double CheckClippedCells(const txMesh &mesh, const txBox &box){
+	const double eps = 1e-9;
+	for (int v=0; v<mesh.NumOfVertices(); v++) {
+		EXPECT_GE(mesh.Vertex(v).x, box.minX-eps);
+		EXPECT_LE(mesh.Vertex(v).x, box.maxX+eps);
+		EXPECT_GE(mesh.Vertex(v).y, box.minY-eps);
+		EXPECT_LE(mesh.Vertex(v).y, box.maxY+eps);
+	}
+	double totalArea = 0.0;
+	for (int f=0; f<mesh.NumOfFaces(); f++) {
+		int start = mesh.Face(f).halfEdgeId;
+		if ( start == -1 ) continue;
+		double area = 0.0;
+		int h = start;
+		int count = 0;
+		do {
+			const txHalfEdge &halfEdge = mesh.HalfEdge(h);
+			EXPECT_EQ(f, halfEdge.faceId);
+			if ( halfEdge.nextId == -1 || halfEdge.vertexId == -1 ) {
+				ADD_FAILURE() << "open cell " << f;
+				return 0.0;
+			}
+			const txVertex &v0 = mesh.Vertex(mesh.HalfEdge(halfEdge.twinId).vertexId);
+			const txVertex &v1 = mesh.Vertex(halfEdge.vertexId);
+			area += 0.5*(v0.x*v1.y - v1.x*v0.y);
+			h = halfEdge.nextId;
+			count++;
+		} while ( h!=start && count<=mesh.NumOfHalfEdges() );
+		EXPECT_EQ(start, h);
+		EXPECT_GE(area, 0.0);
+		totalArea += area;
+	}
+	return totalArea;
+}
+
+TEST(txVoronoiBuilder, ClipRandomSites) {
+	const int n = 500;
+	txVoronoiBuilder builder(n);
+	srand(23);
+	for (int i=0; i<n; i++) {
+		txVertex v = { 1000.0*rand()/RAND_MAX, 1000.0*rand()/RAND_MAX };
+		builder.AddSites(v);
+	}
+	builder.Build();
+	// part of the cells are out of the box
+	txBox box = { 100.0, 150.0, 900.0, 850.0 };
+	builder.Clip(box);
+	double area = CheckClippedCells(builder.GetMesh(), box);
+	EXPECT_NEAR(800.0*700.0, area, 1e-6*800.0*700.0);
+
+	// all the sites in the box
+	builder.Build();
+	txBox bigBox = { -500.0, -500.0, 1500.0, 1500.0 };
+	builder.Clip(bigBox);
+	area = CheckClippedCells(builder.GetMesh(), bigBox);
+	EXPECT_NEAR(2000.0*2000.0, area, 1e-6*2000.0*2000.0);
+}
+
+TEST(txVoronoiBuilder, ClipDegenerate) {
+	txBox box = { 0.0, 0.0, 10.0, 10.0 };
+
+	// one site, the cell is the box
+	txVoronoiBuilder one(1);
+	txVertex site = { 3.0, 4.0 };
+	one.AddSites(site);
+	one.Build();
+	one.Clip(box);
+	EXPECT_EQ(4, one.GetMesh().NumOfVertices());
+	EXPECT_NEAR(100.0, CheckClippedCells(one.GetMesh(), box), 1e-9);
+
+	// the sites on a row have only the parallel bisectors
+	txVoronoiBuilder row(4);
+	for (int i=0; i<4; i++) {
+		txVertex v = { 2.0+2.0*i, 5.0 };
+		row.AddSites(v);
+	}
+	row.Build();
+	row.Clip(box);
+	EXPECT_NEAR(100.0, CheckClippedCells(row.GetMesh(), box), 1e-9);
+
+	// the box is all in the cell of the site 1
+	txVoronoiBuilder far(3);
+	txVertex sites[] = { {-100.0, 5.0}, {5.0, 5.0}, {5.0, 200.0} };
+	far.AddSites(sites, 3);
+	far.Build();
+	far.Clip(box);
+	EXPECT_EQ(-1, far.GetMesh().Face(0).halfEdgeId);
+	EXPECT_EQ(-1, far.GetMesh().Face(2).halfEdgeId);
+	EXPECT_NEAR(100.0, CheckClippedCells(far.GetMesh(), box), 1e-9);
+}
+
+// Clip the clipped diagram again: the same box changes nothing, a smaller
+// box gives the cells of the smaller box
+TEST(txVoronoiBuilder, ClipTwice) {
+	const int n = 300;
+	std::vector<txVertex> sites(n);
+	srand(29);
+	for (int i=0; i<n; i++) {
+		sites[i].x = 1000.0*rand()/RAND_MAX;
+		sites[i].y = 1000.0*rand()/RAND_MAX;
+	}
+	txBox box = { 100.0, 100.0, 900.0, 900.0 };
+	txBox smallBox = { 300.0, 200.0, 700.0, 600.0 };
+
+	txVoronoiBuilder builder(n);
+	builder.AddSites(&sites[0], sites.size());
+	builder.Build();
+	builder.Clip(box);
+	int numOfVertices = builder.GetMesh().NumOfVertices();
+	int numOfHalfEdges = builder.GetMesh().NumOfHalfEdges();
+	builder.Clip(box);
+	EXPECT_EQ(numOfVertices, builder.GetMesh().NumOfVertices());
+	EXPECT_EQ(numOfHalfEdges, builder.GetMesh().NumOfHalfEdges());
+	EXPECT_NEAR(800.0*800.0, CheckClippedCells(builder.GetMesh(), box), 1e-6*800.0*800.0);
+
+	builder.Clip(smallBox);
+	EXPECT_NEAR(400.0*400.0, CheckClippedCells(builder.GetMesh(), smallBox), 1e-6*400.0*400.0);
+
+	txVoronoiBuilder fresh(n);
+	fresh.AddSites(&sites[0], sites.size());
+	fresh.Build();
+	fresh.Clip(smallBox);
+	EXPECT_EQ(fresh.GetMesh().NumOfVertices(), builder.GetMesh().NumOfVertices());
+	EXPECT_EQ(fresh.GetMesh().NumOfHalfEdges(), builder.GetMesh().NumOfHalfEdges());
+}
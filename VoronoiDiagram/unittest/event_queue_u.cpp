@@ -0,0 +1,86 @@
+#include "stdafx.h"
+#include "../thirdparty/gtest-1.6.0/include/gtest.h"
+#include "../VoronoiDiagramDLL/VoronoiBuilder.h"
+#include "../VoronoiDiagramDLL/mesh.h"
+#include <math.h>
+
+static txPriorityNode MakeEvent(int id, double y){
+	txPriorityNode node(NULL, CIRCLE_EVENT);
+	node.id = id;
+	node.circleBottomY = y;
+	return node;
+}
+
+TEST(txIndexedHeap, PopOrder) {
+	PQHeap queue;
+	double ys[] = { 3.0, -1.0, 7.5, 0.0, 7.5, 2.0, -4.0 };
+	for (int i=0; i<7; i++) {
+		queue.Push(MakeEvent(i, ys[i]));
+	}
+	EXPECT_EQ(7, (int)queue.Size());
+
+	// bigger y first, the equal y keep the insert order
+	int expectIds[] = { 2, 4, 0, 5, 3, 1, 6 };
+	for (int i=0; i<7; i++) {
+		ASSERT_FALSE(queue.Empty());
+		EXPECT_EQ(expectIds[i], queue.Top().id);
+		queue.Pop();
+	}
+	EXPECT_TRUE(queue.Empty());
+}
+
+TEST(txIndexedHeap, Erase) {
+	PQHeap queue;
+	for (int i=0; i<100; i++) {
+		queue.Push(MakeEvent(i, (i*37)%100));
+	}
+	// cancel every third event
+	for (int i=0; i<100; i+=3) {
+		EXPECT_TRUE(queue.Erase(i));
+	}
+	EXPECT_FALSE(queue.Erase(0));
+	EXPECT_FALSE(queue.Erase(-1));
+	EXPECT_FALSE(queue.Erase(1000));
+	EXPECT_FALSE(queue.Contains(3));
+	EXPECT_TRUE(queue.Contains(4));
+
+	double preY = 1e20;
+	int count = 0;
+	while (!queue.Empty()) {
+		const txPriorityNode &top = queue.Top();
+		EXPECT_NE(0, top.id%3);
+		EXPECT_LE(top.circleBottomY, preY);
+		preY = top.circleBottomY;
+		queue.Pop();
+		count++;
+	}
+	EXPECT_EQ(66, count);
+}
+
+// The sites are not in the event queue, they are sorted up front. Many
+// sites on the same rows and negative coordinates check the sort order:
+// every Voronoi vertex has to be as far from the sites of the faces around.
+TEST(txVoronoiBuilder, SortedSites) {
+	const int n = 300;
+	std::vector<txVertex> sites;
+	txVoronoiBuilder builder(n);
+	srand(3);
+	for (int i=0; i<n; i++) {
+		txVertex v = { 200.0*rand()/RAND_MAX-100.0, 10.0*(rand()%15-7) };
+		sites.push_back(v);
+		builder.AddSites(v);
+	}
+	builder.Build();
+	const txMesh &mesh = builder.GetMesh();
+	EXPECT_GT(mesh.NumOfVertices(), 0);
+	for (int h=0; h<mesh.NumOfHalfEdges(); h++) {
+		const txHalfEdge &halfEdge = mesh.HalfEdge(h);
+		if ( halfEdge.vertexId == -1 ) continue;
+		const txVertex &v = mesh.Vertex(halfEdge.vertexId);
+		const txVertex &s0 = sites[halfEdge.faceId];
+		const txVertex &s1 = sites[mesh.HalfEdge(halfEdge.twinId).faceId];
+		double d0 = (v.x-s0.x)*(v.x-s0.x)+(v.y-s0.y)*(v.y-s0.y);
+		double d1 = (v.x-s1.x)*(v.x-s1.x)+(v.y-s1.y)*(v.y-s1.y);
+		EXPECT_NEAR(sqrt(d0), sqrt(d1), 1e-6);
+	}
+}
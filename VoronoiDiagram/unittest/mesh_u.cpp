@@ -0,0 +1,157 @@
+#include "stdafx.h"
+#include "../thirdparty/gtest-1.6.0/include/gtest.h"
+#include "../VoronoiDiagramDLL/VoronoiBuilder.h"
+#include "../VoronoiDiagramDLL/mesh.h"
+#include <math.h>
+#include <algorithm>
+
+static double Distance(const txVertex &v0, const txVertex &v1){
+	return sqrt((v0.x-v1.x)*(v0.x-v1.x)+(v0.y-v1.y)*(v0.y-v1.y));
+}
+
+// The site 0 is surrounded by the other four, its cell is closed
+TEST(txMesh, ClosedCell) {
+	txVertex sites[] = { {0,0}, {4,1}, {-1,5}, {-4,-1}, {1,-3} };
+	txVoronoiBuilder builder(5);
+	for (int i=0; i<5; i++) {
+		builder.AddSites(sites[i]);
+	}
+	builder.Build();
+	const txMesh &mesh = builder.GetMesh();
+	EXPECT_EQ(5, mesh.NumOfFaces());
+	EXPECT_EQ(4, mesh.NumOfVertices());
+	EXPECT_EQ(16, mesh.NumOfHalfEdges());
+
+	int start = mesh.Face(0).halfEdgeId;
+	ASSERT_NE(-1, start);
+	int h = start;
+	int count = 0;
+	double area = 0.0;
+	do {
+		const txHalfEdge &halfEdge = mesh.HalfEdge(h);
+		ASSERT_NE(-1, halfEdge.nextId);
+		ASSERT_NE(-1, halfEdge.vertexId);
+		EXPECT_EQ(0, halfEdge.faceId);
+		const txVertex &v0 = mesh.Vertex(mesh.HalfEdge(halfEdge.twinId).vertexId);
+		const txVertex &v1 = mesh.Vertex(halfEdge.vertexId);
+		area += v0.x*v1.y - v1.x*v0.y;
+		h = halfEdge.nextId;
+		count++;
+	} while ( h!=start && count<10 );
+	EXPECT_EQ(4, count);
+	// the halfedges go counter clockwise around the face
+	EXPECT_GT(area, 0.0);
+}
+
+TEST(txMesh, Connectivity) {
+	const int n = 500;
+	std::vector<txVertex> sites;
+	txVoronoiBuilder builder(n);
+	srand(7);
+	for (int i=0; i<n; i++) {
+		txVertex v = { 1000.0*rand()/RAND_MAX, 1000.0*rand()/RAND_MAX };
+		sites.push_back(v);
+		builder.AddSites(v);
+	}
+	builder.Build();
+	const txMesh &mesh = builder.GetMesh();
+	EXPECT_EQ(n, mesh.NumOfFaces());
+	EXPECT_LE(mesh.NumOfVertices(), 2*n-5);
+	EXPECT_LE(mesh.NumOfHalfEdges(), 6*n-12);
+
+	for (int h=0; h<mesh.NumOfHalfEdges(); h++) {
+		const txHalfEdge &halfEdge = mesh.HalfEdge(h);
+		const txHalfEdge &twin = mesh.HalfEdge(halfEdge.twinId);
+		EXPECT_EQ(h, twin.twinId);
+		EXPECT_NE(halfEdge.faceId, twin.faceId);
+		if ( halfEdge.nextId != -1 ) {
+			const txHalfEdge &next = mesh.HalfEdge(halfEdge.nextId);
+			EXPECT_EQ(h, next.preId);
+			EXPECT_EQ(halfEdge.faceId, next.faceId);
+			// the next one starts where this one ends
+			EXPECT_EQ(halfEdge.vertexId, mesh.HalfEdge(next.twinId).vertexId);
+		}
+		// a Voronoi vertex is as far from the sites of both sides
+		if ( halfEdge.vertexId != -1 ) {
+			const txVertex &v = mesh.Vertex(halfEdge.vertexId);
+			EXPECT_NEAR(Distance(v, sites[halfEdge.faceId]), Distance(v, sites[twin.faceId]), 1e-6);
+		}
+	}
+}
+
+// Check the edges of the mesh against the sites: the two sides of an edge
+// are different sites, and a Voronoi vertex is as far from both of them as
+// from its nearest site.
+static void ExpectVoronoiMesh(const txMesh &mesh, const txVertex *sites, int n){
+	EXPECT_EQ(n, mesh.NumOfFaces());
+	for (int h=0; h<mesh.NumOfHalfEdges(); h++) {
+		const txHalfEdge &halfEdge = mesh.HalfEdge(h);
+		const txHalfEdge &twin = mesh.HalfEdge(halfEdge.twinId);
+		EXPECT_EQ(h, twin.twinId);
+		EXPECT_NE(halfEdge.faceId, twin.faceId);
+		if ( halfEdge.vertexId == -1 ) continue;
+		const txVertex &v = mesh.Vertex(halfEdge.vertexId);
+		double nearest = Distance(v, sites[0]);
+		for (int i=1; i<n; i++) nearest = std::min(nearest, Distance(v, sites[i]));
+		EXPECT_NEAR(nearest, Distance(v, sites[halfEdge.faceId]), 1e-6);
+		EXPECT_NEAR(nearest, Distance(v, sites[twin.faceId]), 1e-6);
+	}
+}
+
+static bool HasEdge(const txMesh &mesh, int face0, int face1){
+	for (int h=0; h<mesh.NumOfHalfEdges(); h++) {
+		if ( mesh.HalfEdge(h).faceId==face0 && mesh.HalfEdge(mesh.HalfEdge(h).twinId).faceId==face1 ) return true;
+	}
+	return false;
+}
+
+// The top sites are within PRESISION_OF_PARABOLA_INTERSECTION of each other
+// but not at the same y, so they don't come from left to right. The second
+// one goes left of the first one.
+TEST(txMesh, NearlyEqualTopSites) {
+	txVertex sites[] = { {5,1e-12}, {1,0}, {3,-5}, {2,-9} };
+	txVoronoiBuilder builder(4);
+	for (int i=0; i<4; i++) {
+		builder.AddSites(sites[i]);
+	}
+	builder.Build();
+	const txMesh &mesh = builder.GetMesh();
+	ExpectVoronoiMesh(mesh, sites, 4);
+	EXPECT_TRUE(HasEdge(mesh, 0, 1));
+	EXPECT_TRUE(HasEdge(mesh, 1, 2));
+	EXPECT_TRUE(HasEdge(mesh, 0, 2));
+	EXPECT_TRUE(HasEdge(mesh, 2, 3));
+}
+
+// The third top site goes between the first two, they are not neighbours
+// any more
+TEST(txMesh, NearlyEqualTopSitesBetween) {
+	txVertex sites[] = { {0,1e-12}, {10,2e-12}, {4,0}, {3,-5}, {7,-9} };
+	txVoronoiBuilder builder(5);
+	for (int i=0; i<5; i++) {
+		builder.AddSites(sites[i]);
+	}
+	builder.Build();
+	const txMesh &mesh = builder.GetMesh();
+	ExpectVoronoiMesh(mesh, sites, 5);
+	EXPECT_TRUE(HasEdge(mesh, 0, 2));
+	EXPECT_TRUE(HasEdge(mesh, 2, 1));
+	EXPECT_FALSE(HasEdge(mesh, 0, 1));
+	for (int i=0; i<5; i++) {
+		EXPECT_NE(-1, mesh.Face(i).halfEdgeId);
+		EXPECT_EQ(i, mesh.HalfEdge(mesh.Face(i).halfEdgeId).faceId);
+	}
+}
+
+// -0 and 0 are the same y, the two top sites are sorted by x
+TEST(txMesh, NegativeZeroTopSites) {
+	txVertex sites[] = { {5,0.0}, {1,-0.0}, {3,-5}, {2,-9} };
+	txVoronoiBuilder builder(4);
+	for (int i=0; i<4; i++) {
+		builder.AddSites(sites[i]);
+	}
+	builder.Build();
+	const txMesh &mesh = builder.GetMesh();
+	ExpectVoronoiMesh(mesh, sites, 4);
+	EXPECT_TRUE(HasEdge(mesh, 0, 1));
+}
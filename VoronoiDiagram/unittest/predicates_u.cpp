@@ -0,0 +1,86 @@
+#include "stdafx.h"
+#include <math.h>
+#include <time.h>
+#include "../thirdparty/gtest-1.6.0/include/gtest.h"
+#include "../VoronoiDiagramDLL/Predicates.h"
+#include "../VoronoiDiagramDLL/Matrix3.h"
+
+static int Sign(double v){
+	return v>0 ? 1 : (v<0 ? -1 : 0);
+}
+
+TEST(txPredicates, Orient2d) {
+	txVertex v0 = {0, 0}, v1 = {2, 0}, v2 = {2, 2}, v3 = {2, -2}, v4 = {4, 0};
+	EXPECT_GT(txPredicates::Orient2d(v0, v1, v2), 0.0);
+	EXPECT_LT(txPredicates::Orient2d(v0, v1, v3), 0.0);
+	EXPECT_EQ(0.0, txPredicates::Orient2d(v0, v1, v4));
+}
+
+// The points around (0.5,0.5) a few ulps away from the line y=x, the
+// plain double determinant gets many of them on the wrong side.
+TEST(txPredicates, Orient2dNearlyCollinear) {
+	const double ulp = ldexp(1.0, -53);
+	txVertex b = {12, 12}, c = {24, 24};
+	for (int i=0; i<32; i++) {
+		for (int j=0; j<32; j++) {
+			txVertex p = { 0.5+i*ulp, 0.5+j*ulp };
+			EXPECT_EQ(Sign(j-i), Sign(txPredicates::Orient2d(p, b, c)));
+			EXPECT_EQ(Sign(j-i), Sign(txPredicates::Orient2dExact(p, b, c)));
+		}
+	}
+}
+
+TEST(txPredicates, InCircle) {
+	txVertex a = {0, 0}, b = {1, 0}, c = {0, 1};
+	txVertex on = {1, 1}, inside = {0.5, 0.5}, outside = {2, 2};
+	EXPECT_EQ(0.0, txPredicates::InCircle(a, b, c, on));
+	EXPECT_GT(txPredicates::InCircle(a, b, c, inside), 0.0);
+	EXPECT_LT(txPredicates::InCircle(a, b, c, outside), 0.0);
+	// clockwise reverse the sign
+	EXPECT_LT(txPredicates::InCircle(a, c, b, inside), 0.0);
+
+	// one ulp off the circle
+	txVertex justOut = { 1, 1+ldexp(1.0, -52) };
+	txVertex justIn = { 1, 1-ldexp(1.0, -53) };
+	EXPECT_LT(txPredicates::InCircle(a, b, c, justOut), 0.0);
+	EXPECT_GT(txPredicates::InCircle(a, b, c, justIn), 0.0);
+	EXPECT_LT(txPredicates::InCircleExact(a, b, c, justOut), 0.0);
+	EXPECT_GT(txPredicates::InCircleExact(a, b, c, justIn), 0.0);
+}
+
+// Benchmark: the filtered predicate against the txMatrix3 determinant used
+// before, on random ( not degenerate ) points.
+TEST(txPredicates, OrientationBenchmark) {
+	const int n = 1000;
+	const int rounds = 2000;
+	std::vector<txVertex> points(n);
+	srand(17);
+	for (int i=0; i<n; i++) {
+		points[i].x = 1000.0*rand()/RAND_MAX;
+		points[i].y = 1000.0*rand()/RAND_MAX;
+	}
+
+	int filteredSum = 0;
+	clock_t start = clock();
+	for (int r=0; r<rounds; r++) {
+		for (int i=0; i+2<n; i++) {
+			filteredSum += Sign(txPredicates::Orient2d(points[i], points[i+1], points[i+2]));
+		}
+	}
+	clock_t filteredTime = clock()-start;
+
+	int matrixSum = 0;
+	start = clock();
+	for (int r=0; r<rounds; r++) {
+		for (int i=0; i+2<n; i++) {
+			const txVertex &v0 = points[i], &v1 = points[i+1], &v2 = points[i+2];
+			txMatrix3 m(v0.x, v1.x, v2.x, v0.y, v1.y, v2.y, 1, 1, 1);
+			matrixSum += Sign(m.Determinant());
+		}
+	}
+	clock_t matrixTime = clock()-start;
+
+	EXPECT_EQ(matrixSum, filteredSum);
+	printf("orientation of %d triples: filtered %.1f ms, txMatrix3 %.1f ms\n", rounds*(n-2),
+		1000.0*filteredTime/CLOCKS_PER_SEC, 1000.0*matrixTime/CLOCKS_PER_SEC);
+}
@@ -0,0 +1,35 @@
+#include "VoronoiBench.h"
+#include <stdlib.h>
+
+// Count the allocations by putting malloc in front of the glibc one. The
+// executable's definitions win over libc's for every library in the
+// process, including libstdc++'s operator new. free is left to glibc.
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t n, size_t size);
+extern "C" void *__libc_realloc(void *p, size_t size);
+
+static size_t allocationCount = 0;
+
+extern "C" void *malloc(size_t size)
+{
+	allocationCount++;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t n, size_t size)
+{
+	allocationCount++;
+	return __libc_calloc(n, size);
+}
+
+extern "C" void *realloc(void *p, size_t size)
+{
+	allocationCount++;
+	return __libc_realloc(p, size);
+}
+
+size_t AllocationCount()
+{
+	return allocationCount;
+}
@@ -0,0 +1,29 @@
+#include "VoronoiBench.h"
+#include <stdio.h>
+#include "../VoronoiDiagram/VoronoiDiagramDLL/VoronoiBuilder.h"
+#include "../VoronoiDiagram/VoronoiDiagramDLL/mesh.h"
+
+// txVoronoiBuilder, clipped to the same box the generators get. The box
+// sides that close the cells are not counted as edges since the generators
+// don't output them.
+long RunBuilder(const txBenchSites &sites)
+{
+	size_t n = sites.x.size();
+	std::vector<txVertex> vertices(n);
+	for (size_t i=0; i<n; i++) {
+		vertices[i].x = sites.x[i];
+		vertices[i].y = sites.y[i];
+	}
+
+	txVoronoiBuilder builder((int)n);
+	builder.AddSites(&vertices[0], n);
+	builder.Build();
+	txBox box = { sites.minX, sites.minY, sites.maxX, sites.maxY };
+	builder.Clip(box);
+	const txMesh &mesh = builder.GetMesh();
+	long edges = 0;
+	for (int h=0; h<mesh.NumOfHalfEdges(); h+=2) {
+		if ( mesh.HalfEdge(h).faceId>=0 && mesh.HalfEdge(h+1).faceId>=0 ) edges++;
+	}
+	return edges;
+}
@@ -0,0 +1,429 @@
+// Voronoi cache check
+//
+// MapManagerLibrary/mapmanager/VoronoiDiagramCache, the diagram
+// MapManager::generateVoronoi keeps so that an edit only makes part of it
+// again, on a map of random blocks. One csv row per map size:
+//   size,sites,lines,vertex_pairs,vertices,edits,updates,update_ms_mean,rebuild_ms_mean,wrong
+//
+// Three things are checked, and every list that differs counts in wrong:
+//  - the lists the cache makes from the generator's edges are the ones
+//    generateVoronoi made before the cache, from getNext, getNextVertexPair
+//    and getNextVertex of the generator ( the lines in millimetres, the
+//    vertex pairs and vertices in grid cells, those with an end between the
+//    thresholds left out )
+//  - the same from the edges of VoronoiTiledGenerator in 4 tiles, with the
+//    vertex pairs compared without their direction, as the tiles number the
+//    vertices their own way
+//  - after every one of the random edits, the lists updateVoronoi leaves,
+//    against the cache rebuilt from the whole map, the vertex pairs again
+//    without their direction
+// The lists are compared as sorted lists of their values, exactly. The
+// sites are found as generateVoronoi does, the boundary cells from the
+// lowest x up. updates is the edits done by an update rather than a
+// rebuild, update_ms_mean the time of one, rebuild_ms_mean that of the
+// whole diagram. The program exits with 2 if any list differs.
+//
+// The cache, the generators and the roadmap are compiled in a namespace with
+// the logger of MapManagerGeneratorRunner.cpp, and the few SosUtil
+// functions the cache uses are defined here, sosutil/SosUtil.cpp is windows
+// code.
+
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <vector>
+#include "iostream.h"
+#include "fstream.h"
+#include "../MapManagerLibrary/sosutil/Threaded.h"
+
+namespace mapmanager_cache {
+
+class Logger
+{
+public:
+	static ostream *getFileOstream(){
+		static ostream nullOutput(0);
+		return &nullOutput;
+	}
+	static ostream *getScreenOstream(){ return getFileOstream(); }
+	static ostream *getNullOutput(){ return getFileOstream(); }
+};
+
+inline const char *stripPath(const char *str){ return str; }
+
+#include "../MapManagerLibrary/voronoi/VoronoiDiagramGenerator.cpp"
+#include "../MapManagerLibrary/voronoi/VoronoiTiledGenerator.cpp"
+#include "../MapManagerLibrary/mapmanager/VoronoiRoadmap.cpp"
+#include "../MapManagerLibrary/mapmanager/VoronoiDiagramCache.cpp"
+
+bool SosUtil::between(double num, double lowerVal, double upperVal)
+{
+	return (num >= lowerVal && num <= upperVal) || (num <= lowerVal && num >= upperVal);
+}
+float SosUtil::minVal(float num1, float num2){ return (num1<num2) ? num1 : num2; }
+float SosUtil::maxVal(float num1, float num2){ return (num1>num2) ? num1 : num2; }
+long SosUtil::minVal(long num1, long num2){ return (num1<num2) ? num1 : num2; }
+long SosUtil::maxVal(long num1, long num2){ return (num1>num2) ? num1 : num2; }
+double SosUtil::radToDeg(double rad){ return rad*180.0/PI; }
+}
+
+using mapmanager_cache::LineXY;
+using mapmanager_cache::PointXY;
+using mapmanager_cache::List;
+
+static const float THRESHOLD1 = 0.75f, THRESHOLD2 = 1.0f;
+static const float MIN_DISTANCE = 1.5f;
+static const long RESOLUTION = 50;
+// as VORONOI_UPDATE_MAX_FRACTION in MapManager.h
+static const double MAX_FRACTION = 0.25;
+
+// the map, 1 for an occupied cell and 0 for a free one. Outside it the cells
+// are free
+class txCacheGrid : public mapmanager_cache::ICopyRow2D<float>
+{
+public:
+	txCacheGrid(long size):size(size), cells(size*size, 0.0f){}
+
+	float read(long x, long y) const {
+		return ( x<0 || y<0 || x>=size || y>=size ) ? 0.0f : cells[y*size+x];
+	}
+	void write(long x, long y, float value){
+		if ( x>=0 && y>=0 && x<size && y<size ) cells[y*size+x] = value;
+	}
+	bool copyRow(float *arrayRef, long y, long fromX, long toX){
+		for (long x=fromX; x<=toX; x++) *arrayRef++ = read(x, y);
+		return true;
+	}
+
+	long size;
+
+private:
+	std::vector<float> cells;
+};
+
+// MapManager::gridToMm
+class txCacheMm : public mapmanager_cache::IGridToMm
+{
+public:
+	void gridToMm(float gridX, float gridY, long &mmX, long &mmY){
+		mmX = long(gridX*(float)RESOLUTION);
+		mmY = long(gridY*(float)RESOLUTION);
+	}
+};
+
+// the three lists of MapManager
+struct txCacheLists{
+	List<LineXY>  lines, vertexPairs;
+	List<PointXY> vertices;
+
+	void clear(){ lines.clear(); vertexPairs.clear(); vertices.clear(); }
+};
+
+// xorshift64* as in Workloads.cpp
+class txCacheRandom
+{
+public:
+	txCacheRandom(unsigned int seed):state(seed*2685821657736338717ULL+1){}
+	unsigned long long next(){
+		state ^= state>>12; state ^= state<<25; state ^= state>>27;
+		return state*2685821657736338717ULL;
+	}
+	long below(long n){ return (long)(next()%(unsigned long long)n); }
+
+private:
+	unsigned long long state;
+};
+
+static double NowMs()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1000.0+t.tv_nsec/1000000.0;
+}
+
+static bool Between(float value)
+{
+	return (value>=THRESHOLD1 && value<=THRESHOLD2) || (value<=THRESHOLD1 && value>=THRESHOLD2);
+}
+
+static bool BetweenAt(const txCacheGrid &grid, float x, float y)
+{
+	long xL = (x<0) ? (long)(x-1) : (long)x;
+	long yL = (y<0) ? (long)(y-1) : (long)y;
+	return Between(grid.read(xL, yL));
+}
+
+// the boundary cells of the window, as generateVoronoi always found them
+static void Scan(const txCacheGrid &grid, long west, long south, long east, long north,
+	std::vector<float> &xValues, std::vector<float> &yValues)
+{
+	xValues.clear();
+	yValues.clear();
+	for (long x=west; x<=east; x++) {
+		for (long y=south; y<=north; y++) {
+			if ( !Between(grid.read(x, y)) ) continue;
+			bool boundary = false;
+			for (long dy=-1; dy<=1 && !boundary; dy++) {
+				for (long dx=-1; dx<=1; dx++) {
+					if ( (dx!=0 || dy!=0) && !Between(grid.read(x+dx, y+dy)) ) boundary = true;
+				}
+			}
+			if ( boundary ) {
+				xValues.push_back((float)x+0.5f);
+				yValues.push_back((float)y+0.5f);
+			}
+		}
+	}
+}
+
+static bool Generate(mapmanager_cache::VoronoiDiagramGenerator &vdg, const txCacheGrid &grid,
+	long west, long south, long east, long north, mapmanager_cache::VoronoiSiteEdgeBuffer &edges)
+{
+	std::vector<float> xValues, yValues;
+	Scan(grid, west, south, east, north, xValues, yValues);
+	edges.clear();
+	return xValues.empty() || vdg.generateVoronoi(&xValues[0], &yValues[0], (int)xValues.size(),
+		0.0f, (float)(grid.size-1), 0.0f, (float)(grid.size-1), MIN_DISTANCE, false, &edges);
+}
+
+static void Rebuild(mapmanager_cache::VoronoiDiagramCache &cache, const mapmanager_cache::VoronoiSiteEdgeBuffer &edges,
+	txCacheGrid &grid, txCacheLists &lists)
+{
+	txCacheMm mm;
+	cache.rebuild(edges, grid, mm, THRESHOLD1, THRESHOLD2, MIN_DISTANCE, RESOLUTION,
+		0, grid.size-1, grid.size-1, 0, lists.lines, lists.vertexPairs, lists.vertices);
+}
+
+// MapManager::updateVoronoi
+static bool Update(mapmanager_cache::VoronoiDiagramCache &cache, mapmanager_cache::VoronoiDiagramGenerator &vdg,
+	txCacheGrid &grid, long west, long north, long east, long south, txCacheLists &lists)
+{
+	txCacheMm mm;
+	mapmanager_cache::VoronoiSiteEdgeBuffer edges;
+	long windowWest = 0, windowNorth = 0, windowEast = 0, windowSouth = 0;
+	cache.beginUpdate(west, north, east, south, windowWest, windowNorth, windowEast, windowSouth);
+	while ( (double)(windowEast-windowWest+1)*(double)(windowNorth-windowSouth+1) <=
+		MAX_FRACTION*(double)grid.size*(double)grid.size ) {
+		if ( !Generate(vdg, grid, windowWest, windowSouth, windowEast, windowNorth, edges) ) return false;
+		if ( cache.finishUpdate(edges, grid, mm, windowWest, windowNorth, windowEast, windowSouth,
+			lists.lines, lists.vertexPairs, lists.vertices) ) return true;
+	}
+	return false;
+}
+
+struct txCacheLine{
+	float x1, y1, x2, y2;
+	bool operator<(const txCacheLine &l) const {
+		if ( x1!=l.x1 ) return x1<l.x1;
+		if ( y1!=l.y1 ) return y1<l.y1;
+		if ( x2!=l.x2 ) return x2<l.x2;
+		return y2<l.y2;
+	}
+	bool operator==(const txCacheLine &l) const { return x1==l.x1 && y1==l.y1 && x2==l.x2 && y2==l.y2; }
+};
+
+// the values of the list, sorted. With 'undirected' the lower end of each comes first
+static std::vector<txCacheLine> Sorted(List<LineXY> &list, bool undirected)
+{
+	std::vector<txCacheLine> values;
+	LineXY line;
+	list.resetIterator();
+	while ( list.readNext(line) ) {
+		txCacheLine l = { line.pt1.x, line.pt1.y, line.pt2.x, line.pt2.y };
+		if ( undirected && (l.x2<l.x1 || (l.x2==l.x1 && l.y2<l.y1)) ) {
+			std::swap(l.x1, l.x2);
+			std::swap(l.y1, l.y2);
+		}
+		values.push_back(l);
+	}
+	std::sort(values.begin(), values.end());
+	return values;
+}
+
+static std::vector<txCacheLine> Sorted(List<PointXY> &list)
+{
+	std::vector<txCacheLine> values;
+	PointXY pt;
+	list.resetIterator();
+	while ( list.readNext(pt) ) {
+		txCacheLine l = { pt.x, pt.y, 0, 0 };
+		values.push_back(l);
+	}
+	std::sort(values.begin(), values.end());
+	return values;
+}
+
+// the lists that differ
+static long Compare(txCacheLists &a, txCacheLists &b, bool undirected)
+{
+	return (Sorted(a.lines, false)==Sorted(b.lines, false) ? 0 : 1) +
+		(Sorted(a.vertexPairs, undirected)==Sorted(b.vertexPairs, undirected) ? 0 : 1) +
+		(Sorted(a.vertices)==Sorted(b.vertices) ? 0 : 1);
+}
+
+// the lists as generateVoronoi made them from the generator, before the cache
+static bool Reference(txCacheGrid &grid, txCacheLists &lists)
+{
+	std::vector<float> xValues, yValues;
+	Scan(grid, 0, 0, grid.size-1, grid.size-1, xValues, yValues);
+	lists.clear();
+	if ( xValues.empty() ) return true;
+
+	mapmanager_cache::VoronoiDiagramGenerator vdg;
+	if ( !vdg.generateVoronoi(&xValues[0], &yValues[0], (int)xValues.size(),
+		0.0f, (float)(grid.size-1), 0.0f, (float)(grid.size-1), MIN_DISTANCE) ) return false;
+
+	txCacheMm mm;
+	LineXY line;
+	float x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+	long x1L = 0, y1L = 0, x2L = 0, y2L = 0;
+	vdg.resetIterator();
+	while ( vdg.getNext(x1, y1, x2, y2) ) {
+		if ( BetweenAt(grid, x1, y1) || BetweenAt(grid, x2, y2) ) continue;
+		mm.gridToMm(x1, y1, x1L, y1L);
+		mm.gridToMm(x2, y2, x2L, y2L);
+		line.setPoints(x1L, y1L, x2L, y2L);
+		lists.lines.push(line);
+	}
+	vdg.resetVertexPairIterator();
+	while ( vdg.getNextVertexPair(x1, y1, x2, y2) ) {
+		if ( BetweenAt(grid, x1, y1) || BetweenAt(grid, x2, y2) ) continue;
+		line.setPoints(x1, y1, x2, y2);
+		lists.vertexPairs.push(line);
+	}
+	PointXY pt;
+	vdg.resetVerticesIterator();
+	while ( vdg.getNextVertex(pt.x, pt.y) ) {
+		if ( !BetweenAt(grid, pt.x, pt.y) ) lists.vertices.push(pt);
+	}
+	return true;
+}
+
+// blocks of random sizes over about a fifth of the map
+static void MakeMap(txCacheGrid &grid, txCacheRandom &random)
+{
+	long blocks = grid.size*grid.size/200;
+	for (long b=0; b<blocks; b++) {
+		long x = random.below(grid.size), y = random.below(grid.size);
+		long width = 1+random.below(12), height = 1+random.below(12);
+		for (long dy=0; dy<height; dy++) {
+			for (long dx=0; dx<width; dx++) grid.write(x+dx, y+dy, 1.0f);
+		}
+	}
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: voronoicache [options]\n"
+		"  -sizes list   comma separated sides of the map in cells ( 64,128,256 )\n"
+		"  -edits n      random edits of every map ( 200 )\n"
+		"  -seed n       seed of the maps and edits ( 1 )\n");
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<long> sizes;
+	long numOfEdits = 200;
+	unsigned int seed = 1;
+	for (int i=1; i<argc; i++) {
+		if ( i+1>=argc ) { PrintUsage(); return 1; }
+		const char *option = argv[i];
+		char *value = argv[++i];
+		if ( strcmp(option, "-edits")==0 ) numOfEdits = atol(value);
+		else if ( strcmp(option, "-seed")==0 ) seed = (unsigned int)atoi(value);
+		else if ( strcmp(option, "-sizes")==0 ) {
+			for (char *size = strtok(value, ","); size!=NULL; size = strtok(NULL, ",")) sizes.push_back(atol(size));
+		} else {
+			PrintUsage();
+			return 1;
+		}
+	}
+	if ( sizes.empty() ) {
+		sizes.push_back(64);
+		sizes.push_back(128);
+		sizes.push_back(256);
+	}
+
+	bool allSame = true;
+	printf("size,sites,lines,vertex_pairs,vertices,edits,updates,update_ms_mean,rebuild_ms_mean,wrong\n");
+	for (size_t s=0; s<sizes.size(); s++) {
+		txCacheRandom random(seed);
+		txCacheGrid grid(sizes[s]);
+		MakeMap(grid, random);
+		long wrong = 0;
+
+		// the lists from the generator and from the tiles, against those from before the cache
+		txCacheLists reference, lists, tiledLists;
+		std::vector<float> xValues, yValues;
+		Scan(grid, 0, 0, grid.size-1, grid.size-1, xValues, yValues);
+		mapmanager_cache::VoronoiDiagramGenerator vdg;
+		mapmanager_cache::VoronoiSiteEdgeBuffer edges;
+		mapmanager_cache::VoronoiDiagramCache cache, tiledCache;
+		if ( !Reference(grid, reference) || !Generate(vdg, grid, 0, 0, grid.size-1, grid.size-1, edges) ) {
+			fprintf(stderr, "%ld: the diagram failed\n", grid.size);
+			return 1;
+		}
+		Rebuild(cache, edges, grid, lists);
+		wrong += Compare(lists, reference, false);
+
+		mapmanager_cache::VoronoiTiledGenerator tiles;
+		edges.clear();
+		if ( !xValues.empty() && !tiles.generateVoronoi(&xValues[0], &yValues[0], (long)xValues.size(),
+			0.0f, (float)(grid.size-1), 0.0f, (float)(grid.size-1), MIN_DISTANCE, 4, 0.0f, &edges) ) {
+			fprintf(stderr, "%ld: the tiled diagram failed\n", grid.size);
+			return 1;
+		}
+		Rebuild(tiledCache, edges, grid, tiledLists);
+		wrong += Compare(tiledLists, reference, true);
+
+		// the edits, each updated, against the whole diagram made again
+		long updates = 0;
+		double updateMs = 0, rebuildMs = 0;
+		for (long e=0; e<numOfEdits; e++) {
+			long west = random.below(grid.size), south = random.below(grid.size);
+			long east = std::min(grid.size-1, west+random.below(8));
+			long north = std::min(grid.size-1, south+random.below(8));
+			float value = (random.below(2)==0) ? 0.0f : 1.0f;
+			for (long y=south; y<=north; y++) {
+				for (long x=west; x<=east; x++) grid.write(x, y, value);
+			}
+
+			double start = NowMs();
+			if ( cache.matches(THRESHOLD1, THRESHOLD2, MIN_DISTANCE, RESOLUTION, 0, grid.size-1, grid.size-1, 0,
+				lists.lines, lists.vertexPairs, lists.vertices) &&
+				Update(cache, vdg, grid, west, north, east, south, lists) ) {
+				updateMs += NowMs()-start;
+				updates++;
+			} else if ( Generate(vdg, grid, 0, 0, grid.size-1, grid.size-1, edges) ) {
+				Rebuild(cache, edges, grid, lists);
+			}
+
+			txCacheLists whole;
+			mapmanager_cache::VoronoiDiagramCache wholeCache;
+			start = NowMs();
+			Generate(vdg, grid, 0, 0, grid.size-1, grid.size-1, edges);
+			Rebuild(wholeCache, edges, grid, whole);
+			rebuildMs += NowMs()-start;
+			long differ = Compare(lists, whole, true);
+			if ( differ!=0 ) fprintf(stderr, "%ld: edit %ld of (%ld,%ld)-(%ld,%ld) left %ld lists wrong\n",
+				grid.size, e, west, south, east, north, differ);
+			wrong += differ;
+		}
+		if ( wrong!=0 ) allSame = false;
+
+		printf("%ld,%lu,%ld,%ld,%ld,%ld,%ld,%.3f,%.3f,%ld\n", grid.size, (unsigned long)xValues.size(),
+			reference.lines.getListSize(), reference.vertexPairs.getListSize(), reference.vertices.getListSize(),
+			numOfEdits, updates, updates>0 ? updateMs/updates : 0.0, numOfEdits>0 ? rebuildMs/numOfEdits : 0.0, wrong);
+		fflush(stdout);
+	}
+	return allSame ? 0 : 2;
+}
@@ -0,0 +1,25 @@
+// code/VoronoiDiagramGenerator, built in its own namespace since the
+// MapManager copy has the same class and struct names. Its system headers
+// are included first so the include guards keep them out of the namespace.
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "VoronoiBench.h"
+
+namespace code_generator {
+#include "../code/VoronoiDiagramGenerator.cpp"
+}
+
+long RunCodeGenerator(const txBenchSites &sites)
+{
+	code_generator::VoronoiDiagramGenerator vdg;
+	if ( !vdg.generateVoronoi(const_cast<float*>(&sites.x[0]), const_cast<float*>(&sites.y[0]), (int)sites.x.size(),
+		sites.minX, sites.maxX, sites.minY, sites.maxY) ) {
+		return -1;
+	}
+	long edges = 0;
+	float x1, y1, x2, y2;
+	vdg.resetIterator();
+	while ( vdg.getNext(x1, y1, x2, y2) ) edges++;
+	return edges;
+}
@@ -0,0 +1,61 @@
+#include "VoronoiBench.h"
+#include <math.h>
+#include <algorithm>
+
+// The sites go in square cells of about 2 sites each, the two nearest of a
+// point are searched ring by ring around its cell until the ring is farther
+// than the second nearest.
+txBenchEdgeCheck::txBenchEdgeCheck(const txBenchSites &sites):sites(&sites),badEdges(0)
+{
+	size_t n = sites.x.size();
+	double width = sites.maxX-sites.minX, height = sites.maxY-sites.minY;
+	double spacing = n>0 ? sqrt(width*height/n) : 1.0;
+	if ( spacing<=0.0 ) spacing = 1.0;
+	tolerance = spacing/1000.0;
+	cellSize = spacing*1.5;
+	columns = (long)(width/cellSize)+1;
+	rows = (long)(height/cellSize)+1;
+
+	cellStart.assign((size_t)columns*rows+1, 0);
+	std::vector<size_t> cellOf(n);
+	for (size_t i=0; i<n; i++) {
+		long cx = std::min(columns-1, std::max(0L, (long)((sites.x[i]-sites.minX)/cellSize)));
+		long cy = std::min(rows-1, std::max(0L, (long)((sites.y[i]-sites.minY)/cellSize)));
+		cellOf[i] = (size_t)(cy*columns+cx);
+		cellStart[cellOf[i]+1]++;
+	}
+	for (size_t c=1; c<cellStart.size(); c++) cellStart[c] += cellStart[c-1];
+	std::vector<size_t> fill(cellStart.begin(), cellStart.end()-1);
+	cellSites.resize(n);
+	for (size_t i=0; i<n; i++) cellSites[fill[cellOf[i]]++] = i;
+}
+
+void txBenchEdgeCheck::Add(double x1, double y1, double x2, double y2)
+{
+	double px = (x1+x2)/2.0, py = (y1+y2)/2.0;
+	long cx = std::min(columns-1, std::max(0L, (long)((px-sites->minX)/cellSize)));
+	long cy = std::min(rows-1, std::max(0L, (long)((py-sites->minY)/cellSize)));
+	double best[2] = { HUGE_VAL, HUGE_VAL };
+	for (long ring=0; ring<=std::max(columns, rows); ring++) {
+		// everything outside the rings done so far is at least this far
+		double reach = (ring-1)*cellSize;
+		if ( ring>0 && reach>0.0 && reach*reach>best[1] ) break;
+		for (long y=cy-ring; y<=cy+ring; y++) {
+			if ( y<0 || y>=rows ) continue;
+			bool edgeRow = y==cy-ring || y==cy+ring;
+			for (long x=cx-ring; x<=cx+ring; x += edgeRow ? 1 : 2*ring) {
+				if ( x>=0 && x<columns ) {
+					size_t c = (size_t)(y*columns+x);
+					for (size_t k=cellStart[c]; k<cellStart[c+1]; k++) {
+						double dx = sites->x[cellSites[k]]-px, dy = sites->y[cellSites[k]]-py;
+						double d = dx*dx+dy*dy;
+						if ( d<best[0] ) { best[1] = best[0]; best[0] = d; }
+						else if ( d<best[1] ) best[1] = d;
+					}
+				}
+				if ( ring==0 ) break;
+			}
+		}
+	}
+	if ( best[1]==HUGE_VAL || sqrt(best[1])-sqrt(best[0])>tolerance ) badEdges++;
+}
@@ -0,0 +1,134 @@
+#include "VoronoiBench.h"
+#include "../code/fortunevoronoi/voronoi.h"
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+bool WriteFortuneInput(const char *fileName, const txBenchSites &sites, bool binary)
+{
+	FILE *file = fopen(fileName, binary ? "wb" : "w");
+	if ( file==NULL ) return false;
+	for (size_t i=0; i<sites.x.size(); i++) {
+		if ( binary ) {
+			float point[2] = { sites.x[i], sites.y[i] };
+			fwrite(point, sizeof(point), 1, file);
+		}
+		else fprintf(file, "%.9g %.9g\n", sites.x[i], sites.y[i]);
+	}
+	return fclose(file)==0;
+}
+
+// Count the lines that start with 'e', reading the pipe in big blocks
+static long CountEdgeLines(int fd)
+{
+	static char buffer[1<<16];
+	long edges = 0;
+	bool lineStart = true;
+	ssize_t len;
+	while ( (len = read(fd, buffer, sizeof(buffer)))>0 ) {
+		for (ssize_t i=0; i<len; i++) {
+			if ( lineStart && buffer[i]=='e' ) edges++;
+			lineStart = buffer[i]=='\n';
+		}
+	}
+	return edges;
+}
+
+// Count the edge records of -b, every record is a tag and a fixed size.
+// next is where the next tag is, from the start of the block
+static long CountEdgeRecords(int fd)
+{
+	static char buffer[1<<16];
+	long edges = 0;
+	size_t next = 0;
+	ssize_t len;
+	while ( (len = read(fd, buffer, sizeof(buffer)))>0 ) {
+		size_t i = next;
+		while ( i<(size_t)len ) {
+			switch ( buffer[i] ) {
+			case VORONOI_RECORD_EDGE:   edges++; i += 1 + 3*sizeof(int); break;
+			case VORONOI_RECORD_LINE:   i += 1 + 3*sizeof(double); break;
+			case VORONOI_RECORD_SITE:
+			case VORONOI_RECORD_VERTEX: i += 1 + 2*sizeof(float); break;
+			default:                    i += 1 + 3*sizeof(int); break;
+			}
+		}
+		next = i - (size_t)len;
+	}
+	return edges;
+}
+
+long RunFortune(const char *exe, const char *inputFile, bool binary, int timeout, long &peakRssKb, bool &killedByTimeout)
+{
+	peakRssKb = 0;
+	killedByTimeout = false;
+
+	int output[2];
+	if ( pipe(output)!=0 ) return -1;
+
+	pid_t pid = fork();
+	if ( pid<0 ) {
+		close(output[0]);
+		close(output[1]);
+		return -1;
+	}
+	if ( pid==0 ) {
+		int input = open(inputFile, O_RDONLY);
+		if ( input<0 ) _exit(127);
+		dup2(input, 0);
+		dup2(output[1], 1);
+		close(input);
+		close(output[0]);
+		close(output[1]);
+		// the alarm stays across exec
+		if ( timeout>0 ) alarm(timeout);
+		if ( binary ) execl(exe, exe, "-i", "f", "-b", (char*)NULL);
+		else execl(exe, exe, (char*)NULL);
+		_exit(127);
+	}
+
+	close(output[1]);
+	long edges = binary ? CountEdgeRecords(output[0]) : CountEdgeLines(output[0]);
+	close(output[0]);
+
+	int status = 0;
+	struct rusage usage;
+	memset(&usage, 0, sizeof(usage));
+	if ( wait4(pid, &status, 0, &usage)!=pid ) return -1;
+	peakRssKb = usage.ru_maxrss;
+	if ( WIFSIGNALED(status) && WTERMSIG(status)==SIGALRM ) {
+		killedByTimeout = true;
+		return -1;
+	}
+	if ( !WIFEXITED(status) || WEXITSTATUS(status)!=0 ) return -1;
+	return edges;
+}
+
+static void CountEdge(void *arg, struct Edge *)
+{
+	(*(long *)arg)++;
+}
+
+long RunFortuneLibrary(const txBenchSites &sites)
+{
+	std::vector<struct Point> points(sites.x.size());
+	for (size_t i=0; i<points.size(); i++) {
+		points[i].x = sites.x[i];
+		points[i].y = sites.y[i];
+	}
+	long edges = 0;
+	struct VoronoiOutput output;
+	memset(&output, 0, sizeof(output));
+	output.arg = &edges;
+	output.edge = CountEdge;
+	struct Voronoi *vd = voronoi_create(&output);
+	if ( vd==NULL ) return -1;
+	int r = voronoi_run(vd, &points[0], (int)points.size());
+	voronoi_destroy(vd);
+	return r==0 ? edges : -1;
+}
@@ -0,0 +1,421 @@
+// Voronoi grid check
+//
+// MapManagerLibrary/mapmanager/GridDistanceTransform, the distance transform
+// and ridges MapManager::generateVoronoiGrid makes its lists from, against a
+// brute force search, and its time against that of the lists
+// MapManager::generateVoronoi makes, on maps of random blocks. One csv row per
+// map size:
+//   size,threads,sites,ridge_cells,grid_lines,voronoi_lines,grid_ms,voronoi_ms,edt_wrong,ridge_wrong,scan_wrong
+//
+// Three things are checked:
+//  - edt_wrong is the cells whose squared distance to the nearest occupied
+//    cell is not the least one over all the occupied cells, or whose nearest
+//    cell is not occupied. Every cell is checked on maps up to 128 cells a
+//    side, 4096 random cells on the bigger ones
+//  - ridge_wrong is the cells that break what the ridges are: a ridge cell is
+//    free, and has a neighbour whose nearest occupied cell is at least
+//    minDistance from its own, and of two such neighbours at least one is a
+//    ridge cell
+//  - scan_wrong is the boundary cells VoronoiSiteScan finds in -threads
+//    stripes that the loop generateVoronoi had before it does not, and the
+//    other way round, and the sites out of the y then x order the scan gives
+//    them in
+// grid_ms is the transform, findRidges and getRidges, voronoi_ms the
+// boundary cells of VoronoiSiteScan, the generator and the lists of
+// VoronoiDiagramCache, each the mean of -runs runs. The program exits with 2
+// if any cell is wrong. Some of the blocks are -1, which is occupied too.
+//
+// The transform, the scan, the generator and the cache are compiled in a namespace with
+// the logger of MapManagerGeneratorRunner.cpp. The map is a GridMapLayer of
+// its own, the one of the mapmanager library is windows code, as are the few
+// SosUtil functions defined here.
+
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <vector>
+#include "iostream.h"
+#include "fstream.h"
+#include "../MapManagerLibrary/sosutil/Threaded.h"
+
+// the map of the transform and the scan is the one below, not mapmanager/GridMapLayer.h
+#define GRIDMAPLAYER_H
+
+namespace mapmanager_grid {
+
+class Logger
+{
+public:
+	static ostream *getFileOstream(){
+		static ostream nullOutput(0);
+		return &nullOutput;
+	}
+	static ostream *getScreenOstream(){ return getFileOstream(); }
+	static ostream *getNullOutput(){ return getFileOstream(); }
+};
+
+inline const char *stripPath(const char *str){ return str; }
+
+#include "../MapManagerLibrary/grid/Grid3D.h"
+
+// 1 or -1 for an occupied cell and 0 for a free one. Outside the map the
+// cells are free
+class GridMapLayer : public ICopyRow2D<float>
+{
+public:
+	GridMapLayer(long size):size(size), cells(size*size, 0.0f){}
+
+	float read(long x, long y) const {
+		return ( x<0 || y<0 || x>=size || y>=size ) ? 0.0f : cells[y*size+x];
+	}
+	void write(long x, long y, float value){
+		if ( x>=0 && y>=0 && x<size && y<size ) cells[y*size+x] = value;
+	}
+	bool copyRow(float *arrayRef, long y, long fromX, long toX){
+		return copyRowConcurrent(arrayRef, y, fromX, toX);
+	}
+	bool copyRowConcurrent(float *arrayRef, long y, long fromX, long toX) const {
+		for (long x=fromX; x<=toX; x++) *arrayRef++ = read(x, y);
+		return true;
+	}
+
+	long size;
+
+private:
+	std::vector<float> cells;
+};
+
+template<class T>
+class GridMap
+{
+public:
+	bool copyRowConcurrent(T *, long, long, long){ return false; }
+};
+
+#include "../MapManagerLibrary/voronoi/VoronoiDiagramGenerator.cpp"
+#include "../MapManagerLibrary/voronoi/VoronoiTiledGenerator.cpp"
+#include "../MapManagerLibrary/mapmanager/VoronoiRoadmap.cpp"
+#include "../MapManagerLibrary/mapmanager/VoronoiDiagramCache.cpp"
+#include "../MapManagerLibrary/mapmanager/GridDistanceTransform.cpp"
+#include "../MapManagerLibrary/mapmanager/VoronoiSiteScan.cpp"
+
+bool SosUtil::between(double num, double lowerVal, double upperVal)
+{
+	return (num >= lowerVal && num <= upperVal) || (num <= lowerVal && num >= upperVal);
+}
+bool SosUtil::ensureSmaller(float &num1, float &num2)
+{
+	if ( num2<num1 ) { std::swap(num1, num2); return true; }
+	return false;
+}
+float SosUtil::minVal(float num1, float num2){ return (num1<num2) ? num1 : num2; }
+float SosUtil::maxVal(float num1, float num2){ return (num1>num2) ? num1 : num2; }
+long SosUtil::minVal(long num1, long num2){ return (num1<num2) ? num1 : num2; }
+long SosUtil::maxVal(long num1, long num2){ return (num1>num2) ? num1 : num2; }
+double SosUtil::radToDeg(double rad){ return rad*180.0/PI; }
+}
+
+using mapmanager_grid::LineXY;
+using mapmanager_grid::PointXY;
+using mapmanager_grid::List;
+using mapmanager_grid::GridMapLayer;
+using mapmanager_grid::GridDistanceTransform;
+using mapmanager_grid::VoronoiSiteScan;
+
+static const float THRESHOLD1 = 0.75f, THRESHOLD2 = 1.0f;
+static const float MIN_DISTANCE = 1.5f;
+static const long RESOLUTION = 50;
+static const long SAMPLES = 4096;
+
+// MapManager::gridToMm
+class txGridMm : public mapmanager_grid::IGridToMm
+{
+public:
+	void gridToMm(float gridX, float gridY, long &mmX, long &mmY){
+		mmX = long(gridX*(float)RESOLUTION);
+		mmY = long(gridY*(float)RESOLUTION);
+	}
+};
+
+// the three lists of MapManager
+struct txGridLists{
+	List<LineXY>  lines, vertexPairs;
+	List<PointXY> vertices;
+};
+
+// xorshift64* as in Workloads.cpp
+class txGridRandom
+{
+public:
+	txGridRandom(unsigned int seed):state(seed*2685821657736338717ULL+1){}
+	unsigned long long next(){
+		state ^= state>>12; state ^= state<<25; state ^= state>>27;
+		return state*2685821657736338717ULL;
+	}
+	long below(long n){ return (long)(next()%(unsigned long long)n); }
+
+private:
+	unsigned long long state;
+};
+
+static double NowMs()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1000.0+t.tv_nsec/1000000.0;
+}
+
+static bool Between(float value)
+{
+	return (value>=THRESHOLD1 && value<=THRESHOLD2) || (value<=THRESHOLD1 && value>=THRESHOLD2);
+}
+
+// as the transform takes them, negative cells are occupied too
+static bool Occupied(const GridMapLayer &grid, long x, long y)
+{
+	float value = grid.read(x, y);
+	return value<0 || Between(value);
+}
+
+// the boundary cells, as generateVoronoi found them before VoronoiSiteScan,
+// up each column in turn
+static void Scan(const GridMapLayer &grid, std::vector<float> &xValues, std::vector<float> &yValues)
+{
+	xValues.clear();
+	yValues.clear();
+	for (long x=0; x<grid.size; x++) {
+		for (long y=0; y<grid.size; y++) {
+			// a negative cell is between the thresholds, but not as a neighbour
+			if ( grid.read(x, y)>=0 && !Between(grid.read(x, y)) ) continue;
+			bool boundary = false;
+			for (long dy=-1; dy<=1 && !boundary; dy++) {
+				for (long dx=-1; dx<=1; dx++) {
+					if ( (dx!=0 || dy!=0) && !Between(grid.read(x+dx, y+dy)) ) boundary = true;
+				}
+			}
+			if ( boundary ) {
+				xValues.push_back((float)x+0.5f);
+				yValues.push_back((float)y+0.5f);
+			}
+		}
+	}
+}
+
+// blocks of random sizes over about a fifth of the map, as voronoicache makes,
+// one in eight of them -1
+static void MakeMap(GridMapLayer &grid, txGridRandom &random)
+{
+	long blocks = grid.size*grid.size/200;
+	for (long b=0; b<blocks; b++) {
+		long x = random.below(grid.size), y = random.below(grid.size);
+		long width = 1+random.below(12), height = 1+random.below(12);
+		float value = (random.below(8)==0) ? -1.0f : 1.0f;
+		for (long dy=0; dy<height; dy++) {
+			for (long dx=0; dx<width; dx++) grid.write(x+dx, y+dy, value);
+		}
+	}
+}
+
+struct txGridSite{
+	float x, y;
+	bool operator<(const txGridSite &site) const { return y<site.y || (y==site.y && x<site.x); }
+	bool operator==(const txGridSite &site) const { return x==site.x && y==site.y; }
+};
+
+// the sites of the scan missing from those of the loop, the other way round,
+// and those out of order
+static long WrongSites(VoronoiSiteScan &scan, const std::vector<float> &xValues, const std::vector<float> &yValues)
+{
+	long wrong = 0;
+	std::vector<txGridSite> scanned(scan.getNumOfSites()), looped(xValues.size());
+	for (size_t i=0; i<scanned.size(); i++) {
+		scanned[i].x = scan.getXValues()[i];
+		scanned[i].y = scan.getYValues()[i];
+		if ( i>0 && !(scanned[i-1]<scanned[i]) ) wrong++;
+	}
+	for (size_t i=0; i<looped.size(); i++) {
+		looped[i].x = xValues[i];
+		looped[i].y = yValues[i];
+	}
+	std::sort(scanned.begin(), scanned.end());
+	std::sort(looped.begin(), looped.end());
+	std::vector<txGridSite> differ;
+	std::set_symmetric_difference(scanned.begin(), scanned.end(), looped.begin(), looped.end(),
+		std::back_inserter(differ));
+	return wrong+(long)differ.size();
+}
+
+static double Squared(long x1, long y1, long x2, long y2)
+{
+	return (double)(x1-x2)*(x1-x2)+(double)(y1-y2)*(y1-y2);
+}
+
+// the cell is wrong if its distance is not the least one to an occupied cell
+static bool WrongDistance(const GridDistanceTransform &transform, const GridMapLayer &grid,
+	const std::vector<long> &occupiedX, const std::vector<long> &occupiedY, long x, long y)
+{
+	double least = DBL_MAX;
+	for (size_t i=0; i<occupiedX.size(); i++) least = std::min(least, Squared(x, y, occupiedX[i], occupiedY[i]));
+
+	long nearestX = 0, nearestY = 0;
+	double squared = 0;
+	if ( !transform.getNearest(x, y, nearestX, nearestY) ) return !occupiedX.empty();
+	transform.getSquaredDistance(x, y, squared);
+	return !Occupied(grid, nearestX, nearestY) || squared!=least;
+}
+
+// the nearest occupied cells of the two cells are at least MIN_DISTANCE apart
+static bool Apart(const GridDistanceTransform &transform, long x1, long y1, long x2, long y2)
+{
+	long nearestX1 = 0, nearestY1 = 0, nearestX2 = 0, nearestY2 = 0;
+	if ( !transform.getNearest(x1, y1, nearestX1, nearestY1) || !transform.getNearest(x2, y2, nearestX2, nearestY2) ) return false;
+	if ( nearestX1==nearestX2 && nearestY1==nearestY2 ) return false;
+	return Squared(nearestX1, nearestY1, nearestX2, nearestY2)>=(double)MIN_DISTANCE*MIN_DISTANCE;
+}
+
+static long WrongRidges(const GridDistanceTransform &transform, const GridMapLayer &grid)
+{
+	static const long sideX[] = {1,0,-1,0};
+	static const long sideY[] = {0,1,0,-1};
+	long wrong = 0;
+	for (long y=0; y<grid.size; y++) {
+		for (long x=0; x<grid.size; x++) {
+			bool between = false, separated = true;
+			for (int side=0; side<4; side++) {
+				long nextX = x+sideX[side], nextY = y+sideY[side];
+				if ( nextX<0 || nextY<0 || nextX>=grid.size || nextY>=grid.size ) continue;
+				if ( !Apart(transform, x, y, nextX, nextY) ) continue;
+				between = true;
+				if ( side<2 && !transform.isRidge(x, y) && !transform.isRidge(nextX, nextY) &&
+					!(Occupied(grid, x, y) && Occupied(grid, nextX, nextY)) ) separated = false;
+			}
+			if ( transform.isRidge(x, y) && (Occupied(grid, x, y) || !between) ) wrong++;
+			else if ( !separated ) wrong++;
+		}
+	}
+	return wrong;
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: voronoigrid [options]\n"
+		"  -sizes list   comma separated sides of the map in cells ( 64,128,512,1024 )\n"
+		"  -threads n    threads of the transform and the scan ( 4, VORONOI_SCAN_THREADS )\n"
+		"  -runs n       runs each time is the mean of ( 3 )\n"
+		"  -seed n       seed of the maps ( 1 )\n");
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<long> sizes;
+	int numOfThreads = 4;
+	long runs = 3;
+	unsigned int seed = 1;
+	for (int i=1; i<argc; i++) {
+		if ( i+1>=argc ) { PrintUsage(); return 1; }
+		const char *option = argv[i];
+		char *value = argv[++i];
+		if ( strcmp(option, "-threads")==0 ) numOfThreads = atoi(value);
+		else if ( strcmp(option, "-runs")==0 ) runs = std::max(1L, atol(value));
+		else if ( strcmp(option, "-seed")==0 ) seed = (unsigned int)atoi(value);
+		else if ( strcmp(option, "-sizes")==0 ) {
+			for (char *size = strtok(value, ","); size!=NULL; size = strtok(NULL, ",")) sizes.push_back(atol(size));
+		} else {
+			PrintUsage();
+			return 1;
+		}
+	}
+	if ( sizes.empty() ) {
+		sizes.push_back(64);
+		sizes.push_back(128);
+		sizes.push_back(512);
+		sizes.push_back(1024);
+	}
+
+	bool allRight = true;
+	printf("size,threads,sites,ridge_cells,grid_lines,voronoi_lines,grid_ms,voronoi_ms,edt_wrong,ridge_wrong,scan_wrong\n");
+	for (size_t s=0; s<sizes.size(); s++) {
+		txGridRandom random(seed);
+		GridMapLayer grid(sizes[s]);
+		MakeMap(grid, random);
+
+		// generateVoronoiGrid
+		GridDistanceTransform transform;
+		txGridLists gridLists;
+		double gridMs = 0;
+		for (long r=0; r<runs; r++) {
+			double start = NowMs();
+			transform.transform(grid, 0, 0, grid.size-1, grid.size-1, THRESHOLD1, THRESHOLD2, numOfThreads);
+			transform.findRidges(MIN_DISTANCE);
+			transform.getRidges(RESOLUTION, gridLists.lines, gridLists.vertexPairs, gridLists.vertices);
+			gridMs += NowMs()-start;
+		}
+
+		// generateVoronoi
+		mapmanager_grid::VoronoiDiagramGenerator vdg;
+		vdg.setRetainMemory(true);
+		vdg.setSitesSorted(true);
+		mapmanager_grid::VoronoiDiagramCache cache;
+		VoronoiSiteScan scan;
+		txGridLists lists;
+		txGridMm mm;
+		double voronoiMs = 0;
+		for (long r=0; r<runs; r++) {
+			double start = NowMs();
+			if ( !scan.scan(grid, 0, 0, grid.size-1, grid.size-1, THRESHOLD1, THRESHOLD2, numOfThreads) ) {
+				fprintf(stderr, "%ld: the scan failed\n", grid.size);
+				return 1;
+			}
+			mapmanager_grid::VoronoiSiteEdgeBuffer edges;
+			if ( scan.getNumOfSites()>0 && !vdg.generateVoronoi(scan.getXValues(), scan.getYValues(), scan.getNumOfSites(),
+				0.0f, (float)(grid.size-1), 0.0f, (float)(grid.size-1), MIN_DISTANCE, false, &edges) ) {
+				fprintf(stderr, "%ld: the diagram failed\n", grid.size);
+				return 1;
+			}
+			cache.rebuild(edges, grid, mm, THRESHOLD1, THRESHOLD2, MIN_DISTANCE, RESOLUTION,
+				0, grid.size-1, grid.size-1, 0, lists.lines, lists.vertexPairs, lists.vertices);
+			voronoiMs += NowMs()-start;
+		}
+
+		// the distances, of every cell or of the samples
+		std::vector<long> occupiedX, occupiedY;
+		for (long y=0; y<grid.size; y++) {
+			for (long x=0; x<grid.size; x++) {
+				if ( Occupied(grid, x, y) ) { occupiedX.push_back(x); occupiedY.push_back(y); }
+			}
+		}
+		long edtWrong = 0;
+		if ( grid.size<=128 ) {
+			for (long y=0; y<grid.size; y++) {
+				for (long x=0; x<grid.size; x++) edtWrong += WrongDistance(transform, grid, occupiedX, occupiedY, x, y) ? 1 : 0;
+			}
+		} else {
+			for (long i=0; i<SAMPLES; i++) {
+				long x = random.below(grid.size), y = random.below(grid.size);
+				edtWrong += WrongDistance(transform, grid, occupiedX, occupiedY, x, y) ? 1 : 0;
+			}
+		}
+		long ridgeWrong = WrongRidges(transform, grid);
+
+		std::vector<float> xValues, yValues;
+		Scan(grid, xValues, yValues);
+		long scanWrong = WrongSites(scan, xValues, yValues);
+		if ( edtWrong!=0 || ridgeWrong!=0 || scanWrong!=0 ) allRight = false;
+
+		printf("%ld,%d,%ld,%ld,%ld,%ld,%.3f,%.3f,%ld,%ld,%ld\n", grid.size, numOfThreads, scan.getNumOfSites(),
+			transform.getNumOfRidgeCells(), gridLists.lines.getListSize(), lists.lines.getListSize(),
+			gridMs/runs, voronoiMs/runs, edtWrong, ridgeWrong, scanWrong);
+		fflush(stdout);
+	}
+	return allRight ? 0 : 2;
+}
@@ -0,0 +1,169 @@
+// MapManagerLibrary/voronoi/VoronoiDiagramGenerator, see
+// CodeGeneratorRunner.cpp for the namespace.
+//
+// The logger's "off" macros comment the LOG lines out by token pasting
+// "/##/", which only msvc accepts. So the logging is switched on
+// ( LOGGINGENABLED=1 and LOGGERSOS_H in the makefile skip the real Logger )
+// and goes into a stream without a buffer, whose insertions return right
+// away.
+//
+// Threaded is included before the namespace, its runThread friend is
+// compiled in sosutil/Threaded.cpp ( compat/windows.h puts it on pthreads ).
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include "iostream.h"
+#include "fstream.h"
+#include "VoronoiBench.h"
+#include "../MapManagerLibrary/sosutil/Threaded.h"
+
+namespace mapmanager_generator {
+
+class Logger
+{
+public:
+	static ostream *getFileOstream(){
+		static ostream nullOutput(0);
+		return &nullOutput;
+	}
+	static ostream *getScreenOstream(){ return getFileOstream(); }
+	static ostream *getNullOutput(){ return getFileOstream(); }
+};
+
+inline const char *stripPath(const char *str){ return str; }
+
+#include "../MapManagerLibrary/voronoi/VoronoiDiagramGenerator.cpp"
+}
+
+// Same calls as MapManager::generateVoronoi, the vertex links are
+// generated too ( genVectorInfo ).
+long RunMapManagerGenerator(const txBenchSites &sites, int priorityQueue, long &probes, txBenchEdgeCheck *check)
+{
+	typedef mapmanager_generator::VoronoiDiagramGenerator Generator;
+	static const int queues[] = {
+		Generator::PRIORITY_QUEUE_HASH, Generator::PRIORITY_QUEUE_HEAP, Generator::PRIORITY_QUEUE_ADAPTIVE
+	};
+	Generator vdg;
+	vdg.setGenerateDelaunay(false);
+	vdg.setGenerateVoronoi(true);
+	vdg.setPriorityQueue(queues[priorityQueue]);
+	if ( !vdg.generateVoronoi(const_cast<float*>(&sites.x[0]), const_cast<float*>(&sites.y[0]), (int)sites.x.size(),
+		sites.minX, sites.maxX, sites.minY, sites.maxY, 0.0f) ) {
+		return -1;
+	}
+	probes = vdg.getPQStats().probes;
+	long edges = 0;
+	float x1, y1, x2, y2;
+	vdg.resetIterator();
+	while ( vdg.getNext(x1, y1, x2, y2) ) {
+		if ( check ) check->Add(x1, y1, x2, y2);
+		edges++;
+	}
+	return edges;
+}
+
+// One generator with setRetainMemory kept over the calls, as a map that is
+// regenerated after every edit would use it. The first call warms it up.
+long RunMapManagerGeneratorRetained(const txBenchSites &sites)
+{
+	static mapmanager_generator::VoronoiDiagramGenerator vdg;
+	vdg.setRetainMemory(true);
+	vdg.setGenerateDelaunay(false);
+	vdg.setGenerateVoronoi(true);
+	if ( !vdg.generateVoronoi(const_cast<float*>(&sites.x[0]), const_cast<float*>(&sites.y[0]), (int)sites.x.size(),
+		sites.minX, sites.maxX, sites.minY, sites.maxY, 0.0f) ) {
+		return -1;
+	}
+	long edges = 0;
+	float x1, y1, x2, y2;
+	vdg.resetIterator();
+	while ( vdg.getNext(x1, y1, x2, y2) ) edges++;
+	return edges;
+}
+
+// The typed generators get the sites as Coord values times scale, the edges
+// are given back to the check in the units of the sites.
+template<class Coord>
+static long RunTypedGenerator(const std::vector<Coord> &x, const std::vector<Coord> &y, const txBenchSites &sites,
+	double scale, txBenchEdgeCheck *check)
+{
+	typedef mapmanager_generator::VoronoiDiagramGeneratorT<Coord> Generator;
+	typedef typename Generator::Real Real;
+	Generator vdg;
+	vdg.setGenerateDelaunay(false);
+	vdg.setGenerateVoronoi(true);
+	if ( !vdg.generateVoronoi(const_cast<Coord*>(&x[0]), const_cast<Coord*>(&y[0]), (int)x.size(),
+		(Real)(sites.minX*scale), (Real)(sites.maxX*scale), (Real)(sites.minY*scale), (Real)(sites.maxY*scale), 0.0f) ) {
+		return -1;
+	}
+	long edges = 0;
+	Real x1, y1, x2, y2;
+	vdg.resetIterator();
+	while ( vdg.getNext(x1, y1, x2, y2) ) {
+		if ( check ) check->Add(x1/scale, y1/scale, x2/scale, y2/scale);
+		edges++;
+	}
+	return edges;
+}
+
+long RunMapManagerGeneratorDouble(const txBenchSites &sites, txBenchEdgeCheck *check)
+{
+	std::vector<double> x(sites.x.begin(), sites.x.end()), y(sites.y.begin(), sites.y.end());
+	return RunTypedGenerator(x, y, sites, 1.0, check);
+}
+
+// The biggest power of 2 that keeps the extent of the sites below
+// VDG_EXACT_RANGE, and 1 when even that is too much. The sites are whole
+// numbers after it if they are multiples of a big enough power of 1/2.
+static double IntegerScale(const txBenchSites &sites)
+{
+	double extent = std::max(sites.maxX-sites.minX, sites.maxY-sites.minY);
+	double scale = 1.0;
+	while ( extent*scale*2.0<VDG_EXACT_RANGE && scale<(1<<20) ) scale *= 2.0;
+	return scale;
+}
+
+static long long RoundSite(float v, double scale)
+{
+	return (long long)floor(v*scale+0.5);
+}
+
+long RunMapManagerGeneratorInt64(const txBenchSites &sites, txBenchEdgeCheck *check)
+{
+	double scale = IntegerScale(sites);
+	size_t n = sites.x.size();
+	std::vector<long long> x(n), y(n);
+	for (size_t i=0; i<n; i++) {
+		x[i] = RoundSite(sites.x[i], scale);
+		y[i] = RoundSite(sites.y[i], scale);
+	}
+	return RunTypedGenerator(x, y, sites, scale, check);
+}
+
+// The rounded values are multiples of 1/scale that a float holds exactly:
+// either the rounding changed nothing or the whole number is below 2^24.
+bool RoundInt64Sites(const txBenchSites &sites, txBenchSites &rounded)
+{
+	double scale = IntegerScale(sites);
+	size_t n = sites.x.size();
+	rounded.x.resize(n);
+	rounded.y.resize(n);
+	for (size_t i=0; i<n; i++) {
+		rounded.x[i] = (float)(RoundSite(sites.x[i], scale)/scale);
+		rounded.y[i] = (float)(RoundSite(sites.y[i], scale)/scale);
+	}
+	rounded.minX = (float)(RoundSite(sites.minX, scale)/scale);
+	rounded.maxX = (float)(RoundSite(sites.maxX, scale)/scale);
+	rounded.minY = (float)(RoundSite(sites.minY, scale)/scale);
+	rounded.maxY = (float)(RoundSite(sites.maxY, scale)/scale);
+
+	std::vector<std::pair<float, float> > points(n);
+	for (size_t i=0; i<n; i++) points[i] = std::make_pair(rounded.x[i], rounded.y[i]);
+	std::sort(points.begin(), points.end());
+	return std::adjacent_find(points.begin(), points.end())==points.end();
+}
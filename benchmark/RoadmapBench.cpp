@@ -0,0 +1,215 @@
+// Voronoi roadmap benchmark
+//
+// MapManagerLibrary/mapmanager/VoronoiRoadmap, the graph MapManager::findPath
+// searches, built from the edges of one VoronoiDiagramGenerator on the sites
+// and queried between random points of the box. One csv row per size:
+//   workload,sites,roads,nodes,build_ms,queries,found,query_mean_us,query_p99_us,expanded_mean
+//
+// Every edge is a road between the generator's numbers of its vertices, with
+// the least distance from it to its sites as its clearance, as
+// VoronoiDiagramCache::getRoads gives them. build_ms is VoronoiRoadmap::build
+// on them ( the edges are not timed ), roads and nodes what is left of the
+// graph after the roads through the nodes with two roads are joined. found is
+// the queries with a path, expanded_mean the nodes A* took off its queue per
+// query.
+//
+// The generator is compiled in a namespace with the logger of
+// MapManagerGeneratorRunner.cpp.
+
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "iostream.h"
+#include "fstream.h"
+#include "VoronoiBench.h"
+#include "../MapManagerLibrary/sosutil/Threaded.h"
+#include "../MapManagerLibrary/mapmanager/VoronoiRoadmap.h"
+
+namespace mapmanager_roads {
+
+class Logger
+{
+public:
+	static ostream *getFileOstream(){
+		static ostream nullOutput(0);
+		return &nullOutput;
+	}
+	static ostream *getScreenOstream(){ return getFileOstream(); }
+	static ostream *getNullOutput(){ return getFileOstream(); }
+};
+
+inline const char *stripPath(const char *str){ return str; }
+
+#include "../MapManagerLibrary/voronoi/VoronoiDiagramGenerator.cpp"
+}
+
+// the edges as roads, with the clearance VoronoiDiagramCache::clearance works out
+class txRoadSink : public mapmanager_roads::VoronoiEdgeSink
+{
+public:
+	txRoadSink(VoronoiRoadmap &roads):roadmap(roads){}
+
+	void addEdge(float, float, float, float){}
+
+	void addEdgeVertices(float x1, float y1, float x2, float y2,
+		float site1X, float site1Y, float, float, int v1, int v2){
+		double r1 = sqrt((x1-site1X)*(x1-site1X)+(y1-site1Y)*(y1-site1Y));
+		double r2 = sqrt((x2-site1X)*(x2-site1X)+(y2-site1Y)*(y2-site1Y));
+		double length = sqrt((x2-x1)*(x2-x1)+(y2-y1)*(y2-y1));
+		double clearance = std::min(r1, r2);
+		if ( length>0 ) {
+			double along = (r1*r1-r2*r2+length*length)/(2*length);
+			if ( along>0 && along<length ) clearance = sqrt(std::max(0.0, r1*r1-along*along));
+		}
+		float xs[2] = { x1, x2 }, ys[2] = { y1, y2 };
+		roadmap.addRoad(xs, ys, 2, (float)clearance, v1, v2);
+	}
+
+private:
+	VoronoiRoadmap &roadmap;
+};
+
+// xorshift64* as in Workloads.cpp, so the queries are the same on every machine
+class txRoadRandom
+{
+public:
+	txRoadRandom(unsigned int seed):state(seed*2654435761ULL+7){}
+	double Next(){
+		state ^= state>>12; state ^= state<<25; state ^= state>>27;
+		return ((state*2685821657736338717ULL)>>11)*(1.0/9007199254740992.0);
+	}
+private:
+	unsigned long long state;
+};
+
+struct txRoadOptions{
+	int      minExponent, maxExponent;
+	bool     workloads[NUM_OF_WORKLOADS];
+	long     queries;
+	unsigned int seed;
+	float    minClearance, clearanceWeight;
+};
+
+static double NowMs()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1000.0+t.tv_nsec/1000000.0;
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: voronoiroads [options]\n"
+		"  -min e        smallest size 10^e ( 4 )\n"
+		"  -max e        biggest size 10^e ( 5 )\n"
+		"  -workload list comma separated: uniform,gaussian,lattice,collinear,gridcell,\n"
+		"                gridcell_mm ( uniform,gridcell )\n"
+		"  -queries n    paths found on every diagram ( 1000 )\n"
+		"  -seed n       seed of the random workloads and queries ( 1 )\n"
+		"  -clearance c  least clearance of a road on the paths ( 0 )\n"
+		"  -weight w     clearance weight, a unit of road costs 1+w/clearance ( 0 )\n");
+}
+
+static bool ParseOptions(int argc, char **argv, txRoadOptions &options)
+{
+	options.minExponent = 4;
+	options.maxExponent = 5;
+	for (int i=0; i<NUM_OF_WORKLOADS; i++) options.workloads[i] = false;
+	options.workloads[WORKLOAD_UNIFORM] = true;
+	options.workloads[WORKLOAD_GRIDCELL] = true;
+	options.queries = 1000;
+	options.seed = 1;
+	options.minClearance = 0.0f;
+	options.clearanceWeight = 0.0f;
+
+	for (int i=1; i<argc; i++) {
+		if ( i+1>=argc ) return false;
+		const char *option = argv[i];
+		char *value = argv[++i];
+		if ( strcmp(option, "-min")==0 ) options.minExponent = atoi(value);
+		else if ( strcmp(option, "-max")==0 ) options.maxExponent = atoi(value);
+		else if ( strcmp(option, "-queries")==0 ) options.queries = atol(value);
+		else if ( strcmp(option, "-seed")==0 ) options.seed = (unsigned int)atoi(value);
+		else if ( strcmp(option, "-clearance")==0 ) options.minClearance = (float)atof(value);
+		else if ( strcmp(option, "-weight")==0 ) options.clearanceWeight = (float)atof(value);
+		else if ( strcmp(option, "-workload")==0 ) {
+			for (int w=0; w<NUM_OF_WORKLOADS; w++) options.workloads[w] = false;
+			for (char *name = strtok(value, ","); name!=NULL; name = strtok(NULL, ",")) {
+				int workload = WorkloadByName(name);
+				if ( workload<0 ) {
+					fprintf(stderr, "unknown workload %s\n", name);
+					return false;
+				}
+				options.workloads[workload] = true;
+			}
+		} else {
+			return false;
+		}
+	}
+	return options.minExponent>=0 && options.minExponent<=options.maxExponent && options.queries>0;
+}
+
+int main(int argc, char **argv)
+{
+	txRoadOptions options;
+	if ( !ParseOptions(argc, argv, options) ) {
+		PrintUsage();
+		return 1;
+	}
+
+	printf("workload,sites,roads,nodes,build_ms,queries,found,query_mean_us,query_p99_us,expanded_mean\n");
+	for (int workload=0; workload<NUM_OF_WORKLOADS; workload++) {
+		if ( !options.workloads[workload] ) continue;
+		size_t n = 1;
+		for (int e=0; e<options.minExponent; e++) n *= 10;
+		for (int e=options.minExponent; e<=options.maxExponent; e++, n*=10) {
+			txBenchSites sites;
+			MakeWorkload(workload, n, options.seed, sites);
+
+			VoronoiRoadmap roadmap;
+			txRoadSink sink(roadmap);
+			mapmanager_roads::VoronoiDiagramGenerator vdg;
+			if ( !vdg.generateVoronoi(&sites.x[0], &sites.y[0], (int)sites.x.size(),
+				sites.minX, sites.maxX, sites.minY, sites.maxY, 0.0f, false, &sink) ) {
+				fprintf(stderr, "%s %lu: the diagram failed\n", WorkloadName(workload), (unsigned long)sites.x.size());
+				continue;
+			}
+
+			double start = NowMs();
+			roadmap.build(0);
+			double buildMs = NowMs()-start;
+
+			txRoadRandom rnd(options.seed);
+			std::vector<double> queryUs(options.queries);
+			std::vector<float> xs, ys;
+			long found = 0;
+			double expanded = 0, totalUs = 0;
+			for (long q=0; q<options.queries; q++) {
+				float startX = (float)(sites.minX+rnd.Next()*(sites.maxX-sites.minX));
+				float startY = (float)(sites.minY+rnd.Next()*(sites.maxY-sites.minY));
+				float goalX = (float)(sites.minX+rnd.Next()*(sites.maxX-sites.minX));
+				float goalY = (float)(sites.minY+rnd.Next()*(sites.maxY-sites.minY));
+				start = NowMs();
+				if ( roadmap.findPath(startX, startY, goalX, goalY, options.minClearance, options.clearanceWeight, xs, ys) )
+					found++;
+				queryUs[q] = (NowMs()-start)*1000.0;
+				totalUs += queryUs[q];
+				expanded += roadmap.getNumOfExpanded();
+			}
+			size_t p99 = (size_t)(0.99*(queryUs.size()-1));
+			std::nth_element(queryUs.begin(), queryUs.begin()+p99, queryUs.end());
+
+			printf("%s,%lu,%ld,%ld,%.3f,%ld,%ld,%.3f,%.3f,%.1f\n",
+				WorkloadName(workload), (unsigned long)sites.x.size(), roadmap.getNumOfRoads(), roadmap.getNumOfNodes(),
+				buildMs, options.queries, found, totalUs/options.queries, queryUs[p99], expanded/options.queries);
+			fflush(stdout);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,218 @@
+// Tiled voronoi benchmark
+//
+// MapManagerLibrary/voronoi/VoronoiTiledGenerator against one
+// VoronoiDiagramGenerator on all the sites, for 1 to 32 threads. Every run
+// is checked: the edges of the tiled diagram are diffed against those of the
+// monolithic one, and a row with missing or extra edges is a bug. One csv row
+// per run:
+//   workload,sites,threads,run,tiles,retries,wall_ms,monolithic_ms,speedup,edges,monolithic_edges,missing,extra
+//
+// threads is the number of tiles ( one thread each ), retries the tiles that
+// had to be generated again with a bigger margin. The time covers the
+// generation into a sink that keeps the edges, for both. The edges are
+// compared exactly, with their ends in a fixed order.
+//
+// The generators are compiled in a namespace with the logger of
+// MapManagerGeneratorRunner.cpp.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "iostream.h"
+#include "fstream.h"
+#include "VoronoiBench.h"
+#include "../MapManagerLibrary/sosutil/Threaded.h"
+
+namespace mapmanager_tiles {
+
+class Logger
+{
+public:
+	static ostream *getFileOstream(){
+		static ostream nullOutput(0);
+		return &nullOutput;
+	}
+	static ostream *getScreenOstream(){ return getFileOstream(); }
+	static ostream *getNullOutput(){ return getFileOstream(); }
+};
+
+inline const char *stripPath(const char *str){ return str; }
+
+#include "../MapManagerLibrary/voronoi/VoronoiDiagramGenerator.cpp"
+#include "../MapManagerLibrary/voronoi/VoronoiTiledGenerator.cpp"
+}
+
+struct txTileEdge{
+	float x1, y1, x2, y2;
+	bool operator<(const txTileEdge &e) const {
+		if ( x1!=e.x1 ) return x1<e.x1;
+		if ( y1!=e.y1 ) return y1<e.y1;
+		if ( x2!=e.x2 ) return x2<e.x2;
+		return y2<e.y2;
+	}
+};
+
+// keeps the edges with the lower end first
+class txTileEdgeList : public mapmanager_tiles::VoronoiEdgeSink
+{
+public:
+	std::vector<txTileEdge> edges;
+
+	void addEdge(float x1, float y1, float x2, float y2){
+		txTileEdge e = { x1, y1, x2, y2 };
+		if ( x2<x1 || (x2==x1 && y2<y1) ) {
+			e.x1 = x2; e.y1 = y2; e.x2 = x1; e.y2 = y1;
+		}
+		edges.push_back(e);
+	}
+};
+
+struct txTileOptions{
+	int      minExponent, maxExponent;
+	bool     workloads[NUM_OF_WORKLOADS];
+	std::vector<int> threads;
+	int      repeat;
+	unsigned int seed;
+	float    margin;
+};
+
+static double NowMs()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1000.0+t.tv_nsec/1000000.0;
+}
+
+// the edges of 'a' that are not in 'b', both sorted
+static long CountMissing(const std::vector<txTileEdge> &a, const std::vector<txTileEdge> &b)
+{
+	long missing = 0;
+	size_t j = 0;
+	for (size_t i=0; i<a.size(); i++) {
+		while ( j<b.size() && b[j]<a[i] ) j++;
+		if ( j<b.size() && !(a[i]<b[j]) ) j++;
+		else missing++;
+	}
+	return missing;
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: voronoitiles [options]\n"
+		"  -min e        smallest size 10^e ( 5 )\n"
+		"  -max e        biggest size 10^e ( 6 )\n"
+		"  -workload list comma separated: uniform,gaussian,lattice,collinear,gridcell,\n"
+		"                gridcell_mm ( uniform,gridcell )\n"
+		"  -threads list comma separated thread counts ( 1,2,4,8,16,32 )\n"
+		"  -repeat n     runs of every case ( 1 )\n"
+		"  -seed n       seed of the random workloads ( 1 )\n"
+		"  -margin m     first margin round a tile, in site units, 0 for a quarter\n"
+		"                of the tile ( 0 )\n");
+}
+
+static bool ParseOptions(int argc, char **argv, txTileOptions &options)
+{
+	options.minExponent = 5;
+	options.maxExponent = 6;
+	for (int i=0; i<NUM_OF_WORKLOADS; i++) options.workloads[i] = false;
+	options.workloads[WORKLOAD_UNIFORM] = true;
+	options.workloads[WORKLOAD_GRIDCELL] = true;
+	for (int threads=1; threads<=32; threads *= 2) options.threads.push_back(threads);
+	options.repeat = 1;
+	options.seed = 1;
+	options.margin = 0.0f;
+
+	for (int i=1; i<argc; i++) {
+		if ( i+1>=argc ) return false;
+		const char *option = argv[i];
+		char *value = argv[++i];
+		if ( strcmp(option, "-min")==0 ) options.minExponent = atoi(value);
+		else if ( strcmp(option, "-max")==0 ) options.maxExponent = atoi(value);
+		else if ( strcmp(option, "-repeat")==0 ) options.repeat = atoi(value);
+		else if ( strcmp(option, "-seed")==0 ) options.seed = (unsigned int)atoi(value);
+		else if ( strcmp(option, "-margin")==0 ) options.margin = (float)atof(value);
+		else if ( strcmp(option, "-threads")==0 ) {
+			options.threads.clear();
+			for (char *count = strtok(value, ","); count!=NULL; count = strtok(NULL, ",")) {
+				if ( atoi(count)<1 ) return false;
+				options.threads.push_back(atoi(count));
+			}
+		} else if ( strcmp(option, "-workload")==0 ) {
+			for (int w=0; w<NUM_OF_WORKLOADS; w++) options.workloads[w] = false;
+			for (char *name = strtok(value, ","); name!=NULL; name = strtok(NULL, ",")) {
+				int workload = WorkloadByName(name);
+				if ( workload<0 ) {
+					fprintf(stderr, "unknown workload %s\n", name);
+					return false;
+				}
+				options.workloads[workload] = true;
+			}
+		} else {
+			return false;
+		}
+	}
+	return options.minExponent>=0 && options.minExponent<=options.maxExponent && options.repeat>0 &&
+		!options.threads.empty();
+}
+
+int main(int argc, char **argv)
+{
+	txTileOptions options;
+	if ( !ParseOptions(argc, argv, options) ) {
+		PrintUsage();
+		return 1;
+	}
+
+	bool allSame = true;
+	printf("workload,sites,threads,run,tiles,retries,wall_ms,monolithic_ms,speedup,edges,monolithic_edges,missing,extra\n");
+	for (int workload=0; workload<NUM_OF_WORKLOADS; workload++) {
+		if ( !options.workloads[workload] ) continue;
+		size_t n = 1;
+		for (int e=0; e<options.minExponent; e++) n *= 10;
+		for (int e=options.minExponent; e<=options.maxExponent; e++, n*=10) {
+			txBenchSites sites;
+			MakeWorkload(workload, n, options.seed, sites);
+
+			txTileEdgeList monolithic;
+			double start = NowMs();
+			mapmanager_tiles::VoronoiDiagramGenerator vdg;
+			if ( !vdg.generateVoronoi(&sites.x[0], &sites.y[0], (int)sites.x.size(),
+				sites.minX, sites.maxX, sites.minY, sites.maxY, 0.0f, false, &monolithic) ) {
+				fprintf(stderr, "%s %lu: the monolithic diagram failed\n", WorkloadName(workload), (unsigned long)sites.x.size());
+				continue;
+			}
+			double monolithicMs = NowMs()-start;
+			std::sort(monolithic.edges.begin(), monolithic.edges.end());
+
+			for (size_t t=0; t<options.threads.size(); t++) {
+				for (int run=0; run<options.repeat; run++) {
+					txTileEdgeList tiled;
+					mapmanager_tiles::VoronoiTiledGenerator tiles;
+					start = NowMs();
+					bool ok = tiles.generateVoronoi(&sites.x[0], &sites.y[0], (long)sites.x.size(),
+						sites.minX, sites.maxX, sites.minY, sites.maxY, 0.0f, options.threads[t], options.margin, &tiled);
+					double wallMs = NowMs()-start;
+
+					std::sort(tiled.edges.begin(), tiled.edges.end());
+					long missing = ok ? CountMissing(monolithic.edges, tiled.edges) : -1;
+					long extra = ok ? CountMissing(tiled.edges, monolithic.edges) : -1;
+					if ( missing!=0 || extra!=0 ) allSame = false;
+
+					printf("%s,%lu,%d,%d,%dx%d,%d,%.3f,%.3f,%.2f,%lu,%lu,%ld,%ld\n",
+						WorkloadName(workload), (unsigned long)sites.x.size(), options.threads[t], run,
+						tiles.getNumOfColumns(), tiles.getNumOfRows(), tiles.getNumOfRetries(),
+						wallMs, monolithicMs, wallMs>0 ? monolithicMs/wallMs : 0.0,
+						(unsigned long)tiled.edges.size(), (unsigned long)monolithic.edges.size(), missing, extra);
+					fflush(stdout);
+				}
+			}
+		}
+	}
+	return allSame ? 0 : 2;
+}
@@ -0,0 +1,348 @@
+// Voronoi benchmark
+//
+// Run the sweep implementations of the repo on the same generated sites
+// and print one csv row per run:
+//   builder          txVoronoiBuilder, VoronoiDiagram/VoronoiDiagramDLL
+//   code_vdg         VoronoiDiagramGenerator, code
+//   mapmanager_vdg   VoronoiDiagramGenerator, MapManagerLibrary/voronoi
+//   mapmanager_vdg_heap, mapmanager_vdg_adaptive
+//                    the same with the heap and the adaptive bucket priority
+//                    queues, pq_probes tells how much each queue searched
+//   mapmanager_vdg_retain   the same with setRetainMemory, timed on the second
+//                    generation of the sites so the memory of the first is reused
+//   mapmanager_vdg_double, mapmanager_vdg_int64
+//                    the double and long long instantiations of the same
+//                    generator, the long long one on the sites scaled to
+//                    whole numbers
+//   fortune          fortunevoronoi, code/fortunevoronoi
+//   fortune_bin      the same with packed float input and packed output
+//   fortune_lib      the same sweep in process, through its library interface
+//
+// Every run is in a forked process, so a crash, an assert or a run that
+// takes too long only cost that row, and the peak rss is the one of the run.
+// The time covers the generation and one walk over the output edges, not
+// making the sites. For fortunevoronoi it is the whole program, reading the
+// text input included, and the allocations are not counted ( -1 ).
+//
+// With -check 1 the mapmanager_vdg* runs count the edges that are not on the
+// bisector of their two nearest sites ( txBenchEdgeCheck ), the check is in
+// the timed walk so those runs are for the bad_edges column, not the times.
+// mapmanager_vdg_int64 is checked against its sites as they are rounded for
+// it, the diagram of the unrounded ones is not what it was asked for. When
+// the rounding puts two sites on one point no generator makes a diagram of
+// them, so that run has no bad_edges ( -1 ).
+
+#include "VoronoiBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+enum txBenchImplementation{
+	IMPL_BUILDER,
+	IMPL_CODE_GENERATOR,
+	IMPL_MAPMANAGER_GENERATOR,
+	IMPL_MAPMANAGER_RETAINED,
+	IMPL_MAPMANAGER_HEAP,
+	IMPL_MAPMANAGER_ADAPTIVE,
+	IMPL_MAPMANAGER_DOUBLE,
+	IMPL_MAPMANAGER_INT64,
+	IMPL_FORTUNE,
+	IMPL_FORTUNE_BINARY,
+	IMPL_FORTUNE_LIBRARY,
+	NUM_OF_IMPLEMENTATIONS
+};
+
+static const char *implementationNames[NUM_OF_IMPLEMENTATIONS] = {
+	"builder", "code_vdg", "mapmanager_vdg", "mapmanager_vdg_retain",
+	"mapmanager_vdg_heap", "mapmanager_vdg_adaptive", "mapmanager_vdg_double", "mapmanager_vdg_int64", "fortune", "fortune_bin", "fortune_lib"
+};
+
+enum txBenchStatus{
+	STATUS_OK,
+	STATUS_FAILED,     // the implementation returned an error
+	STATUS_TIMEOUT,
+	STATUS_CRASH
+};
+
+static const char *statusNames[] = { "ok", "failed", "timeout", "crash" };
+
+// what the run process send back through the pipe
+struct txBenchResult{
+	int      status;
+	long     sites;
+	double   wallMs;
+	long     peakRssKb;
+	long     allocations;
+	long     edges;
+	long     probes;      // of the priority queue, mapmanager_vdg* only
+	long     badEdges;    // -check, mapmanager_vdg* only
+};
+
+struct txBenchOptions{
+	int          minExponent, maxExponent;
+	bool         implementations[NUM_OF_IMPLEMENTATIONS];
+	bool         workloads[NUM_OF_WORKLOADS];
+	int          repeat;
+	int          timeout;
+	bool         check;
+	unsigned int seed;
+	const char  *fortuneExe;
+	const char  *tmpDir;
+};
+
+static double NowMs()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1000.0 + t.tv_nsec/1000000.0;
+}
+
+// Linux keep the high water mark of the rss in /proc/self/status, writing
+// 5 to clear_refs set it back to the current rss. That leaves the sites
+// generation out of the peak, while the sites themselves are still in.
+static bool ResetPeakRss()
+{
+	FILE *file = fopen("/proc/self/clear_refs", "w");
+	if ( file==NULL ) return false;
+	bool ok = fputs("5", file)>=0;
+	return fclose(file)==0 && ok;
+}
+
+static long PeakRssKb()
+{
+	FILE *file = fopen("/proc/self/status", "r");
+	if ( file!=NULL ) {
+		char line[256];
+		long kb = -1;
+		while ( fgets(line, sizeof(line), file) ) {
+			if ( sscanf(line, "VmHWM: %ld", &kb)==1 ) break;
+		}
+		fclose(file);
+		if ( kb>=0 ) return kb;
+	}
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+// the body of the run process
+static void RunOnce(int impl, int workload, size_t n, unsigned int seed, const txBenchOptions &options, txBenchResult &result)
+{
+	txBenchSites sites;
+	MakeWorkload(workload, n, seed, sites);
+	result.sites = (long)sites.x.size();
+
+	if ( impl==IMPL_FORTUNE || impl==IMPL_FORTUNE_BINARY ) {
+		bool binary = impl==IMPL_FORTUNE_BINARY;
+		char fileName[1024];
+		snprintf(fileName, sizeof(fileName), "%s/voronoibench_%d.%s", options.tmpDir, (int)getpid(), binary ? "f32" : "txt");
+		if ( !WriteFortuneInput(fileName, sites, binary) ) {
+			result.status = STATUS_FAILED;
+			return;
+		}
+		bool killedByTimeout = false;
+		double start = NowMs();
+		result.edges = RunFortune(options.fortuneExe, fileName, binary, options.timeout, result.peakRssKb, killedByTimeout);
+		result.wallMs = NowMs() - start;
+		result.allocations = -1;
+		unlink(fileName);
+		if ( killedByTimeout ) result.status = STATUS_TIMEOUT;
+		else if ( result.edges<0 ) result.status = STATUS_FAILED;
+		return;
+	}
+
+	if ( impl==IMPL_MAPMANAGER_RETAINED ) {
+		RunMapManagerGeneratorRetained(sites);
+	}
+
+	bool rssReset = ResetPeakRss();
+	if ( options.timeout>0 ) alarm(options.timeout);
+	txBenchSites roundedSites;
+	bool checkable = options.check;
+	if ( impl==IMPL_MAPMANAGER_INT64 && options.check ) checkable = RoundInt64Sites(sites, roundedSites);
+	txBenchEdgeCheck edgeCheck(impl==IMPL_MAPMANAGER_INT64 && options.check ? roundedSites : sites);
+	txBenchEdgeCheck *check = checkable ? &edgeCheck : 0;
+	size_t allocations = AllocationCount();
+	double start = NowMs();
+	switch ( impl ) {
+	case IMPL_BUILDER:              result.edges = RunBuilder(sites); break;
+	case IMPL_CODE_GENERATOR:       result.edges = RunCodeGenerator(sites); break;
+	case IMPL_MAPMANAGER_GENERATOR: result.edges = RunMapManagerGenerator(sites, BENCH_PQ_HASH, result.probes, check); break;
+	case IMPL_MAPMANAGER_RETAINED:  result.edges = RunMapManagerGeneratorRetained(sites); check = 0; break;
+	case IMPL_MAPMANAGER_HEAP:      result.edges = RunMapManagerGenerator(sites, BENCH_PQ_HEAP, result.probes, check); break;
+	case IMPL_MAPMANAGER_ADAPTIVE:  result.edges = RunMapManagerGenerator(sites, BENCH_PQ_ADAPTIVE, result.probes, check); break;
+	case IMPL_MAPMANAGER_DOUBLE:    result.edges = RunMapManagerGeneratorDouble(sites, check); break;
+	case IMPL_MAPMANAGER_INT64:     result.edges = RunMapManagerGeneratorInt64(sites, check); break;
+	case IMPL_FORTUNE_LIBRARY:      result.edges = RunFortuneLibrary(sites); check = 0; break;
+	default:                        check = 0; break;
+	}
+	result.wallMs = NowMs() - start;
+	if ( check ) result.badEdges = check->BadEdges();
+	result.allocations = (long)(AllocationCount() - allocations);
+	alarm(0);
+	result.peakRssKb = rssReset ? PeakRssKb() : -1;
+	if ( result.edges<0 ) result.status = STATUS_FAILED;
+}
+
+// fork, run and collect the result, the status is made from the exit of
+// the run process when it didn't get to send anything
+static txBenchResult Run(int impl, int workload, size_t n, unsigned int seed, const txBenchOptions &options)
+{
+	txBenchResult result;
+	memset(&result, 0, sizeof(result));
+	result.status = STATUS_CRASH;
+	result.sites = (long)n;
+	result.peakRssKb = result.allocations = result.edges = result.probes = result.badEdges = -1;
+
+	int channel[2];
+	if ( pipe(channel)!=0 ) return result;
+	fflush(stdout);
+	pid_t pid = fork();
+	if ( pid<0 ) {
+		close(channel[0]);
+		close(channel[1]);
+		return result;
+	}
+	if ( pid==0 ) {
+		close(channel[0]);
+		txBenchResult childResult = result;
+		childResult.status = STATUS_OK;
+		RunOnce(impl, workload, n, seed, options, childResult);
+		ssize_t written = write(channel[1], &childResult, sizeof(childResult));
+		_exit(written==(ssize_t)sizeof(childResult) ? 0 : 1);
+	}
+
+	close(channel[1]);
+	txBenchResult childResult;
+	ssize_t len = read(channel[0], &childResult, sizeof(childResult));
+	close(channel[0]);
+
+	int status = 0;
+	waitpid(pid, &status, 0);
+	if ( len==(ssize_t)sizeof(childResult) ) {
+		return childResult;
+	}
+	if ( WIFSIGNALED(status) && WTERMSIG(status)==SIGALRM ) {
+		result.status = STATUS_TIMEOUT;
+	}
+	return result;
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: voronoibench [options]\n"
+		"  -min e        smallest size 10^e ( 3 )\n"
+		"  -max e        biggest size 10^e ( 7 )\n"
+		"  -impl list    comma separated: builder,code_vdg,mapmanager_vdg,\n"
+		"                mapmanager_vdg_retain,mapmanager_vdg_heap,\n"
+		"                mapmanager_vdg_adaptive,mapmanager_vdg_double,\n"
+		"                mapmanager_vdg_int64,fortune,fortune_bin,fortune_lib ( all )\n"
+		"  -workload list comma separated: uniform,gaussian,lattice,collinear,gridcell,\n"
+		"                gridcell_mm ( all )\n"
+		"  -repeat n     runs of every case ( 1 )\n"
+		"  -timeout s    seconds before a run is killed, 0 for none ( 600 )\n"
+		"  -seed n       seed of the random workloads ( 1 )\n"
+		"  -check 0|1    count the bad edges of the mapmanager_vdg* runs ( 0 )\n"
+		"  -fortune path fortunevoronoi executable ( ./fortunevoronoi )\n"
+		"  -tmp dir      where the fortunevoronoi input files go ( /tmp )\n");
+}
+
+// parse "a,b,c" into the flags, false if a name is unknown
+static bool ParseList(char *list, bool *flags, int count, const char **names)
+{
+	for (int i=0; i<count; i++) flags[i] = false;
+	for (char *name = strtok(list, ","); name!=NULL; name = strtok(NULL, ",")) {
+		int found = -1;
+		for (int i=0; i<count; i++) {
+			if ( strcmp(name, names[i])==0 ) found = i;
+		}
+		if ( found<0 ) {
+			fprintf(stderr, "unknown name %s\n", name);
+			return false;
+		}
+		flags[found] = true;
+	}
+	return true;
+}
+
+static bool ParseOptions(int argc, char **argv, txBenchOptions &options)
+{
+	options.minExponent = 3;
+	options.maxExponent = 7;
+	for (int i=0; i<NUM_OF_IMPLEMENTATIONS; i++) options.implementations[i] = true;
+	for (int i=0; i<NUM_OF_WORKLOADS; i++) options.workloads[i] = true;
+	options.repeat = 1;
+	options.timeout = 600;
+	options.check = false;
+	options.seed = 1;
+	options.fortuneExe = "./fortunevoronoi";
+	options.tmpDir = "/tmp";
+
+	const char *workloadNames[NUM_OF_WORKLOADS];
+	for (int i=0; i<NUM_OF_WORKLOADS; i++) workloadNames[i] = WorkloadName(i);
+
+	for (int i=1; i<argc; i++) {
+		if ( i+1>=argc ) return false;
+		const char *option = argv[i];
+		char *value = argv[++i];
+		if ( strcmp(option, "-min")==0 ) options.minExponent = atoi(value);
+		else if ( strcmp(option, "-max")==0 ) options.maxExponent = atoi(value);
+		else if ( strcmp(option, "-repeat")==0 ) options.repeat = atoi(value);
+		else if ( strcmp(option, "-timeout")==0 ) options.timeout = atoi(value);
+		else if ( strcmp(option, "-check")==0 ) options.check = atoi(value)!=0;
+		else if ( strcmp(option, "-seed")==0 ) options.seed = (unsigned int)atoi(value);
+		else if ( strcmp(option, "-fortune")==0 ) options.fortuneExe = value;
+		else if ( strcmp(option, "-tmp")==0 ) options.tmpDir = value;
+		else if ( strcmp(option, "-impl")==0 ) {
+			if ( !ParseList(value, options.implementations, NUM_OF_IMPLEMENTATIONS, implementationNames) ) return false;
+		} else if ( strcmp(option, "-workload")==0 ) {
+			if ( !ParseList(value, options.workloads, NUM_OF_WORKLOADS, workloadNames) ) return false;
+		} else {
+			return false;
+		}
+	}
+	return options.minExponent>=0 && options.minExponent<=options.maxExponent && options.repeat>0;
+}
+
+int main(int argc, char **argv)
+{
+	txBenchOptions options;
+	if ( !ParseOptions(argc, argv, options) ) {
+		PrintUsage();
+		return 1;
+	}
+	if ( (options.implementations[IMPL_FORTUNE] || options.implementations[IMPL_FORTUNE_BINARY]) && access(options.fortuneExe, X_OK)!=0 ) {
+		fprintf(stderr, "%s not found, fortune and fortune_bin are skipped\n", options.fortuneExe);
+		options.implementations[IMPL_FORTUNE] = false;
+		options.implementations[IMPL_FORTUNE_BINARY] = false;
+	}
+
+	printf("implementation,workload,sites,run,status,wall_ms,peak_rss_kb,allocations,edges,edges_per_sec,pq_probes,bad_edges\n");
+	for (int workload=0; workload<NUM_OF_WORKLOADS; workload++) {
+		if ( !options.workloads[workload] ) continue;
+		size_t n = 1;
+		for (int e=0; e<options.minExponent; e++) n *= 10;
+		for (int e=options.minExponent; e<=options.maxExponent; e++, n*=10) {
+			for (int impl=0; impl<NUM_OF_IMPLEMENTATIONS; impl++) {
+				if ( !options.implementations[impl] ) continue;
+				for (int run=0; run<options.repeat; run++) {
+					txBenchResult result = Run(impl, workload, n, options.seed, options);
+					double edgesPerSec = result.status==STATUS_OK && result.wallMs>0 ? result.edges/(result.wallMs/1000.0) : 0.0;
+					printf("%s,%s,%ld,%d,%s,%.3f,%ld,%ld,%ld,%.0f,%ld,%ld\n",
+						implementationNames[impl], WorkloadName(workload), result.sites, run,
+						statusNames[result.status], result.wallMs, result.peakRssKb,
+						result.allocations, result.edges, edgesPerSec, result.probes, result.badEdges);
+					fflush(stdout);
+				}
+			}
+		}
+	}
+	return 0;
+}
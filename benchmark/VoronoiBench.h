@@ -0,0 +1,95 @@
+#pragma once
+#include <stddef.h>
+#include <vector>
+
+// Shared declarations of the voronoi benchmark.
+//
+// Every implementation in the repo gets the same input: float coordinates
+// ( that is what the VoronoiDiagramGenerator copies and fortunevoronoi take,
+// txVoronoiBuilder gets the same values in double ) and a bounding box which
+// is the bounding box of the sites with some margin.
+
+struct txBenchSites{
+	std::vector<float>   x, y;
+	float                minX, maxX, minY, maxY;
+};
+
+enum txBenchWorkload{
+	WORKLOAD_UNIFORM,      // uniform random in a square
+	WORKLOAD_GAUSSIAN,     // gaussian clusters
+	WORKLOAD_LATTICE,      // square lattice, every 4 neighbour sites are cocircular
+	WORKLOAD_COLLINEAR,    // all the sites on one sloped line
+	WORKLOAD_GRIDCELL,     // obstacle outline cell centres as MapManager::generateVoronoi feeds them
+	WORKLOAD_GRIDCELL_MM,  // the same in millimetres, 50mm cells on a map 4km from the origin
+	NUM_OF_WORKLOADS
+};
+
+const char *WorkloadName(int workload);
+// -1 if there is no such workload
+int WorkloadByName(const char *name);
+
+// Make about n sites ( exactly n except for duplicates that are dropped ).
+// The density doesn't change with n: the random and lattice sites are about
+// 10 apart, the collinear and grid cell sites are on unit steps ( 50 for
+// gridcell_mm, whose values are still whole numbers in float ).
+void MakeWorkload(int workload, size_t n, unsigned int seed, txBenchSites &sites);
+
+// The in process implementations, each run one whole generation including
+// walking the output and return the number of edges.
+long RunBuilder(const txBenchSites &sites);
+long RunCodeGenerator(const txBenchSites &sites);
+long RunMapManagerGeneratorRetained(const txBenchSites &sites);
+long RunFortuneLibrary(const txBenchSites &sites);
+
+// The priority queues of the mapmanager generator
+enum txBenchPriorityQueue{
+	BENCH_PQ_HASH,
+	BENCH_PQ_HEAP,
+	BENCH_PQ_ADAPTIVE
+};
+
+// Checks the output edges of a run against the sites, -check in the
+// benchmark. An edge is bad when its midpoint is not equally far from its two
+// nearest sites, more than a thousandth of the mean site spacing apart.
+class txBenchEdgeCheck
+{
+public:
+	txBenchEdgeCheck(const txBenchSites &sites);
+	void Add(double x1, double y1, double x2, double y2);
+	long BadEdges() const { return badEdges; }
+
+private:
+	const txBenchSites   *sites;
+	double                cellSize, tolerance;
+	long                  columns, rows;
+	std::vector<size_t>   cellStart, cellSites;    // the sites bucketed by cell
+	long                  badEdges;
+};
+
+// probes is what the priority queue stats say ( VoronoiPQStats::probes ),
+// check is 0 or the -check of the run
+long RunMapManagerGenerator(const txBenchSites &sites, int priorityQueue, long &probes, txBenchEdgeCheck *check);
+
+// The double and long long instantiations of the same generator. The long
+// long one gets the sites scaled by a power of 2 that makes them whole
+// numbers below VDG_EXACT_RANGE when there is one, so its site events are
+// exact, else they are rounded to units of the map.
+long RunMapManagerGeneratorDouble(const txBenchSites &sites, txBenchEdgeCheck *check);
+long RunMapManagerGeneratorInt64(const txBenchSites &sites, txBenchEdgeCheck *check);
+
+// The sites as the long long run gives them to the generator, back in the
+// units of the sites. Its -check is against these, not the unrounded ones.
+// Return false if the rounding put two sites on the same point.
+bool RoundInt64Sites(const txBenchSites &sites, txBenchSites &rounded);
+
+// fortunevoronoi is a command line program with globals, so it runs as a
+// child process on an input file, text or packed floats ( -i f -b ) when
+// binary is set. Return the number of edges ( "e" lines or records ) or -1
+// if the program failed. The peak rss of the program is put in peakRssKb,
+// killedByTimeout tell if the alarm went off.
+long RunFortune(const char *exe, const char *inputFile, bool binary, int timeout, long &peakRssKb, bool &killedByTimeout);
+bool WriteFortuneInput(const char *fileName, const txBenchSites &sites, bool binary);
+
+// Number of malloc/calloc/realloc calls since the start of the process,
+// operator new goes through malloc so it is counted as well.
+size_t AllocationCount();
@@ -0,0 +1,213 @@
+#include "VoronoiBench.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+static const char *workloadNames[NUM_OF_WORKLOADS] = {
+	"uniform", "gaussian", "lattice", "collinear", "gridcell", "gridcell_mm"
+};
+
+const char *WorkloadName(int workload)
+{
+	if ( workload<0 || workload>=NUM_OF_WORKLOADS ) return "unknown";
+	return workloadNames[workload];
+}
+
+int WorkloadByName(const char *name)
+{
+	for (int i=0; i<NUM_OF_WORKLOADS; i++) {
+		if ( strcmp(name, workloadNames[i])==0 ) return i;
+	}
+	return -1;
+}
+
+// xorshift64*, the inputs should be the same on every machine and rand()
+// isn't
+class txBenchRandom
+{
+public:
+	txBenchRandom(unsigned int seed):state(seed*2654435761ULL+1){};
+
+	double Uniform(){
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return ((state*2685821657736338717ULL) >> 11) * (1.0/9007199254740992.0);
+	}
+
+	double Gaussian(){
+		double u = Uniform();
+		double v = Uniform();
+		if ( u<1e-300 ) u = 1e-300;
+		return sqrt(-2.0*log(u)) * cos(6.283185307179586*v);
+	}
+
+private:
+	unsigned long long state;
+};
+
+static void UniformSites(size_t n, txBenchRandom &rnd, txBenchSites &sites)
+{
+	double side = 10.0*sqrt((double)n);
+	for (size_t i=0; i<n; i++) {
+		sites.x.push_back((float)(rnd.Uniform()*side));
+		sites.y.push_back((float)(rnd.Uniform()*side));
+	}
+}
+
+static void GaussianSites(size_t n, txBenchRandom &rnd, txBenchSites &sites)
+{
+	double side = 10.0*sqrt((double)n);
+	size_t numOfClusters = n/1000+1;
+	double sigma = side/(8.0*sqrt((double)numOfClusters));
+	std::vector<double> cx, cy;
+	for (size_t i=0; i<numOfClusters; i++) {
+		cx.push_back(rnd.Uniform()*side);
+		cy.push_back(rnd.Uniform()*side);
+	}
+	for (size_t i=0; i<n; i++) {
+		size_t c = (size_t)(rnd.Uniform()*numOfClusters);
+		if ( c>=numOfClusters ) c = numOfClusters-1;
+		double x = cx[c] + rnd.Gaussian()*sigma;
+		double y = cy[c] + rnd.Gaussian()*sigma;
+		sites.x.push_back((float)std::min(std::max(x, 0.0), side));
+		sites.y.push_back((float)std::min(std::max(y, 0.0), side));
+	}
+}
+
+static void LatticeSites(size_t n, txBenchSites &sites)
+{
+	size_t side = (size_t)ceil(sqrt((double)n));
+	for (size_t i=0; i<n; i++) {
+		sites.x.push_back(10.0f*(float)(i%side));
+		sites.y.push_back(10.0f*(float)(i/side));
+	}
+}
+
+// slope 1/2 keeps the points exactly on the line in float up to 2^23
+static void CollinearSites(size_t n, txBenchSites &sites)
+{
+	for (size_t i=0; i<n; i++) {
+		sites.x.push_back((float)i);
+		sites.y.push_back(0.5f*(float)i+3.0f);
+	}
+}
+
+// MapManager::generateVoronoi passes the centres of the cells that are on
+// the outline of the obstacles, in the x then y scan order of the grid. Here
+// the obstacles are disks and rectangles on a grid of 16 cells per site. An
+// obstacle has about 50 outline cells, they are added in batches sized from
+// what is still missing until the outlines have n cells.
+static void GridCellSites(size_t n, txBenchRandom &rnd, txBenchSites &sites)
+{
+	long side = (long)ceil(sqrt(16.0*n)) + 2;
+	std::vector<unsigned char> grid((size_t)side*side, 0);
+	std::vector<long> cells;
+	for (int batch=0; batch<64 && cells.size()<n; batch++) {
+		size_t numOfObstacles = (n-cells.size())/40+1;
+		for (size_t i=0; i<numOfObstacles; i++) {
+			double r = 2.0 + rnd.Uniform()*10.0;
+			double cx = rnd.Uniform()*side;
+			double cy = rnd.Uniform()*side;
+			bool disk = rnd.Uniform()<0.5;
+			long x0 = std::max(1L, (long)(cx-r)), x1 = std::min(side-2, (long)(cx+r));
+			long y0 = std::max(1L, (long)(cy-r)), y1 = std::min(side-2, (long)(cy+r));
+			for (long x=x0; x<=x1; x++) {
+				for (long y=y0; y<=y1; y++) {
+					double dx = x+0.5-cx, dy = y+0.5-cy;
+					if ( !disk || dx*dx+dy*dy<=r*r ) grid[x*side+y] = 1;
+				}
+			}
+		}
+		cells.clear();
+		for (long x=1; x<side-1; x++) {
+			for (long y=1; y<side-1; y++) {
+				const unsigned char *c = &grid[x*side+y];
+				if ( !c[0] ) continue;
+				if ( !c[-side-1] || !c[-side] || !c[-side+1] || !c[-1] ||
+					 !c[1] || !c[side-1] || !c[side] || !c[side+1] ) {
+					cells.push_back(x*side+y);
+				}
+			}
+		}
+	}
+	if ( cells.size()>n ) cells.resize(n);
+	for (size_t i=0; i<cells.size(); i++) {
+		sites.x.push_back((float)(cells[i]/side)+0.5f);
+		sites.y.push_back((float)(cells[i]%side)+0.5f);
+	}
+}
+
+// The grid cells of a map in millimetres with 50mm cells, 4km away from the
+// origin as the maps of a site survey are. The values are whole numbers
+// below 2^24 so float has them exactly, but the differences the sweep
+// computes from them are not.
+static void GridCellMmSites(size_t n, txBenchRandom &rnd, txBenchSites &sites)
+{
+	GridCellSites(n, rnd, sites);
+	for (size_t i=0; i<sites.x.size(); i++) {
+		sites.x[i] = (float)(4000000.0 + 50.0*sites.x[i]);
+		sites.y[i] = (float)(4000000.0 + 50.0*sites.y[i]);
+	}
+}
+
+struct txSiteIndexLess{
+	const txBenchSites *sites;
+	bool operator()(size_t l, size_t r) const {
+		if ( sites->x[l]!=sites->x[r] ) return sites->x[l]<sites->x[r];
+		return sites->y[l]<sites->y[r];
+	}
+};
+
+// Not every implementation copes with duplicate sites, drop them but keep
+// the order of the rest.
+static void RemoveDuplicates(txBenchSites &sites)
+{
+	size_t n = sites.x.size();
+	std::vector<size_t> order(n);
+	for (size_t i=0; i<n; i++) order[i] = i;
+	txSiteIndexLess less = { &sites };
+	std::sort(order.begin(), order.end(), less);
+	std::vector<unsigned char> duplicate(n, 0);
+	for (size_t i=1; i<n; i++) {
+		if ( !less(order[i-1], order[i]) ) duplicate[order[i]] = 1;
+	}
+	size_t count = 0;
+	for (size_t i=0; i<n; i++) {
+		if ( duplicate[i] ) continue;
+		sites.x[count] = sites.x[i];
+		sites.y[count] = sites.y[i];
+		count++;
+	}
+	sites.x.resize(count);
+	sites.y.resize(count);
+}
+
+void MakeWorkload(int workload, size_t n, unsigned int seed, txBenchSites &sites)
+{
+	txBenchRandom rnd(seed);
+	sites.x.clear();
+	sites.y.clear();
+	sites.x.reserve(n);
+	sites.y.reserve(n);
+	switch ( workload ) {
+	case WORKLOAD_UNIFORM:   UniformSites(n, rnd, sites); break;
+	case WORKLOAD_GAUSSIAN:  GaussianSites(n, rnd, sites); break;
+	case WORKLOAD_LATTICE:   LatticeSites(n, sites); break;
+	case WORKLOAD_COLLINEAR: CollinearSites(n, sites); break;
+	case WORKLOAD_GRIDCELL:  GridCellSites(n, rnd, sites); break;
+	case WORKLOAD_GRIDCELL_MM: GridCellMmSites(n, rnd, sites); break;
+	}
+	RemoveDuplicates(sites);
+
+	sites.minX = sites.maxX = sites.x.empty() ? 0.0f : sites.x[0];
+	sites.minY = sites.maxY = sites.y.empty() ? 0.0f : sites.y[0];
+	for (size_t i=1; i<sites.x.size(); i++) {
+		sites.minX = std::min(sites.minX, sites.x[i]);
+		sites.maxX = std::max(sites.maxX, sites.x[i]);
+		sites.minY = std::min(sites.minY, sites.y[i]);
+		sites.maxY = std::max(sites.maxY, sites.y[i]);
+	}
+	sites.minX -= 10.0f; sites.maxX += 10.0f;
+	sites.minY -= 10.0f; sites.maxY += 10.0f;
+}
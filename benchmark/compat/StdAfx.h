@@ -0,0 +1,5 @@
+// Stand in for the precompiled header of the VoronoiDiagramDLL project,
+// the benchmark builds the dll sources straight into the executable.
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
@@ -0,0 +1,4 @@
+// see iostream.h
+#pragma once
+#include <fstream>
+using namespace std;
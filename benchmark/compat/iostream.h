@@ -0,0 +1,5 @@
+// The MapManager logger still includes the pre standard stream headers,
+// map them on the standard ones for g++.
+#pragma once
+#include <iostream>
+using namespace std;
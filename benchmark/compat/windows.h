@@ -0,0 +1,74 @@
+// Stand in for the part of windows.h that MapManagerLibrary/sosutil/Threaded
+// uses, on top of pthreads.
+#pragma once
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+typedef unsigned long DWORD;
+typedef void *HANDLE;
+
+#define WINAPI
+#define INFINITE 0xFFFFFFFF
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(void *);
+
+struct txCompatThread{
+	pthread_t               thread;
+	bool                    joined;
+};
+
+// what the new thread runs, it is the thread's own and it frees it, so the
+// handle can be closed before the thread has started
+struct txCompatStart{
+	LPTHREAD_START_ROUTINE  start;
+	void                   *arg;
+};
+
+static void *txCompatThreadStart(void *arg)
+{
+	txCompatStart run = *(txCompatStart *)arg;
+	delete (txCompatStart *)arg;
+	run.start(run.arg);
+	return NULL;
+}
+
+inline HANDLE CreateThread(void *, size_t, LPTHREAD_START_ROUTINE start, void *arg, DWORD, DWORD *id)
+{
+	txCompatThread *thread = new txCompatThread;
+	txCompatStart *run = new txCompatStart;
+	run->start = start;
+	run->arg = arg;
+	thread->joined = false;
+	if ( pthread_create(&thread->thread, NULL, txCompatThreadStart, run)!=0 ) {
+		delete run;
+		delete thread;
+		return 0;
+	}
+	if ( id ) *id = 0;
+	return thread;
+}
+
+// only INFINITE waits are supported
+inline DWORD WaitForSingleObject(HANDLE handle, DWORD)
+{
+	txCompatThread *thread = (txCompatThread *)handle;
+	if ( !thread->joined ) pthread_join(thread->thread, NULL);
+	thread->joined = true;
+	return 0;
+}
+
+// a thread closed before it was waited for runs on detached
+inline int CloseHandle(HANDLE handle)
+{
+	txCompatThread *thread = (txCompatThread *)handle;
+	if ( !thread->joined ) pthread_detach(thread->thread);
+	delete thread;
+	return 1;
+}
+
+inline void Sleep(DWORD ms)
+{
+	if ( ms==0 ) sched_yield();
+	else usleep(ms*1000);
+}
@@ -3,7 +3,8 @@
 #endif
 #define DELETED -2
 
-extern int triangulate, sorted, plot, debug;
+#include <setjmp.h>
+#include "voronoi.h"
 
 struct	Freenode	{
 struct	Freenode	*nextfree;
@@ -13,43 +14,13 @@ struct	Freenode	*head;
 int			nodesize;
 };
 char *getfree();
-char *malloc();
 char *myalloc();
 
-extern float xmin, xmax, ymin, ymax, deltax, deltay;
-
-
-struct Point	{
-float x,y;
-};
-
-/* structure used both for sites and for vertices */
-struct Site	{
-struct	Point	coord;
-int		sitenbr;
-int		refcnt;
-};
-
-
-extern struct	Site	*sites;
-extern int		nsites;
-extern int		siteidx;
-extern int		sqrt_nsites;
-extern int		nvertices;
-extern struct 	Freelist sfl;
-extern struct	Site	*bottomsite;
-
-
-struct Edge	{
-double		a,b,c;
-struct	Site 	*ep[2];
-struct	Site	*reg[2];
-int		edgenbr;
+/* header of every block from myalloc, so they can all be freed */
+union	Memblock	{
+union	Memblock	*next;
+double			align;
 };
-#define le 0
-#define re 1
-extern int nedges;
-extern struct	Freelist efl;
 
 int has_endpoint(),right_of();
 struct Site *intersect();
@@ -68,19 +39,43 @@ double		ystar;
 struct	Halfedge *PQnext;
 };
 
-extern struct   Freelist	hfl;
-extern struct	Halfedge *ELleftend, *ELrightend;
-extern int 	ELhashsize;
-extern struct	Halfedge **ELhash;
 struct	Halfedge *HEcreate(), *ELleft(), *ELright(), *ELleftbnd();
 struct	Site *leftreg(), *rightreg();
 
-
-extern int PQhashsize;
-extern struct	Halfedge *PQhash;
-extern struct	Halfedge *PQfind();
-extern int PQcount;
-extern int PQmin;
+struct Halfedge *PQfind();
 int PQempty();
 
-
+/* what used to be the globals, everything of one diagram */
+struct Voronoi	{
+struct	VoronoiOutput	output;
+
+float		xmin, xmax, ymin, ymax, deltax, deltay;
+
+struct	Site	*sites;
+int		nsites;
+int		siteidx;
+int		sqrt_nsites;
+int		nvertices;
+struct 	Freelist sfl;
+struct	Site	*bottomsite;
+int		(*nextpoint)();		/* sites of voronoi_run_sorted */
+void		*nextarg;
+
+int		nedges;
+struct	Freelist efl;
+
+struct   Freelist	hfl;
+struct	Halfedge *ELleftend, *ELrightend;
+int 		ELhashsize;
+struct	Halfedge **ELhash;
+int		ntry, totalsearch;
+
+int		PQhashsize;
+struct	Halfedge *PQhash;
+int		PQcount;
+int		PQmin;
+
+int		total_alloc;
+union	Memblock	*memory;
+jmp_buf		nomemory;		/* myalloc jumps here when malloc fails */
+};
@@ -1,38 +1,32 @@
 #
 #include "defs.h"
-int nedges;
-struct	Freelist efl;
-struct   Freelist	hfl;
-struct	Halfedge *ELleftend, *ELrightend;
-int 	ELhashsize;
-struct	Halfedge **ELhash;
 
-int ntry, totalsearch;
-
-ELinitialize()
+ELinitialize(vd)
+struct Voronoi *vd;
 {
 int i;
-	freeinit(&hfl, sizeof **ELhash);
-	ELhashsize = 2 * sqrt_nsites;
-	ELhash = (struct Halfedge **) myalloc ( sizeof *ELhash * ELhashsize);
-	for(i=0; i<ELhashsize; i +=1) ELhash[i] = (struct Halfedge *)NULL;
-	ELleftend = HEcreate( (struct Edge *)NULL, 0);
-	ELrightend = HEcreate( (struct Edge *)NULL, 0);
-	ELleftend -> ELleft = (struct Halfedge *)NULL;
-	ELleftend -> ELright = ELrightend;
-	ELrightend -> ELleft = ELleftend;
-	ELrightend -> ELright = (struct Halfedge *)NULL;
-	ELhash[0] = ELleftend;
-	ELhash[ELhashsize-1] = ELrightend;
+	freeinit(&vd->hfl, sizeof **vd->ELhash);
+	vd->ELhashsize = 2 * vd->sqrt_nsites;
+	vd->ELhash = (struct Halfedge **) myalloc (vd, sizeof *vd->ELhash * vd->ELhashsize);
+	for(i=0; i<vd->ELhashsize; i +=1) vd->ELhash[i] = (struct Halfedge *)NULL;
+	vd->ELleftend = HEcreate(vd, (struct Edge *)NULL, 0);
+	vd->ELrightend = HEcreate(vd, (struct Edge *)NULL, 0);
+	vd->ELleftend -> ELleft = (struct Halfedge *)NULL;
+	vd->ELleftend -> ELright = vd->ELrightend;
+	vd->ELrightend -> ELleft = vd->ELleftend;
+	vd->ELrightend -> ELright = (struct Halfedge *)NULL;
+	vd->ELhash[0] = vd->ELleftend;
+	vd->ELhash[vd->ELhashsize-1] = vd->ELrightend;
 }
 
 
-struct Halfedge *HEcreate(e, pm)
+struct Halfedge *HEcreate(vd, e, pm)
+struct Voronoi *vd;
 struct Edge *e;
 int pm;
 {
 struct Halfedge *answer;
-	answer = (struct Halfedge *) getfree(&hfl);
+	answer = (struct Halfedge *) getfree(vd, &vd->hfl);
 	answer -> ELedge = e;
 	answer -> ELpm = pm;
 	answer -> PQnext = (struct Halfedge *) NULL;
@@ -52,55 +46,57 @@ struct	Halfedge *lb, *new;
 }
 
 /* Get entry from hash table, pruning any deleted nodes */
-struct Halfedge *ELgethash(b)
+struct Halfedge *ELgethash(vd, b)
+struct Voronoi *vd;
 int b;
 {
 struct Halfedge *he;
 
-	if(b<0 || b>=ELhashsize) return((struct Halfedge *) NULL);
-	he = ELhash[b]; 
+	if(b<0 || b>=vd->ELhashsize) return((struct Halfedge *) NULL);
+	he = vd->ELhash[b]; 
 	if (he == (struct Halfedge *) NULL || 
 	    he -> ELedge != (struct Edge *) DELETED ) return (he);
 
 /* Hash table points to deleted half edge.  Patch as necessary. */
-	ELhash[b] = (struct Halfedge *) NULL;
-	if ((he -> ELrefcnt -= 1) == 0) makefree(he, &hfl);
+	vd->ELhash[b] = (struct Halfedge *) NULL;
+	if ((he -> ELrefcnt -= 1) == 0) makefree(he, &vd->hfl);
 	return ((struct Halfedge *) NULL);
 }	
 
-struct Halfedge *ELleftbnd(p)
+struct Halfedge *ELleftbnd(vd, p)
+struct Voronoi *vd;
 struct Point *p;
 {
 int i, bucket;
 struct Halfedge *he;
 
 /* Use hash table to get close to desired halfedge */
-	bucket = (p->x - xmin)/deltax * ELhashsize;
+	bucket = (p->x - vd->xmin)/vd->deltax * vd->ELhashsize;
 	if(bucket<0) bucket =0;
-	if(bucket>=ELhashsize) bucket = ELhashsize - 1;
-	he = ELgethash(bucket);
+	if(bucket>=vd->ELhashsize) bucket = vd->ELhashsize - 1;
+	he = ELgethash(vd, bucket);
 	if(he == (struct Halfedge *) NULL)
 	{   for(i=1; 1 ; i += 1)
-	    {	if ((he=ELgethash(bucket-i)) != (struct Halfedge *) NULL) break;
-		if ((he=ELgethash(bucket+i)) != (struct Halfedge *) NULL) break;
+	    {	if ((he=ELgethash(vd, bucket-i)) != (struct Halfedge *) NULL) break;
+		if ((he=ELgethash(vd, bucket+i)) != (struct Halfedge *) NULL) break;
 	    };
-	totalsearch += i;
+	vd->totalsearch += i;
 	};
-	ntry += 1;
+	vd->ntry += 1;
 /* Now search linear list of halfedges for the corect one */
-	if (he==ELleftend  || (he != ELrightend && right_of(he,p)))
-	{do {he = he -> ELright;} while (he!=ELrightend && right_of(he,p));
+	if (he==vd->ELleftend  || (he != vd->ELrightend && right_of(he,p)))
+	{do {he = he -> ELright;} while (he!=vd->ELrightend && right_of(he,p));
 	 he = he -> ELleft;
 	}
 	else 
-	do {he = he -> ELleft;} while (he!=ELleftend && !right_of(he,p));
+	do {he = he -> ELleft;} while (he!=vd->ELleftend && !right_of(he,p));
 
 /* Update hash table and reference counts */
-	if(bucket > 0 && bucket <ELhashsize-1)
-	{	if(ELhash[bucket] != (struct Halfedge *) NULL) 
-			ELhash[bucket] -> ELrefcnt -= 1;
-		ELhash[bucket] = he;
-		ELhash[bucket] -> ELrefcnt += 1;
+	if(bucket > 0 && bucket <vd->ELhashsize-1)
+	{	if(vd->ELhash[bucket] != (struct Halfedge *) NULL) 
+			vd->ELhash[bucket] -> ELrefcnt -= 1;
+		vd->ELhash[bucket] = he;
+		vd->ELhash[bucket] -> ELrefcnt += 1;
 	};
 	return (he);
 }
@@ -130,18 +126,20 @@ struct Halfedge *he;
 }
 
 
-struct Site *leftreg(he)
+struct Site *leftreg(vd, he)
+struct Voronoi *vd;
 struct Halfedge *he;
 {
-	if(he -> ELedge == (struct Edge *)NULL) return(bottomsite);
+	if(he -> ELedge == (struct Edge *)NULL) return(vd->bottomsite);
 	return( he -> ELpm == le ? 
 		he -> ELedge -> reg[le] : he -> ELedge -> reg[re]);
 }
 
-struct Site *rightreg(he)
+struct Site *rightreg(vd, he)
+struct Voronoi *vd;
 struct Halfedge *he;
 {
-	if(he -> ELedge == (struct Edge *)NULL) return(bottomsite);
+	if(he -> ELedge == (struct Edge *)NULL) return(vd->bottomsite);
 	return( he -> ELpm == le ? 
 		he -> ELedge -> reg[re] : he -> ELedge -> reg[le]);
 }
@@ -2,28 +2,30 @@
 #include "defs.h"
 #include <math.h>
 
-geominit()
+geominit(vd)
+struct Voronoi *vd;
 {
 struct Edge e;
 float sn;
 
-	freeinit(&efl, sizeof e);
-	nvertices = 0;
-	nedges = 0;
-	sn = nsites+4;
-	sqrt_nsites = sqrt(sn);
-	deltay = ymax - ymin;
-	deltax = xmax - xmin;
+	freeinit(&vd->efl, sizeof e);
+	vd->nvertices = 0;
+	vd->nedges = 0;
+	sn = vd->nsites+4;
+	vd->sqrt_nsites = sqrt(sn);
+	vd->deltay = vd->ymax - vd->ymin;
+	vd->deltax = vd->xmax - vd->xmin;
 }
 
 
-struct Edge *bisect(s1,s2)
+struct Edge *bisect(vd,s1,s2)
+struct	Voronoi *vd;
 struct	Site *s1,*s2;
 {
 double dx,dy,adx,ady;
 struct Edge *newedge;
 
-	newedge = (struct Edge *) getfree(&efl);
+	newedge = (struct Edge *) getfree(vd, &vd->efl);
 
 	newedge -> reg[0] = s1;
 	newedge -> reg[1] = s2;
@@ -42,14 +44,15 @@ struct Edge *newedge;
 	else
 	{	newedge -> b = 1.0; newedge -> a = dx/dy; newedge -> c /= dy;};
 
-	newedge -> edgenbr = nedges;
-	out_bisector(newedge);
-	nedges += 1;
+	newedge -> edgenbr = vd->nedges;
+	out_bisector(vd, newedge);
+	vd->nedges += 1;
 	return(newedge);
 }
 
 
-struct Site *intersect(el1, el2, p)
+struct Site *intersect(vd, el1, el2, p)
+struct Voronoi *vd;
 struct Halfedge *el1, *el2;
 struct Point *p;
 {
@@ -83,7 +86,7 @@ struct Site *v;
 	if ((right_of_site && el -> ELpm == le) ||
 	   (!right_of_site && el -> ELpm == re)) return ((struct Site *) NULL);
 
-	v = (struct Site *) getfree(&sfl);
+	v = (struct Site *) getfree(vd, &vd->sfl);
 	v -> refcnt = 0;
 	v -> coord.x = xint;
 	v -> coord.y = yint;
@@ -137,7 +140,8 @@ return (el->ELpm==le ? above : !above);
 }
 
 
-endpoint(e, lr, s)
+endpoint(vd, e, lr, s)
+struct Voronoi *vd;
 struct Edge *e;
 int	lr;
 struct Site *s;
@@ -145,10 +149,10 @@ struct Site *s;
 e -> ep[lr] = s;
 ref(s);
 if(e -> ep[re-lr]== (struct Site *) NULL) return;
-out_ep(e);
-deref(e->reg[le]);
-deref(e->reg[re]);
-makefree(e, &efl);
+out_ep(vd, e);
+deref(vd, e->reg[le]);
+deref(vd, e->reg[re]);
+makefree(e, &vd->efl);
 }
 
 
@@ -162,20 +166,22 @@ float dx,dy;
 }
 
 
-int makevertex(v)
+int makevertex(vd, v)
+struct Voronoi *vd;
 struct Site *v;
 {
-v -> sitenbr = nvertices;
-nvertices += 1;
-out_vertex(v);
+v -> sitenbr = vd->nvertices;
+vd->nvertices += 1;
+out_vertex(vd, v);
 }
 
 
-deref(v)
+deref(vd, v)
+struct	Voronoi *vd;
 struct	Site *v;
 {
 v -> refcnt -= 1;
-if (v -> refcnt == 0 ) makefree(v, &sfl);
+if (v -> refcnt == 0 ) makefree(v, &vd->sfl);
 }
 
 ref(v)
@@ -1,14 +1,9 @@
 #
 #include "defs.h"
-int PQhashsize;
-struct	Halfedge *PQhash;
-struct	Halfedge *PQfind();
-int PQcount;
-int PQmin;
-int PQempty();
 
 
-PQinsert(he, v, offset)
+PQinsert(vd, he, v, offset)
+struct Voronoi *vd;
 struct Halfedge *he;
 struct Site *v;
 float 	offset;
@@ -17,81 +12,87 @@ struct Halfedge *last, *next;
 he -> vertex = v;
 ref(v);
 he -> ystar = v -> coord.y + offset;
-last = &PQhash[PQbucket(he)];
+last = &vd->PQhash[PQbucket(vd, he)];
 while ((next = last -> PQnext) != (struct Halfedge *) NULL &&
       (he -> ystar  > next -> ystar  ||
       (he -> ystar == next -> ystar && v -> coord.x > next->vertex->coord.x)))
 	{	last = next;};
-he -> PQnext = last -> PQnext; 
+he -> PQnext = last -> PQnext;
 last -> PQnext = he;
-PQcount += 1;
+vd->PQcount += 1;
 }
 
-PQdelete(he)
+PQdelete(vd, he)
+struct Voronoi *vd;
 struct Halfedge *he;
 {
 struct Halfedge *last;
 
 if(he ->  vertex != (struct Site *) NULL)
-{	last = &PQhash[PQbucket(he)];
+{	last = &vd->PQhash[PQbucket(vd, he)];
 	while (last -> PQnext != he) last = last -> PQnext;
 	last -> PQnext = he -> PQnext;
-	PQcount -= 1;
-	deref(he -> vertex);
+	vd->PQcount -= 1;
+	deref(vd, he -> vertex);
 	he -> vertex = (struct Site *) NULL;
 };
 }
 
-int PQbucket(he)
+int PQbucket(vd, he)
+struct Voronoi *vd;
 struct Halfedge *he;
 {
 int bucket;
 
-if	(he->ystar < ymin) bucket = 0;
-else if	(he->ystar >= ymax) bucket = PQhashsize-1;
-else 			   bucket = (he->ystar - ymin)/deltay * PQhashsize;
+if	(he->ystar < vd->ymin) bucket = 0;
+else if	(he->ystar >= vd->ymax) bucket = vd->PQhashsize-1;
+else 			   bucket = (he->ystar - vd->ymin)/vd->deltay * vd->PQhashsize;
 if (bucket<0) bucket = 0;
-if (bucket>=PQhashsize) bucket = PQhashsize-1 ;
-if (bucket < PQmin) PQmin = bucket;
+if (bucket>=vd->PQhashsize) bucket = vd->PQhashsize-1 ;
+if (bucket < vd->PQmin) vd->PQmin = bucket;
 return(bucket);
 }
 
 
 
-int PQempty()
+int PQempty(vd)
+struct Voronoi *vd;
 {
-	return(PQcount==0);
+	return(vd->PQcount==0);
 }
 
 
-struct Point PQ_min()
+struct Point PQ_min(vd)
+struct Voronoi *vd;
 {
 struct Point answer;
 
-	while(PQhash[PQmin].PQnext == (struct Halfedge *)NULL) {PQmin += 1;};
-	answer.x = PQhash[PQmin].PQnext -> vertex -> coord.x;
-	answer.y = PQhash[PQmin].PQnext -> ystar;
+	while(vd->PQhash[vd->PQmin].PQnext == (struct Halfedge *)NULL) {vd->PQmin += 1;};
+	answer.x = vd->PQhash[vd->PQmin].PQnext -> vertex -> coord.x;
+	answer.y = vd->PQhash[vd->PQmin].PQnext -> ystar;
 	return (answer);
 }
 
-struct Halfedge *PQextractmin()
+struct Halfedge *PQextractmin(vd)
+struct Voronoi *vd;
 {
 struct Halfedge *curr;
-	curr = PQhash[PQmin].PQnext;
-	PQhash[PQmin].PQnext = curr -> PQnext;
-	PQcount -= 1;
+	curr = vd->PQhash[vd->PQmin].PQnext;
+	vd->PQhash[vd->PQmin].PQnext = curr -> PQnext;
+	vd->PQcount -= 1;
 	return(curr);
 }
 
 
-PQinitialize()
+PQinitialize(vd)
+struct Voronoi *vd;
 {
 int i; struct Point *s;
 
-	PQcount = 0;
-	PQmin = 0;
-	PQhashsize = 4 * sqrt_nsites;
-	PQhash = (struct Halfedge *) myalloc(PQhashsize * sizeof *PQhash);
-	for(i=0; i<PQhashsize; i+=1) PQhash[i].PQnext = (struct Halfedge *)NULL;
+	vd->PQcount = 0;
+	vd->PQmin = 0;
+	vd->PQhashsize = 4 * vd->sqrt_nsites;
+	vd->PQhash = (struct Halfedge *) myalloc(vd, vd->PQhashsize * sizeof *vd->PQhash);
+	for(i=0; i<vd->PQhashsize; i+=1) vd->PQhash[i].PQnext = (struct Halfedge *)NULL;
 }
 
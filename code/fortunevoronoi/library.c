@@ -0,0 +1,136 @@
+#
+#include "defs.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* The entry points of voronoi.h.  A run sets up vd like main used to set
+   up the globals, runs the sweep and frees what it allocated. */
+
+struct Voronoi *voronoi_create(const struct VoronoiOutput *output)
+{
+struct Voronoi *vd;
+
+	vd = (struct Voronoi *) calloc(1, sizeof *vd);
+	if(vd == (struct Voronoi *) NULL) return(vd);
+	if(output != (struct VoronoiOutput *) NULL) vd->output = *output;
+	return(vd);
+}
+
+void voronoi_destroy(struct Voronoi *vd)
+{
+	if(vd == (struct Voronoi *) NULL) return;
+	myfreeall(vd);
+	free(vd);
+}
+
+
+/* sort sites on y, then x, coord */
+static int scomp(const void *p1, const void *p2)
+{
+const struct Point *s1 = (const struct Point *)p1, *s2 = (const struct Point *)p2;
+	if(s1 -> y < s2 -> y) return(-1);
+	if(s1 -> y > s2 -> y) return(1);
+	if(s1 -> x < s2 -> x) return(-1);
+	if(s1 -> x > s2 -> x) return(1);
+	return(0);
+}
+
+/* return a single in-storage site */
+static struct Site *nextone(struct Voronoi *vd)
+{
+for (;vd->siteidx<vd->nsites; vd->siteidx+= 1)
+{	if (vd->siteidx==0 || vd->sites[vd->siteidx].coord.x!=vd->sites[vd->siteidx-1].coord.x
+		       || vd->sites[vd->siteidx].coord.y!=vd->sites[vd->siteidx-1].coord.y)
+	{	vd->siteidx += 1;
+		return (&vd->sites[vd->siteidx-1]);
+	};
+};
+return( (struct Site *)NULL);
+}
+
+/* read one site */
+static struct Site *readone(struct Voronoi *vd)
+{
+struct Site *s;
+
+s = (struct Site *) getfree(vd, &vd->sfl);
+s -> refcnt = 0;
+s -> sitenbr = vd->siteidx;
+vd->siteidx += 1;
+if((*vd->nextpoint)(vd->nextarg, &s->coord) == 0)
+	return ((struct Site *) NULL );
+return(s);
+}
+
+/* what is left of main once the sites are in */
+static int sweep(struct Voronoi *vd, struct Site *(*next)())
+{
+	if(setjmp(vd->nomemory) != 0)
+	{	myfreeall(vd);
+		return(-1);
+	};
+	vd->siteidx = 0;
+	vd->total_alloc = 0;
+	geominit(vd);
+	if(vd->output.begin != NULL)
+		(*vd->output.begin)(vd->output.arg, vd->xmin, vd->xmax, vd->ymin, vd->ymax);
+
+	voronoi(vd, next);
+
+	if(vd->output.end != NULL)
+		(*vd->output.end)(vd->output.arg);
+	myfreeall(vd);
+	return(0);
+}
+
+
+/* copy the sites, sort, and compute xmin, xmax, ymin, ymax */
+int voronoi_run(struct Voronoi *vd, const struct Point *points, int n)
+{
+int i;
+
+	if(n <= 0) return(0);
+	vd->sites = (struct Site *) malloc(n * sizeof *vd->sites);
+	if(vd->sites == (struct Site *) NULL) return(-1);
+	for(i=0; i<n; i+=1)
+	{	vd->sites[i].coord = points[i];
+		vd->sites[i].sitenbr = i;
+		vd->sites[i].refcnt = 0;
+	};
+	qsort(vd->sites, n, sizeof *vd->sites, scomp);
+	vd->nsites = n;
+	vd->xmin=vd->sites[0].coord.x;
+	vd->xmax=vd->sites[0].coord.x;
+	for(i=1; i<n; i+=1)
+	{	if(vd->sites[i].coord.x < vd->xmin) vd->xmin = vd->sites[i].coord.x;
+		if(vd->sites[i].coord.x > vd->xmax) vd->xmax = vd->sites[i].coord.x;
+	};
+	vd->ymin = vd->sites[0].coord.y;
+	vd->ymax = vd->sites[n-1].coord.y;
+
+	freeinit(&vd->sfl, sizeof *vd->sites);
+	i = sweep(vd, nextone);
+	free(vd->sites);
+	vd->sites = (struct Site *) NULL;
+	return(i);
+}
+
+int voronoi_run_sorted(struct Voronoi *vd, int nsites,
+	float xmin, float xmax, float ymin, float ymax,
+	int (*next)(void *arg, struct Point *p), void *arg)
+{
+int r;
+
+	vd->nsites = nsites;
+	vd->xmin = xmin;
+	vd->xmax = xmax;
+	vd->ymin = ymin;
+	vd->ymax = ymax;
+	vd->nextpoint = next;
+	vd->nextarg = arg;
+
+	freeinit(&vd->sfl, sizeof(struct Site));
+	r = sweep(vd, readone);
+	vd->nextpoint = NULL;
+	return(r);
+}
@@ -1,24 +1,47 @@
 #
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include "defs.h"
-struct Site *readone();
-struct Site *nextone();
 
-int triangulate, sorted, plot, debug;
-float xmin, xmax, ymin, ymax, deltax, deltay;
+static struct Point *readsites();
+static int readone();
+static char *mapinput();
+static int nextpoint();
 
-main(argc,argv) 
-char **argv; 
+/* the binary input of voronoi_run_sorted */
+struct Pointarray	{
+struct	Point	*points;
+int		n, i;
+};
+
+main(argc,argv)
+char **argv;
 int argc;
-{	
-int c;
-struct Site *(*next)();
+{
+int c, n, r, i;
+int triangulate, sorted, plot, debug, binary, input;
+float xmin, xmax, ymin, ymax;
+char *data;
+long size;
+struct Point *points;
+struct Pointarray array;
+struct VoronoiOutput output;
+struct VoronoiPrinter printer;
+struct Voronoi *vd;
 
-sorted = 0; triangulate = 0; plot = 0; debug = 0;
-while((c=getopt(argc,argv,"dpst")) != EOF)
+sorted = 0; triangulate = 0; plot = 0; debug = 0; binary = 0; input = 't';
+while((c=getopt(argc,argv,"bdi:pst")) != EOF)
 	switch(c) {
+	case 'b': binary = 1;
+		  break;
 	case 'd': debug = 1;
 		  break;
+	case 'i': input = optarg[0];
+		  break;
 	case 's': sorted = 1;
 		  break;
 	case 't': triangulate = 1;
@@ -26,87 +49,152 @@ while((c=getopt(argc,argv,"dpst")) != EOF)
 	case 'p': plot = 1;
 		  break;
 		  };
-
-freeinit(&sfl, sizeof *sites);
-if(sorted)
-{	scanf("%d %f %f %f %f", &nsites, &xmin, &xmax, &ymin, &ymax);
-	next = readone;
-}
-else 
-{	readsites();
-	next = nextone;
+if((input != 't' && input != 'f' && input != 'd') || (binary && (plot || debug)))
+{	fprintf(stderr,"usage: voronoi [-s] [-t] [-p | -d | -b] [-i t|f|d]\n");
+	exit(2);
 };
 
-siteidx = 0;
-geominit();
-if(plot) plotinit();
+/* the records are small, write them in big blocks */
+setvbuf(stdout, (char *) NULL, _IOFBF, 1<<16);
+if(binary)
+	voronoi_binary_printer(&output, &printer, stdout, triangulate);
+else
+	voronoi_printer(&output, &printer, stdout, triangulate, plot, debug);
+if((vd = voronoi_create(&output)) == (struct Voronoi *) NULL)
+{	fprintf(stderr,"Insufficient memory\n");
+	exit(1);
+};
 
-voronoi(triangulate, next); 
+if(input != 't')
+{	/* packed float or double pairs, floats are used in place */
+	if((data = mapinput(&size)) == (char *) NULL)
+	{	fprintf(stderr,"Can't read the input\n");
+		exit(1);
+	};
+	/* a partial point at the end is a truncated or wrong input */
+	if(size % (input == 'f' ? sizeof *points : 2 * sizeof(double)) != 0)
+	{	fprintf(stderr,"The input is %ld bytes, not a whole number of %s pairs\n",
+			size, input == 'f' ? "float" : "double");
+		exit(1);
+	};
+	if(input == 'f')
+	{	n = size / sizeof *points;
+		points = (struct Point *) data;
+	}
+	else
+	{	n = size / (2 * sizeof(double));
+		points = (struct Point *) malloc((n > 0 ? n : 1) * sizeof *points);
+		if(points == (struct Point *) NULL)
+		{	fprintf(stderr,"Insufficient memory\n");
+			exit(1);
+		};
+		for(i=0; i<n; i+=1)
+		{	points[i].x = ((double *)data)[2*i];
+			points[i].y = ((double *)data)[2*i+1];
+		};
+	};
+	if(sorted)
+	{	/* there is no first line, the number and range come from the points */
+		xmin = xmax = n > 0 ? points[0].x : 0;
+		ymin = n > 0 ? points[0].y : 0;
+		ymax = n > 0 ? points[n-1].y : 0;
+		for(i=1; i<n; i+=1)
+		{	if(points[i].x < xmin) xmin = points[i].x;
+			if(points[i].x > xmax) xmax = points[i].x;
+		};
+		array.points = points;
+		array.n = n;
+		array.i = 0;
+		r = n > 0 ? voronoi_run_sorted(vd, n, xmin, xmax, ymin, ymax, nextpoint, &array) : 0;
+	}
+	else
+		r = voronoi_run(vd, points, n);
+}
+else if(sorted)
+{	scanf("%d %f %f %f %f", &n, &xmin, &xmax, &ymin, &ymax);
+	r = voronoi_run_sorted(vd, n, xmin, xmax, ymin, ymax, readone, stdin);
+}
+else
+{	points = readsites(&n);
+	r = points != (struct Point *) NULL ? voronoi_run(vd, points, n) : -1;
+};
 
+if(r != 0)
+{	fprintf(stderr,"Insufficient memory processing site %d (%d bytes in use)\n",
+		vd->siteidx, vd->total_alloc);
+	exit(1);
+};
 exit(0);
 }
 
-/* sort sites on y, then x, coord */
-int scomp(s1,s2)
-struct Point *s1,*s2;
-{
-	if(s1 -> y < s2 -> y) return(-1);
-	if(s1 -> y > s2 -> y) return(1);
-	if(s1 -> x < s2 -> x) return(-1);
-	if(s1 -> x > s2 -> x) return(1);
-	return(0);
-}
 
-/* return a single in-storage site */
-struct Site *nextone()
+/* read all sites */
+static struct Point *readsites(n)
+int *n;
 {
-struct Site *s;
-for (;siteidx<nsites; siteidx+= 1)
-{	if (siteidx==0 || sites[siteidx].coord.x!=sites[siteidx-1].coord.x 
-		       || sites[siteidx].coord.y!=sites[siteidx-1].coord.y)
-	{	siteidx += 1;
-		return (&sites[siteidx-1]);
+struct Point *points, *more;
+
+*n=0;
+points = (struct Point *) malloc(4000*sizeof *points);
+while(points != (struct Point *) NULL &&
+      scanf("%f %f", &points[*n].x, &points[*n].y)!=EOF)
+{	*n += 1;
+	if (*n % 4000 == 0)
+	{	more = (struct Point *) realloc(points,(*n+4000)*sizeof*points);
+		if(more == (struct Point *) NULL) free(points);
+		points = more;
 	};
 };
-return( (struct Site *)NULL);
+return(points);
 }
 
-
-/* read all sites, sort, and compute xmin, xmax, ymin, ymax */
-readsites()
+/* read one site */
+static int readone(arg, p)
+void *arg;
+struct Point *p;
 {
-int i;
+return(fscanf((FILE *)arg, "%f %f", &(p->x), &(p->y)) != EOF);
+}
 
-nsites=0;
-sites = (struct Site *) myalloc(4000*sizeof *sites);
-while(scanf("%f %f", &sites[nsites].coord.x, &sites[nsites].coord.y)!=EOF)
-{	sites[nsites].sitenbr = nsites;
-	sites[nsites].refcnt = 0;
-	nsites += 1;
-	if (nsites % 4000 == 0) 
-		sites = (struct Site *) realloc(sites,(nsites+4000)*sizeof*sites);
-};
-qsort(sites, nsites, sizeof *sites, scomp);
-xmin=sites[0].coord.x; 
-xmax=sites[0].coord.x;
-for(i=1; i<nsites; i+=1)
-{	if(sites[i].coord.x < xmin) xmin = sites[i].coord.x;
-	if(sites[i].coord.x > xmax) xmax = sites[i].coord.x;
-};
-ymin = sites[0].coord.y;
-ymax = sites[nsites-1].coord.y;
+/* the next of the sorted binary points */
+static int nextpoint(arg, p)
+void *arg;
+struct Point *p;
+{
+struct Pointarray *array = (struct Pointarray *)arg;
+if(array->i >= array->n) return(0);
+*p = array->points[array->i];
+array->i += 1;
+return(1);
 }
 
-/* read one site */
-struct Site *readone()
+/* all of stdin, mapped when it is a file, read when it is a pipe.  It is
+   left to the exit */
+static char *mapinput(size)
+long *size;
 {
-struct Site *s;
+struct stat st;
+char *data, *more;
+long len, got;
 
-s = (struct Site *) getfree(&sfl);
-s -> refcnt = 0;
-s -> sitenbr = siteidx;
-siteidx += 1;
-if(scanf("%f %f", &(s->coord.x), &(s->coord.y)) == EOF)
-	return ((struct Site *) NULL );
-return(s);
+if(fstat(0, &st) == 0 && S_ISREG(st.st_mode))
+{	*size = st.st_size;
+	if(*size == 0) return((char *) malloc(1));
+	data = (char *) mmap((void *) NULL, *size, PROT_READ, MAP_PRIVATE, 0, 0);
+	if(data != (char *) MAP_FAILED) return(data);
+};
+
+len = 1<<20;
+*size = 0;
+data = (char *) malloc(len);
+while(data != (char *) NULL && (got = read(0, data + *size, len - *size)) > 0)
+{	*size += got;
+	if(*size == len)
+	{	len *= 2;
+		more = (char *) realloc(data, len);
+		if(more == (char *) NULL) free(data);
+		data = more;
+	};
+};
+return(data);
 }
@@ -1,6 +1,6 @@
 #
 #include "defs.h"
-#include <stdio.h>
+#include <stdlib.h>
 
 freeinit(fl, size)
 struct	Freelist *fl;
@@ -10,13 +10,14 @@ fl -> head = (struct Freenode *) NULL;
 fl -> nodesize = size;
 }
 
-char *getfree(fl)
+char *getfree(vd, fl)
+struct	Voronoi *vd;
 struct	Freelist *fl;
 {
 int i; struct Freenode *t;
 if(fl->head == (struct Freenode *) NULL)
-{	t =  (struct Freenode *) myalloc(sqrt_nsites * fl->nodesize);
-	for(i=0; i<sqrt_nsites; i+=1) 	
+{	t =  (struct Freenode *) myalloc(vd, vd->sqrt_nsites * fl->nodesize);
+	for(i=0; i<vd->sqrt_nsites; i+=1)
 		makefree((struct Freenode *)((char *)t+i*fl->nodesize), fl);
 };
 t = fl -> head;
@@ -34,16 +35,27 @@ curr -> nextfree = fl -> head;
 fl -> head = curr;
 }
 
-int total_alloc;
-char *myalloc(n)
+/* the blocks are kept on vd->memory for myfreeall, there is no exit when
+   malloc fails, the run in progress is abandoned */
+char *myalloc(vd, n)
+struct Voronoi *vd;
 unsigned n;
 {
-char *t;
-if ((t=malloc(n)) == (char *) 0)
-{    fprintf(stderr,"Insufficient memory processing site %d (%d bytes in use)\n",
-		siteidx, total_alloc);
-     exit();
+union Memblock *t;
+if ((t=(union Memblock *)malloc(sizeof *t + n)) == (union Memblock *) 0)
+	longjmp(vd->nomemory, 1);
+t -> next = vd -> memory;
+vd -> memory = t;
+vd -> total_alloc += n;
+return((char *)(t+1));
+}
+
+myfreeall(vd)
+struct Voronoi *vd;
+{
+union Memblock *t;
+while ((t = vd -> memory) != (union Memblock *) 0)
+{	vd -> memory = t -> next;
+	free(t);
 };
-total_alloc += n;
-return(t);
 }
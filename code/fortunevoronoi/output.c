@@ -1,101 +1,154 @@
 #
 #include "defs.h"
 #include <stdio.h>
-float pxmin, pxmax, pymin, pymax, cradius;
 
 
+/* the sweep reports through these, to the callbacks of vd->output */
 
-out_bisector(e)
+out_bisector(vd, e)
+struct Voronoi *vd;
 struct Edge *e;
 {
-if(triangulate & plot &!debug)
-	printf("li %g %g %g %g\n", e->reg[0]->coord.x, e->reg[0]->coord.y, 
-	     e->reg[1]->coord.x, e->reg[1]->coord.y);
-if(!triangulate & !plot &!debug)
-	printf("l %f %f %f\n", e->a, e->b, e->c);
-if(debug)
-	printf("line(%d) %gx+%gy=%g, bisecting %d %d\n", e->edgenbr,
-	    e->a, e->b, e->c, e->reg[le]->sitenbr, e->reg[re]->sitenbr);
+if(vd->output.bisector != NULL)
+	(*vd->output.bisector)(vd->output.arg, e);
 }
 
 
-out_ep(e)
+out_ep(vd, e)
+struct Voronoi *vd;
 struct Edge *e;
 {
-if(!triangulate & plot) 
-	clip_line(e);
-if(!triangulate & !plot)
-{	printf("e %d", e->edgenbr);
-	printf(" %d ", e->ep[le] != (struct Site *)NULL ? e->ep[le]->sitenbr : -1);
-	printf("%d\n", e->ep[re] != (struct Site *)NULL ? e->ep[re]->sitenbr : -1);
-};
+if(vd->output.edge != NULL)
+	(*vd->output.edge)(vd->output.arg, e);
 }
 
-out_vertex(v)
+out_vertex(vd, v)
+struct Voronoi *vd;
 struct Site *v;
 {
-if(!triangulate & !plot &!debug)
-	printf ("v %f %f\n", v->coord.x, v->coord.y);
-if(debug)
-	printf("vertex(%d) at %f %f\n", v->sitenbr, v->coord.x, v->coord.y);
+if(vd->output.vertex != NULL)
+	(*vd->output.vertex)(vd->output.arg, v);
 }
 
 
-out_site(s)
+out_site(vd, s)
+struct Voronoi *vd;
 struct Site *s;
 {
-if(!triangulate & plot & !debug)
-	printf("ci %g %g %g\n", s->coord.x, s->coord.y, cradius);
-if(!triangulate & !plot & !debug)
-	printf("s %f %f\n", s->coord.x, s->coord.y);
-if(debug)
-	printf("site (%d) at %f %f\n", s->sitenbr, s->coord.x, s->coord.y);
+if(vd->output.site != NULL)
+	(*vd->output.site)(vd->output.arg, s);
 }
 
 
-out_triple(s1, s2, s3)
+out_triple(vd, s1, s2, s3)
+struct Voronoi *vd;
 struct Site *s1, *s2, *s3;
 {
-if(triangulate & !plot &!debug)
-	printf("%d %d %d\n", s1->sitenbr, s2->sitenbr, s3->sitenbr);
-if(debug)
-	printf("circle through left=%d right=%d bottom=%d\n", 
+if(vd->output.triple != NULL)
+	(*vd->output.triple)(vd->output.arg, s1, s2, s3);
+}
+
+
+/* the records of the voronoi program, see voronoi.man.  The callbacks
+   have prototypes, the float arguments of begin are not promoted */
+
+static void print_bisector(void *arg, struct Edge *e)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+if(pr->triangulate & pr->plot &!pr->debug)
+	fprintf(pr->file, "li %g %g %g %g\n", e->reg[0]->coord.x, e->reg[0]->coord.y,
+	     e->reg[1]->coord.x, e->reg[1]->coord.y);
+if(!pr->triangulate & !pr->plot &!pr->debug)
+	fprintf(pr->file, "l %f %f %f\n", e->a, e->b, e->c);
+if(pr->debug)
+	fprintf(pr->file, "line(%d) %gx+%gy=%g, bisecting %d %d\n", e->edgenbr,
+	    e->a, e->b, e->c, e->reg[le]->sitenbr, e->reg[re]->sitenbr);
+}
+
+
+static void print_ep(void *arg, struct Edge *e)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+if(!pr->triangulate & pr->plot)
+	clip_line(pr, e);
+if(!pr->triangulate & !pr->plot)
+{	fprintf(pr->file, "e %d", e->edgenbr);
+	fprintf(pr->file, " %d ", e->ep[le] != (struct Site *)NULL ? e->ep[le]->sitenbr : -1);
+	fprintf(pr->file, "%d\n", e->ep[re] != (struct Site *)NULL ? e->ep[re]->sitenbr : -1);
+};
+}
+
+static void print_vertex(void *arg, struct Site *v)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+if(!pr->triangulate & !pr->plot &!pr->debug)
+	fprintf (pr->file, "v %f %f\n", v->coord.x, v->coord.y);
+if(pr->debug)
+	fprintf(pr->file, "vertex(%d) at %f %f\n", v->sitenbr, v->coord.x, v->coord.y);
+}
+
+
+static void print_site(void *arg, struct Site *s)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+if(!pr->triangulate & pr->plot & !pr->debug)
+	fprintf(pr->file, "ci %g %g %g\n", s->coord.x, s->coord.y, pr->cradius);
+if(!pr->triangulate & !pr->plot & !pr->debug)
+	fprintf(pr->file, "s %f %f\n", s->coord.x, s->coord.y);
+if(pr->debug)
+	fprintf(pr->file, "site (%d) at %f %f\n", s->sitenbr, s->coord.x, s->coord.y);
+}
+
+
+static void print_triple(void *arg, struct Site *s1, struct Site *s2, struct Site *s3)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+if(pr->triangulate & !pr->plot &!pr->debug)
+	fprintf(pr->file, "%d %d %d\n", s1->sitenbr, s2->sitenbr, s3->sitenbr);
+if(pr->debug)
+	fprintf(pr->file, "circle through left=%d right=%d bottom=%d\n",
 		s1->sitenbr, s2->sitenbr, s3->sitenbr);
 }
 
 
 
-plotinit()
+/* the begin callback, the plot range comes from the sites */
+static void plotinit(void *arg, float xmin, float xmax, float ymin, float ymax)
 {
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
 float dx,dy,d;
 
+if(!pr->plot) return;
 dy = ymax - ymin;
 dx = xmax - xmin;
 d = ( dx > dy ? dx : dy) * 1.3;
-pxmin = xmin - (d-dx)/2.0;
-pxmax = xmax + (d-dx)/2.0;
-pymin = ymin - (d-dy)/2.0;
-pymax = ymax + (d-dy)/2.0;
-cradius = (pxmax - pxmin)/350.0;
-printf("o\ne\nra %g %g %g %g\n", pxmin, pymin, pxmax, pymax);
+pr->pxmin = xmin - (d-dx)/2.0;
+pr->pxmax = xmax + (d-dx)/2.0;
+pr->pymin = ymin - (d-dy)/2.0;
+pr->pymax = ymax + (d-dy)/2.0;
+pr->cradius = (pr->pxmax - pr->pxmin)/350.0;
+fprintf(pr->file, "o\ne\nra %g %g %g %g\n", pr->pxmin, pr->pymin, pr->pxmax, pr->pymax);
 }
 
-finish_pl()
+static void finish_pl(void *arg)
 {
-	if(plot)	printf("cl\n");
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+	if(pr->plot)	fprintf(pr->file, "cl\n");
 }
 
-int clip_line(e)
+int clip_line(pr, e)
+struct VoronoiPrinter *pr;
 struct Edge *e;
 {
 struct Site *s1, *s2;
 float x1,x2,y1,y2;
+float pxmin = pr->pxmin, pxmax = pr->pxmax, pymin = pr->pymin, pymax = pr->pymax;
 
 	if(e -> a == 1.0 && e ->b >= 0.0)
 	{	s1 = e -> ep[1];
 		s2 = e -> ep[0];
 	}
-	else 
+	else
 	{	s1 = e -> ep[0];
 		s2 = e -> ep[1];
 	};
@@ -108,7 +161,7 @@ float x1,x2,y1,y2;
 		if(y1>pymax) return;
 		x1 = e -> c - e -> b * y1;
 		y2 = pymax;
-		if (s2!=(struct Site *)NULL && s2->coord.y < pymax) 
+		if (s2!=(struct Site *)NULL && s2->coord.y < pymax)
 			y2 = s2->coord.y;
 		if(y2<pymin) return(0);
 		x2 = e -> c - e -> b * y2;
@@ -125,12 +178,12 @@ float x1,x2,y1,y2;
 	else
 	{
 		x1 = pxmin;
-		if (s1!=(struct Site *)NULL && s1->coord.x > pxmin) 
+		if (s1!=(struct Site *)NULL && s1->coord.x > pxmin)
 			x1 = s1->coord.x;
 		if(x1>pxmax) return(0);
 		y1 = e -> c - e -> a * x1;
 		x2 = pxmax;
-		if (s2!=(struct Site *)NULL && s2->coord.x < pxmax) 
+		if (s2!=(struct Site *)NULL && s2->coord.x < pxmax)
 			x2 = s2->coord.x;
 		if(x2<pxmin) return(0);
 		y2 = e -> c - e -> a * x2;
@@ -144,6 +197,101 @@ float x1,x2,y1,y2;
 		if(y2<pymin)
 		{	y2 = pymin; x2 = (e -> c - y2)/e -> a;};
 	};
-	
-	printf("li %g %g %g %g\n", x1,y1,x2,y2);
+
+	fprintf(pr->file, "li %g %g %g %g\n", x1,y1,x2,y2);
+}
+
+
+void voronoi_printer(struct VoronoiOutput *output, struct VoronoiPrinter *printer,
+	FILE *file, int triangulate, int plot, int debug)
+{
+	printer->file = file;
+	printer->triangulate = triangulate;
+	printer->plot = plot;
+	printer->debug = debug;
+	printer->pxmin = printer->pxmax = printer->pymin = printer->pymax = 0;
+	printer->cradius = 0;
+
+	output->arg = printer;
+	output->begin = plotinit;
+	output->site = print_site;
+	output->bisector = print_bisector;
+	output->vertex = print_vertex;
+	output->edge = print_ep;
+	output->triple = print_triple;
+	output->end = finish_pl;
+}
+
+
+/* -b, the records packed, see voronoi.h */
+
+static void put_record(pr, tag, data, size)
+struct VoronoiPrinter *pr;
+int tag;
+char *data;
+int size;
+{
+	putc(tag, pr->file);
+	fwrite(data, size, 1, pr->file);
+}
+
+static void put_site(void *arg, struct Site *s)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+float r[2];
+if(pr->triangulate) return;
+r[0] = s->coord.x; r[1] = s->coord.y;
+put_record(pr, VORONOI_RECORD_SITE, (char *)r, sizeof r);
+}
+
+static void put_bisector(void *arg, struct Edge *e)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+double r[3];
+if(pr->triangulate) return;
+r[0] = e->a; r[1] = e->b; r[2] = e->c;
+put_record(pr, VORONOI_RECORD_LINE, (char *)r, sizeof r);
+}
+
+static void put_vertex(void *arg, struct Site *v)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+float r[2];
+if(pr->triangulate) return;
+r[0] = v->coord.x; r[1] = v->coord.y;
+put_record(pr, VORONOI_RECORD_VERTEX, (char *)r, sizeof r);
+}
+
+static void put_ep(void *arg, struct Edge *e)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+int r[3];
+if(pr->triangulate) return;
+r[0] = e->edgenbr;
+r[1] = e->ep[le] != (struct Site *)NULL ? e->ep[le]->sitenbr : -1;
+r[2] = e->ep[re] != (struct Site *)NULL ? e->ep[re]->sitenbr : -1;
+put_record(pr, VORONOI_RECORD_EDGE, (char *)r, sizeof r);
+}
+
+static void put_triple(void *arg, struct Site *s1, struct Site *s2, struct Site *s3)
+{
+struct VoronoiPrinter *pr = (struct VoronoiPrinter *)arg;
+int r[3];
+if(!pr->triangulate) return;
+r[0] = s1->sitenbr; r[1] = s2->sitenbr; r[2] = s3->sitenbr;
+put_record(pr, VORONOI_RECORD_TRIANGLE, (char *)r, sizeof r);
+}
+
+
+void voronoi_binary_printer(struct VoronoiOutput *output, struct VoronoiPrinter *printer,
+	FILE *file, int triangulate)
+{
+	voronoi_printer(output, printer, file, triangulate, 0, 0);
+	output->begin = NULL;
+	output->site = put_site;
+	output->bisector = put_bisector;
+	output->vertex = put_vertex;
+	output->edge = put_ep;
+	output->triple = put_triple;
+	output->end = NULL;
 }
@@ -1,22 +1,14 @@
 #
 #include "defs.h"
 
-struct	Site	*sites;
-int		nsites;
-int		siteidx;
-int		sqrt_nsites;
-int		nvertices;
-struct 	Freelist sfl;
-struct	Site	*bottomsite;
 
-
-/* implicit parameters: nsites, sqrt_nsites, xmin, xmax, ymin, ymax,
+/* implicit parameters in vd: nsites, sqrt_nsites, xmin, xmax, ymin, ymax,
    deltax, deltay (can all be estimates).
    Performance suffers if they are wrong; better to make nsites,
    deltax, and deltay too big than too small.  (?) */
 
-voronoi(triangulate, nextsite)
-int triangulate;
+voronoi(vd, nextsite)
+struct Voronoi *vd;
 struct Site *(*nextsite)();
 {
 struct Site *newsite, *bot, *top, *temp, *p;
@@ -27,79 +19,78 @@ struct Halfedge *lbnd, *rbnd, *llbnd, *rrbnd, *bisector;
 struct Edge *e;
 
 
-PQinitialize();
-bottomsite = (*nextsite)();
-out_site(bottomsite);
-ELinitialize();
+PQinitialize(vd);
+vd->bottomsite = (*nextsite)(vd);
+out_site(vd, vd->bottomsite);
+ELinitialize(vd);
 
-newsite = (*nextsite)();
+newsite = (*nextsite)(vd);
 while(1)
 {
-	if(!PQempty()) newintstar = PQ_min();
+	if(!PQempty(vd)) newintstar = PQ_min(vd);
 
 	if (newsite != (struct Site *)NULL 
-	   && (PQempty() 
+	   && (PQempty(vd) 
 		 || newsite -> coord.y < newintstar.y
 	 	 || (newsite->coord.y == newintstar.y 
 		     && newsite->coord.x < newintstar.x)))
 	{/* new site is smallest */
-		out_site(newsite);
-		lbnd = ELleftbnd(&(newsite->coord));
+		out_site(vd, newsite);
+		lbnd = ELleftbnd(vd, &(newsite->coord));
 		rbnd = ELright(lbnd);
-		bot = rightreg(lbnd);
-		e = bisect(bot, newsite);
-		bisector = HEcreate(e, le);
+		bot = rightreg(vd, lbnd);
+		e = bisect(vd, bot, newsite);
+		bisector = HEcreate(vd, e, le);
 		ELinsert(lbnd, bisector);
-		if ((p = intersect(lbnd, bisector)) != (struct Site *) NULL) 
-		{	PQdelete(lbnd);
-			PQinsert(lbnd, p, dist(p,newsite));
+		if ((p = intersect(vd, lbnd, bisector)) != (struct Site *) NULL) 
+		{	PQdelete(vd, lbnd);
+			PQinsert(vd, lbnd, p, dist(p,newsite));
 		};
 		lbnd = bisector;
-		bisector = HEcreate(e, re);
+		bisector = HEcreate(vd, e, re);
 		ELinsert(lbnd, bisector);
-		if ((p = intersect(bisector, rbnd)) != (struct Site *) NULL)
-		{	PQinsert(bisector, p, dist(p,newsite));	
+		if ((p = intersect(vd, bisector, rbnd)) != (struct Site *) NULL)
+		{	PQinsert(vd, bisector, p, dist(p,newsite));	
 		};
-		newsite = (*nextsite)();	
+		newsite = (*nextsite)(vd);	
 	}
-	else if (!PQempty()) 
+	else if (!PQempty(vd)) 
 	/* intersection is smallest */
-	{	lbnd = PQextractmin();
+	{	lbnd = PQextractmin(vd);
 		llbnd = ELleft(lbnd);
 		rbnd = ELright(lbnd);
 		rrbnd = ELright(rbnd);
-		bot = leftreg(lbnd);
-		top = rightreg(rbnd);
-		out_triple(bot, top, rightreg(lbnd));
+		bot = leftreg(vd, lbnd);
+		top = rightreg(vd, rbnd);
+		out_triple(vd, bot, top, rightreg(vd, lbnd));
 		v = lbnd->vertex;
-		makevertex(v);
-		endpoint(lbnd->ELedge,lbnd->ELpm,v);
-		endpoint(rbnd->ELedge,rbnd->ELpm,v);
+		makevertex(vd, v);
+		endpoint(vd, lbnd->ELedge,lbnd->ELpm,v);
+		endpoint(vd, rbnd->ELedge,rbnd->ELpm,v);
 		ELdelete(lbnd); 
-		PQdelete(rbnd);
+		PQdelete(vd, rbnd);
 		ELdelete(rbnd); 
 		pm = le;
 		if (bot->coord.y > top->coord.y)
 		{	temp = bot; bot = top; top = temp; pm = re;}
-		e = bisect(bot, top);
-		bisector = HEcreate(e, pm);
+		e = bisect(vd, bot, top);
+		bisector = HEcreate(vd, e, pm);
 		ELinsert(llbnd, bisector);
-		endpoint(e, re-pm, v);
-		deref(v);
-		if((p = intersect(llbnd, bisector)) != (struct Site *) NULL)
-		{	PQdelete(llbnd);
-			PQinsert(llbnd, p, dist(p,bot));
+		endpoint(vd, e, re-pm, v);
+		deref(vd, v);
+		if((p = intersect(vd, llbnd, bisector)) != (struct Site *) NULL)
+		{	PQdelete(vd, llbnd);
+			PQinsert(vd, llbnd, p, dist(p,bot));
 		};
-		if ((p = intersect(bisector, rrbnd)) != (struct Site *) NULL)
-		{	PQinsert(bisector, p, dist(p,bot));
+		if ((p = intersect(vd, bisector, rrbnd)) != (struct Site *) NULL)
+		{	PQinsert(vd, bisector, p, dist(p,bot));
 		};
 	}
 	else break;
 };
 
-for(lbnd=ELright(ELleftend); lbnd != ELrightend; lbnd=ELright(lbnd))
+for(lbnd=ELright(vd->ELleftend); lbnd != vd->ELrightend; lbnd=ELright(lbnd))
 	{	e = lbnd -> ELedge;
-		out_ep(e);
+		out_ep(vd, e);
 	};
-finish_pl();
 }
@@ -0,0 +1,94 @@
+#ifndef VORONOI_H
+#define VORONOI_H
+/* Library interface of the sweep.  All the state of a diagram is in a
+   struct Voronoi, so any number of them can run at the same time, one
+   per thread.  The diagram is given to the callbacks of a
+   struct VoronoiOutput while the sweep is running. */
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Point	{
+float x,y;
+};
+
+/* structure used both for sites and for vertices */
+struct Site	{
+struct	Point	coord;
+int		sitenbr;
+int		refcnt;
+};
+
+struct Edge	{
+double		a,b,c;
+struct	Site 	*ep[2];
+struct	Site	*reg[2];
+int		edgenbr;
+};
+#define le 0
+#define re 1
+
+/* The sites, vertices and edges passed to the callbacks are reused by
+   the sweep after the call, copy what is needed.  A callback can be
+   NULL. */
+struct VoronoiOutput	{
+void	*arg;			/* first argument of every callback */
+void	(*begin)(void *arg, float xmin, float xmax, float ymin, float ymax);
+void	(*site)(void *arg, struct Site *s);
+void	(*bisector)(void *arg, struct Edge *e);		/* line e->a x + e->b y = e->c */
+void	(*vertex)(void *arg, struct Site *v);
+void	(*edge)(void *arg, struct Edge *e);		/* e->ep[le], e->ep[re] are NULL at infinity */
+void	(*triple)(void *arg, struct Site *s1, struct Site *s2, struct Site *s3);
+void	(*end)(void *arg);
+};
+
+struct Voronoi;
+
+/* NULL if there is no memory */
+struct Voronoi *voronoi_create(const struct VoronoiOutput *output);
+void voronoi_destroy(struct Voronoi *vd);
+
+/* Compute the diagram of n sites, they are sorted and the duplicates
+   dropped.  Returns 0, or -1 if it ran out of memory.  Everything it
+   allocated is freed before it returns, the context can be run again. */
+int voronoi_run(struct Voronoi *vd, const struct Point *sites, int n);
+
+/* The same on sites that come sorted on y, then x, from next, which
+   returns 0 after the last one.  nsites and the range are estimates
+   for the hash tables, see the -s option in voronoi.man. */
+int voronoi_run_sorted(struct Voronoi *vd, int nsites,
+	float xmin, float xmax, float ymin, float ymax,
+	int (*next)(void *arg, struct Point *p), void *arg);
+
+/* An output that writes the records of the voronoi program to file */
+struct VoronoiPrinter	{
+FILE	*file;
+int	triangulate, plot, debug;
+float	pxmin, pxmax, pymin, pymax, cradius;
+};
+void voronoi_printer(struct VoronoiOutput *output, struct VoronoiPrinter *printer,
+	FILE *file, int triangulate, int plot, int debug);
+
+/* The same records packed, a tag byte and the numbers in the byte order
+   of the machine, float is 4 bytes, double 8 and int 4:
+	's' float x, y		site
+	'l' double a, b, c	line
+	'v' float x, y		vertex
+	'e' int l, v1, v2	edge
+	't' int i, j, k		triangle, only with triangulate */
+#define VORONOI_RECORD_SITE	's'
+#define VORONOI_RECORD_LINE	'l'
+#define VORONOI_RECORD_VERTEX	'v'
+#define VORONOI_RECORD_EDGE	'e'
+#define VORONOI_RECORD_TRIANGLE	't'
+void voronoi_binary_printer(struct VoronoiOutput *output, struct VoronoiPrinter *printer,
+	FILE *file, int triangulate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif